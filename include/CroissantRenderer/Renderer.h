@@ -15,6 +15,7 @@
 #include <CroissantRenderer/Pipeline/Graphics.h>
 #include <CroissantRenderer/Pipeline/Compute.h>
 #include <CroissantRenderer/Features/DepthBuffer.h>
+#include <CroissantRenderer/Features/GBuffer.h>
 #include <CroissantRenderer/RenderPass/RenderPass.h>
 #include <CroissantRenderer/Command/CommandPool.h>
 #include <CroissantRenderer/Device/Device.h>
@@ -27,8 +28,12 @@
 #include <CroissantRenderer/Camera/Camera.h>
 #include <CroissantRenderer/Camera/Types/Arcball.h>
 #include <CroissantRenderer/Features/ShadowMap.h>
+#include <CroissantRenderer/Features/ShadowAtlas.h>
 #include <CroissantRenderer/VKinstance/VKinstance.h>
 #include <CroissantRenderer/Scene/Scene.h>
+#include <CroissantRenderer/Scene/RenderPath.h>
+#include <CroissantRenderer/Job/JobSystem.h>
+#include <CroissantRenderer/Culling/GPUculling.h>
 
 class Renderer
 {
@@ -36,13 +41,30 @@ class Renderer
 public:
 
    void run();
+   // (before run())
+   void setRenderPath(const RenderPath renderPath);
    void addObjectPBR(
          const std::string& name,
          const std::string& folderName,
          const std::string& fileName,
          const glm::fvec3& pos = glm::fvec4(0.0f),
          const glm::fvec3& rot = glm::fvec3(0.0f),
-         const glm::fvec3& size = glm::fvec3(1.0f)
+         const glm::fvec3& size = glm::fvec3(1.0f),
+         const bool isOccluder = false,
+         const bool receivesShadows = true,
+         const bool usesIBL = true
+   );
+   void addObjectPBRInstances(
+         const std::string& name,
+         const std::string& folderName,
+         const std::string& fileName,
+         const std::vector<glm::mat4>& instances,
+         const glm::fvec3& pos = glm::fvec4(0.0f),
+         const glm::fvec3& rot = glm::fvec3(0.0f),
+         const glm::fvec3& size = glm::fvec3(1.0f),
+         const bool isOccluder = false,
+         const bool receivesShadows = true,
+         const bool usesIBL = true
    );
    void addDirectionalLight(
          const std::string& name,
@@ -107,6 +129,8 @@ private:
          const std::vector<VkClearValue>& clearValues,
          const std::shared_ptr<CommandPool>& commandPool
    );
+   void recordShadowMapCommandBuffer(const uint32_t currentFrame);
+   void recordShadowAtlasCommandBuffer(const uint32_t currentFrame);
    void drawFrame(uint8_t& currentFrame);
 
    void createSyncObjects();
@@ -123,6 +147,8 @@ private:
 
    std::shared_ptr<Swapchain>          m_swapchain;
 
+   std::shared_ptr<JobSystem>          m_jobSystem;
+
    Scene                               m_scene;
 
    std::vector<VkSemaphore>            m_imageAvailableSemaphores;
@@ -146,9 +172,17 @@ private:
    // milliseconds per frame
    double m_mpf;
 
+   RenderPath                          m_renderPath = RenderPath::FORWARD;
+
    //---------------------------Features--------------------------------------
    DepthBuffer                                         m_depthBuffer;
    MSAA                                                m_msaa;
+   // (only used by the deferred path)
+   GBuffer                                             m_gBuffer;
    std::shared_ptr<ShadowMap<Attributes::PBR::Vertex>> m_shadowMap;
+   // (point and spot lights)
+   std::shared_ptr<ShadowAtlas>                        m_shadowAtlas;
+   // (nullptr if the culling is done on the CPU)
+   std::shared_ptr<GPUculling>                         m_GPUculling;
 
 };
@@ -22,4 +22,141 @@ namespace COMPUTE_PIPELINE
 
       };
    };
+
+   namespace CULLING
+   {
+      // Invocations per work group(the same as in the shader).
+      inline const uint32_t WORK_GROUP_SIZE = 64;
+
+      // Draws, frame data, indirect commands, stats, instances, draw of each
+      // instance, visible instances, Hi-Z pyramid and visibility of each
+      // instance in the last frame.
+      inline const std::vector<DescriptorInfo> BUFFERS_INFO = {
+         {
+            0,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            1,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            2,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            3,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            4,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            5,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            6,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            7,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            8,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         }
+      };
+   };
+
+   namespace HI_Z
+   {
+      // Invocations per work group in each axis(the same as in the shader).
+      inline const uint32_t WORK_GROUP_SIZE = 8;
+
+      // Depth of the occluders and pyramid.
+      inline const std::vector<DescriptorInfo> BUFFERS_INFO = {
+         {
+            0,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            1,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         }
+      };
+   };
+
+   namespace LIGHT_CLUSTERS
+   {
+      // Invocations per work group(the same as in the shader).
+      inline const uint32_t WORK_GROUP_SIZE = 64;
+
+      // Frame data, lights, light grid and light indices.
+      inline const std::vector<DescriptorInfo> BUFFERS_INFO = {
+         {
+            0,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            1,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            2,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         },
+         {
+            3,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_COMPUTE_BIT
+            )
+         }
+      };
+   };
 };
@@ -6,6 +6,7 @@
 #include <vulkan/vulkan.h>
 
 #include <CroissantRenderer/Descriptor/DescriptorInfo.h>
+#include <CroissantRenderer/Features/ShadowFilter.h>
 
 namespace config
 {
@@ -21,8 +22,114 @@ namespace config
    inline const float Z_NEAR = 0.01f;
    inline const float Z_FAR = 200.0f;
 
-   // Scene
-   inline const uint32_t LIGHTS_COUNT = 10;
+   // Geometry
+   // Size of the(FIFO) post-transform vertex cache targeted by the meshes
+   // optimization at import time.
+   inline const uint32_t VERTEX_CACHE_SIZE = 16;
+
+   // LODs
+   // Max. count of LODs of each mesh(including the original one).
+   inline const uint32_t LOD_COUNT = 5;
+   // Max. simplification error, relative to the size of the mesh.
+   inline const float LOD_MAX_ERROR = 0.05f;
+   // Max. error on screen(in pixels) of the LOD selected each frame.
+   inline const float LOD_PIXEL_ERROR = 1.0f;
+
+   // Culling
+   // Culls the meshes and selects their LODs in a compute pass and draws them
+   // with indirect draws(needs the multiDrawIndirect feature, otherwise the
+   // culling is done on the CPU).
+   inline const bool GPU_CULLING = false;
+   // Also culls the meshes hidden behind others with a Hi-Z pyramid(only
+   // with GPU_CULLING).
+   inline const bool OCCLUSION_CULLING = true;
+   // Without GPU_CULLING, culls the meshes hidden behind the occluders(see
+   // Renderer::addObjectPBR()) with a depth buffer rasterized on the CPU.
+   inline const bool SOFTWARE_OCCLUSION_CULLING = true;
+   // Size of the depth buffer of the occluders(in pixels).
+   inline const uint32_t SOFTWARE_OCCLUSION_W = 320;
+   inline const uint32_t SOFTWARE_OCCLUSION_H = 180;
+
+   // Shadows
+   // Count of cascades of the shadow map of the directional light(2-4). Each
+   // one covers a split of the view frustum with its own orthographic
+   // projection.
+   inline const uint32_t SHADOW_CASCADES_COUNT = 4;
+   // Size of each cascade(in texels), independent of the window.
+   inline const uint32_t SHADOW_MAP_RESOLUTION = 2048;
+   // Distance from the camera covered by the cascades.
+   inline const float SHADOW_DISTANCE = 60.0f;
+   // Splits of the cascades, from uniform(0) to logarithmic(1).
+   inline const float SHADOW_CASCADES_SPLIT_LAMBDA = 0.8f;
+   // Distance towards the light where the casters of each cascade are still
+   // drawn(they can be outside of the view frustum).
+   inline const float SHADOW_CASTERS_DISTANCE = 50.0f;
+   // Keeps the layer of each cascade between frames and only draws it again
+   // when its light space or the casters change.
+   inline const bool SHADOW_CACHING = true;
+   // Extra radius(fraction of the split) of the projection of the cascades
+   // after the first one. With the cache they keep their projection until
+   // the split leaves it, so they aren't drawn again each time the camera
+   // moves or rotates a little(the first one is fitted every frame).
+   inline const float SHADOW_CASCADES_MARGIN = 0.25f;
+   // Kernel of the shadows of all the lights(see ShadowFilter).
+   inline const ShadowFilter SHADOW_FILTER = ShadowFilter::PCF_3X3;
+   // Shadow atlas of the point and spot lights: a depth image splitted in
+   // tiles, one per spot light and one per face of each point light. The
+   // lights that don't fit aren't shadowed.
+   inline const uint32_t SHADOW_ATLAS_RESOLUTION = 4096;
+   inline const uint32_t SHADOW_ATLAS_TILE_SIZE = 512;
+   // Budget of each frame: the outdated tiles are drawn from the most
+   // important and stale ones, up to this count of tiles and of triangles
+   // (at least one tile is drawn).
+   inline const uint32_t SHADOW_ATLAS_TILES_PER_FRAME = 4;
+   inline const uint32_t SHADOW_ATLAS_TRIANGLES_BUDGET = 2000000;
+   // Near plane of the projections of the tiles(the far one is the radius of
+   // the light).
+   inline const float SHADOW_ATLAS_Z_NEAR = 0.05f;
+
+   // Depth pre-pass
+   // Initial state of the depth pre-pass of the PBR models(it can be toggled
+   // from the GUI). The pre-pass only writes the depth, so the PBR shading
+   // runs once per visible sample.
+   inline const bool DEPTH_PREPASS = false;
+
+   // Clustered lighting
+   // Count of clusters(froxels) of the view frustum in each axis. The depth
+   // is splitted exponentially between Z_NEAR and Z_FAR.
+   inline const uint32_t CLUSTERS_X = 16;
+   inline const uint32_t CLUSTERS_Y = 9;
+   inline const uint32_t CLUSTERS_Z = 24;
+   // Max. count of lights of each cluster(the rest are ignored).
+   inline const uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+   // Radiance below which a point/spot light is ignored(it gives the radius
+   // of the lights).
+   inline const float LIGHT_MIN_RADIANCE = 0.05f;
+
+   // Textures
+   // Max. count of textures of the materials of the scene(the size of the
+   // bindless texture table, clamped to the limits of the device).
+   inline const uint32_t MAX_BINDLESS_TEXTURES = 4096;
+
+   // Uniforms
+   // Size of the uniform ring of each frame in flight, where the UBOs of all
+   // the models are written every frame.
+   inline const VkDeviceSize UNIFORM_RING_SIZE = 4 * 1024 * 1024;
+
+   // Upload
+   // Size of the staging ring used to upload the buffers to the device.
+   inline const VkDeviceSize STAGING_BUFFER_SIZE = 64 * 1024 * 1024;
+
+   // Memory
+   // Size of the blocks where the buffers and images are sub-allocated.
+   inline const VkDeviceSize MEMORY_BLOCK_SIZE = 256 * 1024 * 1024;
+
+   // Pipelines
+   // Keeps the pipeline cache of the driver in PIPELINE_CACHE_FILE(next to
+   // the shader binaries) between runs, so a warm start skips most of the
+   // compilation of the pipelines.
+   inline const bool PIPELINE_CACHE = true;
+   inline const char* PIPELINE_CACHE_FILE = "pipeline.cache";
 
    // BRDF
    inline const uint32_t BRDF_WIDTH  = 256;
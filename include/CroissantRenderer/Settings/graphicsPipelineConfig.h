@@ -1,5 +1,7 @@
 #pragma once
 
+#include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
+
 namespace GRAPHICS_PIPELINE
 {
    /////////////////////////////For PBR Models/////////////////////////////////
@@ -8,58 +10,91 @@ namespace GRAPHICS_PIPELINE
    {
 
       inline const std::vector<DescriptorInfo> UBOS_INFO = {
+         // (slice of the uniform ring)
          {
             0,
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_VERTEX_BIT |
                   VK_SHADER_STAGE_FRAGMENT_BIT
-            )
+            ),
+            sizeof(DescriptorTypes::UniformBufferObject::NormalPBR)
          },
+         // Lights of the scene
          {
             1,
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_FRAGMENT_BIT
             )
-         }
-      };
-      inline const std::vector<DescriptorInfo> SAMPLERS_INFO = {
+         },
+         // Instances(transforms)
          {
-            2,
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            11,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             (VkShaderStageFlagBits)(
-                  VK_SHADER_STAGE_FRAGMENT_BIT
+                  VK_SHADER_STAGE_VERTEX_BIT
             )
          },
+         // Visible instances(indices of the instances drawn)
          {
-            3,
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            12,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_VERTEX_BIT
+            )
+         },
+         // Instance materials(index of the material of each instance)
+         {
+            13,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_VERTEX_BIT
+            )
+         },
+         // Materials(factors and indices in the texture table)
+         {
+            14,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_FRAGMENT_BIT
             )
          },
+         // Clusters(grid of the frame)
          {
-            4,
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            15,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_FRAGMENT_BIT
             )
          },
+         // Light grid(count of lights of each cluster)
          {
-            5,
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            16,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_FRAGMENT_BIT
             )
          },
+         // Light indices(lights of each cluster)
          {
-            6,
-            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            17,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_FRAGMENT_BIT
             )
          },
+         // Tiles of the shadow atlas(light space of each one)
+         {
+            23,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         }
+      };
+      // (the textures of the materials are in the texture table)
+      inline const std::vector<DescriptorInfo> SAMPLERS_INFO = {
          // Irradiance Map
          // (IMPORTANT: Always leave it positioned before the BRDF lut map)
          {
@@ -88,21 +123,40 @@ namespace GRAPHICS_PIPELINE
             )
          },
          // Shadow Map
-         // (IMPORTANT: Always leave it as the last sampler)
+         // (IMPORTANT: Always leave it positioned before the shadow atlas)
          {
             10,
             VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_FRAGMENT_BIT
             )
+         },
+         // Shadow atlas(point and spot lights)
+         // (IMPORTANT: Always leave it as the last sampler)
+         {
+            22,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
          }
       };
 
-      // We don't count the shadow , BRDF, prefilteredEnvMap and irradiance map.
-      inline const uint32_t TEXTURES_PER_MESH_COUNT = SAMPLERS_INFO.size() - 4;
-      //inline const uint32_t TEXTURES_PER_MESH_COUNT = SAMPLERS_INFO.size() - 3;
-      inline const uint32_t SAMPLERS_PER_MESH_COUNT = SAMPLERS_INFO.size();
-      inline const uint32_t UBOS_PER_MESH_COUNT = UBOS_INFO.size();
+      // Texture table(bindless), shared by all the PBR models.
+      // (set TEXTURES_SET, an array of textures)
+      inline const uint32_t TEXTURES_SET = 1;
+      inline const DescriptorInfo TEXTURES_INFO = {
+         0,
+         VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+         (VkShaderStageFlagBits)(
+               VK_SHADER_STAGE_FRAGMENT_BIT
+         )
+      };
+
+      // Base color, metallic-roughness, emissive, AO and normal.
+      inline const uint32_t TEXTURES_PER_MESH_COUNT = 5;
+      inline const uint32_t SAMPLERS_PER_MODEL_COUNT = SAMPLERS_INFO.size();
+      inline const uint32_t UBOS_PER_MODEL_COUNT = UBOS_INFO.size();
 
    };
 
@@ -111,12 +165,14 @@ namespace GRAPHICS_PIPELINE
    {
       
       inline const std::vector<DescriptorInfo> UBOS_INFO = {
+         // (slice of the uniform ring)
          {
             0,
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_VERTEX_BIT
-            )
+            ),
+            sizeof(DescriptorTypes::UniformBufferObject::Skybox)
          }
       };
 
@@ -139,13 +195,15 @@ namespace GRAPHICS_PIPELINE
    namespace LIGHT
    {
       inline const std::vector<DescriptorInfo> UBOS_INFO = {
+         // (slice of the uniform ring)
          {
             0,
-            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_VERTEX_BIT |
                   VK_SHADER_STAGE_FRAGMENT_BIT
-            )
+            ),
+            sizeof(DescriptorTypes::UniformBufferObject::Light)
          }
       };
       inline const std::vector<DescriptorInfo> SAMPLERS_INFO = {
@@ -162,6 +220,140 @@ namespace GRAPHICS_PIPELINE
       inline const uint32_t UBOS_PER_MESH_COUNT = UBOS_INFO.size();
    };
 
+   ////////////////////////////Deferred Lighting/////////////////////////////
+   // (lighting subpass of the deferred path, a full-screen triangle)
+
+   namespace DEFERRED_LIGHTING
+   {
+      inline const std::vector<DescriptorInfo> UBOS_INFO = {
+         // (slice of the uniform ring)
+         {
+            0,
+            VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            ),
+            sizeof(DescriptorTypes::UniformBufferObject::DeferredLighting)
+         },
+         // Lights of the scene
+         {
+            1,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Clusters(grid of the frame)
+         {
+            15,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Light grid(count of lights of each cluster)
+         {
+            16,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Light indices(lights of each cluster)
+         {
+            17,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Tiles of the shadow atlas(light space of each one)
+         {
+            23,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         }
+      };
+      // (the same IBL and shadow map bindings as the PBR models)
+      inline const std::vector<DescriptorInfo> SAMPLERS_INFO = {
+         // G-buffer(albedo-metallic, normal-roughness and emissive-AO)
+         // (IMPORTANT: Always leave the input attachments first)
+         {
+            18,
+            VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         {
+            19,
+            VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         {
+            20,
+            VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Depth
+         {
+            21,
+            VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Irradiance Map
+         {
+            7,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // BRDF lut
+         {
+            8,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Prefiltered env. map
+         {
+            9,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Shadow Map
+         // (IMPORTANT: Always leave it positioned before the shadow atlas)
+         {
+            10,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         },
+         // Shadow atlas(point and spot lights)
+         // (IMPORTANT: Always leave it as the last sampler)
+         {
+            22,
+            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_FRAGMENT_BIT
+            )
+         }
+      };
+   };
+
    ////////////////////////////////////////////////////////////////////////////
    ///////////////////////////////FEATURES/////////////////////////////////////
    ////////////////////////////////////////////////////////////////////////////
@@ -176,13 +368,55 @@ namespace GRAPHICS_PIPELINE
             (VkShaderStageFlagBits)(
                   VK_SHADER_STAGE_VERTEX_BIT
             )
+         },
+         // Instances(transforms)
+         {
+            1,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_VERTEX_BIT
+            )
+         },
+         // Visible instances(indices of the instances drawn)
+         {
+            2,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_VERTEX_BIT
+            )
          }
       };
  
-      inline const uint32_t UBOS_COUNT = UBOS_INFO.size();
+      inline const uint32_t UBOS_COUNT = 1;
+      inline const uint32_t STORAGE_BUFFERS_COUNT = UBOS_INFO.size() - 1;
       inline const uint32_t SAMPLERS_COUNT = 0;
    };
 
+   //////////////////////////////Shadow Atlas//////////////////////////////////
+   namespace SHADOW_ATLAS
+   {
+      inline const std::vector<DescriptorInfo> UBOS_INFO = {
+         // Tiles(light space of each one)
+         {
+            0,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_VERTEX_BIT
+            )
+         },
+         // Instances(transforms)
+         {
+            1,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            (VkShaderStageFlagBits)(
+                  VK_SHADER_STAGE_VERTEX_BIT
+            )
+         }
+      };
+
+      inline const uint32_t STORAGE_BUFFERS_COUNT = UBOS_INFO.size();
+   };
+
    namespace PREFILTER_ENV_MAP
    {
       inline const std::vector<DescriptorInfo> SAMPLERS_INFO = {
@@ -0,0 +1,79 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Second subpass of the deferred path: lights each sample of the G-buffer,
+// read as input attachments(so the tile-based GPUs can keep it on-chip).
+// The position is reconstructed from the depth.
+
+const uint MAX_SHADOW_CASCADES = 4;
+
+layout(std140, binding = 0) uniform UniformBufferObject
+{
+   mat4 view;
+   mat4 invViewProj;
+   // Shadow map(see ShadowCascades)
+   mat4 lightSpaces[MAX_SHADOW_CASCADES];
+   vec4 cascadeSplits;
+   vec4 cameraPos;
+   int  lightsCount;
+   int  cascadesCount;
+
+} ubo;
+
+#include "pbrLighting.glsl"
+#include "gBuffer.glsl"
+
+layout(input_attachment_index = 0, binding = 18)
+   uniform subpassInputMS inAlbedoMetallic;
+layout(input_attachment_index = 1, binding = 19)
+   uniform subpassInputMS inNormalRoughness;
+layout(input_attachment_index = 2, binding = 20)
+   uniform subpassInputMS inEmissiveAO;
+layout(input_attachment_index = 3, binding = 21)
+   uniform subpassInputMS inDepth;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+   float depth = subpassLoad(inDepth, gl_SampleID).r;
+
+   // (background, drawn by the skybox)
+   if (depth >= 1.0)
+      discard;
+
+   vec4 albedoMetallic = subpassLoad(inAlbedoMetallic, gl_SampleID);
+   vec4 normalRoughness = subpassLoad(inNormalRoughness, gl_SampleID);
+   vec4 emissiveAO = subpassLoad(inEmissiveAO, gl_SampleID);
+
+   Material material;
+   material.albedo = albedoMetallic.rgb;
+   material.metallicFactor = albedoMetallic.a;
+   material.roughnessFactor = normalRoughness.b;
+   material.emissiveColor = emissiveAO.rgb;
+   material.AO = emissiveAO.a;
+   decodeLightingFeatures(
+         normalRoughness.a,
+         material.receivesShadows,
+         material.usesIBL
+   );
+
+   vec2 ndc = gl_FragCoord.xy / clusters.screenSize * 2.0 - 1.0;
+   vec4 position = ubo.invViewProj * vec4(ndc, depth, 1.0);
+   position /= position.w;
+
+   float viewDepth = -(ubo.view * position).z;
+   int cascade = getCascade(viewDepth, ubo.cascadeSplits, ubo.cascadesCount);
+
+   vec3 color = shadePBR(
+         material,
+         position.xyz,
+         decodeNormal(normalRoughness.xy),
+         vec3(ubo.cameraPos),
+         viewDepth,
+         shadowBias * ubo.lightSpaces[cascade] * position,
+         cascade
+   );
+
+   outColor = ambient * vec4(color, 1.0);
+}
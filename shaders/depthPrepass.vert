@@ -0,0 +1,44 @@
+#version 450
+
+// Depth pre-pass of the PBR models. It only reads the position stream and
+// has no fragment shader. The PBR pass after it uses the depth compare EQUAL,
+// so gl_Position has to be computed exactly as in scene.vert(invariant).
+
+const uint MAX_SHADOW_CASCADES = 4;
+
+layout(std140, binding = 0) uniform UniformBufferObject
+{
+   mat4 model;
+   mat4 view;
+   mat4 proj;
+   // Shadow map(see ShadowCascades)
+   mat4 lightSpaces[MAX_SHADOW_CASCADES];
+   vec4 cascadeSplits;
+   vec4 cameraPos;
+   int  lightsCount;
+   int  cascadesCount;
+
+} ubo;
+
+layout(std430, binding = 11) readonly buffer Instances
+{
+   mat4 instances[];
+};
+
+layout(std430, binding = 12) readonly buffer VisibleInstances
+{
+   uint visibleInstances[];
+};
+
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main()
+{
+   mat4 model = ubo.model * instances[visibleInstances[gl_InstanceIndex]];
+
+   gl_Position = (
+         ubo.proj * ubo.view * model * vec4(inPosition, 1.0)
+   );
+}
@@ -0,0 +1,31 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_GOOGLE_include_directive : require
+
+// First subpass of the deferred path: writes the material of the PBR models
+// to the G-buffer(the lighting is done once per sample in
+// deferredLighting.frag).
+
+#include "pbrLighting.glsl"
+#include "pbrMaterial.glsl"
+#include "gBuffer.glsl"
+
+layout(location = 0) out vec4 outAlbedoMetallic;
+layout(location = 1) out vec4 outNormalRoughness;
+layout(location = 2) out vec4 outEmissiveAO;
+
+void main()
+{
+   MaterialInfo materialInfo = materials[inMaterial];
+
+   Material material = getMaterial(materialInfo);
+   vec3 normal = calculateNormal(materialInfo);
+
+   outAlbedoMetallic = vec4(material.albedo, material.metallicFactor);
+   outNormalRoughness = vec4(
+         encodeNormal(normal),
+         material.roughnessFactor,
+         encodeLightingFeatures(material.receivesShadows, material.usesIBL)
+   );
+   outEmissiveAO = vec4(material.emissiveColor, material.AO);
+}
@@ -0,0 +1,52 @@
+// Layout of the G-buffer of the deferred path(see GBuffer):
+//    0 (RGBA8)       -> albedo, metallic
+//    1 (A2B10G10R10) -> normal(octahedral), roughness, lighting features
+//                       (receives shadows and uses IBL, 1 bit each)
+//    2 (RGBA8)       -> emissive color, AO
+
+vec2 octahedralWrap(vec2 v)
+{
+   return (1.0 - abs(v.yx)) * vec2(
+         (v.x >= 0.0) ? 1.0 : -1.0,
+         (v.y >= 0.0) ? 1.0 : -1.0
+   );
+}
+
+// Unit vector -> [0, 1]^2
+vec2 encodeNormal(vec3 n)
+{
+   n /= abs(n.x) + abs(n.y) + abs(n.z);
+   n.xy = (n.z >= 0.0) ? n.xy : octahedralWrap(n.xy);
+
+   return n.xy * 0.5 + 0.5;
+}
+
+// (in the 2 bits of the alpha of the attachment 1)
+float encodeLightingFeatures(bool receivesShadows, bool usesIBL)
+{
+   return float((receivesShadows ? 1 : 0) + (usesIBL ? 2 : 0)) / 3.0;
+}
+
+void decodeLightingFeatures(
+      float encoded,
+      out bool receivesShadows,
+      out bool usesIBL
+) {
+   uint features = uint(round(encoded * 3.0));
+
+   receivesShadows = (features & 1u) != 0u;
+   usesIBL = (features & 2u) != 0u;
+}
+
+vec3 decodeNormal(vec2 encoded)
+{
+   encoded = encoded * 2.0 - 1.0;
+
+   vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   float t = clamp(-n.z, 0.0, 1.0);
+
+   n.x += (n.x >= 0.0) ? -t : t;
+   n.y += (n.y >= 0.0) ? -t : t;
+
+   return normalize(n);
+}
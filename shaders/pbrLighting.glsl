@@ -0,0 +1,813 @@
+// PBR lighting shared by the forward(scene.frag) and the deferred
+// (deferredLighting.frag) paths: IBL + the lights of the cluster of the
+// fragment(see lightClusters.comp) + the shadow of the directional light
+// (cascaded, see ShadowMap) + the shadows of the point and spot lights(see
+// ShadowAtlas).
+// Both pipelines use the same bindings for the resources declared here.
+
+struct Light
+{
+   vec4 pos;
+   vec4 dir;
+   vec4 color;
+   float attenuation;
+   float radius;
+   float intensity;
+   int type;
+   // (-1 if it has no shadow)
+   int shadowTile;
+   int padding[3];
+};
+
+layout(std430, binding = 1) readonly buffer Lights
+{
+   Light lights[];
+};
+
+// Clustered lighting(see lightClusters.comp): each fragment only shades the
+// lights of its cluster.
+layout(std430, binding = 15) readonly buffer Clusters
+{
+   mat4 view;
+   mat4 invProj;
+   vec2 screenSize;
+   vec2 tileSize;
+   float zNear;
+   float zFar;
+   float sliceScale;
+   float sliceBias;
+   uint clustersX;
+   uint clustersY;
+   uint clustersZ;
+   uint maxLightsPerCluster;
+   uint lightsCount;
+} clusters;
+
+layout(std430, binding = 16) readonly buffer LightGrid
+{
+   uint lightCounts[];
+};
+
+layout(std430, binding = 17) readonly buffer LightIndices
+{
+   uint lightIndices[];
+};
+
+// IBL Samplers
+layout(binding = 7) uniform samplerCube irradianceMapSampler;
+layout(binding = 8) uniform sampler2D   BRDFlutSampler;
+layout(binding = 9) uniform samplerCube prefilteredEnvMapSampler;
+
+// (one layer per cascade)
+// The shadow samplers compare the depth in the hardware(see ShadowMap): each
+// tap returns the lit fraction of the 2x2 texels around it.
+layout(binding = 10) uniform sampler2DArrayShadow shadowMapSampler;
+
+// Shadow atlas of the point and spot lights: light space of the last draw of
+// each tile(see ShadowAtlas).
+layout(std430, binding = 23) readonly buffer ShadowAtlasTiles
+{
+   uint tilesPerRow;
+   mat4 lightSpaces[];
+} atlasTiles;
+
+layout(binding = 22) uniform sampler2DShadow shadowAtlasSampler;
+
+// Filter of the shadows(see ShadowFilter), set when the pipeline is created,
+// so only the kernel used is compiled.
+const int SHADOW_FILTER_HARDWARE_2X2 = 0;
+const int SHADOW_FILTER_POISSON      = 1;
+const int SHADOW_FILTER_PCF_3X3      = 2;
+const int SHADOW_FILTER_PCF_5X5      = 3;
+
+layout(constant_id = 0) const int SHADOW_FILTER = SHADOW_FILTER_PCF_3X3;
+
+const int MAX_SHADOW_TAPS = 9;
+
+// (in texels)
+const float POISSON_RADIUS = 1.5;
+const vec2 POISSON_DISK[8] = vec2[](
+      vec2(-0.94201624, -0.39906216),
+      vec2( 0.94558609, -0.76890725),
+      vec2(-0.09418410, -0.92938870),
+      vec2( 0.34495938,  0.29387760),
+      vec2(-0.91588581,  0.45771432),
+      vec2(-0.81544232, -0.87912464),
+      vec2(-0.38277543,  0.27676845),
+      vec2( 0.97484398,  0.75648379)
+);
+
+struct Material
+{
+   vec3 albedo;
+   float metallicFactor;
+   float roughnessFactor;
+   vec3 emissiveColor;
+   float AO;
+   // Lighting features(see materialFeatures), from the variant of the
+   // pipeline in the forward path and from the G-buffer in the deferred one.
+   bool receivesShadows;
+   bool usesIBL;
+};
+
+struct PBRinfo
+{
+   // cos angle between normal and light direction.
+	float NdotL;
+   // cos angle between normal and view direction.
+	float NdotV;
+   // cos angle between normal and half vector.
+	float NdotH;
+   // cos angle between view direction and half vector.
+	float VdotH;
+   // Roughness value, as authored by the model creator.
+   float perceptualRoughness;
+   // Roughness mapped to a more linear value.
+   float alphaRoughness;
+   // color contribution from diffuse lighting.
+	vec3 diffuseColor;
+   // color contribution from specular lighting.
+	vec3 specularColor;
+   // full reflectance color(normal incidence angle)
+   vec3 reflectance0;
+   // reflectance color at grazing angle
+   vec3 reflectance90;
+};
+
+struct IBLinfo
+{
+   vec3 diffuseLight;
+   vec3 specularLight;
+   vec3 brdf;
+};
+
+const float PI = 3.14159265359;
+
+// (applied to the final color by the main of each path)
+float ambient = 0.3;
+
+/*
+ * We need to compute the current fragment’s position in the same
+ * space that the one we used when creating the shadowmap. So we need to
+ * transform it once with the usual MVP matrix, and another time with the
+ * depthMVP matrix. So this transforms [-1, 1] -> [0, 1].
+ */
+const mat4 shadowBias = mat4(
+      0.5, 0.0, 0.0, 0.0,
+      0.0, 0.5, 0.0, 0.0,
+      0.0, 0.0, 1.0, 0.0,
+      0.5, 0.5, 0.0, 1.0
+);
+
+
+//////////////////////////////////////PBR//////////////////////////////////////
+float distributionGGX(float nDotH, float rough);
+float geometricOcclusion(PBRinfo pbrInfo);
+vec3 fresnelSchlick(PBRinfo pbrInfo);
+///////////////////////////////////////////////////////////////////////////////
+
+uint getCluster(float viewDepth);
+float getRangeWindow(int i, float distance);
+vec3 calculateDirLight(
+      int i,
+      vec3 normal,
+      vec3 view,
+      Material material,
+      PBRinfo pbrInfo
+);
+vec3 calculatePointLight(
+      int i,
+      vec3 position,
+      vec3 normal,
+      vec3 view,
+      Material material,
+      PBRinfo pbrInfo
+);
+vec3 calculateSpotLight(
+      int i,
+      vec3 position,
+      vec3 normal,
+      vec3 view,
+      Material material,
+      PBRinfo pbrInfo
+);
+int getCascade(float viewDepth, vec4 cascadeSplits, int cascadesCount);
+int getShadowTaps(
+      out vec2 offsets[MAX_SHADOW_TAPS],
+      out float weights[MAX_SHADOW_TAPS]
+);
+float filterPCF(vec4 shadowCoords, int cascade);
+float calculateLocalShadow(int i, vec3 position);
+vec3 getIBLcontribution(PBRinfo pbrInfo, IBLinfo iblInfo, Material material);
+
+/*
+ * Color of the point(in world space) lit by the IBL and by the lights of its
+ * cluster, with its AO and emissive color.
+ *    -viewDepth: distance to the camera plane(positive).
+ *    -shadowCoords: position in the space of the cascade of the shadow map
+ *    (with the bias).
+ *    -cascade: cascade of the view depth(see getCascade()).
+ */
+vec3 shadePBR(
+      Material material,
+      vec3 position,
+      vec3 normal,
+      vec3 cameraPos,
+      float viewDepth,
+      vec4 shadowCoords,
+      int cascade
+) {
+   vec3 view = normalize(cameraPos - position);
+   vec3 reflection = -normalize(reflect(view, normal));
+
+   PBRinfo pbrInfo;
+   {
+      float F0 = 0.04;
+
+	   pbrInfo.NdotV = max(dot(normal, view), 0.001);
+      pbrInfo.diffuseColor = material.albedo.rgb * (vec3(1.0) - vec3(F0));
+      pbrInfo.diffuseColor *= 1.0 - material.metallicFactor;
+      pbrInfo.specularColor = mix(
+            vec3(F0),
+            material.albedo,
+            material.metallicFactor
+      );
+
+      pbrInfo.perceptualRoughness = clamp(material.roughnessFactor, 0.04, 1.0);
+      pbrInfo.alphaRoughness = (
+            pbrInfo.perceptualRoughness * pbrInfo.perceptualRoughness
+      );
+
+      // Reflectance
+      float reflectance = max(
+            max(pbrInfo.specularColor.r, pbrInfo.specularColor.g),
+            pbrInfo.specularColor.b
+      );
+      // - For typical incident reflectance range (between 4% to 100%) set the
+      // grazing reflectance to 100% for typical fresnel effect.
+	   // - For very low reflectance range on highly diffuse objects (below 4%),
+      // incrementally reduce grazing reflecance to 0%.
+      pbrInfo.reflectance0 = pbrInfo.specularColor.rgb;
+      pbrInfo.reflectance90 = vec3(clamp(reflectance * 25.0, 0.0, 1.0));
+   }
+
+   vec3 color = vec3(0.0);
+
+   if (material.usesIBL)
+   {
+      IBLinfo iblInfo;
+      {
+         // HDR textures are already linear
+         iblInfo.diffuseLight = texture(
+               irradianceMapSampler,
+               normal
+         ).rgb;
+
+         vec2 brdfSamplePoint = clamp(
+               vec2(
+                  pbrInfo.NdotV,
+                  1.0 - pbrInfo.perceptualRoughness
+               ),
+               vec2(0.0),
+               vec2(1.0)
+         );
+
+         float mipCount = float(textureQueryLevels(prefilteredEnvMapSampler));
+         float lod = pbrInfo.perceptualRoughness * mipCount;
+         iblInfo.brdf = textureLod(
+               BRDFlutSampler,
+               brdfSamplePoint,
+               0
+         ).rgb;
+
+         iblInfo.specularLight = textureLod(
+               prefilteredEnvMapSampler,
+               reflection.xyz,
+               lod
+         ).rgb;
+      }
+
+      color = getIBLcontribution(pbrInfo, iblInfo, material);
+   }
+
+   uint cluster = getCluster(viewDepth);
+   uint firstIndex = cluster * clusters.maxLightsPerCluster;
+   uint lightsCount = lightCounts[cluster];
+
+   for (uint j = 0; j < lightsCount; j++)
+   {
+      int i = int(lightIndices[firstIndex + j]);
+
+      // Directional Light
+      if (lights[i].type == 0)
+      {
+         float shadow = (material.receivesShadows) ? (
+               1.0 - filterPCF(shadowCoords / shadowCoords.w, cascade)
+         ) : 1.0;
+         color += calculateDirLight(
+               i,
+               normal,
+               view,
+               material,
+               pbrInfo
+          ) * shadow;
+
+      // Point Light
+      } else if(lights[i].type == 1)
+      {
+         float shadow = (material.receivesShadows) ? (
+               1.0 - calculateLocalShadow(i, position)
+         ) : 1.0;
+         color += calculatePointLight(
+               i,
+               position,
+               normal,
+               view,
+               material,
+               pbrInfo
+         ) * shadow;
+
+      } else
+      {
+         float shadow = (material.receivesShadows) ? (
+               1.0 - calculateLocalShadow(i, position)
+         ) : 1.0;
+         color += calculateSpotLight(
+               i,
+               position,
+               normal,
+               view,
+               material,
+               pbrInfo
+         ) * shadow;
+      }
+   }
+
+   // AO
+   color = material.AO * color;
+
+   // Emissive
+   color = material.emissiveColor + color;
+
+   return color;
+}
+
+vec3 getIBLcontribution(PBRinfo pbrInfo, IBLinfo iblInfo, Material material)
+{
+
+   vec3 diffuse = iblInfo.diffuseLight * pbrInfo.diffuseColor;
+   vec3 specular = (
+         iblInfo.specularLight *
+         (pbrInfo.specularColor * iblInfo.brdf.x + iblInfo.brdf.y)
+   );
+
+   return diffuse + specular;
+}
+
+/*
+ * Index of the cluster of the fragment(the same grid as lightClusters.comp).
+ */
+uint getCluster(float viewDepth)
+{
+   uint slice = uint(
+         max(log(viewDepth) * clusters.sliceScale - clusters.sliceBias, 0.0)
+   );
+   uvec2 tile = uvec2(gl_FragCoord.xy / clusters.tileSize);
+
+   slice = min(slice, clusters.clustersZ - 1);
+   tile = min(tile, uvec2(clusters.clustersX - 1, clusters.clustersY - 1));
+
+   return (
+         tile.x + clusters.clustersX * (tile.y + clusters.clustersY * slice)
+   );
+}
+
+/*
+ * Fades the point/spot light to 0 at its radius, so the light doesn't pop
+ * at the border of the clusters where it's culled.
+ */
+float getRangeWindow(int i, float distance)
+{
+   float ratio = distance / max(lights[i].radius, 0.0001);
+   float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+
+   return window * window;
+}
+
+/*
+ * Cascade of the shadow map that covers the view depth. The points past the
+ * last split use the last cascade(outside of it they aren't shadowed).
+ */
+int getCascade(float viewDepth, vec4 cascadeSplits, int cascadesCount)
+{
+   int cascade = 0;
+
+   for (int i = 0; i < cascadesCount - 1; i++)
+   {
+      if (viewDepth > cascadeSplits[i])
+         cascade = i + 1;
+   }
+
+   return cascade;
+}
+
+/*
+ * Taps of the shadow filter(offsets in texels and weights). A bilinear tap
+ * between 2 texels weights both, so the gaussian kernels put their taps
+ * between the texels that they weight:
+ *    -3x3: (1 2 1) in each axis -> 2 taps at -0.5 and 0.5.
+ *    -5x5: (1 4 6 4 1) in each axis -> 3 taps at -1.2, 0 and 1.2.
+ */
+int getShadowTaps(
+      out vec2 offsets[MAX_SHADOW_TAPS],
+      out float weights[MAX_SHADOW_TAPS]
+) {
+   if (SHADOW_FILTER == SHADOW_FILTER_HARDWARE_2X2)
+   {
+      offsets[0] = vec2(0.0);
+      weights[0] = 1.0;
+
+      return 1;
+   }
+
+   if (SHADOW_FILTER == SHADOW_FILTER_POISSON)
+   {
+      // (interleaved gradient noise)
+      float angle = 2.0 * PI * fract(
+            52.9829189 * fract(
+               dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))
+            )
+      );
+      float s = sin(angle);
+      float c = cos(angle);
+      mat2 rotation = mat2(c, s, -s, c);
+
+      for (int t = 0; t < 8; t++)
+      {
+         offsets[t] = rotation * POISSON_DISK[t] * POISSON_RADIUS;
+         weights[t] = 1.0 / 8.0;
+      }
+
+      return 8;
+   }
+
+   if (SHADOW_FILTER == SHADOW_FILTER_PCF_3X3)
+   {
+      int t = 0;
+
+      for (int x = 0; x < 2; x++)
+      {
+         for (int y = 0; y < 2; y++)
+         {
+            offsets[t] = vec2(x, y) - 0.5;
+            weights[t] = 0.25;
+            t++;
+         }
+      }
+
+      return 4;
+   }
+
+   const float axisOffsets[3] = float[](-1.2, 0.0, 1.2);
+   const float axisWeights[3] = float[](5.0 / 16.0, 6.0 / 16.0, 5.0 / 16.0);
+   int t = 0;
+
+   for (int x = 0; x < 3; x++)
+   {
+      for (int y = 0; y < 3; y++)
+      {
+         offsets[t] = vec2(axisOffsets[x], axisOffsets[y]);
+         weights[t] = axisWeights[x] * axisWeights[y];
+         t++;
+      }
+   }
+
+   return 9;
+}
+
+/*
+ * Shadow of the directional light(1 -> in shadow) in its cascade, filtered
+ * with the taps of SHADOW_FILTER.
+ */
+float filterPCF(vec4 shadowCoords, int cascade)
+{
+   // (outside of the cascade it isn't shadowed, the depth is in [0, 1])
+   if (shadowCoords.z <= 0.0 || shadowCoords.z >= 1.0 ||
+       any(lessThan(shadowCoords.xy, vec2(0.0))) ||
+       any(greaterThan(shadowCoords.xy, vec2(1.0)))
+   ) {
+      return 0.0;
+   }
+
+   vec2 texelSize = 1.0 / vec2(textureSize(shadowMapSampler, 0).xy);
+
+   vec2 offsets[MAX_SHADOW_TAPS];
+   float weights[MAX_SHADOW_TAPS];
+   int tapsCount = getShadowTaps(offsets, weights);
+
+   float lit = 0.0;
+
+   for (int t = 0; t < tapsCount; t++)
+   {
+      lit += weights[t] * texture(
+            shadowMapSampler,
+            vec4(
+               shadowCoords.xy + offsets[t] * texelSize,
+               float(cascade),
+               shadowCoords.z
+            )
+      );
+   }
+
+   return 1.0 - lit;
+}
+
+/*
+ * Shadow of the point or spot light i(1 -> in shadow), filtered with the taps
+ * of SHADOW_FILTER in its tile of the atlas. A point light uses the tile of
+ * the face of its cube that contains the point(+x, -x, +y, -y, +z, -z).
+ */
+float calculateLocalShadow(int i, vec3 position)
+{
+   int tile = lights[i].shadowTile;
+
+   // (the light didn't fit in the atlas)
+   if (tile < 0)
+      return 0.0;
+
+   if (lights[i].type == 1)
+   {
+      vec3 dir = position - vec3(lights[i].pos);
+      vec3 absDir = abs(dir);
+
+      if (absDir.x >= absDir.y && absDir.x >= absDir.z)
+         tile += (dir.x > 0.0) ? 0 : 1;
+      else if (absDir.y >= absDir.z)
+         tile += (dir.y > 0.0) ? 2 : 3;
+      else
+         tile += (dir.z > 0.0) ? 4 : 5;
+   }
+
+   vec4 shadowCoords = atlasTiles.lightSpaces[tile] * vec4(position, 1.0);
+
+   // (behind the light)
+   if (shadowCoords.w <= 0.0)
+      return 0.0;
+
+   shadowCoords /= shadowCoords.w;
+
+   if (shadowCoords.z <= 0.0 || shadowCoords.z >= 1.0 ||
+       any(greaterThan(abs(shadowCoords.xy), vec2(1.0)))
+   ) {
+      return 0.0;
+   }
+
+   // Rect of the tile in the atlas(without the border texels, so the
+   // bilinear taps don't read the next tiles).
+   float tileSize = 1.0 / float(atlasTiles.tilesPerRow);
+   vec2 tileOrigin = vec2(
+         uint(tile) % atlasTiles.tilesPerRow,
+         uint(tile) / atlasTiles.tilesPerRow
+   ) * tileSize;
+   vec2 texelSize = 1.0 / vec2(textureSize(shadowAtlasSampler, 0));
+   vec2 uvMin = tileOrigin + texelSize * 0.5;
+   vec2 uvMax = tileOrigin + vec2(tileSize) - texelSize * 0.5;
+
+   vec2 uv = tileOrigin + (shadowCoords.xy * 0.5 + 0.5) * tileSize;
+
+   vec2 offsets[MAX_SHADOW_TAPS];
+   float weights[MAX_SHADOW_TAPS];
+   int tapsCount = getShadowTaps(offsets, weights);
+
+   float lit = 0.0;
+
+   for (int t = 0; t < tapsCount; t++)
+   {
+      vec2 sampleUV = clamp(uv + offsets[t] * texelSize, uvMin, uvMax);
+
+      lit += weights[t] * texture(
+            shadowAtlasSampler,
+            vec3(sampleUV, shadowCoords.z)
+      );
+   }
+
+   return 1.0 - lit;
+}
+
+vec3 calculateDirLight(
+      int i,
+      vec3 normal,
+      vec3 view,
+      Material material,
+      PBRinfo pbrInfo
+) {
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Fills the data left for PBR
+   vec3 lightDir = normalize(-vec3(lights[i].dir));
+   vec3 halfway = normalize(view + lightDir);
+
+   {
+      pbrInfo.NdotL = max(dot(normal, lightDir), 0.0);
+      pbrInfo.NdotH = max(dot(normal, halfway), 0.0);
+      pbrInfo.VdotH = max(dot(halfway, view), 0.0);
+   }
+   ////////////////////////////////////////////////////////////////////////////
+
+   vec3 inRadiance = lights[i].intensity * lights[i].color.rbg;
+
+   // Cook-torrance brdf
+   vec3 F = fresnelSchlick(pbrInfo);
+   float D = distributionGGX(pbrInfo.NdotH, material.roughnessFactor);
+   float G = geometricOcclusion(pbrInfo);
+
+   // Energy conservation
+   // Specular and Diffuse
+   vec3 kS = F;
+   vec3 kD = vec3(1.0) - kS;
+   kD *= 1.0 - material.metallicFactor;
+
+   vec3 numerator = D * G * F;
+   float denominator = 4.0 * pbrInfo.NdotV * pbrInfo.NdotL;
+
+   vec3 diffuse = kD * (pbrInfo.diffuseColor / PI);
+   vec3 specular = numerator / max(denominator, 0.0001);
+
+   return (
+         (diffuse + specular) * inRadiance * pbrInfo.NdotL
+   );
+}
+
+vec3 calculatePointLight(
+      int i,
+      vec3 position,
+      vec3 normal,
+      vec3 view,
+      Material material,
+      PBRinfo pbrInfo
+) {
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Fills the data left for PBR
+   vec3 lightDir = normalize(vec3(lights[i].pos) - position);
+   vec3 halfway = normalize(view + lightDir);
+
+   {
+      pbrInfo.NdotL = max(dot(normal, lightDir), 0.0);
+      pbrInfo.NdotH = max(dot(normal, halfway), 0.0);
+      pbrInfo.VdotH = max(dot(halfway, view), 0.0);
+   }
+   ////////////////////////////////////////////////////////////////////////////
+
+
+   vec3 inRadiance = lights[i].intensity * lights[i].color.rgb;
+
+   // Cook-torrance brdf
+   vec3 F = fresnelSchlick(pbrInfo);
+   float D = distributionGGX(pbrInfo.NdotH, material.roughnessFactor);
+   float G = geometricOcclusion(pbrInfo);
+
+   // Energy conservation
+   // Specular and Diffuse
+   vec3 kS = F;
+   vec3 kD = vec3(1.0) - kS;
+   kD *= 1.0 - material.metallicFactor;
+
+   vec3 numerator = D * G * F;
+   float denominator = 4.0 * pbrInfo.NdotV * pbrInfo.NdotL;
+
+   vec3 diffuse = kD * (pbrInfo.diffuseColor / PI);
+   vec3 specular = numerator / max(denominator, 0.0001);
+
+   // TODO: Make these const. adjustable by the GUI.
+   // Distance of 50:
+   float lightConst = 1.0;
+   float lightLinear = 0.09;
+   float lightQuadratic = 0.032;
+
+   float distance = length(vec3(lights[i].pos) - position);
+   float attenuation = (
+         1.0 /
+         (
+            lightConst +
+            lightLinear * distance +
+            lightQuadratic * (distance * distance)
+         )
+   ) * getRangeWindow(i, distance);
+
+   return (attenuation * (diffuse + specular) * inRadiance * pbrInfo.NdotL);
+}
+
+vec3 calculateSpotLight(
+      int i,
+      vec3 position,
+      vec3 normal,
+      vec3 view,
+      Material material,
+      PBRinfo pbrInfo
+) {
+
+   ////////////////////////////////////////////////////////////////////////////
+   // Fills the data left for PBR
+   vec3 lightDir = normalize(vec3(lights[i].pos) - position);
+   vec3 halfway = normalize(view + lightDir);
+
+   {
+      pbrInfo.NdotL = max(dot(normal, lightDir), 0.0);
+      pbrInfo.NdotH = max(dot(normal, halfway), 0.0);
+      pbrInfo.VdotH = max(dot(halfway, view), 0.0);
+   }
+   ////////////////////////////////////////////////////////////////////////////
+
+   float theta = dot(lightDir, normalize(-vec3(lights[i].dir)));
+   // TODO: Make these const. adjustable by the GUI.
+   // 15 degrees
+   float epsilon = 0.9978 - 0.953;
+   float intensity = clamp((theta - 0.953) / epsilon, 0.0, 1.0);
+
+   vec3 inRadiance = lights[i].intensity * lights[i].color.rgb;
+
+   // Cook-torrance brdf
+   vec3 F = fresnelSchlick(pbrInfo);
+   float D = distributionGGX(pbrInfo.NdotH, material.roughnessFactor);
+   float G = geometricOcclusion(pbrInfo);
+
+   // Energy conservation
+   // Specular and Diffuse
+   vec3 kS = F;
+   vec3 kD = vec3(1.0) - kS;
+   kD *= 1.0 - material.metallicFactor;
+
+   vec3 numerator = D * G * F;
+   float denominator = 4.0 * pbrInfo.NdotV * pbrInfo.NdotL;
+
+   vec3 diffuse = kD * (pbrInfo.diffuseColor / PI) * intensity;
+   vec3 specular = numerator / max(denominator, 0.0001) * intensity;
+
+   // TODO: Make these const. adjustable by the GUI.
+   // Distance of 50:
+   float lightConst = 1.0;
+   float lightLinear = 0.09;
+   float lightQuadratic = 0.032;
+
+   float distance = length(vec3(lights[i].pos) - position);
+   float attenuation = (
+         1.0 /
+         (
+            lightConst +
+            lightLinear * distance +
+            lightQuadratic * (distance * distance)
+         )
+   ) * getRangeWindow(i, distance);
+
+   return (attenuation * (diffuse + specular) * inRadiance * pbrInfo.NdotL);
+}
+
+/*
+ * Trowbridge-Reitz GGX approximation.
+ */
+float distributionGGX(float nDotH, float rough)
+{
+   float a = rough * rough;
+   float a2 = a * a;
+
+   float denominator = nDotH * nDotH * (a2 - 1.0) + 1.0;
+   denominator = 1 / (PI * denominator * denominator);
+
+   return a2 * denominator;
+}
+
+float geometricOcclusion(PBRinfo pbrInfo)
+{
+   float alphaRoughness2 = pbrInfo.alphaRoughness * pbrInfo.alphaRoughness;
+   float NdotL2 = pbrInfo.NdotL * pbrInfo.NdotL;
+   float NdotV2 = pbrInfo.NdotV * pbrInfo.NdotV;
+
+   float attenuationL = (
+         2.0 * pbrInfo.NdotL /
+         (
+            pbrInfo.NdotL +
+            sqrt(alphaRoughness2 + (1.0 - alphaRoughness2) * (NdotL2))
+         )
+   );
+   float attenuationV = (
+         2.0 * pbrInfo.NdotV /
+         (
+            pbrInfo.NdotV +
+            sqrt(alphaRoughness2 + (1.0 - alphaRoughness2) * (NdotV2))
+         )
+   );
+
+   return attenuationL * attenuationV;
+}
+
+/*
+ * Fresnel Schlick approximation(for specular reflection).
+ */
+vec3 fresnelSchlick(PBRinfo pbrInfo)
+{
+   return (
+         pbrInfo.reflectance0 + (pbrInfo.reflectance90 - pbrInfo.reflectance0) *
+         pow(1.0 - pbrInfo.VdotH, 5.0)
+   );
+}
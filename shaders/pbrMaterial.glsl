@@ -0,0 +1,117 @@
+// Material of the fragments of the PBR models, shared by the forward
+// (scene.frag) and the G-buffer(gBuffer.frag) passes. It needs the Material
+// struct of pbrLighting.glsl.
+
+struct MaterialInfo
+{
+   // Index of each texture in the texture table.
+   uint baseColor;
+   uint metallicRoughness;
+   uint emissive;
+   uint AO;
+   uint normal;
+   float metallicFactor;
+   float roughnessFactor;
+   // (RECEIVES_SHADOWS and IBL bits of materialFeatures)
+   uint lightingFeatures;
+};
+
+const uint FEATURE_RECEIVES_SHADOWS = 1u << 4;
+const uint FEATURE_IBL = 1u << 5;
+
+// Features of the materials drawn by the pipeline variant(see
+// materialFeatures), so the textures that a material doesn't have aren't
+// read. The lighting ones are only specialized in the forward path, the
+// G-buffer keeps them on and takes them from the material.
+layout(constant_id = 1) const bool HAS_NORMAL_MAP = true;
+layout(constant_id = 2) const bool HAS_METALLIC_ROUGHNESS_MAP = true;
+layout(constant_id = 3) const bool HAS_EMISSIVE_MAP = true;
+layout(constant_id = 4) const bool HAS_AO_MAP = true;
+layout(constant_id = 5) const bool RECEIVES_SHADOWS = true;
+layout(constant_id = 6) const bool USES_IBL = true;
+
+layout(std430, binding = 14) readonly buffer Materials
+{
+   MaterialInfo materials[];
+};
+
+// Texture table(bindless), shared by all the models.
+// (the instances of a draw can have different materials, so the indices
+// aren't uniform)
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec3 inTangent;
+layout(location = 4) in vec3 inBitangent;
+layout(location = 6) flat in uint inMaterial;
+
+vec4 sampleTexture(uint index)
+{
+   return texture(textures[nonuniformEXT(index)], inTexCoord);
+}
+
+vec3 calculateNormal(MaterialInfo materialInfo)
+{
+   mat3 TBN = mat3(inTangent, inBitangent, inNormal);
+
+   if (HAS_NORMAL_MAP)
+   {
+      return normalize(
+            TBN * (sampleTexture(materialInfo.normal).rgb * 2.0 - 1.0)
+      );
+   } else
+      return inNormal;
+}
+
+Material getMaterial(MaterialInfo materialInfo)
+{
+   Material material;
+
+   material.albedo = sampleTexture(materialInfo.baseColor).rgb;
+
+   if (HAS_METALLIC_ROUGHNESS_MAP)
+   {
+      vec4 metallicRoughness = sampleTexture(
+            materialInfo.metallicRoughness
+      );
+
+      material.metallicFactor = metallicRoughness.b;
+      material.roughnessFactor = metallicRoughness.g;
+   } else
+   {
+      material.metallicFactor = clamp(
+            materialInfo.metallicFactor,
+            0.0,
+            1.0
+      );
+      material.roughnessFactor = clamp(
+            materialInfo.roughnessFactor,
+            0.04,
+            1.0
+      );
+   }
+
+   if (HAS_AO_MAP)
+   {
+      material.AO = sampleTexture(materialInfo.AO).r;
+      material.AO = (material.AO < 0.01) ? 1.0 : material.AO;
+   } else
+      material.AO = 1.0;
+
+   if (HAS_EMISSIVE_MAP)
+      material.emissiveColor = sampleTexture(materialInfo.emissive).rgb;
+   else
+      material.emissiveColor = vec3(0.0);
+
+   material.receivesShadows = (
+         RECEIVES_SHADOWS &&
+         (materialInfo.lightingFeatures & FEATURE_RECEIVES_SHADOWS) != 0u
+   );
+   material.usesIBL = (
+         USES_IBL && (materialInfo.lightingFeatures & FEATURE_IBL) != 0u
+   );
+
+   return material;
+}
@@ -1,65 +1,96 @@
 #version 450
 
+const uint MAX_SHADOW_CASCADES = 4;
+
 layout(std140, binding = 0) uniform UniformBufferObject
 {
    mat4 model;
    mat4 view;
    mat4 proj;
-   mat4 lightSpace;
+   // Shadow map(see ShadowCascades)
+   mat4 lightSpaces[MAX_SHADOW_CASCADES];
+   vec4 cascadeSplits;
    vec4 cameraPos;
    int  lightsCount;
-   bool hasNormalMap;
+   int  cascadesCount;
 
 } ubo;
 
+// Transforms of the instances of the meshes(relative to ubo.model).
+layout(std430, binding = 11) readonly buffer Instances
+{
+   mat4 instances[];
+};
+
+// Instances drawn(gl_InstanceIndex already includes the first instance of
+// the draw).
+layout(std430, binding = 12) readonly buffer VisibleInstances
+{
+   uint visibleInstances[];
+};
+
+// Index of the material of each instance.
+layout(std430, binding = 13) readonly buffer InstanceMaterials
+{
+   uint instanceMaterials[];
+};
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
 layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec3 inTangent;
-layout(location = 4) in vec3 inBitangent;
-layout(location = 5) in vec4 inShadowCoords;
+// (w -> sign of the bitangent)
+layout(location = 3) in vec4 inTangent;
 
 layout(location = 0) out vec3 outPosition;
 layout(location = 1) out vec2 outTexCoord;
 layout(location = 2) out vec3 outNormal;
 layout(location = 3) out vec3 outTangent;
 layout(location = 4) out vec3 outBitangent;
-layout(location = 5) out vec4 outShadowCoords;
-
+layout(location = 6) flat out uint outMaterial;
 
-/*
- * We need to compute the current fragment’s position in the same
- * space that the one we used when creating the shadowmap. So we need to
- * transform it once with the usual MVP matrix, and another time with the
- * depthMVP matrix. So this transforms [-1, 1] -> [0, 1].
- */
-
-const mat4 bias = mat4(
-      0.5, 0.0, 0.0, 0.0,
-      0.0, 0.5, 0.0, 0.0,
-      0.0, 0.0, 1.0, 0.0,
-      0.5, 0.5, 0.0, 1.0
-);
+// (same depth as in the depth pre-pass)
+invariant gl_Position;
 
 void main()
 {
+   uint instance = visibleInstances[gl_InstanceIndex];
+   mat4 model = ubo.model * instances[instance];
+
+   outMaterial = instanceMaterials[instance];
+
    gl_Position = (
-         ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0)
+         ubo.proj * ubo.view * model * vec4(inPosition, 1.0)
    );
 
-   outPosition = vec3(ubo.model * vec4(inPosition, 1.0));
+   outPosition = vec3(model * vec4(inPosition, 1.0));
    outTexCoord = inTexCoord;
 
-   outTangent   = normalize(mat3(ubo.model) * inTangent);
-   outNormal    = normalize(mat3(ubo.model) * inNormal);
+#ifdef COMPACT_VERTEX_LAYOUT_ON
+   // 10:10:10:2 unorm -> [-1, 1]
+   vec3 normal  = inNormal * 2.0 - 1.0;
+   vec4 tangent = inTangent * 2.0 - 1.0;
+#else
+   vec3 normal  = inNormal;
+   vec4 tangent = inTangent;
+#endif
+
+   // The normals are transformed by the inverse transpose(non-uniform
+   // scales). The cofactor matrix is det * inverse transpose, so only the sign
+   // of the determinant is needed to keep them pointing outwards.
+   mat3 linear = mat3(model);
+   mat3 cofactor = mat3(
+         cross(linear[1], linear[2]),
+         cross(linear[2], linear[0]),
+         cross(linear[0], linear[1])
+   );
+   float detSign = (dot(linear[0], cofactor[0]) < 0.0) ? -1.0 : 1.0;
+
+   outTangent   = normalize(linear * tangent.xyz);
+   outNormal    = normalize(cofactor * normal) * detSign;
 
    // Gram-Schmidt -> reorthogonalization
    outTangent = normalize(outTangent - dot(outTangent, outNormal) * outNormal);
 
-   outBitangent = cross(outNormal, outTangent);
-
-   outShadowCoords = (
-         (bias * ubo.lightSpace * ubo.model) *
-         vec4(inPosition, 1.0)
-   );
+   // (a mirrored transform flips the handedness of the basis)
+   outBitangent = cross(outNormal, outTangent) * sign(tangent.w) * detSign;
 }
@@ -0,0 +1,32 @@
+#version 450
+
+// Light space of each tile(see ShadowAtlas).
+layout(std430, binding = 0) readonly buffer Tiles
+{
+   uint tilesPerRow;
+   mat4 lightSpaces[];
+} tiles;
+
+layout(std430, binding = 1) readonly buffer Instances
+{
+   mat4 instances[];
+};
+
+// Model drawn and tile of the atlas.
+layout(push_constant) uniform PushBlock
+{
+   mat4 model;
+   uint tile;
+} pushBlock;
+
+layout(location = 0) in vec3 inPosition;
+
+void main()
+{
+   // (all the instances of the mesh, from its first instance)
+   mat4 model = pushBlock.model * instances[gl_InstanceIndex];
+
+   gl_Position = (
+         tiles.lightSpaces[pushBlock.tile] * model * vec4(inPosition, 1.0)
+   );
+}
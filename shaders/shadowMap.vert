@@ -1,16 +1,39 @@
 #version 450
 
+const uint MAX_SHADOW_CASCADES = 4;
+
+// Light space of each cascade(see ShadowMap).
 layout(std140, binding = 0) uniform UniformBufferObject
 {
-   mat4 model;
-   mat4 lightSpace;
+   mat4 lightSpaces[MAX_SHADOW_CASCADES];
 } ubo;
 
+layout(std430, binding = 1) readonly buffer Instances
+{
+   mat4 instances[];
+};
+
+layout(std430, binding = 2) readonly buffer VisibleInstances
+{
+   uint visibleInstances[];
+};
+
+// Model drawn and cascade of the render pass.
+layout(push_constant) uniform PushBlock
+{
+   mat4 model;
+   uint cascade;
+} pushBlock;
+
 layout(location = 0) in vec3 inPosition;
 
 void main()
 {
+   mat4 model = (
+         pushBlock.model * instances[visibleInstances[gl_InstanceIndex]]
+   );
+
    gl_Position = (
-         ubo.lightSpace * ubo.model * vec4(inPosition, 1.0)
+         ubo.lightSpaces[pushBlock.cascade] * model * vec4(inPosition, 1.0)
    );
 }
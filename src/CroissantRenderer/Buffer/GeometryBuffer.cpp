@@ -0,0 +1,384 @@
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
+
+#include <stdexcept>
+#include <limits>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Model/Attributes.h>
+#include <CroissantRenderer/Buffer/bufferManager.h>
+#include <CroissantRenderer/Command/commandManager.h>
+
+template<typename T>
+GeometryBuffer<T>::GeometryBuffer()
+   : m_vertexBuffer(VK_NULL_HANDLE),
+     m_indexBuffer(VK_NULL_HANDLE),
+     m_positionBuffer(VK_NULL_HANDLE)
+{}
+
+/*
+ * -The buffers are created with enough space for all the meshes indicated
+ * (they are added later with add()).
+ */
+template<typename T>
+GeometryBuffer<T>::GeometryBuffer(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const std::vector<const std::vector<Mesh<T>>*>& meshesToAdd,
+      const bool hasPositionStream
+) : m_logicalDevice(logicalDevice),
+    m_vertexBuffer(VK_NULL_HANDLE),
+    m_indexBuffer(VK_NULL_HANDLE),
+    m_positionBuffer(VK_NULL_HANDLE),
+    m_indices32Offset(0),
+    m_maxVerticesCount(0),
+    m_maxIndices16Count(0),
+    m_maxIndices32Count(0),
+    m_verticesCount(0),
+    m_indices16Count(0),
+    m_indices32Count(0)
+{
+   for (auto opMeshes : meshesToAdd)
+   {
+      for (auto& mesh : *opMeshes)
+      {
+         m_maxVerticesCount += mesh.vertices.size();
+
+         if (getIndexType(mesh) == VK_INDEX_TYPE_UINT16)
+            m_maxIndices16Count += mesh.indices.size();
+         else
+            m_maxIndices32Count += mesh.indices.size();
+      }
+   }
+
+   // (Vulkan doesn't allow empty buffers)
+   if (m_maxVerticesCount == 0 ||
+       m_maxIndices16Count + m_maxIndices32Count == 0
+   ) {
+      return;
+   }
+
+   // (the offset of the index buffer has to be a multiple of the index size)
+   m_indices32Offset = (
+         (sizeof(uint16_t) * m_maxIndices16Count + sizeof(uint32_t) - 1) &
+         ~(sizeof(uint32_t) - 1)
+   );
+
+   bufferManager::createBuffer(
+         physicalDevice,
+         logicalDevice,
+         sizeof(T) * m_maxVerticesCount,
+         (
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+         ),
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+         m_vertexAllocation,
+         m_vertexBuffer
+   );
+
+   bufferManager::createBuffer(
+         physicalDevice,
+         logicalDevice,
+         m_indices32Offset + sizeof(uint32_t) * m_maxIndices32Count,
+         (
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+         ),
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+         m_indexAllocation,
+         m_indexBuffer
+   );
+
+   // (same vertex offsets as the vertex buffer, so the draws are the same)
+   if (hasPositionStream)
+   {
+      bufferManager::createBuffer(
+            physicalDevice,
+            logicalDevice,
+            sizeof(Attributes::DEPTH_PREPASS::Vertex) * m_maxVerticesCount,
+            (
+               VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+               VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+            ),
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_positionAllocation,
+            m_positionBuffer
+      );
+   }
+}
+
+template<typename T>
+GeometryBuffer<T>::~GeometryBuffer() {}
+
+/*
+ * -The vertex offset is added after fetching the index, so the indices of a
+ * mesh only have to address its own vertices.
+ */
+template<typename T>
+VkIndexType GeometryBuffer<T>::getIndexType(const Mesh<T>& mesh)
+{
+   if (mesh.vertices.size() <= std::numeric_limits<uint16_t>::max())
+      return VK_INDEX_TYPE_UINT16;
+
+   return VK_INDEX_TYPE_UINT32;
+}
+
+/*
+ * -Reserves a range of the buffers for each mesh and records the copy of its
+ * data in the batch.
+ */
+template<typename T>
+void GeometryBuffer<T>::add(
+      std::vector<Mesh<T>>& meshes,
+      UploadBatch& uploadBatch
+) {
+   for (auto& mesh : meshes)
+   {
+      // (meshes without LODs)
+      if (mesh.lods.empty())
+      {
+         mesh.lods = {
+            {0, static_cast<uint32_t>(mesh.indices.size()), 0.0f}
+         };
+      }
+
+      mesh.indexType = getIndexType(mesh);
+
+      const bool is16bit = (mesh.indexType == VK_INDEX_TYPE_UINT16);
+      const uint32_t indicesCount = (
+            (is16bit) ? m_indices16Count : m_indices32Count
+      );
+      const uint32_t maxIndicesCount = (
+            (is16bit) ? m_maxIndices16Count : m_maxIndices32Count
+      );
+
+      if (m_verticesCount + mesh.vertices.size() > m_maxVerticesCount ||
+          indicesCount + mesh.indices.size() > maxIndicesCount
+      ) {
+         throw std::runtime_error(
+               "The geometry buffer doesn't have space for the mesh!"
+         );
+      }
+
+      mesh.vertexOffset = m_verticesCount;
+      mesh.firstIndex = indicesCount;
+
+      uploadBatch.copyToBuffer(
+            mesh.vertices.data(),
+            sizeof(T) * mesh.vertices.size(),
+            m_vertexBuffer,
+            sizeof(T) * mesh.vertexOffset
+      );
+
+      if (m_positionBuffer != VK_NULL_HANDLE)
+      {
+         // (the batch copies the data to the staging memory right away)
+         std::vector<Attributes::DEPTH_PREPASS::Vertex> positions(
+               mesh.vertices.size()
+         );
+
+         for (size_t i = 0; i < mesh.vertices.size(); i++)
+            positions[i].pos = mesh.vertices[i].pos;
+
+         uploadBatch.copyToBuffer(
+               positions.data(),
+               sizeof(positions[0]) * positions.size(),
+               m_positionBuffer,
+               sizeof(positions[0]) * mesh.vertexOffset
+         );
+      }
+
+      if (is16bit)
+      {
+         // (the batch copies the data to the staging memory right away)
+         std::vector<uint16_t> indices16(
+               mesh.indices.begin(),
+               mesh.indices.end()
+         );
+
+         uploadBatch.copyToBuffer(
+               indices16.data(),
+               sizeof(uint16_t) * indices16.size(),
+               m_indexBuffer,
+               sizeof(uint16_t) * mesh.firstIndex
+         );
+
+         m_indices16Count += mesh.indices.size();
+
+      } else
+      {
+         uploadBatch.copyToBuffer(
+               mesh.indices.data(),
+               sizeof(uint32_t) * mesh.indices.size(),
+               m_indexBuffer,
+               m_indices32Offset + sizeof(uint32_t) * mesh.firstIndex
+         );
+
+         m_indices32Count += mesh.indices.size();
+      }
+
+      m_verticesCount += mesh.vertices.size();
+   }
+}
+
+/*
+ * -Only the vertex buffer, the index buffer is bound by drawIndexed() with
+ * the index type of the mesh.
+ */
+template<typename T>
+void GeometryBuffer<T>::bind(const VkCommandBuffer& commandBuffer) const
+{
+   if (m_vertexBuffer == VK_NULL_HANDLE)
+      return;
+
+   commandManager::state::bindVertexBuffers(
+         {m_vertexBuffer},
+         // Offsets.
+         {0},
+         // Index of first binding.
+         0,
+         // Bindings count.
+         1,
+         commandBuffer
+   );
+}
+
+/*
+ * -Binds the position stream instead of the vertex buffer(the draws and the
+ * index buffer are the same).
+ */
+template<typename T>
+void GeometryBuffer<T>::bindPositions(
+      const VkCommandBuffer& commandBuffer
+) const {
+   if (m_positionBuffer == VK_NULL_HANDLE)
+      return;
+
+   commandManager::state::bindVertexBuffers(
+         {m_positionBuffer},
+         // Offsets.
+         {0},
+         // Index of first binding.
+         0,
+         // Bindings count.
+         1,
+         commandBuffer
+   );
+}
+
+/*
+ * -boundIndexType is the index type bound by the previous draw of the caller
+ * (VK_INDEX_TYPE_MAX_ENUM if there isn't any).
+ */
+template<typename T>
+void GeometryBuffer<T>::bindIndexBuffer(
+      const VkIndexType indexType,
+      VkIndexType& boundIndexType,
+      const VkCommandBuffer& commandBuffer
+) const {
+   if (indexType == boundIndexType)
+      return;
+
+   commandManager::state::bindIndexBuffer(
+         m_indexBuffer,
+         // Offset.
+         (
+            (indexType == VK_INDEX_TYPE_UINT16) ?
+               0 :
+               m_indices32Offset
+         ),
+         indexType,
+         commandBuffer
+   );
+
+   boundIndexType = indexType;
+}
+
+template<typename T>
+void GeometryBuffer<T>::drawIndexed(
+      const Mesh<T>& mesh,
+      const uint32_t lod,
+      const uint32_t instanceCount,
+      const uint32_t firstInstance,
+      VkIndexType& boundIndexType,
+      const VkCommandBuffer& commandBuffer
+) const {
+   bindIndexBuffer(mesh.indexType, boundIndexType, commandBuffer);
+
+   commandManager::action::drawIndexed(
+         // Index Count
+         mesh.lods[lod].indicesCount,
+         instanceCount,
+         // First index.
+         mesh.firstIndex + mesh.lods[lod].firstIndex,
+         // Vertex Offset.
+         mesh.vertexOffset,
+         firstInstance,
+         commandBuffer
+   );
+}
+
+/*
+ * -Draws drawCount consecutive commands of the indirect buffer. All of them
+ * have to use meshes with the same index type(their firstIndex is relative
+ * to the indices of that type).
+ */
+template<typename T>
+void GeometryBuffer<T>::drawIndexedIndirect(
+      const VkIndexType indexType,
+      const VkBuffer& indirectBuffer,
+      const VkDeviceSize offset,
+      const uint32_t drawCount,
+      VkIndexType& boundIndexType,
+      const VkCommandBuffer& commandBuffer
+) const {
+   if (drawCount == 0)
+      return;
+
+   bindIndexBuffer(indexType, boundIndexType, commandBuffer);
+
+   commandManager::action::drawIndexedIndirect(
+         indirectBuffer,
+         offset,
+         drawCount,
+         // Stride
+         sizeof(VkDrawIndexedIndirectCommand),
+         commandBuffer
+   );
+}
+
+template<typename T>
+const uint32_t GeometryBuffer<T>::getVerticesCount() const
+{
+   return m_verticesCount;
+}
+
+template<typename T>
+const uint32_t GeometryBuffer<T>::getIndicesCount() const
+{
+   return m_indices16Count + m_indices32Count;
+}
+
+template<typename T>
+void GeometryBuffer<T>::destroy()
+{
+   if (m_vertexBuffer == VK_NULL_HANDLE)
+      return;
+
+   bufferManager::destroyBuffer(m_logicalDevice, m_vertexBuffer);
+   bufferManager::destroyBuffer(m_logicalDevice, m_indexBuffer);
+   bufferManager::freeMemory(m_vertexAllocation);
+   bufferManager::freeMemory(m_indexAllocation);
+
+   if (m_positionBuffer != VK_NULL_HANDLE)
+   {
+      bufferManager::destroyBuffer(m_logicalDevice, m_positionBuffer);
+      bufferManager::freeMemory(m_positionAllocation);
+   }
+}
+
+////////////////////////////////////INSTANCES//////////////////////////////////
+template class GeometryBuffer<Attributes::PBR::Vertex>;
+template class GeometryBuffer<Attributes::SKYBOX::Vertex>;
+template class GeometryBuffer<Attributes::LIGHT::Vertex>;
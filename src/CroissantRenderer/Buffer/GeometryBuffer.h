@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Model/Mesh.h>
+#include <CroissantRenderer/Memory/Allocation.h>
+#include <CroissantRenderer/Buffer/UploadBatch.h>
+
+/*
+ * One vertex buffer and one index buffer shared by all the meshes with the
+ * same vertex layout. Each mesh gets a range of them, so the draws only need
+ * the firstIndex and the vertexOffset(and the vertex buffer is bound once per
+ * pipeline).
+ * The meshes with less than 65536 vertices use 16-bit indices. They are kept
+ * at the start of the index buffer and the 32-bit ones after them, so the
+ * index buffer is only rebound when the index type changes between draws.
+ * Optionally, it keeps a copy of the positions of the vertices in their own
+ * buffer(position stream), for the passes that only need the position.
+ */
+template<typename T>
+class GeometryBuffer
+{
+
+public:
+
+   GeometryBuffer();
+   GeometryBuffer(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const std::vector<const std::vector<Mesh<T>>*>& meshesToAdd,
+         const bool hasPositionStream = false
+   );
+   ~GeometryBuffer();
+   void add(std::vector<Mesh<T>>& meshes, UploadBatch& uploadBatch);
+   void bind(const VkCommandBuffer& commandBuffer) const;
+   void bindPositions(const VkCommandBuffer& commandBuffer) const;
+   void drawIndexed(
+         const Mesh<T>& mesh,
+         const uint32_t lod,
+         const uint32_t instanceCount,
+         const uint32_t firstInstance,
+         VkIndexType& boundIndexType,
+         const VkCommandBuffer& commandBuffer
+   ) const;
+   void drawIndexedIndirect(
+         const VkIndexType indexType,
+         const VkBuffer& indirectBuffer,
+         const VkDeviceSize offset,
+         const uint32_t drawCount,
+         VkIndexType& boundIndexType,
+         const VkCommandBuffer& commandBuffer
+   ) const;
+   const uint32_t getVerticesCount() const;
+   const uint32_t getIndicesCount() const;
+   void destroy();
+
+private:
+
+   static VkIndexType getIndexType(const Mesh<T>& mesh);
+   void bindIndexBuffer(
+         const VkIndexType indexType,
+         VkIndexType& boundIndexType,
+         const VkCommandBuffer& commandBuffer
+   ) const;
+
+   VkDevice       m_logicalDevice;
+
+   VkBuffer       m_vertexBuffer;
+   VkBuffer       m_indexBuffer;
+   Allocation     m_vertexAllocation;
+   Allocation     m_indexAllocation;
+   // (VK_NULL_HANDLE if there isn't position stream)
+   VkBuffer       m_positionBuffer;
+   Allocation     m_positionAllocation;
+   // Where the 32-bit indices start in the index buffer.
+   VkDeviceSize   m_indices32Offset;
+
+   // Capacity
+   uint32_t       m_maxVerticesCount;
+   uint32_t       m_maxIndices16Count;
+   uint32_t       m_maxIndices32Count;
+   // Used
+   uint32_t       m_verticesCount;
+   uint32_t       m_indices16Count;
+   uint32_t       m_indices32Count;
+};
@@ -0,0 +1,319 @@
+#include <CroissantRenderer/Buffer/UploadBatch.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Buffer/bufferManager.h>
+#include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/Command/commandManager.h>
+
+// Alignment of each upload inside the staging ring.
+static const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+UploadBatch::UploadBatch() {}
+
+UploadBatch::UploadBatch(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const std::shared_ptr<CommandPool>& commandPool,
+      const VkQueue& queue,
+      const VkDeviceSize stagingSize
+) : m_physicalDevice(physicalDevice),
+    m_logicalDevice(logicalDevice),
+    m_commandPool(commandPool),
+    m_queue(queue),
+    m_stagingSize(stagingSize),
+    m_head(0),
+    m_usedBytes(0),
+    m_isRecording(false)
+{
+   bufferManager::createBuffer(
+         physicalDevice,
+         logicalDevice,
+         stagingSize,
+         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+         (
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+         ),
+         m_stagingAllocation,
+         m_stagingBuffer
+   );
+
+   // The ring stays mapped until it's destroyed.
+   // (it's coherent, so we don't need to flush after each memcpy)
+   m_stagingData = static_cast<uint8_t*>(m_stagingAllocation.mappedData);
+}
+
+UploadBatch::~UploadBatch() {}
+
+/*
+ * -Creates the buffer in the device and records the copy of the data to it.
+ * (the data is copied to the staging ring right away, so it can be freed
+ * after this call)
+ */
+void UploadBatch::createBufferAndTransferToDevice(
+      const void* data,
+      const VkDeviceSize size,
+      const VkBufferUsageFlags usageDstBuffer,
+      Allocation& allocation,
+      VkBuffer& buffer
+) {
+   bufferManager::createBuffer(
+         m_physicalDevice,
+         m_logicalDevice,
+         size,
+         VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageDstBuffer,
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+         allocation,
+         buffer
+   );
+
+   copyToBuffer(data, size, buffer, 0);
+}
+
+void UploadBatch::copyToBuffer(
+      const void* data,
+      const VkDeviceSize size,
+      const VkBuffer& dstBuffer,
+      const VkDeviceSize dstOffset
+) {
+   VkBufferCopy copyRegion{};
+   copyRegion.dstOffset = dstOffset;
+   copyRegion.size = size;
+
+   if (size <= m_stagingSize)
+   {
+      copyRegion.srcOffset = allocStaging(size);
+
+      std::memcpy(m_stagingData + copyRegion.srcOffset, data, size);
+
+      commandManager::action::copyBufferToBuffer(
+            m_stagingBuffer,
+            dstBuffer,
+            1,
+            copyRegion,
+            m_currentBatch.commandBuffer
+      );
+
+      return;
+   }
+
+   // It doesn't fit in the ring, so it gets its own staging buffer that will
+   // be destroyed when the batch is completed.
+   VkBuffer dedicatedBuffer;
+   Allocation dedicatedAllocation;
+
+   bufferManager::createBuffer(
+         m_physicalDevice,
+         m_logicalDevice,
+         size,
+         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+         (
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+         ),
+         dedicatedAllocation,
+         dedicatedBuffer,
+         AllocationStrategy::LINEAR
+   );
+
+   std::memcpy(dedicatedAllocation.mappedData, data, size);
+
+   if (m_isRecording == false)
+      beginBatch();
+
+   copyRegion.srcOffset = 0;
+   commandManager::action::copyBufferToBuffer(
+         dedicatedBuffer,
+         dstBuffer,
+         1,
+         copyRegion,
+         m_currentBatch.commandBuffer
+   );
+
+   m_currentBatch.dedicatedBuffers.push_back(dedicatedBuffer);
+   m_currentBatch.dedicatedAllocations.push_back(dedicatedAllocation);
+}
+
+/*
+ * -Returns the offset of a free region of the ring and makes sure that there
+ * is a batch recording.
+ * If the ring is full, it waits for the oldest batches(submitting the current
+ * one if it's the only one using the ring).
+ */
+VkDeviceSize UploadBatch::allocStaging(const VkDeviceSize size)
+{
+   VkDeviceSize offset;
+   // Bytes consumed from the ring(alignment and wrap-around included).
+   VkDeviceSize neededBytes;
+
+   while (true)
+   {
+      // Nobody is using the ring, so we can start from the beginning.
+      if (m_usedBytes == 0)
+         m_head = 0;
+
+      offset = (
+            (m_head + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1)
+      );
+
+      if (offset + size > m_stagingSize)
+      {
+         // It doesn't fit at the end, so we skip the rest of the ring.
+         neededBytes = (m_stagingSize - m_head) + size;
+         offset = 0;
+      } else
+         neededBytes = (offset - m_head) + size;
+
+      if (m_stagingSize - m_usedBytes >= neededBytes)
+         break;
+
+      if (m_inFlightBatches.empty())
+         submit();
+
+      releaseOldestBatch();
+   }
+
+   if (m_isRecording == false)
+      beginBatch();
+
+   m_head = offset + size;
+   m_usedBytes += neededBytes;
+   m_currentBatch.stagingBytes += neededBytes;
+
+   return offset;
+}
+
+void UploadBatch::beginBatch()
+{
+   m_currentBatch = Batch{};
+
+   m_commandPool->allocCommandBuffer(m_currentBatch.commandBuffer, true);
+   m_commandPool->beginCommandBuffer(
+         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+         m_currentBatch.commandBuffer
+   );
+
+   m_isRecording = true;
+}
+
+/*
+ * -Submits all the copies recorded so far without waiting for them.
+ */
+void UploadBatch::submit()
+{
+   if (m_isRecording == false)
+      return;
+
+   // Makes the copies visible to the vertex input and the shaders of the
+   // next submissions in this queue, so they don't need to wait for the
+   // fence.
+   VkMemoryBarrier memoryBarrier{};
+   memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+   memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+   memoryBarrier.dstAccessMask = (
+         VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+         VK_ACCESS_INDEX_READ_BIT |
+         VK_ACCESS_UNIFORM_READ_BIT |
+         VK_ACCESS_SHADER_READ_BIT
+   );
+
+   commandManager::synchronization::recordPipelineBarrier(
+         VK_PIPELINE_STAGE_TRANSFER_BIT,
+         (
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+         ),
+         0,
+         m_currentBatch.commandBuffer,
+         {memoryBarrier},
+         {},
+         {}
+   );
+
+   m_commandPool->endCommandBuffer(m_currentBatch.commandBuffer);
+
+   getFence(m_currentBatch.fence);
+
+   m_commandPool->submitCommandBuffer(
+         m_queue,
+         {m_currentBatch.commandBuffer},
+         false,
+         {},
+         std::nullopt,
+         {},
+         m_currentBatch.fence
+   );
+
+   m_inFlightBatches.push_back(m_currentBatch);
+   m_isRecording = false;
+}
+
+/*
+ * -Submits the current batch and waits until all the batches are completed.
+ */
+void UploadBatch::flush()
+{
+   submit();
+
+   while (m_inFlightBatches.empty() == false)
+      releaseOldestBatch();
+}
+
+void UploadBatch::releaseOldestBatch()
+{
+   Batch& batch = m_inFlightBatches.front();
+
+   vkWaitForFences(m_logicalDevice, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+   vkResetFences(m_logicalDevice, 1, &batch.fence);
+
+   m_freeFences.push_back(batch.fence);
+   m_commandPool->recycleCommandBuffer(batch.commandBuffer);
+
+   for (size_t i = 0; i < batch.dedicatedBuffers.size(); i++)
+   {
+      bufferManager::destroyBuffer(m_logicalDevice, batch.dedicatedBuffers[i]);
+      bufferManager::freeMemory(batch.dedicatedAllocations[i]);
+   }
+
+   m_usedBytes -= batch.stagingBytes;
+
+   m_inFlightBatches.pop_front();
+}
+
+void UploadBatch::getFence(VkFence& fence)
+{
+   if (m_freeFences.size() > 0)
+   {
+      fence = m_freeFences.back();
+      m_freeFences.pop_back();
+
+      return;
+   }
+
+   VkFenceCreateInfo fenceInfo{};
+   fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+   auto status = vkCreateFence(m_logicalDevice, &fenceInfo, nullptr, &fence);
+
+   if (status != VK_SUCCESS)
+      throw std::runtime_error("Failed to create the fence of the batch!");
+}
+
+void UploadBatch::destroy()
+{
+   flush();
+
+   for (auto& fence : m_freeFences)
+      vkDestroyFence(m_logicalDevice, fence, nullptr);
+
+   m_freeFences.clear();
+
+   bufferManager::destroyBuffer(m_logicalDevice, m_stagingBuffer);
+   bufferManager::freeMemory(m_stagingAllocation);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/Memory/Allocation.h>
+
+/*
+ * Records many buffer uploads in the same command buffer and submits them all
+ * together with a fence(one per batch), instead of creating a staging buffer
+ * and waiting for the queue to be idle per upload.
+ * The data goes through a staging ring buffer that is persistently mapped.
+ */
+class UploadBatch
+{
+
+public:
+
+   UploadBatch();
+   UploadBatch(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const std::shared_ptr<CommandPool>& commandPool,
+         const VkQueue& queue,
+         const VkDeviceSize stagingSize
+   );
+   ~UploadBatch();
+   void createBufferAndTransferToDevice(
+         const void* data,
+         const VkDeviceSize size,
+         const VkBufferUsageFlags usageDstBuffer,
+         Allocation& allocation,
+         VkBuffer& buffer
+   );
+   void copyToBuffer(
+         const void* data,
+         const VkDeviceSize size,
+         const VkBuffer& dstBuffer,
+         const VkDeviceSize dstOffset
+   );
+   void submit();
+   void flush();
+   void destroy();
+
+private:
+
+   struct Batch
+   {
+      VkCommandBuffer               commandBuffer;
+      VkFence                       fence;
+      // Bytes of the ring used by this batch(alignment included).
+      VkDeviceSize                  stagingBytes;
+      // Uploads bigger than the ring use their own staging buffer.
+      std::vector<VkBuffer>         dedicatedBuffers;
+      std::vector<Allocation>       dedicatedAllocations;
+   };
+
+   void beginBatch();
+   void releaseOldestBatch();
+   VkDeviceSize allocStaging(const VkDeviceSize size);
+   void getFence(VkFence& fence);
+
+   VkPhysicalDevice                 m_physicalDevice;
+   VkDevice                         m_logicalDevice;
+   std::shared_ptr<CommandPool>     m_commandPool;
+   VkQueue                          m_queue;
+
+   // Staging ring
+   VkBuffer                         m_stagingBuffer;
+   Allocation                       m_stagingAllocation;
+   uint8_t*                         m_stagingData;
+   VkDeviceSize                     m_stagingSize;
+   VkDeviceSize                     m_head;
+   VkDeviceSize                     m_usedBytes;
+
+   bool                             m_isRecording;
+   Batch                            m_currentBatch;
+   // Submitted batches, from the oldest to the newest.
+   std::deque<Batch>                m_inFlightBatches;
+   std::vector<VkFence>             m_freeFences;
+};
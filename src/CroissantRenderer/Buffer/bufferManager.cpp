@@ -7,14 +7,14 @@
 #include <vulkan/vulkan.h>
 
 #include <CroissantRenderer/Model/Attributes.h>
-#include <CroissantRenderer/Buffer/bufferUtils.h>
 #include <CroissantRenderer/Command/CommandPool.h>
 #include <CroissantRenderer/Command/commandManager.h>
+#include <CroissantRenderer/Memory/memoryAllocator.h>
 
 /*
  * It does:
- *    -Creates the memory for the buffer.
- *    -Allocates the buffer.
+ *    -Creates the buffer.
+ *    -Sub-allocates the memory for the buffer.
  *    -Binds the buffer with the memory.
  */
 void bufferManager::createBuffer(
@@ -23,8 +23,9 @@ void bufferManager::createBuffer(
          const VkDeviceSize size,
          const VkBufferUsageFlags usage,
          const VkMemoryPropertyFlags memoryProperties,
-         VkDeviceMemory& memory,
-         VkBuffer& buffer
+         Allocation& allocation,
+         VkBuffer& buffer,
+         const AllocationStrategy strategy
 ) {
    VkBufferCreateInfo bufferInfo{};
    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -46,16 +47,16 @@ void bufferManager::createBuffer(
 
    allocBuffer(
          logicalDevice,
-         physicalDevice,
          memoryProperties,
+         strategy,
          buffer,
-         memory
+         allocation
    );
 
    bindBufferWithMemory(
          logicalDevice,
          buffer,
-         memory
+         allocation
    );
 }
 
@@ -69,7 +70,7 @@ void bufferManager::createSharedConcurrentBuffer(
          const VkBufferUsageFlags usage,
          const VkMemoryPropertyFlags memoryProperties,
          const QueueFamilyIndices& queueFamilyIndices,
-         VkDeviceMemory& memory,
+         Allocation& allocation,
          VkBuffer& buffer
 ) {
 
@@ -118,79 +119,40 @@ void bufferManager::createSharedConcurrentBuffer(
 
    allocBuffer(
          logicalDevice,
-         physicalDevice,
          memoryProperties,
+         AllocationStrategy::TLSF,
          buffer,
-         memory
+         allocation
    );
 
    bindBufferWithMemory(
          logicalDevice,
          buffer,
-         memory
+         allocation
    );
 }
 
 void bufferManager::bindBufferWithMemory(
       const VkDevice& logicalDevice,
       VkBuffer& buffer,
-      VkDeviceMemory& memory
+      Allocation& allocation
 ) {
    // 4 param. -> offset.
-   vkBindBufferMemory(logicalDevice, buffer, memory, 0);
-}
-
-
-/*
- * Creates a cmd to copy the buffer to the buffer in the gpu making a cmd of
- * memory allocation.
- */
-void bufferManager::copyBuffer(
-      const std::shared_ptr<CommandPool>& commandPool,
-      const VkDeviceSize size,
-      VkBuffer& srcBuffer,
-      VkBuffer& dstBuffer,
-      const VkQueue& graphicsQueue
-) {
-   VkCommandBuffer commandBuffer;
-
-   commandPool->allocCommandBuffer(commandBuffer, true);
-
-   commandPool->beginCommandBuffer(
-         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-         commandBuffer
-   );
-
-      VkBufferCopy copyRegion{};
-      // optional
-      copyRegion.srcOffset = 0;
-      // optional
-      copyRegion.dstOffset = 0;
-      copyRegion.size = size;
-
-      commandManager::action::copyBufferToBuffer(
-            srcBuffer,
-            dstBuffer,
-            1,
-            copyRegion,
-            commandBuffer
-      );
-
-   commandPool->endCommandBuffer(commandBuffer);
-
-   commandPool->submitCommandBuffer(
-         graphicsQueue,
-         {commandBuffer},
-         true
+   vkBindBufferMemory(
+         logicalDevice,
+         buffer,
+         allocation.memory,
+         allocation.offset
    );
 }
 
+
 void bufferManager::allocBuffer(
       const VkDevice& logicalDevice,
-      const VkPhysicalDevice& physicalDevice,
       const VkMemoryPropertyFlags memoryProperties,
+      const AllocationStrategy strategy,
       VkBuffer& buffer,
-      VkDeviceMemory& memory
+      Allocation& allocation
 ) {
    // -Memory requirements
 
@@ -209,165 +171,34 @@ void bufferManager::allocBuffer(
          &memRequirements
    );
 
-
-   VkMemoryAllocateInfo allocInfo{};
-
-   allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-   allocInfo.allocationSize =  memRequirements.size;
-   allocInfo.memoryTypeIndex = bufferUtils::findMemoryType(
-            physicalDevice,
-            memRequirements.memoryTypeBits,
-            memoryProperties
-   );
-
-   auto status = vkAllocateMemory(
-         logicalDevice,
-         &allocInfo,
-         nullptr,
-         &memory
-   );
-
-   if (status != VK_SUCCESS)
-      throw std::runtime_error("Failed to allocate buffer memory!");
-
-}
-
-
-template<typename T>
-void bufferManager::createBufferAndTransferToDevice(
-         const std::shared_ptr<CommandPool>& commandPool,
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         T* data,
-         const size_t size,
-         const VkQueue& graphicsQueue,
-         const VkBufferUsageFlags usageDstBuffer,
-         VkDeviceMemory& memory,
-         VkBuffer& buffer
-) {
-   VkBuffer stagingBuffer;
-   VkDeviceMemory stagingBufferMemory;
-
-   createAndFillStagingBuffer(
-         physicalDevice,
-         logicalDevice,
-         size,
-         0,
-         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-         (
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-         ),
-         stagingBufferMemory,
-         stagingBuffer,
-         data
-   );
-
-   // Creates the vertex buffer in the device(gpu).
-   createBuffer(
-         physicalDevice,
-         logicalDevice,
-         size,
-         VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageDstBuffer,
-         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-         memory,
-         buffer
-   );
-
-   copyBuffer(
-         commandPool,
-         size,
-         stagingBuffer,
-         buffer,
-         graphicsQueue
+   memoryAllocator::allocate(
+         memRequirements,
+         memoryProperties,
+         memoryAllocator::ResourceKind::LINEAR,
+         strategy,
+         allocation
    );
-
-   destroyBuffer(logicalDevice, stagingBuffer);
-   freeMemory(logicalDevice, stagingBufferMemory);
 }
 
 
-
-//////////////////////////////////Instances////////////////////////////////////
-
-template void bufferManager::createBufferAndTransferToDevice<uint32_t>(
-         const std::shared_ptr<CommandPool>& commandPool,
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         uint32_t* data,
-         const size_t size,
-         const VkQueue& graphicsQueue,
-         const VkBufferUsageFlags usageDstBuffer,
-         VkDeviceMemory& memory,
-         VkBuffer& buffer
-);
-
-template void bufferManager::createBufferAndTransferToDevice<
-   Attributes::PBR::Vertex
->(
-         const std::shared_ptr<CommandPool>& commandPool,
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         Attributes::PBR::Vertex* data,
-         const size_t size,
-         const VkQueue& graphicsQueue,
-         const VkBufferUsageFlags usageDstBuffer,
-         VkDeviceMemory& memory,
-         VkBuffer& buffer
-);
-
-template void bufferManager::createBufferAndTransferToDevice<
-   Attributes::LIGHT::Vertex
->(
-         const std::shared_ptr<CommandPool>& commandPool,
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         Attributes::LIGHT::Vertex* data,
-         const size_t size,
-         const VkQueue& graphicsQueue,
-         const VkBufferUsageFlags usageDstBuffer,
-         VkDeviceMemory& memory,
-         VkBuffer& buffer
-);
-
-
-template void bufferManager::createBufferAndTransferToDevice<
-   Attributes::SKYBOX::Vertex
->(
-         const std::shared_ptr<CommandPool>& commandPool,
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         Attributes::SKYBOX::Vertex* data,
-         const size_t size,
-         const VkQueue& graphicsQueue,
-         const VkBufferUsageFlags usageDstBuffer,
-         VkDeviceMemory& memory,
-         VkBuffer& buffer
-);
-
-///////////////////////////////////////////////////////////////////////////////
-
 template<typename T>
 void bufferManager::fillBuffer(
       const VkDevice& logicalDevice,
       T* data,
       const VkDeviceSize offset,
       const VkDeviceSize size,
-      VkDeviceMemory& memory
+      Allocation& allocation
 ) {
-   void* memoryMap;
-   // Allows us to access a region of the specified memory resource defined by
-   // an offset and size.
-   vkMapMemory(
-         logicalDevice,
-         memory,
-         offset,
-         size,
-         0,
-         &memoryMap
+   // The host visible blocks are persistently mapped, so we just need to
+   // write in the region of the buffer.
+   if (allocation.mappedData == nullptr)
+      throw std::runtime_error("The memory of the buffer is not host visible!");
+
+   std::memcpy(
+         static_cast<uint8_t*>(allocation.mappedData) + offset,
+         data,
+         size
    );
-      std::memcpy(memoryMap, data, size);
-   vkUnmapMemory(logicalDevice, memory);
 }
 //////////////////////////////////Instances////////////////////////////////////
 template void bufferManager::fillBuffer<Attributes::PBR::Vertex>(
@@ -375,42 +206,42 @@ template void bufferManager::fillBuffer<Attributes::PBR::Vertex>(
       Attributes::PBR::Vertex* data,
       const VkDeviceSize offset,
       const VkDeviceSize size,
-      VkDeviceMemory& memory
+      Allocation& allocation
 );
 template void bufferManager::fillBuffer<Attributes::SKYBOX::Vertex>(
       const VkDevice& logicalDevice,
       Attributes::SKYBOX::Vertex* data,
       const VkDeviceSize offset,
       const VkDeviceSize size,
-      VkDeviceMemory& memory
+      Allocation& allocation
 );
 template void bufferManager::fillBuffer<uint32_t>(
       const VkDevice& logicalDevice,
       uint32_t* data,
       const VkDeviceSize offset,
       const VkDeviceSize size,
-      VkDeviceMemory& memory
+      Allocation& allocation
 );
 template void bufferManager::fillBuffer<uint8_t>(
       const VkDevice& logicalDevice,
       uint8_t* data,
       const VkDeviceSize offset,
       const VkDeviceSize size,
-      VkDeviceMemory& memory
+      Allocation& allocation
 );
 template void bufferManager::fillBuffer<float>(
       const VkDevice& logicalDevice,
       float* data,
       const VkDeviceSize offset,
       const VkDeviceSize size,
-      VkDeviceMemory& memory
+      Allocation& allocation
 );
 template void bufferManager::fillBuffer<Attributes::LIGHT::Vertex>(
       const VkDevice& logicalDevice,
       Attributes::LIGHT::Vertex* data,
       const VkDeviceSize offset,
       const VkDeviceSize size,
-      VkDeviceMemory& memory
+      Allocation& allocation
 );
 ///////////////////////////////////////////////////////////////////////////////
 template<typename T>
@@ -421,18 +252,20 @@ void bufferManager::createAndFillStagingBuffer(
       const uint32_t offset,
       const VkBufferUsageFlags usage,
       const VkMemoryPropertyFlags memoryProperties,
-      VkDeviceMemory& memory,
+      Allocation& allocation,
       VkBuffer& buffer,
       T* data
 ) {
+   // Staging buffers are short-lived, so they are bump allocated.
    bufferManager::createBuffer(
          physicalDevice,
          logicalDevice,
          size,
          usage,
          memoryProperties,
-         memory,
-         buffer
+         allocation,
+         buffer,
+         AllocationStrategy::LINEAR
    );
 
    bufferManager::fillBuffer(
@@ -440,7 +273,7 @@ void bufferManager::createAndFillStagingBuffer(
          data,
          offset,
          size,
-         memory
+         allocation
    );
 }
 ////////////////////////////////////Instances//////////////////////////////////
@@ -451,7 +284,7 @@ template void bufferManager::createAndFillStagingBuffer<uint8_t>(
       const uint32_t offset,
       const VkBufferUsageFlags usage,
       const VkMemoryPropertyFlags memoryProperties,
-      VkDeviceMemory& memory,
+      Allocation& allocation,
       VkBuffer& buffer,
       uint8_t* data
 );
@@ -462,14 +295,17 @@ void bufferManager::downloadDataFromBuffer(
       const VkDevice& logicalDevice,
       const VkDeviceSize& offset,
       const VkDeviceSize& size,
-      const VkDeviceMemory& memory,
+      const Allocation& allocation,
       void* outData
 ) {
-   void* memoryMap = nullptr;
+   if (allocation.mappedData == nullptr)
+      throw std::runtime_error("The memory of the buffer is not host visible!");
 
-   vkMapMemory(logicalDevice, memory, offset, size, 0, &memoryMap);
-      memcpy(outData, memoryMap, size);
-   vkUnmapMemory(logicalDevice, memory);
+   memcpy(
+         outData,
+         static_cast<const uint8_t*>(allocation.mappedData) + offset,
+         size
+   );
 }
 
 void bufferManager::destroyBuffer(
@@ -479,9 +315,7 @@ void bufferManager::destroyBuffer(
    vkDestroyBuffer(logicalDevice, buffer, nullptr);
 }
 
-void bufferManager::freeMemory(
-      const VkDevice& logicalDevice,
-      VkDeviceMemory& memory
-) {
-   vkFreeMemory(logicalDevice, memory, nullptr);
+void bufferManager::freeMemory(Allocation& allocation)
+{
+   memoryAllocator::free(allocation);
 }
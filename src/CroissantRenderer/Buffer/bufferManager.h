@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 
 #include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/Memory/Allocation.h>
 #include <CroissantRenderer/Queue/QueueFamilyIndices.h>
 
 namespace bufferManager
@@ -14,8 +15,9 @@ namespace bufferManager
          const VkDeviceSize size,
          const VkBufferUsageFlags usage,
          const VkMemoryPropertyFlags memoryProperties,
-         VkDeviceMemory& memory,
-         VkBuffer& buffer
+         Allocation& allocation,
+         VkBuffer& buffer,
+         const AllocationStrategy strategy = AllocationStrategy::TLSF
    );
    void createSharedConcurrentBuffer(
             const VkPhysicalDevice& physicalDevice,
@@ -24,7 +26,7 @@ namespace bufferManager
             const VkBufferUsageFlags usage,
             const VkMemoryPropertyFlags memoryProperties,
             const QueueFamilyIndices& queueFamilyIndices,
-            VkDeviceMemory& memory,
+            Allocation& allocation,
             VkBuffer& buffer
    );
    template<typename T>
@@ -35,62 +37,40 @@ namespace bufferManager
          const uint32_t offset,
          const VkBufferUsageFlags usage,
          const VkMemoryPropertyFlags memoryProperties,
-         VkDeviceMemory& memory,
+         Allocation& allocation,
          VkBuffer& buffer,
          T* data
    );
-   template<typename T>
-   void createBufferAndTransferToDevice(
-         const std::shared_ptr<CommandPool>& commandPool,
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         T* data,
-         size_t size,
-         const VkQueue& graphicsQueue,
-         const VkBufferUsageFlags usageDstBuffer,
-         VkDeviceMemory& memory,
-         VkBuffer& buffer
-   );
-   void freeMemory(
-         const VkDevice& logicalDevice,
-         VkDeviceMemory& memory
-   );
+   void freeMemory(Allocation& allocation);
    void destroyBuffer(
          const VkDevice& logicalDevice,
          VkBuffer& buffer
    );
-   void copyBuffer(
-      const std::shared_ptr<CommandPool>& commandPool,
-      const VkDeviceSize size,
-      VkBuffer& srcBuffer,
-      VkBuffer& dstBuffer,
-      const VkQueue& graphicsQueue
-   );
    template<typename T>
    void fillBuffer(
          const VkDevice& logicalDevice,
          T* data,
          const VkDeviceSize offset,
          const VkDeviceSize size,
-         VkDeviceMemory& memory
+         Allocation& allocation
    );
    void downloadDataFromBuffer(
          const VkDevice& logicalDevice,
          const VkDeviceSize& offset,
          const VkDeviceSize& size,
-         const VkDeviceMemory& memory,
+         const Allocation& allocation,
          void* outData
    );
    void allocBuffer(
       const VkDevice& logicalDevice,
-      const VkPhysicalDevice& physicalDevice,
       const VkMemoryPropertyFlags memoryProperties,
+      const AllocationStrategy strategy,
       VkBuffer& buffer,
-      VkDeviceMemory& memory
+      Allocation& allocation
    );
    void bindBufferWithMemory(
       const VkDevice& logicalDevice,
       VkBuffer& buffer,
-      VkDeviceMemory& memory
+      Allocation& allocation
    );
 };
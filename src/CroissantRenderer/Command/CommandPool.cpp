@@ -30,6 +30,21 @@ CommandPool::CommandPool(
 
    if (status != VK_SUCCESS)
       throw std::runtime_error("Failed to create command pool!");
+
+   // Used to wait for the submissions that need to be completed before
+   // returning(instead of waiting for the whole queue to be idle).
+   VkFenceCreateInfo fenceInfo{};
+   fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+   status = vkCreateFence(
+         m_logicalDevice,
+         &fenceInfo,
+         nullptr,
+         &m_submitFence
+   );
+
+   if (status != VK_SUCCESS)
+      throw std::runtime_error("Failed to create the fence of the pool!");
 }
 
 const VkCommandPool& CommandPool::get() const
@@ -39,6 +54,8 @@ const VkCommandPool& CommandPool::get() const
 
 void CommandPool::destroy()
 {
+   vkDestroyFence(m_logicalDevice, m_submitFence, nullptr);
+   // The command buffers are freed with the pool.
    vkDestroyCommandPool(m_logicalDevice, m_commandPool, nullptr);
 }
 
@@ -71,6 +88,17 @@ void CommandPool::allocCommandBuffer(
       VkCommandBuffer& commandBuffer,
       const bool isOneTimeUsage
 ) {
+   // The one time command buffers are not kept in m_commandBuffers, so we
+   // reuse the ones that were already recycled(if any) instead of allocating
+   // a new one each time.
+   if (isOneTimeUsage && m_recycledCommandBuffers.size() > 0)
+   {
+      commandBuffer = m_recycledCommandBuffers.back();
+      m_recycledCommandBuffers.pop_back();
+
+      return;
+   }
+
    VkCommandBufferAllocateInfo allocInfo{};
    createCommandBufferAllocateInfo(1, allocInfo);
 
@@ -80,6 +108,18 @@ void CommandPool::allocCommandBuffer(
       m_commandBuffers.push_back(commandBuffer);
 }
 
+/*
+ * -Gives back a one time command buffer to the pool, so it can be reused by
+ * the next call to allocCommandBuffer.
+ * (its execution has to be already completed)
+ */
+void CommandPool::recycleCommandBuffer(const VkCommandBuffer& commandBuffer)
+{
+   vkResetCommandBuffer(commandBuffer, 0);
+
+   m_recycledCommandBuffers.push_back(commandBuffer);
+}
+
 void CommandPool::submitCommandBuffer(
       const VkQueue& queue,
       const std::vector<VkCommandBuffer>& commandBuffers,
@@ -109,22 +149,38 @@ void CommandPool::submitCommandBuffer(
    submitInfo.signalSemaphoreCount = signalSemaphores.size();
    submitInfo.pSignalSemaphores = signalSemaphores.data();
 
-   // Submits and execute the cmd immediately and wait on this transfer to
-   // complete.
+   // If we have to wait and there isn't any fence, we use the one of the pool.
+   // This way we only wait for this submission and not for the whole queue.
+   VkFence fenceToSignal = VK_NULL_HANDLE;
+   if (fence.has_value())
+      fenceToSignal = fence.value();
+   else if (waitForCompletition)
+      fenceToSignal = m_submitFence;
+
+   // Submits and execute the cmd immediately.
    auto status = vkQueueSubmit(
          queue,
          1,
          &submitInfo,
-         (fence.has_value()) ?
-            fence.value() :
-            VK_NULL_HANDLE
+         fenceToSignal
    );
 
    if (status != VK_SUCCESS)
       throw std::runtime_error("Failed to submit draw command buffer!");
 
    if (waitForCompletition)
-      vkQueueWaitIdle(queue);
+   {
+      vkWaitForFences(
+            m_logicalDevice,
+            1,
+            &fenceToSignal,
+            VK_TRUE,
+            UINT64_MAX
+      );
+
+      if (fenceToSignal == m_submitFence)
+         vkResetFences(m_logicalDevice, 1, &m_submitFence);
+   }
 }
 
 const VkCommandBuffer& CommandPool::getCommandBuffer(const uint32_t index) const
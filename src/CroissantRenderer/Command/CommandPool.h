@@ -48,6 +48,7 @@ public:
    void resetCommandBuffer(const uint32_t index);
 
    void freeCommandBuffer(VkCommandBuffer& commandBuffer);
+   void recycleCommandBuffer(const VkCommandBuffer& commandBuffer);
 
 private:
 
@@ -60,4 +61,8 @@ private:
 
    VkCommandPool                m_commandPool;
    std::vector<VkCommandBuffer> m_commandBuffers;
+   // One time command buffers ready to be reused.
+   std::vector<VkCommandBuffer> m_recycledCommandBuffers;
+
+   VkFence                      m_submitFence;
 };
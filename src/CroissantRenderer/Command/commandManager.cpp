@@ -36,6 +36,36 @@ void commandManager::action::copyBufferToBuffer(
    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, regionCount, &regions);
 }
 
+/*
+ * -Fills the range with the 4 bytes of data(the buffer needs the usage
+ * VK_BUFFER_USAGE_TRANSFER_DST_BIT).
+ */
+void commandManager::action::fillBuffer(
+      const VkBuffer& dstBuffer,
+      const VkDeviceSize& offset,
+      const VkDeviceSize& size,
+      const uint32_t& data,
+      const VkCommandBuffer& commandBuffer
+) {
+   vkCmdFillBuffer(commandBuffer, dstBuffer, offset, size, data);
+}
+
+
+void commandManager::action::draw(
+      const uint32_t& vertexCount,
+      const uint32_t& instanceCount,
+      const uint32_t& firstVertex,
+      const uint32_t& firstInstance,
+      const VkCommandBuffer& commandBuffer
+) {
+   vkCmdDraw(
+         commandBuffer,
+         vertexCount,
+         instanceCount,
+         firstVertex,
+         firstInstance
+   );
+}
 
 void commandManager::action::drawIndexed(
       const uint32_t& indexCount,
@@ -55,6 +85,22 @@ void commandManager::action::drawIndexed(
    );
 }
 
+void commandManager::action::drawIndexedIndirect(
+      const VkBuffer& buffer,
+      const VkDeviceSize& offset,
+      const uint32_t& drawCount,
+      const uint32_t& stride,
+      const VkCommandBuffer& commandBuffer
+) {
+   vkCmdDrawIndexedIndirect(
+         commandBuffer,
+         buffer,
+         offset,
+         drawCount,
+         stride
+   );
+}
+
 void commandManager::action::dispatch(
       const uint32_t& xSize,
       const uint32_t& ySize,
@@ -109,8 +155,8 @@ void commandManager::state::bindIndexBuffer(
    vkCmdBindIndexBuffer(
          commandBuffer,
          indexBuffer,
-         0,
-         VK_INDEX_TYPE_UINT32
+         offset,
+         indexType
    );
 }
 
@@ -175,6 +221,24 @@ void commandManager::state::bindDescriptorSets(
    );
 }
 
+void commandManager::state::pushConstants(
+      const VkPipelineLayout& pipelineLayout,
+      const VkShaderStageFlags& stageFlags,
+      const uint32_t& offset,
+      const uint32_t& size,
+      const void* data,
+      const VkCommandBuffer& commandBuffer
+) {
+   vkCmdPushConstants(
+         commandBuffer,
+         pipelineLayout,
+         stageFlags,
+         offset,
+         size,
+         data
+   );
+}
+
 ////////////////////////////////////Sync. CMDs/////////////////////////////////
 
 
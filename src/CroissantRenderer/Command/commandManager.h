@@ -25,7 +25,21 @@ namespace commandManager
             const VkBufferImageCopy& regions,
             const VkCommandBuffer& commandBuffer
       );
+      void fillBuffer(
+            const VkBuffer& dstBuffer,
+            const VkDeviceSize& offset,
+            const VkDeviceSize& size,
+            const uint32_t& data,
+            const VkCommandBuffer& commandBuffer
+      );
 
+      void draw(
+            const uint32_t& vertexCount,
+            const uint32_t& instanceCount,
+            const uint32_t& firstVertex,
+            const uint32_t& firstInstance,
+            const VkCommandBuffer& commandBuffer
+      );
       void drawIndexed(
             const uint32_t& indexCount,
             const uint32_t& instanceCount,
@@ -34,6 +48,13 @@ namespace commandManager
             const uint32_t& firstInstance,
             const VkCommandBuffer& commandBuffer
       );
+      void drawIndexedIndirect(
+            const VkBuffer& buffer,
+            const VkDeviceSize& offset,
+            const uint32_t& drawCount,
+            const uint32_t& stride,
+            const VkCommandBuffer& commandBuffer
+      );
 
       void dispatch(
             const uint32_t& xSize,
@@ -74,6 +95,15 @@ namespace commandManager
             const VkCommandBuffer& commandBuffer
       );
 
+      void pushConstants(
+            const VkPipelineLayout& pipelineLayout,
+            const VkShaderStageFlags& stageFlags,
+            const uint32_t& offset,
+            const uint32_t& size,
+            const void* data,
+            const VkCommandBuffer& commandBuffer
+      );
+
       // TODO -> setViewportS
       void setViewport(
             const float& x,
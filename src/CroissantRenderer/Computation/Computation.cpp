@@ -33,7 +33,7 @@ Computation::Computation(
             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
          ),
          queueFamilyIndices,
-         m_inMemory,
+         m_inAllocation,
          m_inBuffer
    );
    bufferManager::createSharedConcurrentBuffer(
@@ -46,7 +46,7 @@ Computation::Computation(
             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
          ),
          queueFamilyIndices,
-         m_outMemory,
+         m_outAllocation,
          m_outBuffer
    );
 
@@ -110,7 +110,7 @@ void Computation::downloadData(
          m_logicalDevice,
          offset,
          size,
-         m_outMemory,
+         m_outAllocation,
          data
    );
 }
@@ -124,8 +124,8 @@ void Computation::destroy()
 {
    vkDestroyBuffer(m_logicalDevice, m_inBuffer, nullptr);
    vkDestroyBuffer(m_logicalDevice, m_outBuffer, nullptr);
-   vkFreeMemory(m_logicalDevice, m_inMemory, nullptr);
-   vkFreeMemory(m_logicalDevice, m_outMemory, nullptr);
+   bufferManager::freeMemory(m_inAllocation);
+   bufferManager::freeMemory(m_outAllocation);
 
    m_pipeline.destroy();
 }
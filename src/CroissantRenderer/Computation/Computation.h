@@ -8,6 +8,7 @@
 #include <CroissantRenderer/Descriptor/DescriptorPool.h>
 #include <CroissantRenderer/Descriptor/DescriptorSets.h>
 #include <CroissantRenderer/Queue/QueueFamilyIndices.h>
+#include <CroissantRenderer/Memory/Allocation.h>
 
 class Computation
 {
@@ -41,8 +42,8 @@ private:
    Compute                 m_pipeline;
    DescriptorSets          m_descriptorSet;
 
-   VkBuffer       m_inBuffer;
-   VkBuffer       m_outBuffer;
-   VkDeviceMemory m_inMemory;
-   VkDeviceMemory m_outMemory;
+   VkBuffer                m_inBuffer;
+   VkBuffer                m_outBuffer;
+   Allocation              m_inAllocation;
+   Allocation              m_outAllocation;
 };
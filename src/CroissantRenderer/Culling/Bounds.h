@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+namespace frustumCulling
+{
+   // Center and half size of each AABB(SoA, see frustumCulling).
+   // (apart, so the software occlusion culling doesn't need the meshes)
+   struct Bounds
+   {
+      std::vector<float> centerX;
+      std::vector<float> centerY;
+      std::vector<float> centerZ;
+      std::vector<float> extentX;
+      std::vector<float> extentY;
+      std::vector<float> extentZ;
+   };
+};
@@ -0,0 +1,638 @@
+#include <CroissantRenderer/Culling/GPUculling.h>
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#ifdef RELEASE_MODE_ON
+   #include <tracy/Tracy.hpp>
+#endif
+
+#include <CroissantRenderer/Settings/config.h>
+#include <CroissantRenderer/Settings/computePipelineConfig.h>
+#include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
+#include <CroissantRenderer/Command/commandManager.h>
+#include <CroissantRenderer/Buffer/bufferManager.h>
+#include <CroissantRenderer/Buffer/UploadBatch.h>
+#include <CroissantRenderer/Model/Types/NormalPBR.h>
+
+/*
+ * -The draws of each model are reserved in the order of the object models
+ * (see NormalPBR::setIndirectDraws()).
+ * -The occluders are drawn with the descriptor sets of the PBR models(see
+ * HiZ).
+ */
+GPUculling::GPUculling(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const VkQueue& graphicsQueue,
+      const std::shared_ptr<CommandPool>& commandPoolForUploads,
+      const uint32_t& graphicsFamilyIndex,
+      const std::vector<std::shared_ptr<Model>>& models,
+      const std::vector<size_t>& objectModelIndices,
+      // From the scene
+      const std::shared_ptr<UBO>& instances,
+      const std::shared_ptr<UBO>& visibleInstances,
+      const VkDescriptorSetLayout& texturesSetLayout,
+      // For the occlusion culling
+      const VkExtent2D& extent,
+      const VkFormat& depthBufferFormat
+) : m_logicalDevice(logicalDevice),
+    m_instances(instances),
+    m_visibleInstances(visibleInstances),
+    m_drawsCount(0),
+    m_instancesCount(0)
+{
+   for (auto i : objectModelIndices)
+   {
+      if (auto pModel = std::dynamic_pointer_cast<NormalPBR>(models[i]))
+      {
+         pModel->setIndirectDraws(this, m_drawsCount);
+
+         m_opModels.push_back(pModel.get());
+         m_drawsCount += pModel->getMeshes().size();
+         m_instancesCount += pModel->getInstancesCount();
+      }
+   }
+
+   m_pipeline = Compute(
+         m_logicalDevice,
+         ShaderInfo(
+            shaderType::COMPUTE,
+            "culling"
+         ),
+         COMPUTE_PIPELINE::CULLING::BUFFERS_INFO,
+         {
+            {
+               VK_SHADER_STAGE_COMPUTE_BIT,
+               0,
+               sizeof(CullingPhase)
+            }
+         }
+   );
+
+   // (the early ones and then the late ones)
+   m_commandPool = std::make_shared<CommandPool>(
+         m_logicalDevice,
+         VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+         graphicsFamilyIndex
+   );
+   m_commandPool->allocCommandBuffers(2 * config::MAX_FRAMES_IN_FLIGHT);
+
+   if (config::OCCLUSION_CULLING)
+   {
+      m_hiZ = std::make_shared<HiZ>(
+            physicalDevice,
+            m_logicalDevice,
+            graphicsFamilyIndex,
+            extent,
+            depthBufferFormat,
+            objectModelIndices,
+            texturesSetLayout
+      );
+   }
+
+   createDrawsBuffer(physicalDevice, graphicsQueue, commandPoolForUploads);
+   createFrameBuffers(physicalDevice);
+   createDescriptorSets();
+}
+
+GPUculling::~GPUculling() {}
+
+/*
+ * -Uploads the bounds, the LODs and the instances of each mesh and the draw
+ * of each instance. They don't change after being loaded, so they are kept
+ * in device local memory.
+ * -The visibility of the instances starts cleared, so the first frame only
+ * has the late phase.
+ */
+void GPUculling::createDrawsBuffer(
+      const VkPhysicalDevice& physicalDevice,
+      const VkQueue& graphicsQueue,
+      const std::shared_ptr<CommandPool>& commandPoolForUploads
+) {
+   // (Vulkan doesn't allow empty buffers)
+   std::vector<DescriptorTypes::StorageBufferObject::CullingDraw> draws(
+         std::max(m_drawsCount, 1u)
+   );
+   std::vector<uint32_t> instanceDraws(std::max(m_instancesCount, 1u));
+   const std::vector<uint32_t> visibility(instanceDraws.size(), 0);
+
+   for (uint32_t i = 0; i < m_opModels.size(); i++)
+   {
+      const auto& meshes = m_opModels[i]->getMeshes();
+      const auto& drawIndices = m_opModels[i]->getDrawIndices();
+
+      for (size_t j = 0; j < meshes.size(); j++)
+      {
+         const auto& mesh = meshes[j];
+         auto& draw = draws[drawIndices[j]];
+
+         draw.center = glm::vec4(
+               (mesh.aabbMin + mesh.aabbMax) * 0.5f,
+               mesh.boundingSphere.w
+         );
+         draw.extent = glm::vec4((mesh.aabbMax - mesh.aabbMin) * 0.5f, 0.0f);
+         draw.modelIndex = i;
+         draw.vertexOffset = mesh.vertexOffset;
+         draw.instancesCount = mesh.instancesCount;
+         draw.firstVisibleInstance = mesh.firstVisibleInstance;
+         draw.lodsCount = std::min(
+               static_cast<uint32_t>(mesh.lods.size()),
+               DescriptorTypes::StorageBufferObject::CULLING_MAX_LODS
+         );
+
+         for (uint32_t lod = 0; lod < draw.lodsCount; lod++)
+         {
+            const auto& meshLOD = mesh.lods[lod];
+
+            draw.lodFirstIndex[lod] = mesh.firstIndex + meshLOD.firstIndex;
+            draw.lodIndicesCount[lod] = meshLOD.indicesCount;
+            draw.lodError[lod] = meshLOD.error;
+         }
+
+         std::fill(
+               instanceDraws.begin() + mesh.firstInstance,
+               instanceDraws.begin() + mesh.firstInstance + mesh.instancesCount,
+               drawIndices[j]
+         );
+      }
+   }
+
+   const VkDeviceSize drawsSize = sizeof(draws[0]) * draws.size();
+   const VkDeviceSize instanceDrawsSize = (
+         sizeof(instanceDraws[0]) * instanceDraws.size()
+   );
+
+   UploadBatch uploadBatch(
+         physicalDevice,
+         m_logicalDevice,
+         commandPoolForUploads,
+         graphicsQueue,
+         drawsSize + 2 * instanceDrawsSize
+   );
+
+   uploadBatch.createBufferAndTransferToDevice(
+         draws.data(),
+         drawsSize,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+         m_drawsAllocation,
+         m_drawsBuffer
+   );
+   uploadBatch.createBufferAndTransferToDevice(
+         instanceDraws.data(),
+         instanceDrawsSize,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+         m_instanceDrawsAllocation,
+         m_instanceDrawsBuffer
+   );
+   uploadBatch.createBufferAndTransferToDevice(
+         visibility.data(),
+         instanceDrawsSize,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+         m_visibilityAllocation,
+         m_visibilityBuffer
+   );
+
+   uploadBatch.destroy();
+}
+
+/*
+ * -The buffers written each frame(one of each per frame in flight):
+ *    - Frame data(camera, frustums and model matrices) -> written by the CPU.
+ *    - Indirect commands(scene pass + cascades) -> cleared and written
+ *      by the GPU.
+ *    - Stats -> written by the GPU and read by the CPU.
+ */
+void GPUculling::createFrameBuffers(const VkPhysicalDevice& physicalDevice)
+{
+   const VkDeviceSize frameSize = (
+         sizeof(DescriptorTypes::StorageBufferObject::CullingFrame) +
+         sizeof(glm::mat4) * std::max(m_opModels.size(), size_t(1))
+   );
+   // (one command per LOD + one per cascade of the shadow map per draw)
+   const VkDeviceSize indirectSize = (
+         sizeof(VkDrawIndexedIndirectCommand) *
+         (
+            DescriptorTypes::StorageBufferObject::CULLING_MAX_LODS +
+            config::SHADOW_CASCADES_COUNT
+         ) *
+         std::max(m_drawsCount, 1u)
+   );
+
+   m_frameBuffers.resize(config::MAX_FRAMES_IN_FLIGHT);
+   m_frameAllocations.resize(config::MAX_FRAMES_IN_FLIGHT);
+   m_indirectBuffers.resize(config::MAX_FRAMES_IN_FLIGHT);
+   m_indirectAllocations.resize(config::MAX_FRAMES_IN_FLIGHT);
+   m_statsBuffers.resize(config::MAX_FRAMES_IN_FLIGHT);
+   m_statsAllocations.resize(config::MAX_FRAMES_IN_FLIGHT);
+
+   for (size_t i = 0; i < config::MAX_FRAMES_IN_FLIGHT; i++)
+   {
+      bufferManager::createBuffer(
+            physicalDevice,
+            m_logicalDevice,
+            frameSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            (
+               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            ),
+            m_frameAllocations[i],
+            m_frameBuffers[i]
+      );
+      bufferManager::createBuffer(
+            physicalDevice,
+            m_logicalDevice,
+            indirectSize,
+            (
+               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+               VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+               VK_BUFFER_USAGE_TRANSFER_DST_BIT
+            ),
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_indirectAllocations[i],
+            m_indirectBuffers[i]
+      );
+      bufferManager::createBuffer(
+            physicalDevice,
+            m_logicalDevice,
+            sizeof(DescriptorTypes::StorageBufferObject::CullingStats),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            (
+               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            ),
+            m_statsAllocations[i],
+            m_statsBuffers[i]
+      );
+
+      std::memset(
+            m_statsAllocations[i].mappedData,
+            0,
+            sizeof(DescriptorTypes::StorageBufferObject::CullingStats)
+      );
+   }
+}
+
+void GPUculling::createDescriptorSets()
+{
+   m_descriptorPool = DescriptorPool(
+         m_logicalDevice,
+         {
+            {
+               VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+               static_cast<uint32_t>(
+                  COMPUTE_PIPELINE::CULLING::BUFFERS_INFO.size() *
+                  config::MAX_FRAMES_IN_FLIGHT
+               )
+            }
+         },
+         config::MAX_FRAMES_IN_FLIGHT
+   );
+
+   for (size_t i = 0; i < config::MAX_FRAMES_IN_FLIGHT; i++)
+   {
+      m_descriptorSets.push_back(
+            DescriptorSets(
+               m_logicalDevice,
+               COMPUTE_PIPELINE::CULLING::BUFFERS_INFO,
+               {
+                  m_drawsBuffer,
+                  m_frameBuffers[i],
+                  m_indirectBuffers[i],
+                  m_statsBuffers[i],
+                  m_instances->get(i),
+                  m_instanceDrawsBuffer,
+                  m_visibleInstances->get(i),
+                  // (not read without occlusion culling)
+                  (m_hiZ) ? m_hiZ->getPyramid() : m_visibilityBuffer,
+                  m_visibilityBuffer
+               },
+               m_pipeline.getDescriptorSetLayout(),
+               m_descriptorPool
+            )
+      );
+   }
+}
+
+/*
+ * -Reads the stats of the last frame that used the buffers of currentFrame
+ * (its fence has to be already waited) and writes the data of this frame.
+ * -It has to be called after the model matrices are updated.
+ */
+void GPUculling::update(
+      const std::shared_ptr<Camera>& camera,
+      // From the shadow map
+      const ShadowCascades& shadowCascades,
+      const VkExtent2D& extent,
+      const uint32_t currentFrame
+) {
+#ifdef RELEASE_MODE_ON
+   ZoneScoped;
+#endif
+
+   // - Stats
+   auto stats = static_cast<
+      DescriptorTypes::StorageBufferObject::CullingStats*
+   >(m_statsAllocations[currentFrame].mappedData);
+
+   m_stats.visibleCount = stats->visibleCount;
+   m_stats.culledCount = m_instancesCount - stats->visibleCount;
+   m_stats.shadowVisibleCount = stats->shadowVisibleCount;
+   m_stats.shadowCulledCount = (
+         m_instancesCount * shadowCascades.count - stats->shadowVisibleCount
+   );
+   m_stats.occludedCount = stats->occludedCount;
+
+   stats->visibleCount = 0;
+   stats->shadowVisibleCount = 0;
+   stats->occludedCount = 0;
+
+   // - Frame data
+   const auto cameraPlanes = frustumCulling::getPlanes(
+         camera->getProjectionM() * camera->getViewM()
+   );
+
+   DescriptorTypes::StorageBufferObject::CullingFrame frame{};
+
+   for (size_t i = 0; i < cameraPlanes.size(); i++)
+      frame.cameraPlanes[i] = cameraPlanes[i];
+
+   for (uint32_t c = 0; c < shadowCascades.count; c++)
+   {
+      const auto lightPlanes = frustumCulling::getPlanes(
+            shadowCascades.lightSpaces[c]
+      );
+
+      for (size_t i = 0; i < lightPlanes.size(); i++)
+         frame.lightPlanes[c * lightPlanes.size() + i] = lightPlanes[i];
+   }
+
+   frame.cameraPos = camera->getPos();
+   // (the same as NormalPBR::updateUBO())
+   frame.pixelsPerUnit = (
+         std::abs(camera->getProjectionM()[1][1]) * 0.5f * extent.height
+   );
+   frame.maxPixelsError = config::LOD_PIXEL_ERROR;
+   frame.drawsCount = m_drawsCount;
+   frame.instancesCount = m_instancesCount;
+   // (the same as the occluders)
+   frame.viewProj = camera->getProjectionM() * camera->getViewM();
+   frame.screenSize = glm::vec2(extent.width, extent.height);
+   frame.hiZLevelsCount = (m_hiZ) ? m_hiZ->getLevelsCount() : 0;
+   frame.cascadesCount = shadowCascades.count;
+
+   uint8_t* data = static_cast<uint8_t*>(
+         m_frameAllocations[currentFrame].mappedData
+   );
+
+   std::memcpy(data, &frame, sizeof(frame));
+
+   for (size_t i = 0; i < m_opModels.size(); i++)
+   {
+      std::memcpy(
+            data + sizeof(frame) + sizeof(glm::mat4) * i,
+            &(m_opModels[i]->getModelM()),
+            sizeof(glm::mat4)
+      );
+   }
+}
+
+/*
+ * -It has to be submitted before the command buffers that draw with the
+ * indirect commands(the barrier makes them wait for the compute pass).
+ * -With occlusion culling, the early command buffer has to be followed by
+ * the occluders(HiZ) and the late command buffer.
+ */
+void GPUculling::recordCommandBuffer(const uint32_t currentFrame)
+{
+#ifdef RELEASE_MODE_ON
+   ZoneScoped;
+#endif
+
+   const VkCommandBuffer& commandBuffer = (
+         m_commandPool->getCommandBuffer(currentFrame)
+   );
+
+   m_commandPool->resetCommandBuffer(currentFrame);
+   m_commandPool->beginCommandBuffer(0, commandBuffer);
+
+      // The instances are added to the commands with atomics, so they start
+      // empty.
+      commandManager::action::fillBuffer(
+            m_indirectBuffers[currentFrame],
+            0,
+            VK_WHOLE_SIZE,
+            0,
+            commandBuffer
+      );
+
+      // (and the late phase of the last frame writes the visibility)
+      VkMemoryBarrier clearBarrier{};
+      clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+      clearBarrier.srcAccessMask = (
+            VK_ACCESS_TRANSFER_WRITE_BIT |
+            VK_ACCESS_SHADER_WRITE_BIT
+      );
+      clearBarrier.dstAccessMask = (
+            VK_ACCESS_SHADER_READ_BIT |
+            VK_ACCESS_SHADER_WRITE_BIT
+      );
+
+      commandManager::synchronization::recordPipelineBarrier(
+            (
+               VK_PIPELINE_STAGE_TRANSFER_BIT |
+               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+            ),
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            commandBuffer,
+            {clearBarrier},
+            {},
+            {}
+      );
+
+      recordDispatch(
+            (m_hiZ) ? CullingPhase::EARLY : CullingPhase::ALL,
+            currentFrame,
+            commandBuffer
+      );
+
+   m_commandPool->endCommandBuffer(commandBuffer);
+
+   if (m_hiZ == nullptr)
+      return;
+
+   const uint32_t lateIndex = config::MAX_FRAMES_IN_FLIGHT + currentFrame;
+   const VkCommandBuffer& lateCommandBuffer = (
+         m_commandPool->getCommandBuffer(lateIndex)
+   );
+
+   m_commandPool->resetCommandBuffer(lateIndex);
+   m_commandPool->beginCommandBuffer(0, lateCommandBuffer);
+
+      m_hiZ->recordBuild(lateCommandBuffer);
+
+      // (the occluders already read the commands of the early phase)
+      recordDispatch(CullingPhase::LATE, currentFrame, lateCommandBuffer);
+
+   m_commandPool->endCommandBuffer(lateCommandBuffer);
+}
+
+void GPUculling::recordDispatch(
+      const CullingPhase phase,
+      const uint32_t currentFrame,
+      const VkCommandBuffer& commandBuffer
+) {
+   const uint32_t workGroupSize = COMPUTE_PIPELINE::CULLING::WORK_GROUP_SIZE;
+
+   commandManager::state::bindPipeline(
+         m_pipeline.get(),
+         PipelineType::COMPUTE,
+         commandBuffer
+   );
+   commandManager::state::bindDescriptorSets(
+         m_pipeline.getPipelineLayout(),
+         PipelineType::COMPUTE,
+         // Index of first descriptor set.
+         0,
+         {m_descriptorSets[currentFrame].get(0)},
+         // Dynamic offsets.
+         {},
+         commandBuffer
+   );
+   commandManager::state::pushConstants(
+         m_pipeline.getPipelineLayout(),
+         VK_SHADER_STAGE_COMPUTE_BIT,
+         0,
+         sizeof(phase),
+         &phase,
+         commandBuffer
+   );
+   commandManager::action::dispatch(
+         (m_instancesCount + workGroupSize - 1) / workGroupSize,
+         1,
+         1,
+         commandBuffer
+   );
+
+   // The draws read the commands and the visible instances and the CPU
+   // reads the stats(after the fence of the frame).
+   VkMemoryBarrier barrier{};
+   barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+   barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+   barrier.dstAccessMask = (
+         VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+         VK_ACCESS_SHADER_READ_BIT |
+         VK_ACCESS_HOST_READ_BIT
+   );
+
+   commandManager::synchronization::recordPipelineBarrier(
+         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         (
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_HOST_BIT
+         ),
+         0,
+         commandBuffer,
+         {barrier},
+         {},
+         {}
+   );
+}
+
+const VkCommandBuffer& GPUculling::getCommandBuffer(const uint32_t index) const
+{
+   return m_commandPool->getCommandBuffer(index);
+}
+
+const VkCommandBuffer& GPUculling::getLateCommandBuffer(
+      const uint32_t index
+) const {
+   return m_commandPool->getCommandBuffer(
+         config::MAX_FRAMES_IN_FLIGHT + index
+   );
+}
+
+/*
+ * -nullptr without occlusion culling.
+ */
+const HiZ* GPUculling::getHiZ() const
+{
+   return m_hiZ.get();
+}
+
+const VkBuffer& GPUculling::getIndirectBuffer(const uint32_t index) const
+{
+   return m_indirectBuffers[index];
+}
+
+/*
+ * -Offset of the first command of the draw(one per LOD, CULLING_MAX_LODS
+ * each draw).
+ */
+const VkDeviceSize GPUculling::getCommandOffset(const uint32_t drawIndex) const
+{
+   return (
+         sizeof(VkDrawIndexedIndirectCommand) *
+         DescriptorTypes::StorageBufferObject::CULLING_MAX_LODS *
+         drawIndex
+   );
+}
+
+/*
+ * -The commands of the cascades are after the ones of the scene pass(one
+ * per draw each cascade).
+ */
+const VkDeviceSize GPUculling::getShadowCommandOffset(
+      const uint32_t drawIndex,
+      const uint32_t cascade
+) const {
+   return (
+         sizeof(VkDrawIndexedIndirectCommand) *
+         (
+            DescriptorTypes::StorageBufferObject::CULLING_MAX_LODS *
+            m_drawsCount +
+            cascade * m_drawsCount +
+            drawIndex
+         )
+   );
+}
+
+const frustumCulling::Stats& GPUculling::getStats() const
+{
+   return m_stats;
+}
+
+void GPUculling::destroy()
+{
+   bufferManager::destroyBuffer(m_logicalDevice, m_drawsBuffer);
+   bufferManager::freeMemory(m_drawsAllocation);
+   bufferManager::destroyBuffer(m_logicalDevice, m_instanceDrawsBuffer);
+   bufferManager::freeMemory(m_instanceDrawsAllocation);
+   bufferManager::destroyBuffer(m_logicalDevice, m_visibilityBuffer);
+   bufferManager::freeMemory(m_visibilityAllocation);
+
+   if (m_hiZ)
+      m_hiZ->destroy();
+
+   for (size_t i = 0; i < config::MAX_FRAMES_IN_FLIGHT; i++)
+   {
+      bufferManager::destroyBuffer(m_logicalDevice, m_frameBuffers[i]);
+      bufferManager::destroyBuffer(m_logicalDevice, m_indirectBuffers[i]);
+      bufferManager::destroyBuffer(m_logicalDevice, m_statsBuffers[i]);
+      bufferManager::freeMemory(m_frameAllocations[i]);
+      bufferManager::freeMemory(m_indirectAllocations[i]);
+      bufferManager::freeMemory(m_statsAllocations[i]);
+   }
+
+   m_descriptorPool.destroy();
+   m_pipeline.destroy();
+   m_commandPool->destroy();
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Pipeline/Compute.h>
+#include <CroissantRenderer/Descriptor/DescriptorPool.h>
+#include <CroissantRenderer/Descriptor/DescriptorSets.h>
+#include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/Memory/Allocation.h>
+#include <CroissantRenderer/Model/Model.h>
+#include <CroissantRenderer/Camera/Camera.h>
+#include <CroissantRenderer/Culling/frustumCulling.h>
+#include <CroissantRenderer/Culling/HiZ.h>
+#include <CroissantRenderer/Features/ShadowCascades.h>
+
+class NormalPBR;
+
+// Dispatches of the culling shader(push constant).
+enum class CullingPhase : uint32_t
+{
+   // Only frustum culling.
+   ALL = 0,
+   // Instances visible in the last frame.
+   EARLY = 1,
+   // Every instance against the Hi-Z pyramid.
+   LATE = 2
+};
+
+/*
+ * GPU-driven culling of the instances of the meshes of the PBR models. Each
+ * frame a compute pass culls every instance against the frustums of the
+ * camera and of each cascade of the shadow map, selects its LOD and adds it
+ * to the indirect draw commands of its mesh(one per LOD + one per cascade),
+ * so the CPU cost doesn't grow with the count of instances.
+ * The commands of each model are ordered by index type(16-bit first), so
+ * the meshes of a model that share a descriptor set can be drawn with one
+ * multi-draw per index type.
+ * With occlusion culling, the culling is splitted in 2 phases around the
+ * draw of the occluders(see HiZ), so the instances that become visible are
+ * drawn in the same frame:
+ *    early command buffer -> occluders(HiZ) -> late command buffer
+ */
+class GPUculling
+{
+
+public:
+
+   GPUculling(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const VkQueue& graphicsQueue,
+         const std::shared_ptr<CommandPool>& commandPoolForUploads,
+         const uint32_t& graphicsFamilyIndex,
+         const std::vector<std::shared_ptr<Model>>& models,
+         const std::vector<size_t>& objectModelIndices,
+         // From the scene
+         const std::shared_ptr<UBO>& instances,
+         const std::shared_ptr<UBO>& visibleInstances,
+         const VkDescriptorSetLayout& texturesSetLayout,
+         // For the occlusion culling
+         const VkExtent2D& extent,
+         const VkFormat& depthBufferFormat
+   );
+   ~GPUculling();
+   void update(
+         const std::shared_ptr<Camera>& camera,
+         // From the shadow map
+         const ShadowCascades& shadowCascades,
+         const VkExtent2D& extent,
+         const uint32_t currentFrame
+   );
+   void recordCommandBuffer(const uint32_t currentFrame);
+   const VkCommandBuffer& getCommandBuffer(const uint32_t index) const;
+   const VkCommandBuffer& getLateCommandBuffer(const uint32_t index) const;
+   const HiZ* getHiZ() const;
+   const VkBuffer& getIndirectBuffer(const uint32_t index) const;
+   const VkDeviceSize getCommandOffset(const uint32_t drawIndex) const;
+   const VkDeviceSize getShadowCommandOffset(
+         const uint32_t drawIndex,
+         const uint32_t cascade
+   ) const;
+   const frustumCulling::Stats& getStats() const;
+   void destroy();
+
+private:
+
+   void createDrawsBuffer(
+         const VkPhysicalDevice& physicalDevice,
+         const VkQueue& graphicsQueue,
+         const std::shared_ptr<CommandPool>& commandPoolForUploads
+   );
+   void createFrameBuffers(const VkPhysicalDevice& physicalDevice);
+   void createDescriptorSets();
+   void recordDispatch(
+         const CullingPhase phase,
+         const uint32_t currentFrame,
+         const VkCommandBuffer& commandBuffer
+   );
+
+   VkDevice                         m_logicalDevice;
+
+   Compute                          m_pipeline;
+   DescriptorPool                   m_descriptorPool;
+   // One per frame in flight.
+   std::vector<DescriptorSets>      m_descriptorSets;
+   std::shared_ptr<CommandPool>     m_commandPool;
+
+   // Static
+   VkBuffer                         m_drawsBuffer;
+   Allocation                       m_drawsAllocation;
+   // (draw of each instance)
+   VkBuffer                         m_instanceDrawsBuffer;
+   Allocation                       m_instanceDrawsAllocation;
+   // (visibility of each instance in the last frame, written by the late
+   // phase)
+   VkBuffer                         m_visibilityBuffer;
+   Allocation                       m_visibilityAllocation;
+   // (nullptr without occlusion culling)
+   std::shared_ptr<HiZ>             m_hiZ;
+   // One per frame in flight.
+   std::vector<VkBuffer>            m_frameBuffers;
+   std::vector<Allocation>          m_frameAllocations;
+   std::vector<VkBuffer>            m_indirectBuffers;
+   std::vector<Allocation>          m_indirectAllocations;
+   std::vector<VkBuffer>            m_statsBuffers;
+   std::vector<Allocation>          m_statsAllocations;
+   // (owned by the scene)
+   std::shared_ptr<UBO>             m_instances;
+   std::shared_ptr<UBO>             m_visibleInstances;
+
+   std::vector<const NormalPBR*>    m_opModels;
+   uint32_t                         m_drawsCount;
+   uint32_t                         m_instancesCount;
+   // (of the last frame that used the same buffers)
+   frustumCulling::Stats            m_stats;
+};
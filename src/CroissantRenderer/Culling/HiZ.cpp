@@ -0,0 +1,382 @@
+#include <CroissantRenderer/Culling/HiZ.h>
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Settings/config.h>
+#include <CroissantRenderer/Settings/graphicsPipelineConfig.h>
+#include <CroissantRenderer/Settings/computePipelineConfig.h>
+#include <CroissantRenderer/Command/commandManager.h>
+#include <CroissantRenderer/Buffer/bufferManager.h>
+#include <CroissantRenderer/Framebuffer/framebufferManager.h>
+#include <CroissantRenderer/RenderPass/attachmentUtils.h>
+#include <CroissantRenderer/RenderPass/subPassUtils.h>
+#include <CroissantRenderer/Model/Attributes.h>
+
+/*
+ * -The occluders are drawn with the descriptor sets of the PBR models, so
+ * their pipeline has the same layout as the PBR one.
+ */
+HiZ::HiZ(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const uint32_t& graphicsFamilyIndex,
+      const VkExtent2D& extent,
+      const VkFormat& depthBufferFormat,
+      // From the scene
+      const std::vector<size_t>& objectModelIndices,
+      const VkDescriptorSetLayout& texturesSetLayout
+) : m_logicalDevice(logicalDevice),
+    m_extent(extent)
+{
+   // (single sample, the pyramid doesn't need the MSAA of the scene)
+   m_depth = Image(
+         physicalDevice,
+         logicalDevice,
+         m_extent.width,
+         m_extent.height,
+         depthBufferFormat,
+         VK_IMAGE_TILING_OPTIMAL,
+         (
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_SAMPLED_BIT
+         ),
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+         false,
+         1,
+         VK_SAMPLE_COUNT_1_BIT,
+         VK_IMAGE_ASPECT_DEPTH_BIT,
+         VK_COMPONENT_SWIZZLE_R,
+         VK_COMPONENT_SWIZZLE_G,
+         VK_COMPONENT_SWIZZLE_B,
+         VK_COMPONENT_SWIZZLE_A,
+         VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+         VK_FILTER_NEAREST
+   );
+
+   createRenderPass(depthBufferFormat);
+
+   std::vector<VkImageView> attachments = {m_depth.getImageView()};
+
+   framebufferManager::createFramebuffer(
+         m_logicalDevice,
+         m_renderPass.get(),
+         attachments,
+         m_extent.width,
+         m_extent.height,
+         1,
+         m_framebuffer
+   );
+
+   // (only the positions, without color attachments)
+   m_occludersPipeline = Graphics(
+         m_logicalDevice,
+         GraphicsPipelineType::DEPTH_PREPASS,
+         m_extent,
+         m_renderPass,
+         {
+            {
+               shaderType::VERTEX,
+               "depthPrepass"
+            }
+         },
+         VK_SAMPLE_COUNT_1_BIT,
+         Attributes::DEPTH_PREPASS::getBindingDescription(),
+         Attributes::DEPTH_PREPASS::getAttributeDescriptions(),
+         objectModelIndices,
+         GRAPHICS_PIPELINE::PBR::UBOS_INFO,
+         GRAPHICS_PIPELINE::PBR::SAMPLERS_INFO,
+         {},
+         // (GRAPHICS_PIPELINE::PBR::TEXTURES_SET)
+         {texturesSetLayout},
+         0,
+         0
+   );
+
+   m_commandPool = std::make_shared<CommandPool>(
+         m_logicalDevice,
+         VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+         graphicsFamilyIndex
+   );
+   m_commandPool->allocCommandBuffers(config::MAX_FRAMES_IN_FLIGHT);
+
+   m_pipeline = Compute(
+         m_logicalDevice,
+         ShaderInfo(
+            shaderType::COMPUTE,
+            "hiZ"
+         ),
+         COMPUTE_PIPELINE::HI_Z::BUFFERS_INFO,
+         {
+            {
+               VK_SHADER_STAGE_COMPUTE_BIT,
+               0,
+               sizeof(PushBlockHiZ)
+            }
+         }
+   );
+
+   createPyramid(physicalDevice);
+   createDescriptorSets();
+}
+
+HiZ::~HiZ() {}
+
+/*
+ * -The depth is read by the compute pass after the render pass(and the next
+ * frame can't clear it until the last build is done).
+ */
+void HiZ::createRenderPass(const VkFormat& depthBufferFormat)
+{
+   VkAttachmentDescription depthAttachment{};
+   attachmentUtils::createAttachmentDescriptionWithStencil(
+         depthBufferFormat,
+         VK_SAMPLE_COUNT_1_BIT,
+         VK_ATTACHMENT_LOAD_OP_CLEAR,
+         VK_ATTACHMENT_STORE_OP_STORE,
+         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+         VK_ATTACHMENT_STORE_OP_DONT_CARE,
+         VK_IMAGE_LAYOUT_UNDEFINED,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         depthAttachment
+   );
+
+   VkAttachmentReference depthAttachmentRef{};
+   attachmentUtils::createAttachmentReference(
+         0,
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+         depthAttachmentRef
+   );
+
+   VkSubpassDescription subpass{};
+   subPassUtils::createSubPassDescription(
+         VK_PIPELINE_BIND_POINT_GRAPHICS,
+         nullptr,
+         &depthAttachmentRef,
+         nullptr,
+         subpass,
+         0
+   );
+
+   std::vector<VkSubpassDependency> dependencies(2);
+   subPassUtils::createSubPassDependency(
+         VK_SUBPASS_EXTERNAL,
+         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         0,
+         0,
+         (
+            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+         ),
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         (VkDependencyFlagBits)0,
+         dependencies[0]
+   );
+   subPassUtils::createSubPassDependency(
+         0,
+         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         VK_SUBPASS_EXTERNAL,
+         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         VK_ACCESS_SHADER_READ_BIT,
+         (VkDependencyFlagBits)0,
+         dependencies[1]
+   );
+
+   m_renderPass = RenderPass(
+         m_logicalDevice,
+         {depthAttachment},
+         {subpass},
+         dependencies
+   );
+}
+
+/*
+ * -Each level has half the size of the previous one(rounded up) until 1x1.
+ * The shaders compute the same sizes and offsets.
+ */
+void HiZ::createPyramid(const VkPhysicalDevice& physicalDevice)
+{
+   glm::uvec2 size(m_extent.width, m_extent.height);
+   uint32_t texelsCount = 0;
+
+   do
+   {
+      PushBlockHiZ level{};
+      level.srcSize = size;
+      level.dstSize = (size + 1u) / 2u;
+      level.srcOffset = (m_levels.empty()) ? 0 : m_levels.back().dstOffset;
+      level.dstOffset = texelsCount;
+      level.isFirst = (m_levels.empty()) ? 1 : 0;
+
+      m_levels.push_back(level);
+
+      texelsCount += level.dstSize.x * level.dstSize.y;
+      size = level.dstSize;
+
+   } while (size.x > 1 || size.y > 1);
+
+   bufferManager::createBuffer(
+         physicalDevice,
+         m_logicalDevice,
+         sizeof(float) * texelsCount,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+         m_pyramidAllocation,
+         m_pyramidBuffer
+   );
+}
+
+void HiZ::createDescriptorSets()
+{
+   m_descriptorPool = DescriptorPool(
+         m_logicalDevice,
+         {
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}
+         },
+         1
+   );
+
+   VkDescriptorImageInfo depthInfo{};
+   depthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+   depthInfo.imageView = m_depth.getImageView();
+   depthInfo.sampler = m_depth.getSampler();
+
+   m_descriptorSets = DescriptorSets(
+         m_logicalDevice,
+         COMPUTE_PIPELINE::HI_Z::BUFFERS_INFO,
+         {m_pyramidBuffer},
+         m_pipeline.getDescriptorSetLayout(),
+         m_descriptorPool,
+         {depthInfo}
+   );
+}
+
+/*
+ * -It has to be recorded after the render pass of the occluders. Each level
+ * waits for the previous one and the last barrier makes the culling wait for
+ * the whole pyramid.
+ */
+void HiZ::recordBuild(const VkCommandBuffer& commandBuffer) const
+{
+   const uint32_t workGroupSize = COMPUTE_PIPELINE::HI_Z::WORK_GROUP_SIZE;
+
+   VkMemoryBarrier barrier{};
+   barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+   barrier.srcAccessMask = (
+         VK_ACCESS_SHADER_READ_BIT |
+         VK_ACCESS_SHADER_WRITE_BIT
+   );
+   barrier.dstAccessMask = (
+         VK_ACCESS_SHADER_READ_BIT |
+         VK_ACCESS_SHADER_WRITE_BIT
+   );
+
+   // (the culling of the last frame reads the pyramid)
+   commandManager::synchronization::recordPipelineBarrier(
+         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         0,
+         commandBuffer,
+         {barrier},
+         {},
+         {}
+   );
+
+   commandManager::state::bindPipeline(
+         m_pipeline.get(),
+         PipelineType::COMPUTE,
+         commandBuffer
+   );
+   commandManager::state::bindDescriptorSets(
+         m_pipeline.getPipelineLayout(),
+         PipelineType::COMPUTE,
+         // Index of first descriptor set.
+         0,
+         {m_descriptorSets.get(0)},
+         // Dynamic offsets.
+         {},
+         commandBuffer
+   );
+
+   for (const auto& level : m_levels)
+   {
+      commandManager::state::pushConstants(
+            m_pipeline.getPipelineLayout(),
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            0,
+            sizeof(level),
+            &level,
+            commandBuffer
+      );
+      commandManager::action::dispatch(
+            (level.dstSize.x + workGroupSize - 1) / workGroupSize,
+            (level.dstSize.y + workGroupSize - 1) / workGroupSize,
+            1,
+            commandBuffer
+      );
+      commandManager::synchronization::recordPipelineBarrier(
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0,
+            commandBuffer,
+            {barrier},
+            {},
+            {}
+      );
+   }
+}
+
+const RenderPass& HiZ::getRenderPass() const
+{
+   return m_renderPass;
+}
+
+const VkFramebuffer& HiZ::getFramebuffer() const
+{
+   return m_framebuffer;
+}
+
+const Graphics& HiZ::getOccludersPipeline() const
+{
+   return m_occludersPipeline;
+}
+
+const VkCommandBuffer& HiZ::getCommandBuffer(const uint32_t index) const
+{
+   return m_commandPool->getCommandBuffer(index);
+}
+
+const std::shared_ptr<CommandPool>& HiZ::getCommandPool() const
+{
+   return m_commandPool;
+}
+
+const VkBuffer& HiZ::getPyramid() const
+{
+   return m_pyramidBuffer;
+}
+
+const uint32_t HiZ::getLevelsCount() const
+{
+   return static_cast<uint32_t>(m_levels.size());
+}
+
+void HiZ::destroy()
+{
+   bufferManager::destroyBuffer(m_logicalDevice, m_pyramidBuffer);
+   bufferManager::freeMemory(m_pyramidAllocation);
+
+   m_descriptorPool.destroy();
+   m_pipeline.destroy();
+   m_occludersPipeline.destroy();
+
+   vkDestroyFramebuffer(m_logicalDevice, m_framebuffer, nullptr);
+   m_renderPass.destroy();
+   m_depth.destroy();
+
+   m_commandPool->destroy();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Pipeline/Compute.h>
+#include <CroissantRenderer/Pipeline/Graphics.h>
+#include <CroissantRenderer/Descriptor/DescriptorPool.h>
+#include <CroissantRenderer/Descriptor/DescriptorSets.h>
+#include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/RenderPass/RenderPass.h>
+#include <CroissantRenderer/Image/Image.h>
+#include <CroissantRenderer/Memory/Allocation.h>
+
+struct PushBlockHiZ
+{
+   glm::uvec2 srcSize;
+   glm::uvec2 dstSize;
+   uint32_t srcOffset;
+   uint32_t dstOffset;
+   uint32_t isFirst;
+};
+
+/*
+ * Hi-Z pyramid of the occlusion culling. Each frame the instances that were
+ * visible in the last frame are drawn(only their depth) as occluders and a
+ * compute pass reduces their depth to a pyramid with the max depth of each
+ * texel. The levels are stored one after another in a storage buffer, the
+ * first one with half the size of the screen(rounded up).
+ */
+class HiZ
+{
+
+public:
+
+   HiZ(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const uint32_t& graphicsFamilyIndex,
+         const VkExtent2D& extent,
+         const VkFormat& depthBufferFormat,
+         // From the scene
+         const std::vector<size_t>& objectModelIndices,
+         const VkDescriptorSetLayout& texturesSetLayout
+   );
+   ~HiZ();
+   void recordBuild(const VkCommandBuffer& commandBuffer) const;
+   const RenderPass& getRenderPass() const;
+   const VkFramebuffer& getFramebuffer() const;
+   const Graphics& getOccludersPipeline() const;
+   const VkCommandBuffer& getCommandBuffer(const uint32_t index) const;
+   const std::shared_ptr<CommandPool>& getCommandPool() const;
+   const VkBuffer& getPyramid() const;
+   const uint32_t getLevelsCount() const;
+   void destroy();
+
+private:
+
+   void createRenderPass(const VkFormat& depthBufferFormat);
+   void createPyramid(const VkPhysicalDevice& physicalDevice);
+   void createDescriptorSets();
+
+   VkDevice                         m_logicalDevice;
+   VkExtent2D                       m_extent;
+
+   // Occluders
+   Image                            m_depth;
+   RenderPass                       m_renderPass;
+   VkFramebuffer                    m_framebuffer;
+   Graphics                         m_occludersPipeline;
+   std::shared_ptr<CommandPool>     m_commandPool;
+
+   // Pyramid
+   Compute                          m_pipeline;
+   DescriptorPool                   m_descriptorPool;
+   DescriptorSets                   m_descriptorSets;
+   VkBuffer                         m_pyramidBuffer;
+   Allocation                       m_pyramidAllocation;
+   // (size and offset of each level)
+   std::vector<PushBlockHiZ>        m_levels;
+};
@@ -0,0 +1,262 @@
+#include <CroissantRenderer/Culling/LightClusters.h>
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#ifdef RELEASE_MODE_ON
+   #include <tracy/Tracy.hpp>
+#endif
+
+#include <CroissantRenderer/Settings/config.h>
+#include <CroissantRenderer/Settings/computePipelineConfig.h>
+#include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
+#include <CroissantRenderer/Command/commandManager.h>
+
+LightClusters::LightClusters(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const uint32_t& graphicsFamilyIndex,
+      // From the scene
+      const std::shared_ptr<UBO>& lights,
+      const uint32_t lightsCount
+) : m_logicalDevice(logicalDevice),
+    m_lights(lights),
+    m_lightsCount(lightsCount),
+    m_clustersCount(
+         config::CLUSTERS_X * config::CLUSTERS_Y * config::CLUSTERS_Z
+    )
+{
+   m_pipeline = Compute(
+         m_logicalDevice,
+         ShaderInfo(
+            shaderType::COMPUTE,
+            "lightClusters"
+         ),
+         COMPUTE_PIPELINE::LIGHT_CLUSTERS::BUFFERS_INFO,
+         {}
+   );
+
+   m_commandPool = std::make_shared<CommandPool>(
+         m_logicalDevice,
+         0,
+         graphicsFamilyIndex
+   );
+   m_commandPool->allocCommandBuffers(config::MAX_FRAMES_IN_FLIGHT);
+
+   createBuffers(physicalDevice);
+   createDescriptorSets();
+   recordCommandBuffers();
+}
+
+LightClusters::~LightClusters() {}
+
+/*
+ * -The grid of the frame is written by the CPU and the lights of each
+ * cluster only by the GPU(device local).
+ */
+void LightClusters::createBuffers(const VkPhysicalDevice& physicalDevice)
+{
+   m_frames = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(DescriptorTypes::StorageBufferObject::ClustersFrame),
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+   );
+   m_lightGrid = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(uint32_t) * m_clustersCount,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+   );
+   m_lightIndices = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(uint32_t) * m_clustersCount * config::MAX_LIGHTS_PER_CLUSTER,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+   );
+}
+
+void LightClusters::createDescriptorSets()
+{
+   m_descriptorPool = DescriptorPool(
+         m_logicalDevice,
+         {
+            {
+               VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+               static_cast<uint32_t>(
+                  COMPUTE_PIPELINE::LIGHT_CLUSTERS::BUFFERS_INFO.size() *
+                  config::MAX_FRAMES_IN_FLIGHT
+               )
+            }
+         },
+         config::MAX_FRAMES_IN_FLIGHT
+   );
+
+   for (size_t i = 0; i < config::MAX_FRAMES_IN_FLIGHT; i++)
+   {
+      m_descriptorSets.push_back(
+            DescriptorSets(
+               m_logicalDevice,
+               COMPUTE_PIPELINE::LIGHT_CLUSTERS::BUFFERS_INFO,
+               {
+                  m_frames->get(i),
+                  m_lights->get(i),
+                  m_lightGrid->get(i),
+                  m_lightIndices->get(i)
+               },
+               m_pipeline.getDescriptorSetLayout(),
+               m_descriptorPool
+            )
+      );
+   }
+}
+
+/*
+ * -The dispatch is the same every frame(only the data of the buffers
+ * changes), so the command buffers are recorded once.
+ * -They have to be submitted before the command buffers that draw the PBR
+ * models(the barrier makes them wait for the compute pass).
+ */
+void LightClusters::recordCommandBuffers()
+{
+   const uint32_t workGroupSize = (
+         COMPUTE_PIPELINE::LIGHT_CLUSTERS::WORK_GROUP_SIZE
+   );
+
+   for (uint32_t i = 0; i < config::MAX_FRAMES_IN_FLIGHT; i++)
+   {
+      const VkCommandBuffer& commandBuffer = (
+            m_commandPool->getCommandBuffer(i)
+      );
+
+      m_commandPool->beginCommandBuffer(0, commandBuffer);
+
+         commandManager::state::bindPipeline(
+               m_pipeline.get(),
+               PipelineType::COMPUTE,
+               commandBuffer
+         );
+         commandManager::state::bindDescriptorSets(
+               m_pipeline.getPipelineLayout(),
+               PipelineType::COMPUTE,
+               // Index of first descriptor set.
+               0,
+               {m_descriptorSets[i].get(0)},
+               // Dynamic offsets.
+               {},
+               commandBuffer
+         );
+         commandManager::action::dispatch(
+               (m_clustersCount + workGroupSize - 1) / workGroupSize,
+               1,
+               1,
+               commandBuffer
+         );
+
+         // The PBR fragments read the lights of their cluster.
+         VkMemoryBarrier barrier{};
+         barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+         barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+         barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+         commandManager::synchronization::recordPipelineBarrier(
+               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+               0,
+               commandBuffer,
+               {barrier},
+               {},
+               {}
+         );
+
+      m_commandPool->endCommandBuffer(commandBuffer);
+   }
+}
+
+/*
+ * -Writes the grid of the clusters of this frame. The depth slices are
+ * exponential:
+ *    zNear * (zFar / zNear)^(slice / CLUSTERS_Z)
+ * so the fragments get their slice with:
+ *    slice = log(z) * sliceScale - sliceBias
+ */
+void LightClusters::update(
+      const std::shared_ptr<Camera>& camera,
+      const VkExtent2D& extent,
+      const uint32_t currentFrame
+) {
+#ifdef RELEASE_MODE_ON
+   ZoneScoped;
+#endif
+
+   const float logDepthRange = std::log(config::Z_FAR / config::Z_NEAR);
+
+   DescriptorTypes::StorageBufferObject::ClustersFrame frame{};
+
+   frame.view = camera->getViewM();
+   frame.invProj = glm::inverse(camera->getProjectionM());
+   frame.screenSize = glm::vec2(extent.width, extent.height);
+   frame.tileSize = glm::vec2(
+         std::ceil(extent.width / (float)config::CLUSTERS_X),
+         std::ceil(extent.height / (float)config::CLUSTERS_Y)
+   );
+   frame.zNear = config::Z_NEAR;
+   frame.zFar = config::Z_FAR;
+   frame.sliceScale = config::CLUSTERS_Z / logDepthRange;
+   frame.sliceBias = (
+         config::CLUSTERS_Z * std::log(config::Z_NEAR) / logDepthRange
+   );
+   frame.clustersX = config::CLUSTERS_X;
+   frame.clustersY = config::CLUSTERS_Y;
+   frame.clustersZ = config::CLUSTERS_Z;
+   frame.maxLightsPerCluster = config::MAX_LIGHTS_PER_CLUSTER;
+   frame.lightsCount = m_lightsCount;
+
+   std::memcpy(
+         m_frames->getAllocation(currentFrame).mappedData,
+         &frame,
+         sizeof(frame)
+   );
+}
+
+const VkCommandBuffer& LightClusters::getCommandBuffer(
+      const uint32_t index
+) const {
+   return m_commandPool->getCommandBuffer(index);
+}
+
+UBO* LightClusters::getFrames() const
+{
+   return m_frames.get();
+}
+
+UBO* LightClusters::getLightGrid() const
+{
+   return m_lightGrid.get();
+}
+
+UBO* LightClusters::getLightIndices() const
+{
+   return m_lightIndices.get();
+}
+
+void LightClusters::destroy()
+{
+   m_frames->destroy();
+   m_lightGrid->destroy();
+   m_lightIndices->destroy();
+
+   m_descriptorPool.destroy();
+   m_pipeline.destroy();
+   m_commandPool->destroy();
+}
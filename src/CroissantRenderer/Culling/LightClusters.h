@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Pipeline/Compute.h>
+#include <CroissantRenderer/Descriptor/DescriptorPool.h>
+#include <CroissantRenderer/Descriptor/DescriptorSets.h>
+#include <CroissantRenderer/Descriptor/Types/UBO/UBO.h>
+#include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/Camera/Camera.h>
+
+/*
+ * Light culling of the clustered forward shading. The view frustum is
+ * splitted in a grid of clusters(screen tiles x exponential depth slices)
+ * and each frame a compute pass adds to each cluster the lights whose
+ * sphere of influence intersects it. The PBR fragments only shade the
+ * lights of their cluster, so their cost depends on the count of lights
+ * around them and not on the count of lights of the scene.
+ */
+class LightClusters
+{
+
+public:
+
+   LightClusters(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const uint32_t& graphicsFamilyIndex,
+         // From the scene
+         const std::shared_ptr<UBO>& lights,
+         const uint32_t lightsCount
+   );
+   ~LightClusters();
+   void update(
+         const std::shared_ptr<Camera>& camera,
+         const VkExtent2D& extent,
+         const uint32_t currentFrame
+   );
+   const VkCommandBuffer& getCommandBuffer(const uint32_t index) const;
+   UBO* getFrames() const;
+   UBO* getLightGrid() const;
+   UBO* getLightIndices() const;
+   void destroy();
+
+private:
+
+   void createBuffers(const VkPhysicalDevice& physicalDevice);
+   void createDescriptorSets();
+   void recordCommandBuffers();
+
+   VkDevice                         m_logicalDevice;
+
+   Compute                          m_pipeline;
+   DescriptorPool                   m_descriptorPool;
+   // One per frame in flight.
+   std::vector<DescriptorSets>      m_descriptorSets;
+   std::shared_ptr<CommandPool>     m_commandPool;
+
+   // One per frame in flight.
+   // -Grid of the frame(written by the CPU).
+   std::shared_ptr<UBO>             m_frames;
+   // -Count of lights of each cluster.
+   std::shared_ptr<UBO>             m_lightGrid;
+   // -Indices of the lights of each cluster(MAX_LIGHTS_PER_CLUSTER each).
+   std::shared_ptr<UBO>             m_lightIndices;
+   // (owned by the scene)
+   std::shared_ptr<UBO>             m_lights;
+
+   uint32_t                         m_lightsCount;
+   uint32_t                         m_clustersCount;
+};
@@ -0,0 +1,581 @@
+#include <CroissantRenderer/Culling/MaskedOcclusion.h>
+
+#include <vector>
+#include <atomic>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64)
+   #include <xmmintrin.h>
+   #define MASKED_OCCLUSION_SSE_ON
+#endif
+
+#if defined(__AVX2__)
+   #include <immintrin.h>
+   #define MASKED_OCCLUSION_AVX2_ON
+#endif
+
+#include <glm/glm.hpp>
+
+#ifdef RELEASE_MODE_ON
+   #include <tracy/Tracy.hpp>
+#endif
+
+#include <CroissantRenderer/Culling/Bounds.h>
+#include <CroissantRenderer/Job/JobSystem.h>
+
+// Size of the tiles(in pixels), one bit of the mask per pixel.
+static const int TILE_W = 8;
+static const int TILE_H = 4;
+static const uint32_t FULL_MASK = 0xffffffff;
+// Rows of tiles rasterized by each job.
+static const int TILE_ROWS_PER_JOB = 4;
+// Below this the culling isn't worth to be splitted in jobs.
+static const size_t MIN_BOUNDS_COUNT_PER_JOB = 1024;
+// The triangles(and AABBs) with a vertex behind this w are not projected.
+static const float MIN_W = 1e-5f;
+
+MaskedOcclusion::MaskedOcclusion()
+   : m_width(0),
+     m_height(0),
+     m_tilesCountX(0),
+     m_tilesCountY(0)
+{}
+
+MaskedOcclusion::MaskedOcclusion(const uint32_t width, const uint32_t height)
+   : m_width(width),
+     m_height(height),
+     m_tilesCountX((width + TILE_W - 1) / TILE_W),
+     m_tilesCountY((height + TILE_H - 1) / TILE_H)
+{
+   const size_t tilesCount = m_tilesCountX * m_tilesCountY;
+
+   m_zMax0.assign(tilesCount, 1.0f);
+   m_zMax1.assign(tilesCount, 0.0f);
+   m_masks.assign(tilesCount, 0);
+}
+
+MaskedOcclusion::~MaskedOcclusion() {}
+
+void MaskedOcclusion::clearOccluders()
+{
+   m_occluders.clear();
+}
+
+/*
+ * -The mesh has to outlive the render of this frame(only its address is
+ * stored).
+ */
+void MaskedOcclusion::addOccluder(
+      const glm::mat4& model,
+      const OccluderMesh& mesh
+) {
+   m_occluders.push_back({model, &mesh});
+}
+
+/*
+ * -Projects the triangles of the occluders to the screen. Each occluder is
+ * a job that writes its own range of triangles.
+ * -The triangles with a vertex in front of the near plane(or behind the
+ * camera) or out of the screen are discarded, since they aren't clipped and
+ * their depths would be too near(an occluder less is still conservative).
+ * The rest are stored counter-clockwise.
+ */
+void MaskedOcclusion::setupTriangles(
+      const glm::mat4& viewProj,
+      JobSystem& jobSystem
+) {
+   m_firstTriangles.resize(m_occluders.size() + 1);
+   m_firstTriangles[0] = 0;
+
+   for (size_t i = 0; i < m_occluders.size(); i++)
+   {
+      m_firstTriangles[i + 1] = (
+            m_firstTriangles[i] + m_occluders[i].opMesh->indices.size() / 3
+      );
+   }
+
+   m_triangles.resize(m_firstTriangles.back());
+   m_isTriangleValid.resize(m_firstTriangles.back());
+
+   const glm::vec2 screenSize = glm::vec2(m_width, m_height);
+
+   jobSystem.parallelFor(
+         m_occluders.size(),
+         [&](const size_t occluderIndex)
+         {
+            const Occluder& occluder = m_occluders[occluderIndex];
+            const OccluderMesh& mesh = *occluder.opMesh;
+            const glm::mat4 mvp = viewProj * occluder.model;
+
+            std::vector<glm::vec4> clipVertices(mesh.vertices.size());
+
+            for (size_t i = 0; i < mesh.vertices.size(); i++)
+               clipVertices[i] = mvp * glm::vec4(mesh.vertices[i], 1.0f);
+
+            size_t t = m_firstTriangles[occluderIndex];
+
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3, t++)
+            {
+               Triangle& triangle = m_triangles[t];
+               bool isValid = true;
+
+               for (int j = 0; j < 3; j++)
+               {
+                  const glm::vec4& clip = clipVertices[mesh.indices[i + j]];
+
+                  // (ndc z < 0)
+                  if (clip.w < MIN_W || clip.z < 0.0f)
+                  {
+                     isValid = false;
+                     break;
+                  }
+
+                  const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+                  triangle.v[j] = glm::vec3(
+                        (glm::vec2(ndc) * 0.5f + 0.5f) * screenSize,
+                        ndc.z
+                  );
+               }
+
+               if (isValid == false)
+               {
+                  m_isTriangleValid[t] = false;
+                  continue;
+               }
+
+               const glm::vec3 e1 = triangle.v[1] - triangle.v[0];
+               const glm::vec3 e2 = triangle.v[2] - triangle.v[0];
+               const float area = e1.x * e2.y - e1.y * e2.x;
+
+               if (area < 0.0f)
+                  std::swap(triangle.v[1], triangle.v[2]);
+
+               const glm::vec3 minV = glm::min(
+                     triangle.v[0], glm::min(triangle.v[1], triangle.v[2])
+               );
+               const glm::vec3 maxV = glm::max(
+                     triangle.v[0], glm::max(triangle.v[1], triangle.v[2])
+               );
+
+               isValid = (
+                     area != 0.0f &&
+                     maxV.x >= 0.0f && minV.x < screenSize.x &&
+                     maxV.y >= 0.0f && minV.y < screenSize.y &&
+                     minV.z <= 1.0f
+               );
+
+               m_isTriangleValid[t] = isValid;
+
+               if (isValid == false)
+                  continue;
+
+               triangle.minTileX = (int)std::max(minV.x, 0.0f) / TILE_W;
+               triangle.minTileY = (int)std::max(minV.y, 0.0f) / TILE_H;
+               triangle.maxTileX = (
+                     (int)std::min(maxV.x, screenSize.x - 1.0f) / TILE_W
+               );
+               triangle.maxTileY = (
+                     (int)std::min(maxV.y, screenSize.y - 1.0f) / TILE_H
+               );
+            }
+         }
+   );
+}
+
+/*
+ * -Returns the mask of the pixels(centers) of a row of a tile that are
+ * inside the 3 edges, from x(the center of the first pixel) and y.
+ */
+static uint32_t getRowCoverage(
+      const float a[3],
+      const float b[3],
+      const float c[3],
+      const float x,
+      const float y
+) {
+#if defined(MASKED_OCCLUSION_AVX2_ON)
+   // - 8 pixels at once.
+   const __m256 xs = _mm256_add_ps(
+         _mm256_set1_ps(x),
+         _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)
+   );
+   const __m256 zero = _mm256_setzero_ps();
+   __m256 isInside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+
+   for (int e = 0; e < 3; e++)
+   {
+      const __m256 edge = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_set1_ps(a[e]), xs),
+            _mm256_set1_ps(b[e] * y + c[e])
+      );
+
+      isInside = _mm256_and_ps(
+            isInside,
+            _mm256_cmp_ps(edge, zero, _CMP_GE_OQ)
+      );
+   }
+
+   return _mm256_movemask_ps(isInside);
+#elif defined(MASKED_OCCLUSION_SSE_ON)
+   // - 2 x 4 pixels.
+   const __m128 xs0 = _mm_add_ps(
+         _mm_set1_ps(x),
+         _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)
+   );
+   const __m128 xs1 = _mm_add_ps(xs0, _mm_set1_ps(4.0f));
+   const __m128 zero = _mm_setzero_ps();
+   __m128 isInside0 = _mm_cmpeq_ps(zero, zero);
+   __m128 isInside1 = isInside0;
+
+   for (int e = 0; e < 3; e++)
+   {
+      const __m128 ae = _mm_set1_ps(a[e]);
+      const __m128 rowEdge = _mm_set1_ps(b[e] * y + c[e]);
+
+      isInside0 = _mm_and_ps(
+            isInside0,
+            _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(ae, xs0), rowEdge), zero)
+      );
+      isInside1 = _mm_and_ps(
+            isInside1,
+            _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(ae, xs1), rowEdge), zero)
+      );
+   }
+
+   return _mm_movemask_ps(isInside0) | (_mm_movemask_ps(isInside1) << 4);
+#else
+   uint32_t mask = 0;
+
+   for (int i = 0; i < TILE_W; i++)
+   {
+      bool isInside = true;
+
+      for (int e = 0; e < 3; e++)
+         isInside = isInside && (a[e] * (x + i) + b[e] * y + c[e] >= 0.0f);
+
+      mask |= (uint32_t)isInside << i;
+   }
+
+   return mask;
+#endif
+}
+
+/*
+ * -Rasterizes the tiles of the triangle between the rows of tiles
+ * firstTileRow and lastTileRow(included). The depth of the triangle in each
+ * tile is the farthest one of its plane in the corners of the tile(clamped
+ * to its farthest vertex).
+ */
+void MaskedOcclusion::rasterizeTriangle(
+      const Triangle& triangle,
+      const int firstTileRow,
+      const int lastTileRow
+) {
+   const glm::vec3& v0 = triangle.v[0];
+   const glm::vec3& v1 = triangle.v[1];
+   const glm::vec3& v2 = triangle.v[2];
+
+   // - Edges(inside if a * x + b * y + c >= 0).
+   float a[3];
+   float b[3];
+   float c[3];
+
+   for (int e = 0; e < 3; e++)
+   {
+      const glm::vec3& p = triangle.v[e];
+      const glm::vec3& q = triangle.v[(e + 1) % 3];
+
+      a[e] = p.y - q.y;
+      b[e] = q.x - p.x;
+      c[e] = -(a[e] * p.x + b[e] * p.y);
+   }
+
+   // - Plane of the depth(z = zA * x + zB * y + zC).
+   const glm::vec3 e1 = v1 - v0;
+   const glm::vec3 e2 = v2 - v0;
+   const float area = e1.x * e2.y - e1.y * e2.x;
+   const float zA = (e1.z * e2.y - e1.y * e2.z) / area;
+   const float zB = (e1.x * e2.z - e1.z * e2.x) / area;
+   const float zC = v0.z - zA * v0.x - zB * v0.y;
+   const float zMax = std::max(v0.z, std::max(v1.z, v2.z));
+
+   const int firstRow = std::max(triangle.minTileY, firstTileRow);
+   const int lastRow = std::min(triangle.maxTileY, lastTileRow);
+
+   for (int ty = firstRow; ty <= lastRow; ty++)
+   {
+      const float y0 = (float)(ty * TILE_H);
+      const float zRow = zC + std::max(zB * y0, zB * (y0 + TILE_H));
+
+      for (int tx = triangle.minTileX; tx <= triangle.maxTileX; tx++)
+      {
+         const float x0 = (float)(tx * TILE_W);
+         uint32_t coverage = 0;
+
+         for (int row = 0; row < TILE_H; row++)
+         {
+            coverage |= getRowCoverage(
+                  a, b, c, x0 + 0.5f, y0 + row + 0.5f
+            ) << (row * TILE_W);
+         }
+
+         if (coverage == 0)
+            continue;
+
+         const float zTriangle = std::min(
+               zRow + std::max(zA * x0, zA * (x0 + TILE_W)),
+               zMax
+         );
+
+         updateTile(ty * m_tilesCountX + tx, coverage, zTriangle);
+      }
+   }
+}
+
+/*
+ * -Merges the coverage of a triangle with the working layer of the tile:
+ *    - If the triangle is behind the reference layer, it hides nothing new.
+ *    - If it's much closer than the working layer(more than the distance
+ *      between both layers), the working layer is discarded and a new one
+ *      starts with the triangle.
+ *    - Once the mask is full, the working layer becomes the reference one.
+ */
+void MaskedOcclusion::updateTile(
+      const size_t tileIndex,
+      const uint32_t coverage,
+      const float zTriangle
+) {
+   float& zMax0 = m_zMax0[tileIndex];
+   float& zMax1 = m_zMax1[tileIndex];
+   uint32_t& mask = m_masks[tileIndex];
+
+   if (zTriangle >= zMax0)
+      return;
+
+   if (mask != 0 && (zMax1 - zTriangle) > (zMax0 - zMax1))
+      mask = 0;
+
+   zMax1 = (mask == 0) ? zTriangle : std::max(zMax1, zTriangle);
+   mask |= coverage;
+
+   if (mask == FULL_MASK)
+   {
+      zMax0 = zMax1;
+      zMax1 = 0.0f;
+      mask = 0;
+   }
+}
+
+/*
+ * -Clears the depth and rasterizes the occluders added in this frame. Each
+ * job rasterizes the triangles of TILE_ROWS_PER_JOB rows of tiles.
+ */
+void MaskedOcclusion::render(const glm::mat4& viewProj, JobSystem& jobSystem)
+{
+#ifdef RELEASE_MODE_ON
+   ZoneScoped;
+#endif
+
+   std::fill(m_zMax0.begin(), m_zMax0.end(), 1.0f);
+   std::fill(m_zMax1.begin(), m_zMax1.end(), 0.0f);
+   std::fill(m_masks.begin(), m_masks.end(), 0);
+
+   if (m_occluders.size() == 0)
+      return;
+
+   setupTriangles(viewProj, jobSystem);
+
+   const size_t jobsCount = (
+         (m_tilesCountY + TILE_ROWS_PER_JOB - 1) / TILE_ROWS_PER_JOB
+   );
+
+   jobSystem.parallelFor(
+         jobsCount,
+         [&](const size_t jobIndex)
+         {
+            const int firstTileRow = jobIndex * TILE_ROWS_PER_JOB;
+            const int lastTileRow = std::min(
+                  firstTileRow + TILE_ROWS_PER_JOB,
+                  (int)m_tilesCountY
+            ) - 1;
+
+            for (size_t i = 0; i < m_triangles.size(); i++)
+            {
+               const Triangle& triangle = m_triangles[i];
+
+               if (m_isTriangleValid[i] == false ||
+                   triangle.maxTileY < firstTileRow ||
+                   triangle.minTileY > lastTileRow
+               ) {
+                  continue;
+               }
+
+               rasterizeTriangle(triangle, firstTileRow, lastTileRow);
+            }
+         }
+   );
+}
+
+/*
+ * -The AABB(center and half size in world space) is hidden if its closest
+ * depth is behind the reference layer of all the tiles covered by its
+ * rectangle on screen.
+ * -The ones that cross the near plane or are out of the screen are never
+ * hidden(the frustum culling decides).
+ */
+bool MaskedOcclusion::isOccluded(
+      const glm::mat4& viewProj,
+      const glm::vec3& center,
+      const glm::vec3& extent
+) const {
+   glm::vec2 minP = glm::vec2(FLT_MAX);
+   glm::vec2 maxP = glm::vec2(-FLT_MAX);
+   float minZ = FLT_MAX;
+
+   for (int i = 0; i < 8; i++)
+   {
+      const glm::vec3 corner = center + extent * glm::vec3(
+            (i & 1) ? 1.0f : -1.0f,
+            (i & 2) ? 1.0f : -1.0f,
+            (i & 4) ? 1.0f : -1.0f
+      );
+      const glm::vec4 clip = viewProj * glm::vec4(corner, 1.0f);
+
+      // (crosses the near plane)
+      if (clip.w < MIN_W || clip.z < 0.0f)
+         return false;
+
+      const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+      const glm::vec2 p = (
+            (glm::vec2(ndc) * 0.5f + 0.5f) * glm::vec2(m_width, m_height)
+      );
+
+      minP = glm::min(minP, p);
+      maxP = glm::max(maxP, p);
+      minZ = std::min(minZ, ndc.z);
+   }
+
+   if (maxP.x < 0.0f || minP.x >= m_width ||
+       maxP.y < 0.0f || minP.y >= m_height
+   ) {
+      return false;
+   }
+
+   const int minTileX = (int)std::max(minP.x, 0.0f) / TILE_W;
+   const int minTileY = (int)std::max(minP.y, 0.0f) / TILE_H;
+   const int maxTileX = (int)std::min(maxP.x, m_width - 1.0f) / TILE_W;
+   const int maxTileY = (int)std::min(maxP.y, m_height - 1.0f) / TILE_H;
+
+   for (int ty = minTileY; ty <= maxTileY; ty++)
+   {
+      const float* zMax0 = &m_zMax0[ty * m_tilesCountX];
+      int tx = minTileX;
+
+#ifdef MASKED_OCCLUSION_SSE_ON
+      // - 4 tiles at once.
+      const __m128 z = _mm_set1_ps(minZ);
+
+      for (; tx + 3 <= maxTileX; tx += 4)
+      {
+         if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(&zMax0[tx]), z)))
+            return false;
+      }
+#endif
+
+      for (; tx <= maxTileX; tx++)
+      {
+         if (zMax0[tx] >= minZ)
+            return false;
+      }
+   }
+
+   return true;
+}
+
+/*
+ * -Only tests the AABBs that are still visible(after the frustum culling),
+ * sets the hidden ones to 0 and returns their count.
+ */
+uint32_t MaskedOcclusion::cull(
+      const glm::mat4& viewProj,
+      const frustumCulling::Bounds& bounds,
+      JobSystem& jobSystem,
+      std::vector<uint8_t>& isVisible
+) const {
+#ifdef RELEASE_MODE_ON
+   ZoneScoped;
+#endif
+
+   if (m_occluders.size() == 0)
+      return 0;
+
+   const size_t boundsCount = bounds.centerX.size();
+
+   auto cullRange = [&](const size_t begin, const size_t end)
+   {
+      uint32_t occludedCount = 0;
+
+      for (size_t i = begin; i < end; i++)
+      {
+         if (isVisible[i] == false)
+            continue;
+
+         const bool isHidden = isOccluded(
+               viewProj,
+               glm::vec3(
+                  bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]
+               ),
+               glm::vec3(
+                  bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]
+               )
+         );
+
+         isVisible[i] = !isHidden;
+         occludedCount += isHidden;
+      }
+
+      return occludedCount;
+   };
+
+   if (boundsCount < MIN_BOUNDS_COUNT_PER_JOB * 2)
+      return cullRange(0, boundsCount);
+
+   const size_t jobsCount = (
+         (boundsCount + MIN_BOUNDS_COUNT_PER_JOB - 1) / MIN_BOUNDS_COUNT_PER_JOB
+   );
+   std::atomic<uint32_t> occludedCount(0);
+
+   jobSystem.parallelFor(
+         jobsCount,
+         [&](const size_t jobIndex)
+         {
+            const size_t begin = jobIndex * MIN_BOUNDS_COUNT_PER_JOB;
+            const size_t end = std::min(
+                  begin + MIN_BOUNDS_COUNT_PER_JOB,
+                  boundsCount
+            );
+
+            occludedCount += cullRange(begin, end);
+         }
+   );
+
+   return occludedCount;
+}
+
+const size_t MaskedOcclusion::getOccludersCount() const
+{
+   return m_occluders.size();
+}
+
+const uint32_t MaskedOcclusion::getWidth() const
+{
+   return m_width;
+}
+
+const uint32_t MaskedOcclusion::getHeight() const
+{
+   return m_height;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Culling/Bounds.h>
+#include <CroissantRenderer/Job/JobSystem.h>
+
+// Simplified geometry of a mesh that hides the others(in model space).
+struct OccluderMesh
+{
+   std::vector<glm::vec3> vertices;
+   std::vector<uint32_t>  indices;
+};
+
+/*
+ * Masked software occlusion culling on the CPU(for when there is no GPU
+ * culling). The occluders are rasterized to a low resolution depth buffer
+ * splitted in tiles of 8x4 pixels, where each tile only keeps:
+ *    - zMax0: the farthest depth of the tile(reference layer).
+ *    - zMax1 + mask: the farthest depth and the coverage of the triangles
+ *      that don't cover the whole tile yet(working layer). Once the mask is
+ *      full, the working layer replaces the reference one.
+ * The coverage of each row of a tile is computed with SSE/AVX2 and the rows
+ * of tiles are splitted in jobs, so no tile is shared between threads. The
+ * AABBs are hidden if they are behind the reference layer of all the tiles
+ * that they cover.
+ * It doesn't need the GPU(it only reads the geometry on the CPU).
+ */
+class MaskedOcclusion
+{
+
+public:
+
+   MaskedOcclusion();
+   MaskedOcclusion(const uint32_t width, const uint32_t height);
+   ~MaskedOcclusion();
+   void clearOccluders();
+   void addOccluder(const glm::mat4& model, const OccluderMesh& mesh);
+   void render(const glm::mat4& viewProj, JobSystem& jobSystem);
+   uint32_t cull(
+         const glm::mat4& viewProj,
+         const frustumCulling::Bounds& bounds,
+         JobSystem& jobSystem,
+         std::vector<uint8_t>& isVisible
+   ) const;
+   bool isOccluded(
+         const glm::mat4& viewProj,
+         const glm::vec3& center,
+         const glm::vec3& extent
+   ) const;
+   const size_t getOccludersCount() const;
+   const uint32_t getWidth() const;
+   const uint32_t getHeight() const;
+
+private:
+
+   struct Occluder
+   {
+      glm::mat4            model;
+      const OccluderMesh*  opMesh;
+   };
+
+   // (in screen space: x and y in pixels, z in [0, 1])
+   struct Triangle
+   {
+      glm::vec3 v[3];
+      // Tiles covered by the bounding box(last ones included).
+      int       minTileX;
+      int       minTileY;
+      int       maxTileX;
+      int       maxTileY;
+   };
+
+   void setupTriangles(const glm::mat4& viewProj, JobSystem& jobSystem);
+   void rasterizeTriangle(
+         const Triangle& triangle,
+         const int firstTileRow,
+         const int lastTileRow
+   );
+   void updateTile(
+         const size_t tileIndex,
+         const uint32_t coverage,
+         const float zTriangle
+   );
+
+   uint32_t                m_width;
+   uint32_t                m_height;
+   uint32_t                m_tilesCountX;
+   uint32_t                m_tilesCountY;
+
+   // (the occluders of this frame, set by addOccluder())
+   std::vector<Occluder>   m_occluders;
+   std::vector<Triangle>   m_triangles;
+   // Triangles of each occluder(invalid ones included).
+   std::vector<size_t>     m_firstTriangles;
+   std::vector<uint8_t>    m_isTriangleValid;
+
+   // Tiles(SoA)
+   std::vector<float>      m_zMax0;
+   std::vector<float>      m_zMax1;
+   std::vector<uint32_t>   m_masks;
+};
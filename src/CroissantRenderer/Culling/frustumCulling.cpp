@@ -0,0 +1,286 @@
+#include <CroissantRenderer/Culling/frustumCulling.h>
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64)
+   #include <xmmintrin.h>
+   #define FRUSTUM_CULLING_SSE_ON
+#endif
+
+#include <glm/glm.hpp>
+
+#ifdef RELEASE_MODE_ON
+   #include <tracy/Tracy.hpp>
+#endif
+
+#include <CroissantRenderer/Model/Mesh.h>
+#include <CroissantRenderer/Model/Attributes.h>
+#include <CroissantRenderer/Job/JobSystem.h>
+
+// Below this the culling isn't worth to be splitted in jobs.
+static const size_t MIN_BOUNDS_COUNT_PER_JOB = 1024;
+
+/*
+ * -Computes the AABB and the bounding sphere(centered in the AABB) of the
+ * mesh in model space.
+ */
+template<typename T>
+void frustumCulling::computeBounds(Mesh<T>& mesh)
+{
+   mesh.aabbMin = glm::vec3(0.0f);
+   mesh.aabbMax = glm::vec3(0.0f);
+   mesh.boundingSphere = glm::vec4(0.0f);
+
+   if (mesh.vertices.size() == 0)
+      return;
+
+   mesh.aabbMin = mesh.vertices[0].pos;
+   mesh.aabbMax = mesh.vertices[0].pos;
+
+   for (auto& vertex : mesh.vertices)
+   {
+      mesh.aabbMin = glm::min(mesh.aabbMin, vertex.pos);
+      mesh.aabbMax = glm::max(mesh.aabbMax, vertex.pos);
+   }
+
+   const glm::vec3 center = (mesh.aabbMin + mesh.aabbMax) * 0.5f;
+   float radius = 0.0f;
+
+   for (auto& vertex : mesh.vertices)
+      radius = std::max(radius, glm::length(vertex.pos - center));
+
+   mesh.boundingSphere = glm::vec4(center, radius);
+}
+
+/*
+ * -Extracts the planes from the rows of the matrix(Gribb-Hartmann) and
+ * normalizes them.
+ * -The near plane is taken as if the depth range were [-1, 1]. With [0, 1]
+ * it's a bit behind the real one(more conservative), so it's valid for both.
+ */
+frustumCulling::Planes frustumCulling::getPlanes(const glm::mat4& viewProj)
+{
+   const glm::vec4 row0 = glm::vec4(
+         viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]
+   );
+   const glm::vec4 row1 = glm::vec4(
+         viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]
+   );
+   const glm::vec4 row2 = glm::vec4(
+         viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]
+   );
+   const glm::vec4 row3 = glm::vec4(
+         viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]
+   );
+
+   Planes planes = {
+      row3 + row0,
+      row3 - row0,
+      row3 + row1,
+      row3 - row1,
+      row3 + row2,
+      row3 - row2
+   };
+
+   for (auto& plane : planes)
+   {
+      const float length = glm::length(glm::vec3(plane));
+
+      if (length > 0.0f)
+         plane /= length;
+   }
+
+   return planes;
+}
+
+void frustumCulling::clearBounds(Bounds& bounds)
+{
+   bounds.centerX.clear();
+   bounds.centerY.clear();
+   bounds.centerZ.clear();
+   bounds.extentX.clear();
+   bounds.extentY.clear();
+   bounds.extentZ.clear();
+}
+
+/*
+ * -Adds the AABB(in model space) transformed to world space. The new AABB is
+ * the one that contains the transformed box:
+ *    center' = M * center
+ *    extent' = |M3x3| * extent
+ */
+void frustumCulling::addBounds(
+      const glm::mat4& model,
+      const glm::vec3& aabbMin,
+      const glm::vec3& aabbMax,
+      Bounds& bounds
+) {
+   const glm::vec3 center = glm::vec3(
+         model * glm::vec4((aabbMin + aabbMax) * 0.5f, 1.0f)
+   );
+   const glm::vec3 extent = (aabbMax - aabbMin) * 0.5f;
+
+   glm::vec3 newExtent = glm::vec3(0.0f);
+
+   for (int i = 0; i < 3; i++)
+   {
+      newExtent += glm::abs(glm::vec3(model[i])) * extent[i];
+   }
+
+   bounds.centerX.push_back(center.x);
+   bounds.centerY.push_back(center.y);
+   bounds.centerZ.push_back(center.z);
+   bounds.extentX.push_back(newExtent.x);
+   bounds.extentY.push_back(newExtent.y);
+   bounds.extentZ.push_back(newExtent.z);
+}
+
+/*
+ * -An AABB is outside if it's fully behind any of the planes:
+ *    dot(n, c) + d + dot(|n|, e) < 0
+ * -Returns the count of visible AABBs of the range.
+ */
+static uint32_t cullRange(
+      const frustumCulling::Planes& planes,
+      const frustumCulling::Bounds& bounds,
+      const size_t begin,
+      const size_t end,
+      std::vector<uint8_t>& isVisible
+) {
+   uint32_t visibleCount = 0;
+   size_t i = begin;
+
+#ifdef FRUSTUM_CULLING_SSE_ON
+   // - 4 AABBs at once.
+   const __m128 zero = _mm_setzero_ps();
+
+   for (; i + 4 <= end; i += 4)
+   {
+      const __m128 cx = _mm_loadu_ps(&bounds.centerX[i]);
+      const __m128 cy = _mm_loadu_ps(&bounds.centerY[i]);
+      const __m128 cz = _mm_loadu_ps(&bounds.centerZ[i]);
+      const __m128 ex = _mm_loadu_ps(&bounds.extentX[i]);
+      const __m128 ey = _mm_loadu_ps(&bounds.extentY[i]);
+      const __m128 ez = _mm_loadu_ps(&bounds.extentZ[i]);
+
+      __m128 isOutside = _mm_setzero_ps();
+
+      for (auto& plane : planes)
+      {
+         const __m128 nx = _mm_set1_ps(plane.x);
+         const __m128 ny = _mm_set1_ps(plane.y);
+         const __m128 nz = _mm_set1_ps(plane.z);
+         const __m128 d = _mm_set1_ps(plane.w);
+         const __m128 absNx = _mm_set1_ps(std::abs(plane.x));
+         const __m128 absNy = _mm_set1_ps(std::abs(plane.y));
+         const __m128 absNz = _mm_set1_ps(std::abs(plane.z));
+
+         __m128 distance = _mm_add_ps(
+               _mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+               _mm_add_ps(_mm_mul_ps(nz, cz), d)
+         );
+         const __m128 radius = _mm_add_ps(
+               _mm_add_ps(_mm_mul_ps(absNx, ex), _mm_mul_ps(absNy, ey)),
+               _mm_mul_ps(absNz, ez)
+         );
+         distance = _mm_add_ps(distance, radius);
+
+         isOutside = _mm_or_ps(isOutside, _mm_cmplt_ps(distance, zero));
+      }
+
+      const int outsideMask = _mm_movemask_ps(isOutside);
+
+      for (int j = 0; j < 4; j++)
+      {
+         const bool isInside = ((outsideMask >> j) & 1) == 0;
+
+         isVisible[i + j] = isInside;
+         visibleCount += isInside;
+      }
+   }
+#endif
+
+   // - Rest(or all of them if there is no SSE).
+   for (; i < end; i++)
+   {
+      bool isInside = true;
+
+      for (auto& plane : planes)
+      {
+         const float distance = (
+               plane.x * bounds.centerX[i] +
+               plane.y * bounds.centerY[i] +
+               plane.z * bounds.centerZ[i] +
+               plane.w +
+               std::abs(plane.x) * bounds.extentX[i] +
+               std::abs(plane.y) * bounds.extentY[i] +
+               std::abs(plane.z) * bounds.extentZ[i]
+         );
+
+         if (distance < 0.0f)
+         {
+            isInside = false;
+            break;
+         }
+      }
+
+      isVisible[i] = isInside;
+      visibleCount += isInside;
+   }
+
+   return visibleCount;
+}
+
+/*
+ * -Writes 1(visible) or 0(culled) for each AABB and returns the count of
+ * visible ones. The big scenes are splitted in jobs of
+ * MIN_BOUNDS_COUNT_PER_JOB AABBs.
+ */
+uint32_t frustumCulling::cull(
+      const Planes& planes,
+      const Bounds& bounds,
+      JobSystem& jobSystem,
+      std::vector<uint8_t>& isVisible
+) {
+#ifdef RELEASE_MODE_ON
+   ZoneScoped;
+#endif
+
+   const size_t boundsCount = bounds.centerX.size();
+
+   isVisible.resize(boundsCount);
+
+   if (boundsCount < MIN_BOUNDS_COUNT_PER_JOB * 2)
+      return cullRange(planes, bounds, 0, boundsCount, isVisible);
+
+   const size_t jobsCount = (
+         (boundsCount + MIN_BOUNDS_COUNT_PER_JOB - 1) / MIN_BOUNDS_COUNT_PER_JOB
+   );
+   std::atomic<uint32_t> visibleCount(0);
+
+   jobSystem.parallelFor(
+         jobsCount,
+         [&](const size_t jobIndex)
+         {
+            const size_t begin = jobIndex * MIN_BOUNDS_COUNT_PER_JOB;
+            const size_t end = std::min(
+                  begin + MIN_BOUNDS_COUNT_PER_JOB,
+                  boundsCount
+            );
+
+            visibleCount += cullRange(planes, bounds, begin, end, isVisible);
+         }
+   );
+
+   return visibleCount;
+}
+
+////INSTANCES////
+
+template void frustumCulling::computeBounds<Attributes::PBR::Vertex>(
+      Mesh<Attributes::PBR::Vertex>& mesh
+);
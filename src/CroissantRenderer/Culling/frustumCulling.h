@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <array>
+
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Model/Mesh.h>
+#include <CroissantRenderer/Culling/Bounds.h>
+#include <CroissantRenderer/Job/JobSystem.h>
+
+/*
+ * Frustum culling of the AABBs of the meshes(in world space). The bounds are
+ * stored as SoA so each plane is tested against 4 AABBs at once(SSE).
+ */
+namespace frustumCulling
+{
+   // (inside if dot(xyz, p) + w >= 0)
+   typedef std::array<glm::vec4, 6> Planes;
+
+   struct Stats
+   {
+      uint32_t visibleCount       = 0;
+      uint32_t culledCount        = 0;
+      uint32_t shadowVisibleCount = 0;
+      uint32_t shadowCulledCount  = 0;
+      // (only with the occlusion culling)
+      uint32_t occludedCount      = 0;
+   };
+
+   template<typename T>
+   void computeBounds(Mesh<T>& mesh);
+   Planes getPlanes(const glm::mat4& viewProj);
+   void clearBounds(Bounds& bounds);
+   void addBounds(
+         const glm::mat4& model,
+         const glm::vec3& aabbMin,
+         const glm::vec3& aabbMax,
+         Bounds& bounds
+   );
+   uint32_t cull(
+         const Planes& planes,
+         const Bounds& bounds,
+         JobSystem& jobSystem,
+         std::vector<uint8_t>& isVisible
+   );
+};
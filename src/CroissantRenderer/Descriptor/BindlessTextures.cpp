@@ -0,0 +1,133 @@
+#include <CroissantRenderer/Descriptor/BindlessTextures.h>
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Descriptor/descriptorSetLayoutManager.h>
+#include <CroissantRenderer/Settings/config.h>
+
+BindlessTextures::BindlessTextures() {}
+
+/*
+ * -Creates the table with space for config::MAX_BINDLESS_TEXTURES textures
+ * (or less, if the device doesn't support so many).
+ */
+BindlessTextures::BindlessTextures(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const DescriptorInfo& descriptorInfo
+) : m_logicalDevice(logicalDevice),
+    m_descriptorInfo(descriptorInfo)
+{
+   VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+   indexingProperties.sType = (
+         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT
+   );
+
+   VkPhysicalDeviceProperties2 properties{};
+   properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+   properties.pNext = &indexingProperties;
+
+   vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+   m_maxTexturesCount = std::min({
+         config::MAX_BINDLESS_TEXTURES,
+         indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+         indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+         indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+         indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages
+   });
+
+   descriptorSetLayoutManager::bindless::createDescriptorSetLayout(
+         m_logicalDevice,
+         m_descriptorInfo,
+         m_maxTexturesCount,
+         m_descriptorSetLayout
+   );
+
+   m_descriptorPool = DescriptorPool(
+         m_logicalDevice,
+         {
+            {
+               m_descriptorInfo.descriptorType,
+               m_maxTexturesCount
+            }
+         },
+         1,
+         VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT
+   );
+
+   std::vector<VkDescriptorSetLayout> descriptorSetLayouts = {
+      m_descriptorSetLayout
+   };
+   std::vector<VkDescriptorSet> descriptorSets(1);
+
+   m_descriptorPool.allocDescriptorSets(descriptorSetLayouts, descriptorSets);
+
+   m_descriptorSet = descriptorSets[0];
+}
+
+BindlessTextures::~BindlessTextures() {}
+
+/*
+ * -Adds the texture to the table(if it wasn't already) and returns its index.
+ */
+const uint32_t BindlessTextures::add(const Texture* texture)
+{
+   auto it = m_texturesID.find(texture);
+
+   if (it != m_texturesID.end())
+      return it->second;
+
+   const uint32_t index = m_texturesID.size();
+
+   if (index >= m_maxTexturesCount)
+      throw std::runtime_error("Too many textures for the texture table!");
+
+   VkDescriptorImageInfo imageInfo{};
+   imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+   imageInfo.imageView = texture->getImageView();
+   imageInfo.sampler = texture->getSampler();
+
+   VkWriteDescriptorSet descriptorWrite{};
+   descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+   descriptorWrite.dstSet = m_descriptorSet;
+   descriptorWrite.dstBinding = m_descriptorInfo.bindingNumber;
+   descriptorWrite.dstArrayElement = index;
+   descriptorWrite.descriptorType = m_descriptorInfo.descriptorType;
+   descriptorWrite.descriptorCount = 1;
+   descriptorWrite.pImageInfo = &imageInfo;
+
+   vkUpdateDescriptorSets(m_logicalDevice, 1, &descriptorWrite, 0, nullptr);
+
+   m_texturesID[texture] = index;
+
+   return index;
+}
+
+const VkDescriptorSetLayout& BindlessTextures::getDescriptorSetLayout() const
+{
+   return m_descriptorSetLayout;
+}
+
+const VkDescriptorSet& BindlessTextures::getDescriptorSet() const
+{
+   return m_descriptorSet;
+}
+
+const uint32_t BindlessTextures::getTexturesCount() const
+{
+   return m_texturesID.size();
+}
+
+void BindlessTextures::destroy()
+{
+   m_descriptorPool.destroy();
+   descriptorSetLayoutManager::destroyDescriptorSetLayout(
+         m_logicalDevice,
+         m_descriptorSetLayout
+   );
+}
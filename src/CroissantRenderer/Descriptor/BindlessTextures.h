@@ -0,0 +1,47 @@
+#pragma once
+
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Descriptor/DescriptorInfo.h>
+#include <CroissantRenderer/Descriptor/DescriptorPool.h>
+#include <CroissantRenderer/Texture/Texture.h>
+
+/*
+ * Table with the textures of the materials of all the models. It's just one
+ * descriptor set(an array of textures), bound once per pipeline, so the
+ * materials only store the index of each texture in the table and the draws
+ * don't need their own descriptor sets.
+ * The same set is used by all the frames in flight: the textures are only
+ * added(never replaced), so a frame never reads a descriptor being written.
+ */
+class BindlessTextures
+{
+
+public:
+
+   BindlessTextures();
+   BindlessTextures(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const DescriptorInfo& descriptorInfo
+   );
+   ~BindlessTextures();
+   const uint32_t add(const Texture* texture);
+   const VkDescriptorSetLayout& getDescriptorSetLayout() const;
+   const VkDescriptorSet& getDescriptorSet() const;
+   const uint32_t getTexturesCount() const;
+   void destroy();
+
+private:
+
+   VkDevice                                     m_logicalDevice;
+   DescriptorInfo                               m_descriptorInfo;
+   DescriptorPool                               m_descriptorPool;
+   VkDescriptorSetLayout                        m_descriptorSetLayout;
+   VkDescriptorSet                              m_descriptorSet;
+   uint32_t                                     m_maxTexturesCount;
+   // Index of each texture added(a texture is added only once).
+   std::unordered_map<const Texture*, uint32_t> m_texturesID;
+};
@@ -7,5 +7,7 @@ struct DescriptorInfo
    int                   bindingNumber;
    VkDescriptorType      descriptorType;
    VkShaderStageFlagBits shaderStage;
+   // Size of the data seen by the descriptor(the dynamic UBOs only see their
+   // slice of the buffer).
+   VkDeviceSize          range = VK_WHOLE_SIZE;
 };
-
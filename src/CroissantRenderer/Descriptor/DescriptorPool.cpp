@@ -12,7 +12,8 @@ DescriptorPool::DescriptorPool() {}
 DescriptorPool::DescriptorPool(
       const VkDevice& logicalDevice,
       const std::vector<VkDescriptorPoolSize> poolSizes,
-      const uint32_t descriptorSetsCount
+      const uint32_t descriptorSetsCount,
+      const VkDescriptorPoolCreateFlags flags
 ) : m_logicalDevice(logicalDevice)
 {
 
@@ -21,6 +22,7 @@ DescriptorPool::DescriptorPool(
 
    VkDescriptorPoolCreateInfo poolInfo{};
    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+   poolInfo.flags = flags;
    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
    poolInfo.pPoolSizes = poolSizes.data();
    // Specifies the maximum number of descriptor sets that may be allocated.
@@ -13,7 +13,8 @@ public:
    DescriptorPool(
       const VkDevice& logicalDevice,
       const std::vector<VkDescriptorPoolSize> poolSizes,
-      const uint32_t descriptorSetsCount
+      const uint32_t descriptorSetsCount,
+      const VkDescriptorPoolCreateFlags flags = 0
    );
    ~DescriptorPool();
    const VkDescriptorPool& get() const;
@@ -13,11 +13,13 @@
 ////////////////////////////////Helper functions///////////////////////////////
 inline static void createDescriptorBufferInfo(
       const VkBuffer& buffer,
+      const VkDeviceSize range,
       VkDescriptorBufferInfo& bufferInfo
 ) {
    bufferInfo.buffer = buffer;
+   // (the dynamic UBOs are moved by the dynamic offset when they are bound)
    bufferInfo.offset = 0;
-   bufferInfo.range = VK_WHOLE_SIZE;
+   bufferInfo.range = range;
 }
 
 inline static void createDescriptorImageInfo(
@@ -75,6 +77,7 @@ DescriptorSets::DescriptorSets(
       {
          createDescriptorBufferInfo(
                UBOs[j]->get(i),
+               uboInfo[j].range,
                bufferInfos[j]
          );
       }
@@ -91,27 +94,41 @@ DescriptorSets::DescriptorSets(
          );
       }
 
+      if (additionalTextures != nullptr &&
+          additionalTextures->inputAttachments != nullptr
+      ) {
+         const auto& inputAttachments = *(additionalTextures->inputAttachments);
+
+         for (size_t j = 0; j < inputAttachments.size(); j++)
+            imageInfos[textures.size() + j] = inputAttachments[j];
+      }
+
       if (additionalTextures != nullptr)
       {
          createDescriptorImageInfo(
                additionalTextures->irradianceMap->getImageView(),
                additionalTextures->irradianceMap->getSampler(),
-               imageInfos[samplersInfo.size() - 4]
+               imageInfos[samplersInfo.size() - 5]
          );
          createDescriptorImageInfo(
                additionalTextures->BRDFlut->getImageView(),
                additionalTextures->BRDFlut->getSampler(),
-               imageInfos[samplersInfo.size() - 3]
+               imageInfos[samplersInfo.size() - 4]
          );
          createDescriptorImageInfo(
                additionalTextures->prefilteredEnvMap->getImageView(),
                additionalTextures->prefilteredEnvMap->getSampler(),
-               imageInfos[samplersInfo.size() - 2]
+               imageInfos[samplersInfo.size() - 3]
          );
 
          createDescriptorImageInfo(
                *(additionalTextures->shadowMapView),
                *(additionalTextures->shadowMapSampler),
+               imageInfos[samplersInfo.size() - 2]
+         );
+         createDescriptorImageInfo(
+               *(additionalTextures->shadowAtlasView),
+               *(additionalTextures->shadowAtlasSampler),
                imageInfos[samplersInfo.size() - 1]
          );
       }
@@ -160,13 +177,16 @@ DescriptorSets::DescriptorSets(
 
 /*
  * Used for Compute Pipelines.
+ * -The buffers and the images are assigned to the descriptors of bufferInfos
+ * in order, depending on the type of each descriptor.
  */
 DescriptorSets::DescriptorSets(
    const VkDevice logicalDevice,
    const std::vector<DescriptorInfo>& bufferInfos,
    const std::vector<VkBuffer>& buffers,
    const VkDescriptorSetLayout& descriptorSetLayout,
-   DescriptorPool& descriptorPool
+   DescriptorPool& descriptorPool,
+   const std::vector<VkDescriptorImageInfo>& images
 ) {
 
    // We just need 1 descriptor set per compute pipeline.
@@ -183,25 +203,44 @@ DescriptorSets::DescriptorSets(
    );
 
    std::vector<VkDescriptorBufferInfo> descriptorBufferInfos(buffers.size());
-   for (size_t i = 0; i < buffers.size(); i++)
+   std::vector<VkWriteDescriptorSet> descriptorWrites(
+         buffers.size() + images.size()
+   );
+   size_t bufferIndex = 0;
+   size_t imageIndex = 0;
+
+   for (size_t j = 0; j < descriptorWrites.size(); j++)
    {
+      if (bufferInfos[j].descriptorType ==
+          VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+      ) {
+         createDescriptorWriteInfo(
+               images[imageIndex],
+               m_descriptorSets[0],
+               bufferInfos[j].bindingNumber,
+               0,
+               bufferInfos[j].descriptorType,
+               descriptorWrites[j]
+         );
+         imageIndex++;
+
+         continue;
+      }
+
       createDescriptorBufferInfo(
-            buffers[i],
-            descriptorBufferInfos[i]
+            buffers[bufferIndex],
+            bufferInfos[j].range,
+            descriptorBufferInfos[bufferIndex]
       );
-   }
-
-   std::vector<VkWriteDescriptorSet> descriptorWrites(buffers.size());
-   for (size_t j = 0; j < buffers.size(); j++)
-   {
       createDescriptorWriteInfo(
-            descriptorBufferInfos[j],
+            descriptorBufferInfos[bufferIndex],
             m_descriptorSets[0],
             bufferInfos[j].bindingNumber,
             0,
             bufferInfos[j].descriptorType,
             descriptorWrites[j]
       );
+      bufferIndex++;
    }
 
    vkUpdateDescriptorSets(
@@ -248,13 +287,15 @@ void DescriptorSets::createDescriptorWriteInfo(
    descriptorWrite.descriptorCount = 1;
 
    if (type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+       type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
        type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
    ) {
 
       descriptorWrite.pBufferInfo = (VkDescriptorBufferInfo*)&descriptorInfo;
 
-   } else if (type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
-   {
+   } else if (type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+              type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT
+   ) {
 
       descriptorWrite.pImageInfo = (VkDescriptorImageInfo*)&descriptorInfo;
       
@@ -6,6 +6,7 @@
 
 #include <CroissantRenderer/Descriptor/DescriptorInfo.h>
 #include <CroissantRenderer/Descriptor/DescriptorPool.h>
+#include <CroissantRenderer/Descriptor/BindlessTextures.h>
 #include <CroissantRenderer/Descriptor/Types/UBO/UBO.h>
 #include <CroissantRenderer/Texture/Texture.h>
 
@@ -15,7 +16,29 @@ struct DescriptorSetInfo
    const Texture*               BRDFlut;
    const VkImageView*           shadowMapView;
    const VkSampler*             shadowMapSampler;
+   // Shadow atlas of the point and spot lights and its tiles.
+   const VkImageView*           shadowAtlasView;
+   const VkSampler*             shadowAtlasSampler;
+   UBO*                         shadowAtlasTiles;
    const Image*                 prefilteredEnvMap;
+   // Lights of the scene.
+   UBO*                         lights;
+   // Instances of the meshes of the PBR models.
+   UBO*                         instances;
+   UBO*                         visibleInstances;
+   // Materials of the meshes of the PBR models.
+   UBO*                         instanceMaterials;
+   UBO*                         materials;
+   const BindlessTextures*      textures;
+   // UBOs of the models(bound with dynamic offsets).
+   UBO*                         uniformRing;
+   // Clustered lighting(grid of the frame and lights of each cluster).
+   UBO*                         clustersFrame;
+   UBO*                         lightGrid;
+   UBO*                         lightIndices;
+   // Input attachments of the deferred lighting(G-buffer and depth), after
+   // the textures.
+   const std::vector<VkDescriptorImageInfo>* inputAttachments;
 };
 
 class DescriptorSets
@@ -39,7 +62,9 @@ public:
       const std::vector<DescriptorInfo>& buffersInfo,
       const std::vector<VkBuffer>& buffers,
       const VkDescriptorSetLayout& descriptorSetLayout,
-      DescriptorPool& descriptorPool
+      DescriptorPool& descriptorPool,
+      // (for the descriptors of buffersInfo that aren't buffers)
+      const std::vector<VkDescriptorImageInfo>& images = {}
    );
    DescriptorSets(const DescriptorSets& other);
    DescriptorSets& operator=(const DescriptorSets& other);
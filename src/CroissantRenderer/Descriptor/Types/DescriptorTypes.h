@@ -7,30 +7,21 @@ namespace DescriptorTypes
 {
    namespace UniformBufferObject
    {
-      struct alignas(16) LightInfo
-      {
-         glm::vec4 pos;
-         glm::vec4 dir;
-         glm::vec4 color;
-         float attenuation;
-         float radius;
-         float intensity;
-         int type;
-      };
+      // Max. count of cascades of the shadow map(the size of the arrays of
+      // the shaders).
+      inline const uint32_t MAX_SHADOW_CASCADES = 4;
 
       struct alignas(16) NormalPBR
       {
          glm::mat4 model;
          glm::mat4 view;
          glm::mat4 proj;
-         glm::mat4 lightSpace;
+         // Shadow map(see ShadowCascades)
+         glm::mat4 lightSpaces[MAX_SHADOW_CASCADES];
+         glm::vec4 cascadeSplits;
          glm::vec4 cameraPos;
          int lightsCount;
-         // TODO: Wrap this data in a diff. UBO called Material.
-         float metallicFactor;
-         float roughnessFactor;
-         int hasNormalMap;
-         int hasMetallicRoughnessMap;
+         int cascadesCount;
       };
 
       struct alignas(16) Light
@@ -50,8 +41,139 @@ namespace DescriptorTypes
 
       struct alignas(16) ShadowMap
       {
-         glm::mat4 model;
-         glm::mat4 lightSpace;
+         glm::mat4 lightSpaces[MAX_SHADOW_CASCADES];
+      };
+
+      // Lighting subpass of the deferred path.
+      struct alignas(16) DeferredLighting
+      {
+         glm::mat4 view;
+         // (reconstructs the position from the depth)
+         glm::mat4 invViewProj;
+         // Shadow map(see ShadowCascades)
+         glm::mat4 lightSpaces[MAX_SHADOW_CASCADES];
+         glm::vec4 cascadeSplits;
+         glm::vec4 cameraPos;
+         int lightsCount;
+         int cascadesCount;
+      };
+   }
+
+   // (std430)
+   namespace StorageBufferObject
+   {
+      // Each light of the scene(shared by all the PBR models).
+      struct alignas(16) LightInfo
+      {
+         glm::vec4 pos;
+         glm::vec4 dir;
+         glm::vec4 color;
+         float attenuation;
+         float radius;
+         float intensity;
+         int type;
+         // First tile of the light in the shadow atlas(-1 if it has no
+         // shadow, see ShadowAtlas).
+         int shadowTile;
+         int padding[3];
+      };
+
+      // Material of each mesh of the PBR models.
+      struct alignas(16) Material
+      {
+         // Index of each texture in the texture table.
+         uint32_t baseColor;
+         uint32_t metallicRoughness;
+         uint32_t emissive;
+         uint32_t AO;
+         uint32_t normal;
+         float metallicFactor;
+         float roughnessFactor;
+         // RECEIVES_SHADOWS and IBL bits of materialFeatures(the textures
+         // that it has are only in its key). The deferred path reads them
+         // from here, since its keys don't have them.
+         uint32_t lightingFeatures;
+      };
+
+      // Max. count of LODs of a draw of the GPU culling.
+      inline const uint32_t CULLING_MAX_LODS = 8;
+
+      // Static data of each draw(one per mesh).
+      struct alignas(16) CullingDraw
+      {
+         // xyz -> center of the AABB, w -> radius of the bounding sphere
+         // (in model space)
+         glm::vec4 center;
+         // xyz -> half size of the AABB
+         glm::vec4 extent;
+         uint32_t modelIndex;
+         uint32_t vertexOffset;
+         uint32_t lodsCount;
+         // Instances of the mesh and their visible lists(see Mesh).
+         uint32_t instancesCount;
+         uint32_t firstVisibleInstance;
+         uint32_t padding[3];
+         // (relative to the indices of the index type of the mesh)
+         uint32_t lodFirstIndex[CULLING_MAX_LODS];
+         uint32_t lodIndicesCount[CULLING_MAX_LODS];
+         float    lodError[CULLING_MAX_LODS];
+      };
+
+      // Updated each frame. It's followed by the model matrix of each model.
+      struct alignas(16) CullingFrame
+      {
+         glm::vec4 cameraPlanes[6];
+         // (6 per cascade of the shadow map)
+         glm::vec4 lightPlanes[6 * UniformBufferObject::MAX_SHADOW_CASCADES];
+         glm::vec4 cameraPos;
+         float pixelsPerUnit;
+         float maxPixelsError;
+         uint32_t drawsCount;
+         uint32_t instancesCount;
+         // Occlusion culling(see HiZ).
+         glm::mat4 viewProj;
+         // (in pixels)
+         glm::vec2 screenSize;
+         uint32_t hiZLevelsCount;
+         uint32_t cascadesCount;
+      };
+
+      struct alignas(16) CullingStats
+      {
+         uint32_t visibleCount;
+         // (counted once per cascade where the instance is visible)
+         uint32_t shadowVisibleCount;
+         // (inside of the frustum of the camera but behind the occluders)
+         uint32_t occludedCount;
+      };
+
+      // Tiles of the shadow atlas. It's followed by the light space of each
+      // tile(the one of its last draw).
+      struct alignas(16) ShadowAtlasTiles
+      {
+         uint32_t tilesPerRow;
+         uint32_t padding[3];
+      };
+
+      // Updated each frame(grid of clusters of the camera).
+      struct alignas(16) ClustersFrame
+      {
+         glm::mat4 view;
+         glm::mat4 invProj;
+         // (in pixels)
+         glm::vec2 screenSize;
+         glm::vec2 tileSize;
+         float zNear;
+         float zFar;
+         // slice = log(z) * sliceScale - sliceBias
+         float sliceScale;
+         float sliceBias;
+         uint32_t clustersX;
+         uint32_t clustersY;
+         uint32_t clustersZ;
+         uint32_t maxLightsPerCluster;
+         uint32_t lightsCount;
+         uint32_t padding[3];
       };
    }
 };
@@ -1,6 +1,7 @@
 #include <CroissantRenderer/Descriptor/Types/Sampler/Sampler.h>
 
 #include <stdexcept>
+#include <optional>
 
 #include <vulkan/vulkan.h>
 
@@ -9,7 +10,8 @@ Sampler::Sampler(
       const VkDevice& logicalDevice,
       const uint32_t mipLevels,
       const VkSamplerAddressMode& addressMode,
-      const VkFilter& filter
+      const VkFilter& filter,
+      const std::optional<VkCompareOp>& compareOp
 ) : m_logicalDevice(logicalDevice)
 {
    VkSamplerCreateInfo samplerInfo{};
@@ -22,7 +24,8 @@ Sampler::Sampler(
    samplerInfo.addressModeU = addressMode;
    samplerInfo.addressModeV = addressMode;
    samplerInfo.addressModeW = addressMode;
-   samplerInfo.anisotropyEnable = VK_TRUE;
+   // (the comparison samplers only filter the result of the compare)
+   samplerInfo.anisotropyEnable = (compareOp.has_value()) ? VK_FALSE : VK_TRUE;
 
    // Limits the amount of texel samples that can be used to calculate the
    // final color.
@@ -39,8 +42,10 @@ Sampler::Sampler(
    // Vk_FALSE: we can use the coords within [0, 1)
    samplerInfo.unnormalizedCoordinates = VK_FALSE;
    // These two options are used in SHADOW MAPS(percentage-closer filtering).
-   samplerInfo.compareEnable = VK_FALSE;
-   samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+   // Each texel is compared with the reference depth before the filtering,
+   // so a linear filter returns the average of the compares of 2x2 texels.
+   samplerInfo.compareEnable = (compareOp.has_value()) ? VK_TRUE : VK_FALSE;
+   samplerInfo.compareOp = compareOp.value_or(VK_COMPARE_OP_ALWAYS);
    // Mipmapping fields:
    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
    samplerInfo.mipLodBias = 0.0f;
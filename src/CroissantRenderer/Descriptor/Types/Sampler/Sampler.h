@@ -1,5 +1,7 @@
 #pragma once
 
+#include <optional>
+
 #include <vulkan/vulkan.h>
 
 class Sampler
@@ -12,7 +14,9 @@ public:
       const VkDevice& logicalDevice,
       const uint32_t mipLevels,
       const VkSamplerAddressMode& addressMode,
-      const VkFilter& filter
+      const VkFilter& filter,
+      // (depth compare done by the hardware when sampling, see ShadowMap)
+      const std::optional<VkCompareOp>& compareOp = std::nullopt
    );
    ~Sampler();
    const VkSampler& get() const;
@@ -11,12 +11,14 @@ UBO::UBO(
       const VkPhysicalDevice physicalDevice,
       const VkDevice logicalDevice,
       const uint32_t nSets,
-      const size_t size
+      const size_t size,
+      const VkBufferUsageFlags usage,
+      const VkMemoryPropertyFlags memoryProperties
 ) : m_logicalDevice(logicalDevice)
 {
 
    m_buffers.resize(nSets);
-   m_memories.resize(nSets);
+   m_allocations.resize(nSets);
 
    for (size_t i = 0; i < nSets; i++)
    {
@@ -24,10 +26,9 @@ UBO::UBO(
             physicalDevice,
             logicalDevice,
             (VkDeviceSize) size,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            m_memories[i],
+            usage,
+            memoryProperties,
+            m_allocations[i],
             m_buffers[i]
       );
    }
@@ -35,14 +36,14 @@ UBO::UBO(
 
 UBO::~UBO() {}
 
-std::vector<VkDeviceMemory>& UBO::getMemories()
+std::vector<Allocation>& UBO::getAllocations()
 {
-   return m_memories;
+   return m_allocations;
 }
 
-VkDeviceMemory& UBO::getMemory(const uint32_t index)
+Allocation& UBO::getAllocation(const uint32_t index)
 {
-   return m_memories[index];
+   return m_allocations[index];
 }
 
 std::vector<VkBuffer>& UBO::get()
@@ -64,10 +65,6 @@ void UBO::destroy()
             m_buffers[i],
             nullptr
       );
-      vkFreeMemory(
-            m_logicalDevice,
-            m_memories[i],
-            nullptr
-      );
+      bufferManager::freeMemory(m_allocations[i]);
    }
 }
@@ -4,6 +4,8 @@
 
 #include <vulkan/vulkan.h>
 
+#include <CroissantRenderer/Memory/Allocation.h>
+
 class UBO
 {
 
@@ -13,11 +15,18 @@ public:
          const VkPhysicalDevice physicalDevice,
          const VkDevice logicalDevice,
          const uint32_t nSets,
-         const size_t size
+         const size_t size,
+         // (it's also used for the storage buffers written by the CPU)
+         const VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+         // (or device local for the ones only written by the GPU)
+         const VkMemoryPropertyFlags memoryProperties = (
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+            VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+         )
    );
    ~UBO();
-   std::vector<VkDeviceMemory>& getMemories();
-   VkDeviceMemory& getMemory(const uint32_t index);
+   std::vector<Allocation>& getAllocations();
+   Allocation& getAllocation(const uint32_t index);
    std::vector<VkBuffer>& get();
    VkBuffer& get(const size_t i);
    void destroy();
@@ -27,6 +36,6 @@ private:
    VkDevice                     m_logicalDevice;
 
    std::vector<VkBuffer>        m_buffers;
-   std::vector<VkDeviceMemory>  m_memories;
+   std::vector<Allocation>      m_allocations;
 
 };
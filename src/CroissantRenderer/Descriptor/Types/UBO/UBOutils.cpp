@@ -11,18 +11,11 @@ void UBOutils::updateUBO(
       void* dataToSend,
       const uint32_t& currentFrame
 ) {
-   void* data;
-   vkMapMemory(
-         logicalDevice,
-         ubo->getMemory(currentFrame),
-         0,
-         size,
-         0,
-         &data
-   );
-      memcpy(data, dataToSend, size);
-   vkUnmapMemory(
-         logicalDevice,
-         ubo->getMemory(currentFrame)
+   // The UBOs are persistently mapped(host visible and coherent), so we
+   // don't need to map/unmap them each frame.
+   memcpy(
+         ubo->getAllocation(currentFrame).mappedData,
+         dataToSend,
+         size
    );
 }
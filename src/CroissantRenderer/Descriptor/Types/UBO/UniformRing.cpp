@@ -0,0 +1,83 @@
+#include <CroissantRenderer/Descriptor/Types/UBO/UniformRing.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Settings/config.h>
+
+UniformRing::UniformRing() {}
+
+UniformRing::UniformRing(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const VkDeviceSize size
+) : m_size(size),
+    m_heads(config::MAX_FRAMES_IN_FLIGHT, 0)
+{
+   VkPhysicalDeviceProperties properties;
+   vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+   m_alignment = properties.limits.minUniformBufferOffsetAlignment;
+
+   m_buffers = std::make_shared<UBO>(
+         physicalDevice,
+         logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         size
+   );
+}
+
+UniformRing::~UniformRing() {}
+
+/*
+ * -It has to be called once the GPU has finished with the frame(the slices
+ * of the last frame are overwritten).
+ */
+void UniformRing::reset(const uint32_t currentFrame)
+{
+   m_heads[currentFrame] = 0;
+}
+
+/*
+ * -Copies the data to the next free slice of the ring of the frame and
+ * returns its offset(the dynamic offset of the descriptor).
+ */
+const uint32_t UniformRing::push(
+      const void* data,
+      const size_t size,
+      const uint32_t currentFrame
+) {
+   // (the alignment is always a power of 2)
+   const VkDeviceSize offset = (
+         (m_heads[currentFrame] + m_alignment - 1) & ~(m_alignment - 1)
+   );
+
+   if (offset + size > m_size)
+      throw std::runtime_error(
+            "The uniform ring is full, increase config::UNIFORM_RING_SIZE!"
+      );
+
+   std::memcpy(
+         static_cast<uint8_t*>(
+            m_buffers->getAllocation(currentFrame).mappedData
+         ) + offset,
+         data,
+         size
+   );
+
+   m_heads[currentFrame] = offset + size;
+
+   return static_cast<uint32_t>(offset);
+}
+
+UBO* UniformRing::get() const
+{
+   return m_buffers.get();
+}
+
+void UniformRing::destroy()
+{
+   m_buffers->destroy();
+}
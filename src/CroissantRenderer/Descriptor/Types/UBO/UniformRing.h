@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Descriptor/Types/UBO/UBO.h>
+
+/*
+ * Linear allocator of the UBOs of the models, with one buffer per frame in
+ * flight(persistently mapped). Each frame the ring of the frame is reset and
+ * every model writes its data in the next free slice, which is bound with a
+ * dynamic offset. So all the models share the same buffers and nothing is
+ * allocated or mapped after the creation.
+ */
+class UniformRing
+{
+
+public:
+
+   UniformRing();
+   UniformRing(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const VkDeviceSize size
+   );
+   ~UniformRing();
+   void reset(const uint32_t currentFrame);
+   const uint32_t push(
+         const void* data,
+         const size_t size,
+         const uint32_t currentFrame
+   );
+   UBO* get() const;
+   void destroy();
+
+private:
+
+   std::shared_ptr<UBO>        m_buffers;
+   VkDeviceSize                m_size;
+   // (minUniformBufferOffsetAlignment)
+   VkDeviceSize                m_alignment;
+   // Next free byte of the ring of each frame.
+   std::vector<VkDeviceSize>   m_heads;
+};
@@ -54,6 +54,53 @@ void descriptorSetLayoutManager::graphics::createDescriptorSetLayout(
       throw std::runtime_error("Failed to create descriptor set layout!");
 }
 
+/*
+ * Descriptor Set layout with just one binding: an array of descriptorsCount
+ * descriptors that can be written while the set is bound and that doesn't
+ * need to be fully written(only the used ones have to be valid).
+ */
+void descriptorSetLayoutManager::bindless::createDescriptorSetLayout(
+      const VkDevice& logicalDevice,
+      const DescriptorInfo& descriptorInfo,
+      const uint32_t descriptorsCount,
+      VkDescriptorSetLayout& descriptorSetLayout
+) {
+   VkDescriptorSetLayoutBinding binding{};
+   createDescriptorBindingLayout(descriptorInfo, {}, binding);
+   binding.descriptorCount = descriptorsCount;
+
+   const VkDescriptorBindingFlagsEXT bindingFlags = (
+         VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+         VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT
+   );
+
+   VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+   bindingFlagsInfo.sType = (
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT
+   );
+   bindingFlagsInfo.bindingCount = 1;
+   bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+   VkDescriptorSetLayoutCreateInfo layoutInfo{};
+   layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+   layoutInfo.pNext = &bindingFlagsInfo;
+   layoutInfo.flags = (
+         VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT
+   );
+   layoutInfo.bindingCount = 1;
+   layoutInfo.pBindings = &binding;
+
+   auto status = vkCreateDescriptorSetLayout(
+         logicalDevice,
+         &layoutInfo,
+         nullptr,
+         &descriptorSetLayout
+   );
+
+   if (status != VK_SUCCESS)
+      throw std::runtime_error("Failed to create descriptor set layout!");
+}
+
 /*
  * Descriptor Set layout for In/Out buffer pair.
  */
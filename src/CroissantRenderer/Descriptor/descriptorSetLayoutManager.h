@@ -19,6 +19,16 @@ namespace descriptorSetLayoutManager
 
    };
 
+   namespace bindless
+   {
+      void createDescriptorSetLayout(
+            const VkDevice& logicalDevice,
+            const DescriptorInfo& descriptorInfo,
+            const uint32_t descriptorsCount,
+            VkDescriptorSetLayout& descriptorSetLayout
+      );
+   };
+
    namespace compute
    {
       void createDescriptorSetLayout(
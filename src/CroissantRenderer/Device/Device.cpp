@@ -56,10 +56,38 @@ void Device::createLogicalDevice(
    deviceFeatures.samplerAnisotropy = VK_TRUE;
    deviceFeatures.sampleRateShading = VK_TRUE;
 
+   // (optional, used by the GPU culling)
+   VkPhysicalDeviceFeatures supportedFeatures;
+   vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+
+   m_isMultiDrawIndirectSupported = supportedFeatures.multiDrawIndirect;
+   deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+   // (the indirect commands of the instances don't start from the first one)
+   m_isDrawIndirectFirstInstanceSupported = (
+         supportedFeatures.drawIndirectFirstInstance
+   );
+   deviceFeatures.drawIndirectFirstInstance = (
+         supportedFeatures.drawIndirectFirstInstance
+   );
+
+   // (bindless textures, see isDescriptorIndexingSupported())
+   VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+   indexingFeatures.sType = (
+         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT
+   );
+   indexingFeatures.shaderSampledImageArrayNonUniformIndexing = (
+         VK_TRUE
+   );
+   indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = (
+         VK_TRUE
+   );
+   indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+   indexingFeatures.runtimeDescriptorArray = VK_TRUE;
 
    // Now we can create the logical device.
    VkDeviceCreateInfo createInfo{};
    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+   createInfo.pNext = &indexingFeatures;
    createInfo.queueCreateInfoCount = static_cast<uint32_t>(
          queueCreateInfos.size()
    );
@@ -177,10 +205,17 @@ bool Device::isPhysicalDeviceSuitable(
    if (deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
       return false;
 
+   // (needed to query the features of the extensions)
+   if (deviceProperties.apiVersion < VK_API_VERSION_1_1)
+      return false;
+
    // - Device Extensions
    if (areAllExtensionsSupported(possiblePhysicalDevice) == false)
       return false;
 
+   if (isDescriptorIndexingSupported(possiblePhysicalDevice) == false)
+      return false;
+
    // - Swapchain support
    if (isSwapchainAdequated(possiblePhysicalDevice, windowSurface) == false)
       return false;
@@ -230,6 +265,36 @@ bool Device::areAllExtensionsSupported(
    return true;
 }
 
+/*
+ * -Verifies the features of the descriptor indexing used by the bindless
+ * textures:
+ *    - An array of textures of unknown size(runtime array), indexed with a
+ *      different index per draw/instance(non-uniform).
+ *    - Its descriptors can be written while it's bound(update after bind)
+ *      and not all of them have to be valid(partially bound).
+ */
+bool Device::isDescriptorIndexingSupported(
+      const VkPhysicalDevice& possiblePhysicalDevice
+) {
+   VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+   indexingFeatures.sType = (
+         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT
+   );
+
+   VkPhysicalDeviceFeatures2 features{};
+   features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+   features.pNext = &indexingFeatures;
+
+   vkGetPhysicalDeviceFeatures2(possiblePhysicalDevice, &features);
+
+   return (
+         indexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+         indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+         indexingFeatures.descriptorBindingPartiallyBound &&
+         indexingFeatures.runtimeDescriptorArray
+   );
+}
+
 const VkDevice& Device::getLogicalDevice() const
 {
    return m_logicalDevice;
@@ -326,3 +391,13 @@ const uint32_t& Device::getApiVersion() const
 {
    return m_apiVersion;
 }
+
+const bool Device::isMultiDrawIndirectSupported() const
+{
+   return m_isMultiDrawIndirectSupported;
+}
+
+const bool Device::isDrawIndirectFirstInstanceSupported() const
+{
+   return m_isDrawIndirectFirstInstanceSupported;
+}
@@ -23,6 +23,8 @@ public:
    const VkPhysicalDevice& getPhysicalDevice() const;
    const std::string& getDeviceName() const;
    const uint32_t& getApiVersion() const;
+   const bool isMultiDrawIndirectSupported() const;
+   const bool isDrawIndirectFirstInstanceSupported() const;
    const SwapchainSupportedProperties& getSupportedProperties() const;
 
 private:
@@ -52,15 +54,22 @@ private:
    bool areAllExtensionsSupported(
          const VkPhysicalDevice& possiblePhysicalDevice
    );
+   bool isDescriptorIndexingSupported(
+         const VkPhysicalDevice& possiblePhysicalDevice
+   );
 
 
    VkPhysicalDevice               m_physicalDevice;
    VkDevice                       m_logicalDevice;
    std::string                    m_deviceName;
    uint32_t                       m_apiVersion;
+   bool                           m_isMultiDrawIndirectSupported;
+   bool                           m_isDrawIndirectFirstInstanceSupported;
    SwapchainSupportedProperties   m_supportedProperties;
    const std::vector<const char*> m_requiredExtensions = {
-         VK_KHR_SWAPCHAIN_EXTENSION_NAME
+         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+         // (bindless textures)
+         VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
    };
 
 };
@@ -12,7 +12,8 @@ DepthBuffer::DepthBuffer(
       const VkPhysicalDevice& physicalDevice,
       const VkDevice& logicalDevice,
       const VkExtent2D& swapchainExtent,
-      const VkSampleCountFlagBits& samplesCount
+      const VkSampleCountFlagBits& samplesCount,
+      const VkImageUsageFlags additionalUsage
 ) {
    m_format = featuresUtils::findSupportedFormat(
          physicalDevice,
@@ -32,7 +33,7 @@ DepthBuffer::DepthBuffer(
          swapchainExtent.height,
          m_format,
          VK_IMAGE_TILING_OPTIMAL,
-         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | additionalUsage,
          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
          false,
          1,
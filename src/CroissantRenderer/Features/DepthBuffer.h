@@ -15,7 +15,9 @@ public:
       const VkPhysicalDevice& physicalDevice,
       const VkDevice& logicalDevice,
       const VkExtent2D& swapchainExtent,
-      const VkSampleCountFlagBits& samplesCount
+      const VkSampleCountFlagBits& samplesCount,
+      // (e.g. read as input attachment by the deferred lighting)
+      const VkImageUsageFlags additionalUsage = 0
    );
    ~DepthBuffer();
    const VkImageView& getImageView() const;
@@ -0,0 +1,78 @@
+#include <CroissantRenderer/Features/GBuffer.h>
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Image/Image.h>
+
+GBuffer::GBuffer() {}
+
+GBuffer::GBuffer(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const VkExtent2D& swapchainExtent,
+      const VkSampleCountFlagBits& samplesCount
+) : m_logicalDevice(logicalDevice)
+{
+   for (auto& format : getFormats())
+   {
+      m_images.push_back(
+            Image(
+               physicalDevice,
+               m_logicalDevice,
+               swapchainExtent.width,
+               swapchainExtent.height,
+               format,
+               VK_IMAGE_TILING_OPTIMAL,
+               (
+                  VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT |
+                  VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                  VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT
+               ),
+               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+               false,
+               1,
+               samplesCount,
+               VK_IMAGE_ASPECT_COLOR_BIT,
+               VK_COMPONENT_SWIZZLE_IDENTITY,
+               VK_COMPONENT_SWIZZLE_IDENTITY,
+               VK_COMPONENT_SWIZZLE_IDENTITY,
+               VK_COMPONENT_SWIZZLE_IDENTITY
+            )
+      );
+   }
+}
+
+GBuffer::~GBuffer() {}
+
+/*
+ * -Compact layout(12 bytes per sample): the normal is encoded in 2 channels
+ * with 10 bits each.
+ */
+const std::vector<VkFormat>& GBuffer::getFormats()
+{
+   static const std::vector<VkFormat> formats = {
+      VK_FORMAT_R8G8B8A8_UNORM,
+      VK_FORMAT_A2B10G10R10_UNORM_PACK32,
+      VK_FORMAT_R8G8B8A8_UNORM
+   };
+
+   return formats;
+}
+
+const std::vector<VkImageView> GBuffer::getImageViews() const
+{
+   std::vector<VkImageView> imageViews;
+
+   for (auto& image : m_images)
+      imageViews.push_back(image.getImageView());
+
+   return imageViews;
+}
+
+void GBuffer::destroy()
+{
+   for (auto& image : m_images)
+      image.destroy();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Image/Image.h>
+
+/*
+ * G-buffer of the deferred path. It's written by the first subpass and read
+ * by the lighting subpass as input attachments, so it never leaves the
+ * render pass(transient):
+ *    0 -> albedo, metallic
+ *    1 -> normal(octahedral), roughness
+ *    2 -> emissive color, AO
+ */
+class GBuffer
+{
+
+public:
+
+   GBuffer();
+   GBuffer(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const VkExtent2D& swapchainExtent,
+         const VkSampleCountFlagBits& samplesCount
+   );
+   ~GBuffer();
+
+   static const std::vector<VkFormat>& getFormats();
+   const std::vector<VkImageView> getImageViews() const;
+
+   void destroy();
+
+private:
+
+   VkDevice           m_logicalDevice;
+
+   std::vector<Image> m_images;
+
+};
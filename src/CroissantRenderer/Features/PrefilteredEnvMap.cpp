@@ -21,6 +21,7 @@ PrefilteredEnvMap<T>::PrefilteredEnvMap(
       const std::shared_ptr<CommandPool>& commandPool,
       const uint32_t dim,
       const std::vector<Mesh<T>>& meshes,
+      const GeometryBuffer<T>& geometryBuffer,
       const std::shared_ptr<Texture>& envMap
 )  : m_logicalDevice(logicalDevice), 
      m_dim(dim),
@@ -35,7 +36,7 @@ PrefilteredEnvMap<T>::PrefilteredEnvMap(
    createPipeline();
    createDescriptorPool();
    createDescriptorSet(envMap);
-   recordCommandBuffer(commandPool, graphicsQueue, meshes);
+   recordCommandBuffer(commandPool, graphicsQueue, meshes, geometryBuffer);
 
 }
 
@@ -74,7 +75,8 @@ template<typename T>
 void PrefilteredEnvMap<T>::recordCommandBuffer(
    const std::shared_ptr<CommandPool>& commandPool,
    const VkQueue& graphicsQueue,
-   const std::vector<Mesh<T>>& meshes
+   const std::vector<Mesh<T>>& meshes,
+   const GeometryBuffer<T>& geometryBuffer
 ) {
 
    VkClearValue clearValues;
@@ -250,37 +252,21 @@ void PrefilteredEnvMap<T>::recordCommandBuffer(
                      commandBuffer
                );
 
+               geometryBuffer.bind(commandBuffer);
+
+               VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+
                for (auto& mesh : meshes)
                {
-                  commandManager::state::bindVertexBuffers(
-                        {mesh.vertexBuffer},
-                        // Offsets.
-                        {0},
-                        // Index of first binding.
-                        0,
-                        // Bindings count.
-                        1,
-                        commandBuffer
-                  );
-                  commandManager::state::bindIndexBuffer(
-                        mesh.indexBuffer,
-                        // Offset.
+                  geometryBuffer.drawIndexed(
+                        mesh,
+                        // LOD
                         0,
-                        VK_INDEX_TYPE_UINT32,
-                        commandBuffer
-                  );
-
-                  commandManager::action::drawIndexed(
-                        // Index Count
-                        mesh.indices.size(),
                         // Instance Count
                         1,
-                        // First index.
-                        0,
-                        // Vertex Offset.
-                        0,
-                        // First Intance.
+                        // First Instance
                         0,
+                        boundIndexType,
                         commandBuffer
                   );
                }
@@ -13,6 +13,7 @@
 #include <CroissantRenderer/Descriptor/DescriptorSets.h>
 #include <CroissantRenderer/Pipeline/Graphics.h>
 #include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
 
 struct PushBlockPrefilterEnv
 {
@@ -34,6 +35,7 @@ public:
       const std::shared_ptr<CommandPool>& commandPool,
       const uint32_t dim,
       const std::vector<Mesh<T>>& meshes,
+      const GeometryBuffer<T>& geometryBuffer,
       const std::shared_ptr<Texture>& envMap
    );
    ~PrefilteredEnvMap();
@@ -61,7 +63,8 @@ private:
    void recordCommandBuffer(
          const std::shared_ptr<CommandPool>& commandPool,
          const VkQueue& graphicsQueue,
-         const std::vector<Mesh<T>>& meshes
+         const std::vector<Mesh<T>>& meshes,
+         const GeometryBuffer<T>& geometryBuffer
    );
 
    VkDevice                         m_logicalDevice;
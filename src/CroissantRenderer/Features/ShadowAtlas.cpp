@@ -0,0 +1,688 @@
+#include <CroissantRenderer/Features/ShadowAtlas.h>
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Settings/config.h>
+#include <CroissantRenderer/Settings/graphicsPipelineConfig.h>
+#include <CroissantRenderer/Command/commandManager.h>
+#include <CroissantRenderer/Framebuffer/framebufferManager.h>
+#include <CroissantRenderer/Features/featuresUtils.h>
+#include <CroissantRenderer/RenderPass/attachmentUtils.h>
+#include <CroissantRenderer/RenderPass/subPassUtils.h>
+#include <CroissantRenderer/Math/mathUtils.h>
+
+// Field of view of the tile of a spot light: the cone of the spot lights of
+// pbrLighting.glsl(cos = 0.953) with a margin for the filter.
+static const float SPOT_LIGHT_FOV = 2.0f * std::acos(0.953f) + 0.1f;
+
+// Faces of the cube of a point light(the same order as pbrLighting.glsl).
+static const std::array<glm::vec3, 6> CUBE_FACES_DIR = {
+   glm::vec3( 1.0f,  0.0f,  0.0f),
+   glm::vec3(-1.0f,  0.0f,  0.0f),
+   glm::vec3( 0.0f,  1.0f,  0.0f),
+   glm::vec3( 0.0f, -1.0f,  0.0f),
+   glm::vec3( 0.0f,  0.0f,  1.0f),
+   glm::vec3( 0.0f,  0.0f, -1.0f)
+};
+static const std::array<glm::vec3, 6> CUBE_FACES_UP = {
+   glm::vec3(0.0f, 1.0f,  0.0f),
+   glm::vec3(0.0f, 1.0f,  0.0f),
+   glm::vec3(0.0f, 0.0f, -1.0f),
+   glm::vec3(0.0f, 0.0f,  1.0f),
+   glm::vec3(0.0f, 1.0f,  0.0f),
+   glm::vec3(0.0f, 1.0f,  0.0f)
+};
+
+////////////////////////////////Helper functions///////////////////////////////
+
+/*
+ * -Perspective projection of the tile from the light(up to its radius), with
+ * the y flipped for Vulkan as in mathUtils::getUpdatedProjMatrix().
+ */
+static glm::mat4 getLightSpace(
+      const DescriptorTypes::StorageBufferObject::LightInfo& light,
+      const uint32_t face
+) {
+   const glm::vec3 pos = glm::vec3(light.pos);
+   const float zFar = std::max(
+         light.radius,
+         2.0f * config::SHADOW_ATLAS_Z_NEAR
+   );
+
+   glm::vec3 dir, up;
+   float fov;
+
+   if (light.type == 1)
+   {
+      dir = CUBE_FACES_DIR[face];
+      up = CUBE_FACES_UP[face];
+      fov = glm::radians(90.0f);
+
+   } else
+   {
+      dir = glm::normalize(glm::vec3(light.dir));
+      up = (
+            (std::abs(dir.y) > 0.99f) ?
+               glm::vec3(0.0f, 0.0f, 1.0f) :
+               glm::vec3(0.0f, 1.0f, 0.0f)
+      );
+      fov = SPOT_LIGHT_FOV;
+   }
+
+   glm::mat4 proj = glm::perspectiveRH_ZO(
+         fov,
+         1.0f,
+         config::SHADOW_ATLAS_Z_NEAR,
+         zFar
+   );
+   proj[1][1] *= -1;
+
+   return proj * glm::lookAt(pos, pos + dir, up);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+ShadowAtlas::ShadowAtlas(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice,
+      const uint32_t& graphicsFamilyIndex,
+      const VkFormat& depthBufferFormat,
+      // From the scene
+      const std::vector<size_t>& objectModelIndices
+) : m_logicalDevice(logicalDevice),
+    m_format(depthBufferFormat),
+    m_extent(
+      {config::SHADOW_ATLAS_RESOLUTION, config::SHADOW_ATLAS_RESOLUTION}
+    ),
+    m_tilesPerRow(
+      config::SHADOW_ATLAS_RESOLUTION / config::SHADOW_ATLAS_TILE_SIZE
+    ),
+    m_maxTilesCount(m_tilesPerRow * m_tilesPerRow),
+    m_isCleared(false),
+    m_tilesInfo()
+{
+   m_image = Image(
+         physicalDevice,
+         logicalDevice,
+         m_extent.width,
+         m_extent.height,
+         depthBufferFormat,
+         VK_IMAGE_TILING_OPTIMAL,
+         (
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_SAMPLED_BIT
+         ),
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+         false,
+         1,
+         VK_SAMPLE_COUNT_1_BIT,
+         VK_IMAGE_ASPECT_DEPTH_BIT,
+         VK_COMPONENT_SWIZZLE_R,
+         VK_COMPONENT_SWIZZLE_G,
+         VK_COMPONENT_SWIZZLE_B,
+         VK_COMPONENT_SWIZZLE_A,
+         VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+         featuresUtils::getShadowFilter(physicalDevice, depthBufferFormat),
+         1,
+         // (hardware PCF, see pbrLighting.glsl)
+         VK_COMPARE_OP_LESS_OR_EQUAL
+   );
+
+   createRenderPass(depthBufferFormat);
+
+   std::vector<VkImageView> attachments = {m_image.getImageView()};
+
+   framebufferManager::createFramebuffer(
+         m_logicalDevice,
+         m_renderPass.get(),
+         attachments,
+         m_extent.width,
+         m_extent.height,
+         1,
+         m_framebuffer
+   );
+
+   // (the same rasterization and depth bias as the shadow map)
+   m_graphicsPipeline = Graphics(
+         m_logicalDevice,
+         GraphicsPipelineType::SHADOWMAP,
+         m_extent,
+         m_renderPass,
+         {
+            {
+               shaderType::VERTEX,
+               "shadowAtlas"
+            }
+         },
+         VK_SAMPLE_COUNT_1_BIT,
+         Attributes::PBR::getBindingDescription(),
+         Attributes::PBR::getAttributeDescriptions(),
+         objectModelIndices,
+         GRAPHICS_PIPELINE::SHADOW_ATLAS::UBOS_INFO,
+         {},
+         // (model drawn and its tile)
+         {
+            {
+               VK_SHADER_STAGE_VERTEX_BIT,
+               0,
+               sizeof(PushBlockShadowAtlas)
+            }
+         }
+   );
+
+   m_commandPool = std::make_shared<CommandPool>(
+         m_logicalDevice,
+         VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+         graphicsFamilyIndex
+   );
+   m_commandPool->allocCommandBuffers(config::MAX_FRAMES_IN_FLIGHT);
+
+   // Tiles
+   m_tilesInfo.tilesPerRow = m_tilesPerRow;
+   m_drawnLightSpaces.resize(m_maxTilesCount, glm::mat4(1.0f));
+   m_isTilesBufferOutdated.assign(config::MAX_FRAMES_IN_FLIGHT, true);
+
+   m_tilesBuffer = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(m_tilesInfo) + sizeof(glm::mat4) * m_maxTilesCount,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+   );
+
+   createDescriptorPool();
+   // (the descriptor sets are created by the scene, with the buffer of the
+   // instances)
+}
+
+ShadowAtlas::~ShadowAtlas() {}
+
+/*
+ * -The atlas keeps its content between frames: each render pass loads it and
+ * only clears the tiles that are drawn(see beginTile()).
+ */
+void ShadowAtlas::createRenderPass(const VkFormat& depthBufferFormat)
+{
+   VkAttachmentDescription depthAttachment{};
+   attachmentUtils::createAttachmentDescriptionWithStencil(
+         depthBufferFormat,
+         VK_SAMPLE_COUNT_1_BIT,
+         VK_ATTACHMENT_LOAD_OP_LOAD,
+         VK_ATTACHMENT_STORE_OP_STORE,
+         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+         VK_ATTACHMENT_STORE_OP_DONT_CARE,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+         depthAttachment
+   );
+
+   VkAttachmentReference depthAttachmentRef{};
+   attachmentUtils::createAttachmentReference(
+         0,
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+         depthAttachmentRef
+   );
+
+   VkSubpassDescription subpass{};
+   subPassUtils::createSubPassDescription(
+         VK_PIPELINE_BIND_POINT_GRAPHICS,
+         nullptr,
+         &depthAttachmentRef,
+         nullptr,
+         subpass,
+         0
+   );
+
+   // (the PBR shading of the last frame reads it)
+   std::vector<VkSubpassDependency> dependencies(2);
+   subPassUtils::createSubPassDependency(
+         VK_SUBPASS_EXTERNAL,
+         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+         0,
+         0,
+         (
+            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+         ),
+         (
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+         ),
+         (VkDependencyFlagBits)0,
+         dependencies[0]
+   );
+   subPassUtils::createSubPassDependency(
+         0,
+         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         VK_SUBPASS_EXTERNAL,
+         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+         VK_ACCESS_SHADER_READ_BIT,
+         (VkDependencyFlagBits)0,
+         dependencies[1]
+   );
+
+   m_renderPass = RenderPass(
+         m_logicalDevice,
+         {depthAttachment},
+         {subpass},
+         dependencies
+   );
+}
+
+void ShadowAtlas::createDescriptorPool()
+{
+   // (one set per frame in flight)
+   const uint32_t setsCount = config::MAX_FRAMES_IN_FLIGHT;
+   const uint32_t buffersCount = (
+         GRAPHICS_PIPELINE::SHADOW_ATLAS::STORAGE_BUFFERS_COUNT
+   );
+
+   m_descriptorPool = DescriptorPool(
+         m_logicalDevice,
+         {
+            {
+               VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+               setsCount * buffersCount
+            }
+         },
+         setsCount
+   );
+}
+
+void ShadowAtlas::createDescriptorSets(UBO* instances)
+{
+   std::vector<UBO*> opUBOs = {m_tilesBuffer.get(), instances};
+
+   m_descriptorSets = DescriptorSets(
+         m_logicalDevice,
+         GRAPHICS_PIPELINE::SHADOW_ATLAS::UBOS_INFO,
+         {},
+         {},
+         m_graphicsPipeline.getDescriptorSetLayout(),
+         m_descriptorPool,
+         nullptr,
+         opUBOs
+   );
+}
+
+/*
+ * -Reserves the tiles of the light(lightIndex in the lights buffer of the
+ * scene) and returns the first one, or -1 if they don't fit(the light
+ * won't have shadows).
+ */
+const int ShadowAtlas::addLight(
+      const uint32_t lightIndex,
+      const bool isPointLight
+) {
+   const uint32_t facesCount = (isPointLight) ? 6 : 1;
+
+   if (m_tiles.size() + facesCount > m_maxTilesCount)
+      return -1;
+
+   const int firstTile = static_cast<int>(m_tiles.size());
+
+   for (uint32_t face = 0; face < facesCount; face++)
+   {
+      Tile tile{};
+      tile.lightIndex = lightIndex;
+      tile.face = face;
+      // (drawn as soon as possible)
+      tile.isOutdated = true;
+
+      m_tiles.push_back(tile);
+   }
+
+   return firstTile;
+}
+
+/*
+ * -Marks the tiles whose light space or casters changed as outdated and picks
+ * the ones drawn this frame(getTilesToDraw()):
+ *    - Priority: importance of the light(its radius over its distance to
+ *      the camera) * frames waiting, so no tile waits forever.
+ *    - Budget: SHADOW_ATLAS_TILES_PER_FRAME tiles and
+ *      SHADOW_ATLAS_TRIANGLES_BUDGET triangles(each tile draws all the
+ *      casters), at least one tile.
+ * -The picked tiles are considered drawn, so they have to be recorded this
+ * frame. It has to be called after the update of the lights buffer.
+ */
+void ShadowAtlas::update(
+      const std::vector<
+         DescriptorTypes::StorageBufferObject::LightInfo
+      >& lights,
+      const glm::vec3& cameraPos,
+      const std::vector<glm::mat4>& castersModelMs,
+      const uint64_t castersTrianglesCount,
+      const uint32_t currentFrame
+) {
+   const bool haveCastersChanged = (castersModelMs != m_castersModelMs);
+
+   if (haveCastersChanged)
+      m_castersModelMs = castersModelMs;
+
+   m_candidates.clear();
+
+   for (uint32_t i = 0; i < m_tiles.size(); i++)
+   {
+      auto& tile = m_tiles[i];
+      const auto& light = lights[tile.lightIndex];
+
+      const glm::mat4 lightSpace = getLightSpace(light, tile.face);
+
+      if (haveCastersChanged || lightSpace != tile.lightSpace)
+      {
+         tile.lightSpace = lightSpace;
+         tile.isOutdated = true;
+      }
+
+      if (tile.isOutdated == false)
+         continue;
+
+      tile.staleFrames++;
+
+      const float distance = glm::length(glm::vec3(light.pos) - cameraPos);
+      const float importance = light.radius / std::max(distance, 1.0f);
+
+      m_candidates.push_back({importance * tile.staleFrames, i});
+   }
+
+   // - Budget
+   uint64_t maxTilesCount = config::SHADOW_ATLAS_TILES_PER_FRAME;
+
+   if (castersTrianglesCount > 0)
+   {
+      maxTilesCount = std::min(
+            maxTilesCount,
+            std::max(
+               config::SHADOW_ATLAS_TRIANGLES_BUDGET / castersTrianglesCount,
+               (uint64_t)1
+            )
+      );
+   }
+
+   const size_t tilesCount = std::min(
+         m_candidates.size(),
+         static_cast<size_t>(maxTilesCount)
+   );
+
+   std::partial_sort(
+         m_candidates.begin(),
+         m_candidates.begin() + tilesCount,
+         m_candidates.end(),
+         [](const auto& a, const auto& b) { return a.first > b.first; }
+   );
+
+   m_tilesToDraw.clear();
+
+   for (size_t i = 0; i < tilesCount; i++)
+   {
+      const uint32_t tileIndex = m_candidates[i].second;
+      auto& tile = m_tiles[tileIndex];
+
+      tile.isOutdated = false;
+      tile.staleFrames = 0;
+      m_drawnLightSpaces[tileIndex] = tile.lightSpace;
+
+      m_tilesToDraw.push_back(tileIndex);
+   }
+
+   if (m_tilesToDraw.empty() == false)
+   {
+      std::fill(
+            m_isTilesBufferOutdated.begin(),
+            m_isTilesBufferOutdated.end(),
+            true
+      );
+   }
+
+   if (m_isTilesBufferOutdated[currentFrame] == false)
+      return;
+
+   auto* data = static_cast<uint8_t*>(
+         m_tilesBuffer->getAllocation(currentFrame).mappedData
+   );
+
+   std::memcpy(data, &m_tilesInfo, sizeof(m_tilesInfo));
+   std::memcpy(
+         data + sizeof(m_tilesInfo),
+         m_drawnLightSpaces.data(),
+         sizeof(glm::mat4) * m_drawnLightSpaces.size()
+   );
+
+   m_isTilesBufferOutdated[currentFrame] = false;
+}
+
+/*
+ * -Before the first draw the atlas has no content, so it's moved to the
+ * layout of the render pass(its tiles are cleared once it begins).
+ */
+void ShadowAtlas::recordInitialLayout(
+      const VkCommandBuffer& commandBuffer
+) const {
+   VkImageMemoryBarrier barrier{};
+   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+   barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+   barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+   barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   barrier.image = m_image.get();
+   barrier.subresourceRange.aspectMask = (
+         (m_format == VK_FORMAT_D32_SFLOAT) ?
+            VK_IMAGE_ASPECT_DEPTH_BIT :
+            VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT
+   );
+   barrier.subresourceRange.baseMipLevel = 0;
+   barrier.subresourceRange.levelCount = 1;
+   barrier.subresourceRange.baseArrayLayer = 0;
+   barrier.subresourceRange.layerCount = 1;
+   barrier.srcAccessMask = 0;
+   barrier.dstAccessMask = (
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+   );
+
+   commandManager::synchronization::recordPipelineBarrier(
+         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+         0,
+         commandBuffer,
+         {},
+         {},
+         {barrier}
+   );
+}
+
+void ShadowAtlas::beginRenderPass(const VkCommandBuffer& commandBuffer)
+{
+   if (m_isCleared == false)
+      recordInitialLayout(commandBuffer);
+
+   m_renderPass.begin(
+         m_framebuffer,
+         m_extent,
+         {},
+         commandBuffer,
+         VK_SUBPASS_CONTENTS_INLINE
+   );
+
+   commandManager::state::bindPipeline(
+         m_graphicsPipeline.get(),
+         PipelineType::GRAPHICS,
+         commandBuffer
+   );
+
+   // (without shadows until their tiles are drawn)
+   if (m_isCleared == false)
+   {
+      VkClearAttachment clearAttachment{};
+      clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+      clearAttachment.clearValue.depthStencil = {1.0f, 0};
+
+      VkClearRect clearRect{};
+      clearRect.rect = {{0, 0}, m_extent};
+      clearRect.baseArrayLayer = 0;
+      clearRect.layerCount = 1;
+
+      vkCmdClearAttachments(commandBuffer, 1, &clearAttachment, 1, &clearRect);
+
+      m_isCleared = true;
+   }
+}
+
+/*
+ * -Restricts the next draws to the tile and clears it.
+ */
+void ShadowAtlas::beginTile(
+      const uint32_t tile,
+      const VkCommandBuffer& commandBuffer
+) {
+   const VkOffset2D offset = {
+      static_cast<int32_t>(
+         (tile % m_tilesPerRow) * config::SHADOW_ATLAS_TILE_SIZE
+      ),
+      static_cast<int32_t>(
+         (tile / m_tilesPerRow) * config::SHADOW_ATLAS_TILE_SIZE
+      )
+   };
+   const VkExtent2D extent = {
+      config::SHADOW_ATLAS_TILE_SIZE,
+      config::SHADOW_ATLAS_TILE_SIZE
+   };
+
+   commandManager::state::setViewport(
+         static_cast<float>(offset.x),
+         static_cast<float>(offset.y),
+         extent,
+         0.0f,
+         1.0f,
+         0,
+         1,
+         commandBuffer
+   );
+   commandManager::state::setScissor(
+         offset,
+         extent,
+         0,
+         1,
+         commandBuffer
+   );
+
+   VkClearAttachment clearAttachment{};
+   clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+   clearAttachment.clearValue.depthStencil = {1.0f, 0};
+
+   VkClearRect clearRect{};
+   clearRect.rect = {offset, extent};
+   clearRect.baseArrayLayer = 0;
+   clearRect.layerCount = 1;
+
+   vkCmdClearAttachments(commandBuffer, 1, &clearAttachment, 1, &clearRect);
+}
+
+/*
+ * -The geometry buffer of the meshes has to be bound before this.
+ * -Each mesh draws all its instances(LOD 0), the tiles aren't culled.
+ */
+void ShadowAtlas::bindData(
+      const GeometryBuffer<Attributes::PBR::Vertex>& geometryBuffer,
+      const std::vector<Mesh<Attributes::PBR::Vertex>>& meshes,
+      const glm::mat4& modelM,
+      const uint32_t tile,
+      const VkCommandBuffer& commandBuffer,
+      const uint32_t currentFrame
+) {
+   commandManager::state::bindDescriptorSets(
+         m_graphicsPipeline.getPipelineLayout(),
+         PipelineType::GRAPHICS,
+         // Index of first descriptor set.
+         0,
+         {m_descriptorSets.get(currentFrame)},
+         // Dynamic offsets.
+         {},
+         commandBuffer
+   );
+
+   PushBlockShadowAtlas pushBlock;
+   pushBlock.model = modelM;
+   pushBlock.tile = tile;
+
+   commandManager::state::pushConstants(
+         m_graphicsPipeline.getPipelineLayout(),
+         VK_SHADER_STAGE_VERTEX_BIT,
+         0,
+         sizeof(pushBlock),
+         &pushBlock,
+         commandBuffer
+   );
+
+   VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+
+   for (const auto& mesh : meshes)
+   {
+      geometryBuffer.drawIndexed(
+            mesh,
+            // LOD
+            0,
+            mesh.instancesCount,
+            // (the shader reads the instances directly)
+            mesh.firstInstance,
+            boundIndexType,
+            commandBuffer
+      );
+   }
+}
+
+void ShadowAtlas::endRenderPass(const VkCommandBuffer& commandBuffer) const
+{
+   m_renderPass.end(commandBuffer);
+}
+
+const std::vector<uint32_t>& ShadowAtlas::getTilesToDraw() const
+{
+   return m_tilesToDraw;
+}
+
+const VkImageView& ShadowAtlas::getImageView() const
+{
+   return m_image.getImageView();
+}
+
+const VkSampler& ShadowAtlas::getSampler() const
+{
+   return m_image.getSampler();
+}
+
+UBO* ShadowAtlas::getTiles() const
+{
+   return m_tilesBuffer.get();
+}
+
+const VkCommandBuffer& ShadowAtlas::getCommandBuffer(
+      const uint32_t index
+) const {
+   return m_commandPool->getCommandBuffer(index);
+}
+
+const std::shared_ptr<CommandPool>& ShadowAtlas::getCommandPool() const
+{
+   return m_commandPool;
+}
+
+void ShadowAtlas::destroy()
+{
+   m_graphicsPipeline.destroy();
+   m_descriptorPool.destroy();
+   m_image.destroy();
+   m_tilesBuffer->destroy();
+   m_commandPool->destroy();
+   m_renderPass.destroy();
+
+   vkDestroyFramebuffer(m_logicalDevice, m_framebuffer, nullptr);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Pipeline/Graphics.h>
+#include <CroissantRenderer/Descriptor/DescriptorPool.h>
+#include <CroissantRenderer/Descriptor/DescriptorSets.h>
+#include <CroissantRenderer/Descriptor/Types/UBO/UBO.h>
+#include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
+#include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/RenderPass/RenderPass.h>
+#include <CroissantRenderer/Image/Image.h>
+#include <CroissantRenderer/Model/Mesh.h>
+#include <CroissantRenderer/Model/Attributes.h>
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
+
+struct PushBlockShadowAtlas
+{
+   // (model matrix of the model drawn)
+   glm::mat4 model;
+   uint32_t tile;
+};
+
+/*
+ * Shadow atlas of the point and spot lights. A depth image of
+ * SHADOW_ATLAS_RESOLUTION texels is splitted in tiles of
+ * SHADOW_ATLAS_TILE_SIZE and each light gets its tiles once(see addLight()):
+ * one for the frustum of a spot light and one for each face of the cube of a
+ * point light.
+ * The tiles are kept between frames and only the outdated ones(their light
+ * or a caster moved) are drawn again. Each frame, the scheduler picks the
+ * most important(big lights close to the camera) and stale ones, up to the
+ * budget of the frame, so the cost doesn't grow with the count of lights.
+ * The shaders read the light space of the last draw of each tile, so a tile
+ * that waits for its turn is still coherent with its depth.
+ */
+class ShadowAtlas
+{
+
+public:
+
+   ShadowAtlas(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice,
+         const uint32_t& graphicsFamilyIndex,
+         const VkFormat& depthBufferFormat,
+         // From the scene
+         const std::vector<size_t>& objectModelIndices
+   );
+   ~ShadowAtlas();
+   const int addLight(const uint32_t lightIndex, const bool isPointLight);
+   void createDescriptorSets(UBO* instances);
+   void update(
+         const std::vector<
+            DescriptorTypes::StorageBufferObject::LightInfo
+         >& lights,
+         const glm::vec3& cameraPos,
+         const std::vector<glm::mat4>& castersModelMs,
+         const uint64_t castersTrianglesCount,
+         const uint32_t currentFrame
+   );
+   void beginRenderPass(const VkCommandBuffer& commandBuffer);
+   void beginTile(const uint32_t tile, const VkCommandBuffer& commandBuffer);
+   void bindData(
+         const GeometryBuffer<Attributes::PBR::Vertex>& geometryBuffer,
+         const std::vector<Mesh<Attributes::PBR::Vertex>>& meshes,
+         const glm::mat4& modelM,
+         const uint32_t tile,
+         const VkCommandBuffer& commandBuffer,
+         const uint32_t currentFrame
+   );
+   void endRenderPass(const VkCommandBuffer& commandBuffer) const;
+   const std::vector<uint32_t>& getTilesToDraw() const;
+   const VkImageView& getImageView() const;
+   const VkSampler& getSampler() const;
+   UBO* getTiles() const;
+   const VkCommandBuffer& getCommandBuffer(const uint32_t index) const;
+   const std::shared_ptr<CommandPool>& getCommandPool() const;
+   void destroy();
+
+private:
+
+   struct Tile
+   {
+      uint32_t  lightIndex;
+      // (0 for the spot lights, the face of the cube for the point lights)
+      uint32_t  face;
+      // Light space with the current light(the shaders read the one of the
+      // last draw).
+      glm::mat4 lightSpace;
+      bool      isOutdated;
+      // Frames waiting since it's outdated.
+      uint32_t  staleFrames;
+   };
+
+   void createRenderPass(const VkFormat& depthBufferFormat);
+   void createDescriptorPool();
+   void recordInitialLayout(const VkCommandBuffer& commandBuffer) const;
+
+   VkDevice                         m_logicalDevice;
+   VkFormat                         m_format;
+   VkExtent2D                       m_extent;
+   uint32_t                         m_tilesPerRow;
+   uint32_t                         m_maxTilesCount;
+
+   Image                            m_image;
+   RenderPass                       m_renderPass;
+   VkFramebuffer                    m_framebuffer;
+   Graphics                         m_graphicsPipeline;
+   DescriptorPool                   m_descriptorPool;
+   DescriptorSets                   m_descriptorSets;
+   std::shared_ptr<CommandPool>     m_commandPool;
+   // (the first draw clears the whole atlas, the next ones keep the tiles
+   // that aren't drawn)
+   bool                             m_isCleared;
+
+   // Tiles(one buffer per frame in flight), only copied when a tile is drawn.
+   std::shared_ptr<UBO>             m_tilesBuffer;
+   DescriptorTypes::StorageBufferObject::ShadowAtlasTiles m_tilesInfo;
+   // (light space of the last draw of each tile)
+   std::vector<glm::mat4>           m_drawnLightSpaces;
+   std::vector<bool>                m_isTilesBufferOutdated;
+
+   // Scheduler
+   std::vector<Tile>                m_tiles;
+   // (priority and index of the outdated tiles)
+   std::vector<std::pair<float, uint32_t>> m_candidates;
+   std::vector<uint32_t>            m_tilesToDraw;
+   // (model matrix of each caster in the last update, zero if it's hidden)
+   std::vector<glm::mat4>           m_castersModelMs;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
+
+// Cascades of the shadow map of this frame(set by ShadowMap).
+struct ShadowCascades
+{
+   uint32_t count;
+   // Light space(proj * view) of each cascade.
+   std::array<
+      glm::mat4,
+      DescriptorTypes::UniformBufferObject::MAX_SHADOW_CASCADES
+   > lightSpaces;
+   // Far distance(view depth) of each cascade.
+   glm::vec4 splits;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+/*
+ * Filter of the shadows of every light(see pbrLighting.glsl). Each tap is a
+ * hardware compare with bilinear filtering(2x2 texels), so the kernels need
+ * fewer taps than a compare per texel:
+ *    -HARDWARE_2X2: one tap.
+ *    -POISSON: 8 taps of a Poisson disk rotated per pixel(the banding becomes
+ *    noise).
+ *    -PCF_3X3: 3x3 texels weighted as a gaussian, with 4 taps.
+ *    -PCF_5X5: 5x5 texels weighted as a gaussian, with 9 taps.
+ * It's the value of the specialization constant SHADOW_FILTER of the
+ * lighting shaders.
+ */
+enum class ShadowFilter
+{
+   HARDWARE_2X2 = 0,
+   POISSON      = 1,
+   PCF_3X3      = 2,
+   PCF_5X5      = 3
+};
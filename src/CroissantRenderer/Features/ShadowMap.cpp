@@ -1,6 +1,9 @@
 #include <CroissantRenderer/Features/ShadowMap.h>
 
 #include <memory>
+#include <array>
+#include <algorithm>
+#include <cmath>
 
 #include <vulkan/vulkan.h>
 
@@ -14,6 +17,7 @@
 #include <CroissantRenderer/Descriptor/Types/UBO/UBOutils.h>
 #include <CroissantRenderer/Image/imageManager.h>
 #include <CroissantRenderer/Framebuffer/framebufferManager.h>
+#include <CroissantRenderer/Features/featuresUtils.h>
 #include <CroissantRenderer/Math/mathUtils.h>
 #include <CroissantRenderer/Command/commandManager.h>
 #include <CroissantRenderer/Model/Attributes.h>
@@ -23,23 +27,23 @@ template<typename T>
 ShadowMap<T>::ShadowMap(
       const VkPhysicalDevice& physicalDevice,
       const VkDevice& logicalDevice,
-      const VkExtent2D& extent,
-      const uint32_t imagesCount,
       const VkFormat& format,
       const uint32_t& uboCount,
-      const std::vector<Mesh<T>>* meshes,
       const std::vector<size_t>& modelIndices
-) : m_logicalDevice(logicalDevice), 
-    m_width(extent.width),
-    m_height(extent.height),
-    m_opMeshes(meshes)
+) : m_logicalDevice(logicalDevice),
+    m_extent({config::SHADOW_MAP_RESOLUTION, config::SHADOW_MAP_RESOLUTION}),
+    m_basicInfo(),
+    m_cascades(),
+    m_fittedCenters(),
+    m_fittedRadii(),
+    m_fittedLightView(1.0f)
 {
 
    m_image = Image(
          physicalDevice,
          logicalDevice,
-         m_width,
-         m_height,
+         m_extent.width,
+         m_extent.height,
          format,
          VK_IMAGE_TILING_OPTIMAL,
          (
@@ -56,24 +60,31 @@ ShadowMap<T>::ShadowMap(
          VK_COMPONENT_SWIZZLE_B,
          VK_COMPONENT_SWIZZLE_A,
          VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-         VK_FILTER_NEAREST
+         featuresUtils::getShadowFilter(physicalDevice, format),
+         config::SHADOW_CASCADES_COUNT,
+         // (hardware PCF, see pbrLighting.glsl)
+         VK_COMPARE_OP_LESS_OR_EQUAL
    );
 
    createUBO(physicalDevice, uboCount);
    createRenderPass(format);
-   createFramebuffer(imagesCount);
-   createGraphicsPipeline(extent);
+   createFramebuffers(format);
+   createGraphicsPipeline(modelIndices);
    createDescriptorPool();
-   createDescriptorSets();
+   // (the descriptor sets are created by the scene, with the buffers of the
+   // instances)
+
+   m_isCascadeDirty.fill(true);
 }
 
 template<typename T>
-void ShadowMap<T>::createGraphicsPipeline(const VkExtent2D& extent)
-{
+void ShadowMap<T>::createGraphicsPipeline(
+      const std::vector<size_t>& modelIndices
+) {
    m_graphicsPipeline = Graphics(
          m_logicalDevice,
          GraphicsPipelineType::SHADOWMAP,
-         extent,
+         m_extent,
          m_renderPass,
          {
             {
@@ -84,10 +95,17 @@ void ShadowMap<T>::createGraphicsPipeline(const VkExtent2D& extent)
          VK_SAMPLE_COUNT_1_BIT,
          Attributes::PBR::getBindingDescription(),
          Attributes::PBR::getAttributeDescriptions(),
-         m_modelIndices,
+         modelIndices,
          GRAPHICS_PIPELINE::SHADOWMAP::UBOS_INFO,
          {},
-         {}
+         // (model drawn and its cascade)
+         {
+            {
+               VK_SHADER_STAGE_VERTEX_BIT,
+               0,
+               sizeof(PushBlockShadowMap)
+            }
+         }
    );
 }
 
@@ -106,34 +124,142 @@ void ShadowMap<T>::createCommandPool(
    );
 }
 
+/*
+ * -Splits the view frustum(from Z_NEAR to SHADOW_DISTANCE) between the
+ * cascades and fits an orthographic projection to each split:
+ *    - The splits mix the uniform and the logarithmic ones(see
+ *      SHADOW_CASCADES_SPLIT_LAMBDA).
+ *    - The projection covers the bounding sphere of the corners of the split
+ *      and its center is snapped to the texels of the cascade(in the space
+ *      of the light).
+ *    - The near plane is moved SHADOW_CASTERS_DISTANCE towards the light, so
+ *      the casters outside of the split still cast their shadows on it.
+ *    - With the cache, the cascades after the first one are fitted with
+ *      SHADOW_CASCADES_MARGIN and their projection is kept while the sphere
+ *      of the split is inside of the fitted one(and the light doesn't
+ *      change), so their layers aren't drawn again.
+ */
 template<typename T>
-void ShadowMap<T>::updateUBO(
-      const glm::mat4 modelM,
+void ShadowMap<T>::updateCascades(
+      const std::shared_ptr<Camera>& camera,
       const glm::fvec4 directionalLightStartPos,
       const glm::fvec4 directionalLightEndPos,
-      const float aspect,
-      const float zNear,
-      const float zFar,
       const uint32_t& currentFrame
 ) {
-
-   // TODO: Improve this.
-   // The model and projection matrix don't need to be updated every frame.
-   m_basicInfo.model = modelM;
-   glm::mat4 proj = mathUtils::getUpdatedProjMatrix(
-         glm::radians(config::FOV),
-         aspect,
-         zNear,
-         zFar
+   const float zNear = config::Z_NEAR;
+   const float zFar = std::min(config::SHADOW_DISTANCE, config::Z_FAR);
+   const float lambda = config::SHADOW_CASCADES_SPLIT_LAMBDA;
+
+   const glm::mat4 invView = glm::inverse(camera->getViewM());
+   const float tanY = std::tan(glm::radians(camera->getFOV()) * 0.5f);
+   const float tanX = tanY * camera->getAspect();
+
+   // (only the rotation of the light, so the snapping doesn't depend on its
+   // position)
+   const glm::vec3 lightDir = glm::normalize(
+         glm::vec3(directionalLightEndPos - directionalLightStartPos)
    );
-
-   glm::mat4 view = glm::lookAt(
-         glm::fvec3(directionalLightStartPos),
-         glm::fvec3(directionalLightEndPos),
-         glm::fvec3(0.0f, 1.0f, 0.0f)
+   const glm::vec3 up = (
+         (std::abs(lightDir.y) > 0.99f) ?
+            glm::vec3(0.0f, 0.0f, 1.0f) :
+            glm::vec3(0.0f, 1.0f, 0.0f)
    );
+   const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDir, up);
+
+   m_cascades.count = config::SHADOW_CASCADES_COUNT;
+
+   float splitNear = zNear;
 
-   m_basicInfo.lightSpace = proj * view;
+   for (uint32_t c = 0; c < m_cascades.count; c++)
+   {
+      const float p = static_cast<float>(c + 1) / m_cascades.count;
+      const float splitFar = (
+            lambda * zNear * std::pow(zFar / zNear, p) +
+            (1.0f - lambda) * (zNear + (zFar - zNear) * p)
+      );
+
+      // - Bounding sphere of the split(in world space).
+      std::array<glm::vec3, 8> corners;
+      glm::vec3 center(0.0f);
+
+      for (uint32_t i = 0; i < corners.size(); i++)
+      {
+         const float z = (i & 4) ? splitFar : splitNear;
+
+         corners[i] = glm::vec3(
+               invView * glm::vec4(
+                  ((i & 1) ? tanX : -tanX) * z,
+                  ((i & 2) ? tanY : -tanY) * z,
+                  -z,
+                  1.0f
+               )
+         );
+         center += corners[i];
+      }
+      center /= static_cast<float>(corners.size());
+
+      float radius = 0.0f;
+
+      for (const auto& corner : corners)
+         radius = std::max(radius, glm::length(corner - center));
+
+      glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+
+      // - Keeps the fit of the far cascades.
+      const bool hasMargin = (config::SHADOW_CACHING && c > 0);
+
+      if (hasMargin &&
+          lightView == m_fittedLightView &&
+          glm::length(lightCenter - m_fittedCenters[c]) + radius <=
+          m_fittedRadii[c]
+      ) {
+         m_cascades.splits[c] = splitFar;
+         splitNear = splitFar;
+         continue;
+      }
+
+      if (hasMargin)
+         radius *= 1.0f + config::SHADOW_CASCADES_MARGIN;
+
+      // (rounded, so the size of the texels doesn't change with the
+      // rotation of the camera)
+      radius = std::ceil(radius * 16.0f) / 16.0f;
+
+      // - Snaps the center to the texels.
+      const float texelSize = 2.0f * radius / m_extent.width;
+
+      lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+      lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+      // (and its depth, so the light space doesn't change until the camera
+      // moves a texel and the cache can be used)
+      lightCenter.z = std::floor(lightCenter.z / texelSize) * texelSize;
+
+      // (the light looks towards -z and the bottom and top are swapped for
+      // Vulkan, as in mathUtils::getUpdatedProjMatrix())
+      const glm::mat4 proj = glm::orthoRH_ZO(
+            lightCenter.x - radius,
+            lightCenter.x + radius,
+            lightCenter.y + radius,
+            lightCenter.y - radius,
+            -lightCenter.z - radius - config::SHADOW_CASTERS_DISTANCE,
+            -lightCenter.z + radius
+      );
+
+      const glm::mat4 lightSpace = proj * lightView;
+
+      if (lightSpace != m_cascades.lightSpaces[c])
+         m_isCascadeDirty[c] = true;
+
+      m_cascades.lightSpaces[c] = lightSpace;
+      m_cascades.splits[c] = splitFar;
+      m_fittedCenters[c] = lightCenter;
+      m_fittedRadii[c] = radius;
+      m_basicInfo.lightSpaces[c] = m_cascades.lightSpaces[c];
+
+      splitNear = splitFar;
+   }
+
+   m_fittedLightView = lightView;
 
    size_t size = sizeof(m_basicInfo);
    UBOutils::updateUBO(
@@ -145,6 +271,45 @@ void ShadowMap<T>::updateUBO(
    );
 }
 
+/*
+ * -All the cascades are dirty if any caster moved, appeared or was hidden
+ *  since the last update.
+ */
+template<typename T>
+void ShadowMap<T>::updateCasters(const std::vector<glm::mat4>& castersModelMs)
+{
+   if (castersModelMs == m_castersModelMs)
+      return;
+
+   m_castersModelMs = castersModelMs;
+   m_isCascadeDirty.fill(true);
+}
+
+template<typename T>
+const bool ShadowMap<T>::isDirty() const
+{
+   for (uint32_t c = 0; c < config::SHADOW_CASCADES_COUNT; c++)
+   {
+      if (isCascadeDirty(c))
+         return true;
+   }
+
+   return false;
+}
+
+template<typename T>
+const bool ShadowMap<T>::isCascadeDirty(const uint32_t cascade) const
+{
+   return (config::SHADOW_CACHING == false || m_isCascadeDirty[cascade]);
+}
+
+// (once the dirty cascades are recorded)
+template<typename T>
+void ShadowMap<T>::clearDirty()
+{
+   m_isCascadeDirty.fill(false);
+}
+
 template<typename T>
 const VkCommandBuffer& ShadowMap<T>::getCommandBuffer(const uint32_t index) const
 {
@@ -160,15 +325,22 @@ void ShadowMap<T>::allocCommandBuffers(const uint32_t& commandBuffersCount)
 template<typename T>
 void ShadowMap<T>::createDescriptorPool()
 {
+   // (one set per frame in flight)
+   const uint32_t setsCount = config::MAX_FRAMES_IN_FLIGHT;
+
    m_descriptorPool = DescriptorPool(
          m_logicalDevice,
          {
             {
                VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-               15 * GRAPHICS_PIPELINE::SHADOWMAP::UBOS_COUNT
+               setsCount * GRAPHICS_PIPELINE::SHADOWMAP::UBOS_COUNT
+            },
+            {
+               VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+               setsCount * GRAPHICS_PIPELINE::SHADOWMAP::STORAGE_BUFFERS_COUNT
             }
          },
-         15 // TODO: Improve this.
+         setsCount
    );
 }
 
@@ -186,9 +358,9 @@ void ShadowMap<T>::createUBO(
 }
 
 template<typename T>
-void ShadowMap<T>::createDescriptorSets()
+void ShadowMap<T>::createDescriptorSets(UBO* instances, UBO* visibleInstances)
 {
-   std::vector<UBO*> opUBOs = {m_ubo.get()};
+   std::vector<UBO*> opUBOs = {m_ubo.get(), instances, visibleInstances};
 
    m_descriptorSets = DescriptorSets(
          m_logicalDevice,
@@ -214,59 +386,127 @@ const VkSampler& ShadowMap<T>::getSampler() const
    return m_image.getSampler();
 }
 
+/*
+ * -The geometry buffer of the meshes has to be bound before this.
+ * -Each mesh of the model is drawn with the visible list of the cascade(see
+ * NormalPBR::reserveInstances()).
+ */
 template<typename T>
 void ShadowMap<T>::bindData(
+      const GeometryBuffer<T>& geometryBuffer,
+      const std::vector<Mesh<T>>& meshes,
+      const glm::mat4& modelM,
+      const uint32_t cascade,
+      const std::vector<uint32_t>& visibleInstancesCounts,
       const VkCommandBuffer& commandBuffer,
       const uint32_t currentFrame
 ) {
-   for (auto mesh = m_opMeshes->begin(); mesh != m_opMeshes->end(); mesh++)
+   // All the meshes use the same descriptor set.
+   commandManager::state::bindDescriptorSets(
+         m_graphicsPipeline.getPipelineLayout(),
+         PipelineType::GRAPHICS,
+         // Index of first descriptor set.
+         0,
+         {getDescriptorSet(currentFrame)},
+         // Dynamic offsets.
+         {},
+         commandBuffer
+   );
+   pushConstants(modelM, cascade, commandBuffer);
+
+   VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+
+   for (size_t i = 0; i < meshes.size(); i++)
    {
-      commandManager::state::bindVertexBuffers(
-            {mesh->vertexBuffer},
-            // Offsets.
-            {0},
-            // Index of first binding.
-            0,
-            // Bindings count.
-            1,
-            commandBuffer
-      );
-      commandManager::state::bindIndexBuffer(
-            mesh->indexBuffer,
-            // Offset.
-            0,
-            VK_INDEX_TYPE_UINT32,
-            commandBuffer
-      );
+      // (all the instances are outside of the cascade)
+      if (visibleInstancesCounts[i] == 0)
+         continue;
 
-      commandManager::state::bindDescriptorSets(
-            m_graphicsPipeline.getPipelineLayout(),
-            PipelineType::GRAPHICS,
-            // Index of first descriptor set.
+      geometryBuffer.drawIndexed(
+            meshes[i],
+            // LOD
             0,
-            {getDescriptorSet(currentFrame)},
-            // Dynamic offsets.
-            {},
-            commandBuffer
-      );
-
-      commandManager::action::drawIndexed(
-            // Index Count
-            mesh->indices.size(),
             // Instance Count
-            1,
-            // First index.
-            0,
-            // Vertex Offset.
-            0,
-            // First Intance.
-            0,
+            visibleInstancesCounts[i],
+            // First Instance
+            meshes[i].firstVisibleInstance + cascade * meshes[i].instancesCount,
+            boundIndexType,
             commandBuffer
       );
    }
 }
 
 
+/*
+ * -Draws the meshes of a model with the commands of the cascade written by
+ * the GPU culling. They are drawsCount consecutive commands from offset, the
+ * first draws16Count with 16-bit indices.
+ */
+template<typename T>
+void ShadowMap<T>::bindDataIndirect(
+      const GeometryBuffer<T>& geometryBuffer,
+      const glm::mat4& modelM,
+      const uint32_t cascade,
+      const VkBuffer& indirectBuffer,
+      const VkDeviceSize offset,
+      const uint32_t draws16Count,
+      const uint32_t drawsCount,
+      const VkCommandBuffer& commandBuffer,
+      const uint32_t currentFrame
+) {
+   // All the meshes use the same descriptor set.
+   commandManager::state::bindDescriptorSets(
+         m_graphicsPipeline.getPipelineLayout(),
+         PipelineType::GRAPHICS,
+         // Index of first descriptor set.
+         0,
+         {getDescriptorSet(currentFrame)},
+         // Dynamic offsets.
+         {},
+         commandBuffer
+   );
+   pushConstants(modelM, cascade, commandBuffer);
+
+   VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+
+   geometryBuffer.drawIndexedIndirect(
+         VK_INDEX_TYPE_UINT16,
+         indirectBuffer,
+         offset,
+         draws16Count,
+         boundIndexType,
+         commandBuffer
+   );
+   geometryBuffer.drawIndexedIndirect(
+         VK_INDEX_TYPE_UINT32,
+         indirectBuffer,
+         offset + sizeof(VkDrawIndexedIndirectCommand) * draws16Count,
+         drawsCount - draws16Count,
+         boundIndexType,
+         commandBuffer
+   );
+}
+
+template<typename T>
+void ShadowMap<T>::pushConstants(
+      const glm::mat4& modelM,
+      const uint32_t cascade,
+      const VkCommandBuffer& commandBuffer
+) {
+   PushBlockShadowMap pushBlock;
+   pushBlock.model = modelM;
+   pushBlock.cascade = cascade;
+
+   commandManager::state::pushConstants(
+         m_graphicsPipeline.getPipelineLayout(),
+         VK_SHADER_STAGE_VERTEX_BIT,
+         0,
+         sizeof(pushBlock),
+         &pushBlock,
+         commandBuffer
+   );
+}
+
 template<typename T>
 const VkDescriptorSet& ShadowMap<T>::getDescriptorSet(const uint32_t index) const
 {
@@ -274,9 +514,9 @@ const VkDescriptorSet& ShadowMap<T>::getDescriptorSet(const uint32_t index) cons
 }
 
 template<typename T>
-const VkFramebuffer& ShadowMap<T>::getFramebuffer(const uint32_t imageIndex) const
+const VkFramebuffer& ShadowMap<T>::getFramebuffer(const uint32_t cascade) const
 {
-   return m_framebuffers[imageIndex];
+   return m_framebuffers[cascade];
 }
 
 template<typename T>
@@ -286,9 +526,15 @@ const std::shared_ptr<CommandPool>& ShadowMap<T>::getCommandPool() const
 }
 
 template<typename T>
-const glm::mat4& ShadowMap<T>::getLightSpace() const
+const ShadowCascades& ShadowMap<T>::getCascades() const
 {
-   return m_basicInfo.lightSpace;
+   return m_cascades;
+}
+
+template<typename T>
+const VkExtent2D& ShadowMap<T>::getExtent() const
+{
+   return m_extent;
 }
 
 template<typename T>
@@ -303,22 +549,45 @@ const Graphics& ShadowMap<T>::getGraphicsPipeline() const
    return m_graphicsPipeline;
 }
 
+/*
+ * -Each cascade is drawn to its layer of the image, with a framebuffer that
+ * only has the view of that layer.
+ */
 template<typename T>
-void ShadowMap<T>::createFramebuffer(const uint32_t& imagesCount)
+void ShadowMap<T>::createFramebuffers(const VkFormat& format)
 {
-   m_framebuffers.resize(imagesCount);
+   const uint32_t cascadesCount = m_image.getLayersCount();
 
-   // We'll write in the sampler to later use it in the scene fragment shader.
-   std::vector<VkImageView> attachments = {m_image.getImageView()};
+   m_cascadeViews.resize(cascadesCount);
+   m_framebuffers.resize(cascadesCount);
 
-   for (uint32_t i = 0; i < imagesCount; i++)
+   for (uint32_t i = 0; i < cascadesCount; i++)
    {
+      imageManager::createImageView(
+            m_logicalDevice,
+            format,
+            m_image.get(),
+            VK_IMAGE_ASPECT_DEPTH_BIT,
+            false,
+            1,
+            VK_COMPONENT_SWIZZLE_R,
+            VK_COMPONENT_SWIZZLE_G,
+            VK_COMPONENT_SWIZZLE_B,
+            VK_COMPONENT_SWIZZLE_A,
+            m_cascadeViews[i],
+            // (only the layer of the cascade)
+            1,
+            i
+      );
+
+      std::vector<VkImageView> attachments = {m_cascadeViews[i]};
+
       framebufferManager::createFramebuffer(
             m_logicalDevice,
             m_renderPass.get(),
             attachments,
-            m_width,
-            m_height,
+            m_extent.width,
+            m_extent.height,
             1,
             m_framebuffers[i]
       );
@@ -338,6 +607,9 @@ void ShadowMap<T>::destroy()
 
    for (auto& framebuffer : m_framebuffers)
       vkDestroyFramebuffer(m_logicalDevice, framebuffer, nullptr);
+
+   for (auto& cascadeView : m_cascadeViews)
+      vkDestroyImageView(m_logicalDevice, cascadeView, nullptr);
 }
 
 template<typename T>
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+#include <array>
 
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
@@ -12,8 +14,40 @@
 #include <CroissantRenderer/Command/CommandPool.h>
 #include <CroissantRenderer/Pipeline/Graphics.h>
 #include <CroissantRenderer/Model/Mesh.h>
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
 #include <CroissantRenderer/RenderPass/RenderPass.h>
+#include <CroissantRenderer/Camera/Camera.h>
+#include <CroissantRenderer/Features/ShadowCascades.h>
+#include <CroissantRenderer/Settings/config.h>
+
+static_assert(
+      config::SHADOW_CASCADES_COUNT >= 2 &&
+      config::SHADOW_CASCADES_COUNT <=
+      DescriptorTypes::UniformBufferObject::MAX_SHADOW_CASCADES,
+      "The shadow map needs between 2 and MAX_SHADOW_CASCADES cascades."
+);
+
+struct PushBlockShadowMap
+{
+   // (model matrix of the model drawn)
+   glm::mat4 model;
+   uint32_t cascade;
+};
 
+/*
+ * Cascaded shadow map of the directional light. The view frustum(up to
+ * SHADOW_DISTANCE) is splitted in SHADOW_CASCADES_COUNT cascades and each
+ * one is drawn with an orthographic projection to a layer of the same depth
+ * image(of SHADOW_MAP_RESOLUTION texels, independent of the window):
+ *    - The projection fits the bounding sphere of the split, so its size
+ *      doesn't change when the camera rotates.
+ *    - Its center is snapped to the texels of the cascade, so the shadows
+ *      don't shimmer when the camera moves.
+ * The layers are cached(SHADOW_CACHING): a cascade is only drawn again when
+ * its light space(the light or the camera moved) or a caster changed. The
+ * cascades after the first one are fitted with a margin and kept until the
+ * split leaves them(SHADOW_CASCADES_MARGIN).
+ */
 template<typename T>
 class ShadowMap
 {
@@ -23,25 +57,40 @@ public:
    ShadowMap(
          const VkPhysicalDevice& physicalDevice,
          const VkDevice& logicalDevice,
-         const VkExtent2D& extent,
-         const uint32_t imagesCount,
          const VkFormat& format,
          const uint32_t& uboCount,
-         const std::vector<Mesh<T>>* meshes,
          const std::vector<size_t>& modelIndices
    );
    ~ShadowMap();
    void destroy();
-   void updateUBO(
-         const glm::mat4 modelM,
+   void updateCascades(
+         const std::shared_ptr<Camera>& camera,
          const glm::fvec4 directionalLightStartPos,
          const glm::fvec4 directionalLightEndPos,
-         const float aspect,
-         const float zNear,
-         const float zFar,
          const uint32_t& currentFrame
    );
+   void updateCasters(const std::vector<glm::mat4>& castersModelMs);
+   const bool isDirty() const;
+   const bool isCascadeDirty(const uint32_t cascade) const;
+   void clearDirty();
+   void createDescriptorSets(UBO* instances, UBO* visibleInstances);
    void bindData(
+         const GeometryBuffer<T>& geometryBuffer,
+         const std::vector<Mesh<T>>& meshes,
+         const glm::mat4& modelM,
+         const uint32_t cascade,
+         const std::vector<uint32_t>& visibleInstancesCounts,
+         const VkCommandBuffer& commandBuffer,
+         const uint32_t currentFrame
+   );
+   void bindDataIndirect(
+         const GeometryBuffer<T>& geometryBuffer,
+         const glm::mat4& modelM,
+         const uint32_t cascade,
+         const VkBuffer& indirectBuffer,
+         const VkDeviceSize offset,
+         const uint32_t draws16Count,
+         const uint32_t drawsCount,
          const VkCommandBuffer& commandBuffer,
          const uint32_t currentFrame
    );
@@ -53,9 +102,10 @@ public:
    void allocCommandBuffers(const uint32_t& commandBuffersCount);
    const VkImageView& getShadowMapView() const;
    const VkSampler& getSampler() const;
-   const glm::mat4& getLightSpace() const;
+   const ShadowCascades& getCascades() const;
+   const VkExtent2D& getExtent() const;
    const VkDescriptorSet& getDescriptorSet(const uint32_t index) const;
-   const VkFramebuffer& getFramebuffer(const uint32_t imageIndex) const;
+   const VkFramebuffer& getFramebuffer(const uint32_t cascade) const;
    const VkCommandBuffer& getCommandBuffer(const uint32_t index) const;
    const std::shared_ptr<CommandPool>& getCommandPool() const;
    const Graphics& getGraphicsPipeline() const;
@@ -68,16 +118,20 @@ private:
          const uint32_t& uboCount
    );
    void createDescriptorPool();
-   void createDescriptorSets();
-   void createGraphicsPipeline(const VkExtent2D& extent);
+   void createGraphicsPipeline(const std::vector<size_t>& modelIndices);
    void createRenderPass(const VkFormat& depthBufferFormat);
-   void createFramebuffer(const uint32_t& imagesCount);
+   void createFramebuffers(const VkFormat& format);
+   void pushConstants(
+         const glm::mat4& modelM,
+         const uint32_t cascade,
+         const VkCommandBuffer& commandBuffer
+   );
 
    VkDevice                         m_logicalDevice;
 
-   uint32_t                         m_width;
-   uint32_t                         m_height;
+   VkExtent2D                       m_extent;
 
+   // (one layer per cascade)
    Image                            m_image;
    std::shared_ptr<UBO>             m_ubo;
 
@@ -88,11 +142,33 @@ private:
 
    std::shared_ptr<CommandPool>     m_commandPool;
 
+   // (one per cascade, with the view of its layer)
+   std::vector<VkImageView>         m_cascadeViews;
    std::vector<VkFramebuffer>       m_framebuffers;
 
    Graphics                         m_graphicsPipeline;
 
    DescriptorTypes::UniformBufferObject::ShadowMap m_basicInfo;
-   const std::vector<Mesh<T>>* m_opMeshes;
-   const std::vector<size_t> m_modelIndices;
+   ShadowCascades                   m_cascades;
+
+   // Cache
+   // Set when the light space of a cascade or the casters change, until the
+   // layer is drawn again.
+   std::array<
+      bool,
+      DescriptorTypes::UniformBufferObject::MAX_SHADOW_CASCADES
+   >                                m_isCascadeDirty;
+   // (model matrix of each caster in the last update, zero if it's hidden)
+   std::vector<glm::mat4>           m_castersModelMs;
+   // Sphere covered by the projection of each cascade(its center in the
+   // space of the light) and the light view of the last fit.
+   std::array<
+      glm::vec3,
+      DescriptorTypes::UniformBufferObject::MAX_SHADOW_CASCADES
+   >                                m_fittedCenters;
+   std::array<
+      float,
+      DescriptorTypes::UniformBufferObject::MAX_SHADOW_CASCADES
+   >                                m_fittedRadii;
+   glm::mat4                        m_fittedLightView;
 };
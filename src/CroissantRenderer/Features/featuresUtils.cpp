@@ -48,6 +48,27 @@ VkFormat featuresUtils::findSupportedFormat(
    throw std::runtime_error("Failed to find supported format!");
 }
 
+/*
+ * -Linear if the depth format can be filtered, so each hardware compare of the
+ * shadows returns the average of 2x2 texels(bilinear PCF). Otherwise each tap
+ * only compares the closest texel.
+ */
+VkFilter featuresUtils::getShadowFilter(
+      const VkPhysicalDevice& physicalDevice,
+      const VkFormat& depthFormat
+) {
+   VkFormatProperties props;
+   vkGetPhysicalDeviceFormatProperties(physicalDevice, depthFormat, &props);
+
+   if (props.optimalTilingFeatures &
+       VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+   ) {
+      return VK_FILTER_LINEAR;
+   }
+
+   return VK_FILTER_NEAREST;
+}
+
  void featuresUtils::createDepthStencilStateInfo(
        const GraphicsPipelineType& type,
        VkPipelineDepthStencilStateCreateInfo& depthStencil
@@ -56,12 +77,19 @@ VkFormat featuresUtils::findSupportedFormat(
          VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO
    );
 
-    if (type == GraphicsPipelineType::PREFILTER_ENV_MAP)
-    {
+    if (type == GraphicsPipelineType::PREFILTER_ENV_MAP ||
+        type == GraphicsPipelineType::DEFERRED_LIGHTING
+    ) {
       
       depthStencil.depthTestEnable = VK_FALSE;
       depthStencil.depthWriteEnable = VK_FALSE;
 
+    } else if (type == GraphicsPipelineType::PBR_AFTER_DEPTH_PREPASS)
+    {
+      // The depth is already written by the depth pre-pass.
+      depthStencil.depthTestEnable = VK_TRUE;
+      depthStencil.depthWriteEnable = VK_FALSE;
+
     } else
     {
       // Specifies if the depth of new fragments shoud be compared to the depth
@@ -82,6 +110,10 @@ VkFormat featuresUtils::findSupportedFormat(
     } else if (type == GraphicsPipelineType::PREFILTER_ENV_MAP)
     {
       depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    } else if (type == GraphicsPipelineType::PBR_AFTER_DEPTH_PREPASS)
+    {
+      // (only the closest fragment of each sample is shaded)
+      depthStencil.depthCompareOp = VK_COMPARE_OP_EQUAL;
     } else
       depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
 
@@ -21,6 +21,12 @@ namespace featuresUtils
    );
    
    
+   // (filter of the comparison samplers of the shadows)
+   VkFilter getShadowFilter(
+         const VkPhysicalDevice& physicalDevice,
+         const VkFormat& depthFormat
+   );
+
    VkSampleCountFlagBits getMaxUsableSampleCount(
       const VkPhysicalDevice& physicalDevice
    );
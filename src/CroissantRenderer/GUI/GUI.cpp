@@ -16,6 +16,7 @@
 
 #include <CroissantRenderer/Settings/config.h>
 #include <CroissantRenderer/Descriptor/DescriptorPool.h>
+#include <CroissantRenderer/Pipeline/pipelineCache.h>
 #include <CroissantRenderer/Command/CommandPool.h>
 #include <CroissantRenderer/Swapchain/Swapchain.h>
 #include <CroissantRenderer/RenderPass/attachmentUtils.h>
@@ -78,7 +79,7 @@ GUI::GUI(
    initInfo.Device = logicalDevice;
    initInfo.QueueFamily = graphicsFamilyIndex;
    initInfo.Queue = graphicsQueue;
-   initInfo.PipelineCache = VK_NULL_HANDLE;
+   initInfo.PipelineCache = pipelineCache::get();
    initInfo.DescriptorPool = m_descriptorPool.get();
    initInfo.Allocator = nullptr;
    initInfo.MinImageCount = m_opSwapchain->getMinImageCount();
@@ -191,6 +192,7 @@ void GUI::uploadFonts(const VkQueue& graphicsQueue)
          {newCommandBuffer},
          true
    );
+   m_commandPool->recycleCommandBuffer(newCommandBuffer);
 }
 
 void GUI::createFrameBuffers()
@@ -338,7 +340,9 @@ void GUI::draw(
       const std::string& deviceName,
       const double mpf,
       const VkSampleCountFlagBits samplesCount,
-      const uint32_t apiVersion
+      const uint32_t apiVersion,
+      const frustumCulling::Stats& cullingStats,
+      bool& isDepthPrepassEnabled
 ) {
 
    ImGui_ImplVulkan_NewFrame();
@@ -363,7 +367,14 @@ void GUI::draw(
                ImGuiCond_Always,
                ImVec2(1.0f, 0.0f)
          );
-         createProfilingWindow(deviceName, mpf, samplesCount, apiVersion);
+         createProfilingWindow(
+               deviceName,
+               mpf,
+               samplesCount,
+               apiVersion,
+               cullingStats,
+               isDepthPrepassEnabled
+         );
       }
       {
          sizeX = float(ImGui::GetIO().DisplaySize.x) * 0.2f;
@@ -396,7 +407,9 @@ void GUI::createProfilingWindow(
       const std::string& deviceName,
       const double mpf,
       const VkSampleCountFlagBits samplesCount,
-      const uint32_t apiVersion
+      const uint32_t apiVersion,
+      const frustumCulling::Stats& cullingStats,
+      bool& isDepthPrepassEnabled
 ) {
    ImGui::Begin(
          "Profiling",
@@ -436,6 +449,40 @@ void GUI::createProfilingWindow(
       ImGui::NextColumn();
       ImGui::Separator();
 
+      ImGui::Text(("Meshes(visible/culled): "));
+      ImGui::NextColumn();
+      ImGui::Text(
+            (
+               std::to_string(cullingStats.visibleCount) + " / " +
+               std::to_string(cullingStats.culledCount)
+            ).c_str()
+      );
+      ImGui::NextColumn();
+      ImGui::Separator();
+
+      ImGui::Text(("Occluded meshes: "));
+      ImGui::NextColumn();
+      ImGui::Text(std::to_string(cullingStats.occludedCount).c_str());
+      ImGui::NextColumn();
+      ImGui::Separator();
+
+      ImGui::Text(("Shadow meshes(visible/culled): "));
+      ImGui::NextColumn();
+      ImGui::Text(
+            (
+               std::to_string(cullingStats.shadowVisibleCount) + " / " +
+               std::to_string(cullingStats.shadowCulledCount)
+            ).c_str()
+      );
+      ImGui::NextColumn();
+      ImGui::Separator();
+
+      ImGui::Text(("Depth pre-pass: "));
+      ImGui::NextColumn();
+      ImGui::Checkbox("##depthPrepass", &isDepthPrepassEnabled);
+      ImGui::NextColumn();
+      ImGui::Separator();
+
    ImGui::End();
 
 }
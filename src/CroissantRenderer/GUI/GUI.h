@@ -12,6 +12,7 @@
 #include <CroissantRenderer/Camera/Camera.h>
 #include <CroissantRenderer/RenderPass/RenderPass.h>
 #include <CroissantRenderer/Model/Model.h>
+#include <CroissantRenderer/Culling/frustumCulling.h>
 
 class GUI
 {
@@ -41,7 +42,9 @@ public:
          const std::string& deviceName,
          const double mpf,
          const VkSampleCountFlagBits samplesCount,
-         const uint32_t apiVersion
+         const uint32_t apiVersion,
+         const frustumCulling::Stats& cullingStats,
+         bool& isDepthPrepassEnabled
    );
    const VkCommandBuffer& getCommandBuffer(const uint32_t index) const;
    const bool isCursorPositionInGUI() const;
@@ -66,7 +69,9 @@ private:
          const std::string& deviceName,
          const double mpf,
          const VkSampleCountFlagBits samplesCount,
-         const uint32_t apiVersion
+         const uint32_t apiVersion,
+         const frustumCulling::Stats& cullingStats,
+         bool& isDepthPrepassEnabled
    );
    void createSlider(
          const std::string& subMenuName, const std::string& sliceName,
@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 
 #include <CroissantRenderer/Image/imageManager.h>
+#include <CroissantRenderer/Memory/memoryAllocator.h>
 
 Image::Image() {}
 
@@ -24,7 +25,7 @@ Image::Image(
       const VkComponentSwizzle& componentMapG,
       const VkComponentSwizzle& componentMapB,
       const VkComponentSwizzle& componentMapA
-) : m_logicalDevice(logicalDevice), m_isCubeMap(isCubemap)
+) : m_logicalDevice(logicalDevice), m_isCubeMap(isCubemap), m_layersCount(1)
 {
    init(
          physicalDevice,
@@ -64,8 +65,12 @@ Image::Image(
       const VkComponentSwizzle& componentMapA,
       // Parameters to create the Sampler
       const VkSamplerAddressMode& addressMode,
-      const VkFilter& filter
-) : m_logicalDevice(logicalDevice), m_isCubeMap(isCubemap)
+      const VkFilter& filter,
+      const uint32_t layersCount,
+      const std::optional<VkCompareOp>& compareOp
+) : m_logicalDevice(logicalDevice),
+    m_isCubeMap(isCubemap),
+    m_layersCount(layersCount)
 {
    init(
          physicalDevice,
@@ -89,7 +94,8 @@ Image::Image(
          m_logicalDevice,
          mipLevels,
          addressMode,
-         filter
+         filter,
+         compareOp
    );
 }
 
@@ -124,7 +130,8 @@ void Image::init(
          mipLevels,
          numSamples,
          m_image,
-         m_imageMemory
+         m_imageAllocation,
+         m_layersCount
    );
 
    imageManager::createImageView(
@@ -138,7 +145,8 @@ void Image::init(
          componentMapG,
          componentMapB,
          componentMapA,
-         m_imageView
+         m_imageView,
+         m_layersCount
    );
 
 }
@@ -160,6 +168,11 @@ const VkSampler& Image::getSampler() const
       return m_sampler->get();
 }
 
+const uint32_t Image::getLayersCount() const
+{
+   return m_layersCount;
+}
+
 void Image::destroy()
 {
    if (m_sampler.has_value())
@@ -167,5 +180,5 @@ void Image::destroy()
 
    vkDestroyImageView(m_logicalDevice, m_imageView, nullptr);
    vkDestroyImage(m_logicalDevice, m_image, nullptr);
-   vkFreeMemory(m_logicalDevice, m_imageMemory, nullptr);
+   memoryAllocator::free(m_imageAllocation);
 }
@@ -5,6 +5,7 @@
 #include <vulkan/vulkan.h>
 
 #include <CroissantRenderer/Descriptor/Types/Sampler/Sampler.h>
+#include <CroissantRenderer/Memory/Allocation.h>
 
 class Image
 {
@@ -53,7 +54,11 @@ public:
       const VkComponentSwizzle& componentMapA,
       // Parameters to create the Sampler
       const VkSamplerAddressMode& addressMode,
-      const VkFilter& filter
+      const VkFilter& filter,
+      // (more than 1 layer -> the view is an array)
+      const uint32_t layersCount = 1,
+      // (sampler with depth compare, see Sampler)
+      const std::optional<VkCompareOp>& compareOp = std::nullopt
    );
    void init(
       const VkPhysicalDevice& physicalDevice,
@@ -77,6 +82,7 @@ public:
    const VkImage& get() const;
    const VkImageView& getImageView() const;
    const VkSampler& getSampler() const;
+   const uint32_t getLayersCount() const;
    void destroy();
 
 private:
@@ -85,9 +91,10 @@ private:
 
    VkImage                 m_image;
    VkImageView             m_imageView;
-   VkDeviceMemory          m_imageMemory;
+   Allocation              m_imageAllocation;
    std::optional<Sampler>  m_sampler;
 
    bool                    m_isCubeMap;
+   uint32_t                m_layersCount;
 
 };
@@ -4,8 +4,8 @@
 
 #include <CroissantRenderer/Command/commandManager.h>
 #include <CroissantRenderer/Command/CommandPool.h>
-#include <CroissantRenderer/Buffer/bufferUtils.h>
 #include <CroissantRenderer/Buffer/bufferManager.h>
+#include <CroissantRenderer/Memory/memoryAllocator.h>
 
 void imageManager::createImage(
       const VkPhysicalDevice& physicalDevice,
@@ -20,7 +20,8 @@ void imageManager::createImage(
       const uint32_t mipLevels,
       const VkSampleCountFlagBits& numSamples,
       VkImage& image,
-      VkDeviceMemory& memory
+      Allocation& allocation,
+      const uint32_t layersCount
 ) {
    // Creates an image object with the array of pixels.
    // (So later we can sample it as texels...so in 2D coords)
@@ -39,7 +40,7 @@ void imageManager::createImage(
    } else
    {
       imageInfo.flags = 0;
-      imageInfo.arrayLayers = 1;
+      imageInfo.arrayLayers = layersCount;
    }
 
    imageInfo.format = format;
@@ -75,31 +76,26 @@ void imageManager::createImage(
          &memRequirements
    );
 
-   VkMemoryAllocateInfo allocInfo{};
-   allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-   allocInfo.allocationSize = memRequirements.size;
-   allocInfo.memoryTypeIndex = bufferUtils::findMemoryType(
-         physicalDevice,
-         memRequirements.memoryTypeBits,
-         memoryProperties
-   );
-
-   status = vkAllocateMemory(
-         logicalDevice,
-         &allocInfo,
-         nullptr,
-         &memory
+   // Optimal images can't be in the same blocks as the buffers(and linear
+   // images) because of the bufferImageGranularity.
+   memoryAllocator::allocate(
+         memRequirements,
+         memoryProperties,
+         (
+            (tiling == VK_IMAGE_TILING_OPTIMAL) ?
+               memoryAllocator::ResourceKind::OPTIMAL :
+               memoryAllocator::ResourceKind::LINEAR
+         ),
+         AllocationStrategy::TLSF,
+         allocation
    );
 
-   if (status != VK_SUCCESS)
-      throw std::runtime_error("Failed to allocate image memory!");
-
    // Bind the image object(it's like a buffer) to the memory.
    vkBindImageMemory(
          logicalDevice,
          image,
-         memory,
-         0
+         allocation.memory,
+         allocation.offset
    );
 
 }
@@ -115,7 +111,9 @@ void imageManager::createImageView(
       const VkComponentSwizzle& componentMapG,
       const VkComponentSwizzle& componentMapB,
       const VkComponentSwizzle& componentMapA,
-      VkImageView& imageView
+      VkImageView& imageView,
+      const uint32_t layersCount,
+      const uint32_t baseLayer
 ) {
 
    VkImageViewCreateInfo createInfo{};
@@ -127,6 +125,10 @@ void imageManager::createImageView(
    {
       createInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
       createInfo.subresourceRange.layerCount = 6;
+   } else if (layersCount > 1)
+   {
+      createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+      createInfo.subresourceRange.layerCount = layersCount;
    } else
    {
       createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
@@ -147,7 +149,7 @@ void imageManager::createImageView(
    createInfo.subresourceRange.aspectMask = aspectFlags;
    createInfo.subresourceRange.baseMipLevel = 0;
    createInfo.subresourceRange.levelCount = mipLevels;
-   createInfo.subresourceRange.baseArrayLayer = 0;
+   createInfo.subresourceRange.baseArrayLayer = (isCubemap) ? 0 : baseLayer;
    
    const auto status = vkCreateImageView(
          logicalDevice,
@@ -179,7 +181,7 @@ void imageManager::copyDataToImage(
 ) {
 
    VkBuffer stagingBuffer;
-   VkDeviceMemory stagingBufferMemory;
+   Allocation stagingBufferAllocation;
 
    bufferManager::createAndFillStagingBuffer(
          physicalDevice,
@@ -191,7 +193,7 @@ void imageManager::copyDataToImage(
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
             VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
          ),
-         stagingBufferMemory,
+         stagingBufferAllocation,
          stagingBuffer,
          data
    );
@@ -261,9 +263,10 @@ void imageManager::copyDataToImage(
          {commandBuffer},
          true
    );
+   commandPool->recycleCommandBuffer(commandBuffer);
 
    bufferManager::destroyBuffer(logicalDevice, stagingBuffer);
-   bufferManager::freeMemory(logicalDevice, stagingBufferMemory);
+   bufferManager::freeMemory(stagingBufferAllocation);
 
    // Another transition to sample from the shader.
    if (isCubemap)
@@ -348,6 +351,7 @@ void imageManager::transitionImageLayout(
          {commandBuffer},
          true
    );
+   commandPool->recycleCommandBuffer(commandBuffer);
 }
 
 void imageManager::createImageMemoryBarrier(
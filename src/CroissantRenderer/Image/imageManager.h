@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 
 #include <CroissantRenderer/Command/CommandPool.h>
+#include <CroissantRenderer/Memory/Allocation.h>
 
 namespace imageManager
 {
@@ -19,7 +20,9 @@ namespace imageManager
       const uint32_t mipLevels,
       const VkSampleCountFlagBits& numSamples,
       VkImage& image,
-      VkDeviceMemory& memory
+      Allocation& allocation,
+      // (ignored by the cubemaps)
+      const uint32_t layersCount = 1
    );
    void createImageView(
          const VkDevice& logicalDevice,
@@ -32,7 +35,10 @@ namespace imageManager
          const VkComponentSwizzle& componentMapG,
          const VkComponentSwizzle& componentMapB,
          const VkComponentSwizzle& componentMapA,
-         VkImageView& imageView
+         VkImageView& imageView,
+         // (more than 1 layer -> array view, ignored by the cubemaps)
+         const uint32_t layersCount = 1,
+         const uint32_t baseLayer = 0
    );
    template<typename T>
    void copyDataToImage(
@@ -0,0 +1,320 @@
+#include <CroissantRenderer/Job/JobSystem.h>
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+
+// Identifies the worker(and its job system) that is running in this thread.
+static thread_local const JobSystem* t_opJobSystem = nullptr;
+static thread_local uint32_t         t_workerIndex = 0;
+
+JobSystem::JobSystem()
+{
+   // The calling thread also helps while it waits, so we leave one core for
+   // it.
+   const uint32_t coresCount = std::thread::hardware_concurrency();
+
+   init((coresCount > 1) ? coresCount - 1 : 1);
+}
+
+JobSystem::JobSystem(const uint32_t workersCount)
+{
+   init(std::max(workersCount, 1u));
+}
+
+JobSystem::~JobSystem()
+{
+   // (in case the owner didn't reach its cleanup, e.g. an exception)
+   destroy();
+}
+
+void JobSystem::init(const uint32_t workersCount)
+{
+   m_isRunning = true;
+   m_pendingJobsCount = 0;
+
+   // +1 -> queue of the threads that are not workers.
+   for (uint32_t i = 0; i < workersCount + 1; i++)
+      m_queues.push_back(std::make_unique<WorkQueue>());
+
+   for (uint32_t i = 0; i < workersCount; i++)
+      m_workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+/*
+ * -Creates a job without scheduling it.
+ * If it has a parent, the parent will not be finished until this job is
+ * finished. That's why the children have to be created before running the
+ * parent.
+ */
+std::shared_ptr<Job> JobSystem::createJob(
+      const std::function<void()>& task,
+      const std::shared_ptr<Job>& parent
+) {
+   auto job = std::make_shared<Job>();
+   job->task = task;
+   job->parent = parent;
+   job->unfinishedJobs = 1;
+   job->isFinished = false;
+
+   if (parent)
+      parent->unfinishedJobs++;
+
+   return job;
+}
+
+void JobSystem::run(const std::shared_ptr<Job>& job)
+{
+   push(job);
+}
+
+/*
+ * -Schedules 'continuation' when 'job' and all its children are finished.
+ * (if it's already finished, the continuation is scheduled right away)
+ */
+void JobSystem::addContinuation(
+      const std::shared_ptr<Job>& job,
+      const std::shared_ptr<Job>& continuation
+) {
+   {
+      std::lock_guard<std::mutex> lock(job->continuationsMutex);
+
+      if (job->isFinished == false)
+      {
+         job->continuations.push_back(continuation);
+         return;
+      }
+   }
+
+   push(continuation);
+}
+
+/*
+ * -Blocks until the job and all its children are finished. Meanwhile, the
+ * calling thread executes the pending jobs instead of sleeping.
+ * -If the job or any of its children threw, the first exception is rethrown
+ * here(once all of them are finished).
+ */
+void JobSystem::wait(const std::shared_ptr<Job>& job)
+{
+   while (job->unfinishedJobs.load() > 0)
+   {
+      if (auto nextJob = getJob())
+         execute(nextJob);
+      else
+         std::this_thread::yield();
+   }
+
+   std::exception_ptr error;
+   {
+      std::lock_guard<std::mutex> lock(job->continuationsMutex);
+      error = job->error;
+   }
+
+   if (error)
+      std::rethrow_exception(error);
+}
+
+/*
+ * -Fork/join: creates one job per index and waits for all of them.
+ * The order of execution is not guaranteed, so each task must only write to
+ * its own slot(e.g. results[i]).
+ */
+void JobSystem::parallelFor(
+      const size_t count,
+      const std::function<void(const size_t)>& task
+) {
+   auto root = createJob([](){});
+
+   for (size_t i = 0; i < count; i++)
+      run(createJob([&task, i](){ task(i); }, root));
+
+   run(root);
+   wait(root);
+}
+
+const uint32_t JobSystem::getWorkersCount() const
+{
+   return static_cast<uint32_t>(m_workers.size());
+}
+
+void JobSystem::workerLoop(const uint32_t workerIndex)
+{
+   t_opJobSystem = this;
+   t_workerIndex = workerIndex;
+
+   while (m_isRunning)
+   {
+      if (auto job = getJob())
+      {
+         execute(job);
+         continue;
+      }
+
+      // There is nothing to do(or steal), so we sleep until a new job is
+      // pushed.
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wakeCondition.wait(
+            lock,
+            [this]() {
+               return (m_isRunning == false || m_pendingJobsCount > 0);
+            }
+      );
+   }
+}
+
+const uint32_t JobSystem::getCurrentQueueIndex() const
+{
+   if (t_opJobSystem == this)
+      return t_workerIndex;
+
+   // Not a worker -> shared queue.
+   return static_cast<uint32_t>(m_queues.size() - 1);
+}
+
+void JobSystem::push(const std::shared_ptr<Job>& job)
+{
+   WorkQueue& queue = *m_queues[getCurrentQueueIndex()];
+
+   // The counter goes first, so it never goes below 0 if a thief takes the
+   // job before we leave this function.
+   {
+      std::lock_guard<std::mutex> lock(m_wakeMutex);
+      m_pendingJobsCount++;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.jobs.push_back(job);
+   }
+
+   m_wakeCondition.notify_one();
+}
+
+std::shared_ptr<Job> JobSystem::pop(const uint32_t queueIndex)
+{
+   WorkQueue& queue = *m_queues[queueIndex];
+   std::lock_guard<std::mutex> lock(queue.mutex);
+
+   if (queue.jobs.empty())
+      return nullptr;
+
+   // LIFO for the owner.
+   auto job = queue.jobs.back();
+   queue.jobs.pop_back();
+
+   m_pendingJobsCount--;
+
+   return job;
+}
+
+std::shared_ptr<Job> JobSystem::steal(const uint32_t thiefIndex)
+{
+   const uint32_t queuesCount = static_cast<uint32_t>(m_queues.size());
+
+   // Starts with the next queue so not all the thieves hit the same victim.
+   for (uint32_t i = 1; i < queuesCount; i++)
+   {
+      WorkQueue& queue = *m_queues[(thiefIndex + i) % queuesCount];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+
+      if (queue.jobs.empty())
+         continue;
+
+      // FIFO for the thieves.
+      auto job = queue.jobs.front();
+      queue.jobs.pop_front();
+
+      m_pendingJobsCount--;
+
+      return job;
+   }
+
+   return nullptr;
+}
+
+std::shared_ptr<Job> JobSystem::getJob()
+{
+   const uint32_t queueIndex = getCurrentQueueIndex();
+
+   if (auto job = pop(queueIndex))
+      return job;
+
+   return steal(queueIndex);
+}
+
+/*
+ * -The exceptions can't leave the thread of a worker, so they are saved in
+ * the job(and its parents) and the job is finished anyway, otherwise its
+ * waiters would never wake up.
+ */
+void JobSystem::execute(const std::shared_ptr<Job>& job)
+{
+   try
+   {
+      job->task();
+
+   } catch (...)
+   {
+      setError(job, std::current_exception());
+   }
+
+   finish(job);
+}
+
+void JobSystem::setError(
+      const std::shared_ptr<Job>& job,
+      const std::exception_ptr& error
+) {
+   for (auto current = job; current != nullptr; current = current->parent)
+   {
+      std::lock_guard<std::mutex> lock(current->continuationsMutex);
+
+      // (the first one is kept)
+      if (current->error == nullptr)
+         current->error = error;
+   }
+}
+
+void JobSystem::finish(const std::shared_ptr<Job>& job)
+{
+   // Waits for the children too.
+   if (job->unfinishedJobs.fetch_sub(1) != 1)
+      return;
+
+   std::vector<std::shared_ptr<Job>> continuations;
+   {
+      std::lock_guard<std::mutex> lock(job->continuationsMutex);
+
+      job->isFinished = true;
+      continuations.swap(job->continuations);
+   }
+
+   for (auto& continuation : continuations)
+      push(continuation);
+
+   if (job->parent)
+      finish(job->parent);
+}
+
+/*
+ * -Stops and joins the workers(it can be called more than once).
+ */
+void JobSystem::destroy()
+{
+   if (m_workers.empty() && m_queues.empty())
+      return;
+
+   {
+      std::lock_guard<std::mutex> lock(m_wakeMutex);
+      m_isRunning = false;
+   }
+   m_wakeCondition.notify_all();
+
+   for (auto& worker : m_workers)
+      worker.join();
+
+   m_workers.clear();
+   m_queues.clear();
+}
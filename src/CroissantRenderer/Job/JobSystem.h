@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+
+struct Job
+{
+   std::function<void()>               task;
+   // The parent isn't finished until all its children are finished.
+   std::shared_ptr<Job>                parent;
+   // Counts the job itself + all the children that are not finished yet.
+   std::atomic<uint32_t>               unfinishedJobs;
+
+   // Jobs scheduled when this one (and all its children) finishes.
+   std::mutex                          continuationsMutex;
+   std::vector<std::shared_ptr<Job>>   continuations;
+   bool                                isFinished;
+   // First exception thrown by the job or its children(guarded by
+   // continuationsMutex, wait() rethrows it).
+   std::exception_ptr                  error;
+};
+
+/*
+ * Persistent pool of workers where each worker owns a deque of jobs. The
+ * owner pushes/pops from the back(LIFO, keeps the cache hot) and the idle
+ * workers steal from the front of the others(FIFO, steals the bigger and
+ * older jobs).
+ */
+class JobSystem
+{
+
+public:
+
+   JobSystem();
+   JobSystem(const uint32_t workersCount);
+   ~JobSystem();
+   std::shared_ptr<Job> createJob(
+         const std::function<void()>& task,
+         const std::shared_ptr<Job>& parent = nullptr
+   );
+   void run(const std::shared_ptr<Job>& job);
+   void addContinuation(
+         const std::shared_ptr<Job>& job,
+         const std::shared_ptr<Job>& continuation
+   );
+   void wait(const std::shared_ptr<Job>& job);
+   void parallelFor(
+         const size_t count,
+         const std::function<void(const size_t)>& task
+   );
+   const uint32_t getWorkersCount() const;
+   void destroy();
+
+private:
+
+   struct WorkQueue
+   {
+      std::mutex                          mutex;
+      std::deque<std::shared_ptr<Job>>    jobs;
+   };
+
+   void init(const uint32_t workersCount);
+   void workerLoop(const uint32_t workerIndex);
+   void push(const std::shared_ptr<Job>& job);
+   std::shared_ptr<Job> pop(const uint32_t queueIndex);
+   std::shared_ptr<Job> steal(const uint32_t thiefIndex);
+   std::shared_ptr<Job> getJob();
+   void execute(const std::shared_ptr<Job>& job);
+   void setError(
+         const std::shared_ptr<Job>& job,
+         const std::exception_ptr& error
+   );
+   void finish(const std::shared_ptr<Job>& job);
+   const uint32_t getCurrentQueueIndex() const;
+
+   std::vector<std::thread>                  m_workers;
+   // One queue per worker + one shared by the threads that are not workers
+   // (e.g. the main thread while it's waiting).
+   std::vector<std::unique_ptr<WorkQueue>>   m_queues;
+
+   std::atomic<bool>                         m_isRunning;
+   std::atomic<uint32_t>                     m_pendingJobsCount;
+   std::mutex                                m_wakeMutex;
+   std::condition_variable                   m_wakeCondition;
+};
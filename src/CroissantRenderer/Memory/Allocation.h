@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+class MemoryBlock;
+
+enum class AllocationStrategy
+{
+   // General purpose(two-level segregated fit). Allocations can be freed in
+   // any order.
+   TLSF = 0,
+   // Just bumps an offset. The block is reused only when all its allocations
+   // are freed, so it's meant for short-lived resources(e.g. staging
+   // buffers).
+   LINEAR = 1
+};
+
+/*
+ * A region of a VkDeviceMemory shared with other resources.
+ */
+struct Allocation
+{
+   VkDeviceMemory memory = VK_NULL_HANDLE;
+   VkDeviceSize   offset = 0;
+   VkDeviceSize   size = 0;
+   // Only for the host visible memory(the blocks are persistently mapped).
+   void*          mappedData = nullptr;
+
+   // Observer pointer
+   MemoryBlock*   opBlock = nullptr;
+};
@@ -0,0 +1,434 @@
+#include <CroissantRenderer/Memory/MemoryBlock.h>
+
+#include <stdexcept>
+#include <algorithm>
+
+#include <vulkan/vulkan.h>
+
+static VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+{
+   return (value + alignment - 1) / alignment * alignment;
+}
+
+static uint32_t floorLog2(const VkDeviceSize value)
+{
+   return 63 - __builtin_clzll(value);
+}
+
+MemoryBlock::MemoryBlock(
+      const VkDevice& logicalDevice,
+      const uint32_t memoryTypeIndex,
+      const VkDeviceSize size,
+      const bool isHostVisible,
+      const AllocationStrategy strategy,
+      const bool isDedicated
+) : m_logicalDevice(logicalDevice),
+    m_mappedData(nullptr),
+    m_memoryTypeIndex(memoryTypeIndex),
+    m_size(size),
+    m_strategy(strategy),
+    m_isDedicated(isDedicated),
+    m_usedBytes(0),
+    m_allocationsCount(0),
+    m_flBitmap(0),
+    m_linearHead(0)
+{
+   VkMemoryAllocateInfo allocInfo{};
+   allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+   allocInfo.allocationSize = size;
+   allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+   auto status = vkAllocateMemory(
+         logicalDevice,
+         &allocInfo,
+         nullptr,
+         &m_memory
+   );
+
+   if (status != VK_SUCCESS)
+      throw std::runtime_error("Failed to allocate a memory block!");
+
+   // The whole block is mapped only once, so the resources inside it don't
+   // need to map/unmap(and a VkDeviceMemory can't be mapped twice).
+   if (isHostVisible)
+      vkMapMemory(logicalDevice, m_memory, 0, VK_WHOLE_SIZE, 0, &m_mappedData);
+
+   // TLSF
+   std::fill(m_slBitmaps, m_slBitmaps + FL_COUNT, 0);
+   for (uint32_t fl = 0; fl < FL_COUNT; fl++)
+      std::fill(m_freeHeads[fl], m_freeHeads[fl] + SL_COUNT, -1);
+
+   if (strategy == AllocationStrategy::TLSF)
+   {
+      // At the beginning, the whole block is a free chunk.
+      const int32_t chunkIndex = newChunk();
+      Chunk& chunk = m_chunks[chunkIndex];
+      chunk.offset = 0;
+      chunk.size = size / MIN_CHUNK_SIZE * MIN_CHUNK_SIZE;
+
+      insertFreeChunk(chunkIndex);
+   }
+}
+
+MemoryBlock::~MemoryBlock() {}
+
+/*
+ * -Returns false if there isn't any free region big enough.
+ */
+bool MemoryBlock::alloc(
+      const VkDeviceSize size,
+      const VkDeviceSize alignment,
+      VkDeviceSize& offset
+) {
+   bool isAllocated;
+
+   if (m_strategy == AllocationStrategy::LINEAR)
+      isAllocated = allocLinear(size, alignment, offset);
+   else
+      isAllocated = allocTLSF(size, alignment, offset);
+
+   if (isAllocated)
+      m_allocationsCount++;
+
+   return isAllocated;
+}
+
+void MemoryBlock::free(const VkDeviceSize offset)
+{
+   m_allocationsCount--;
+
+   if (m_strategy == AllocationStrategy::LINEAR)
+   {
+      m_usedBytes -= m_linearAllocations[offset];
+      m_linearAllocations.erase(offset);
+
+      // Everything was freed, so we can start again from the beginning.
+      if (m_allocationsCount == 0)
+         m_linearHead = 0;
+
+      return;
+   }
+
+   int32_t chunkIndex = m_usedChunks[offset];
+   m_usedChunks.erase(offset);
+
+   m_usedBytes -= m_chunks[chunkIndex].size;
+
+   // Coalesces with the free neighbours.
+   const int32_t nextIndex = m_chunks[chunkIndex].nextPhysical;
+   if (nextIndex != -1 && m_chunks[nextIndex].isFree)
+   {
+      removeFreeChunk(nextIndex);
+      mergeWithNext(chunkIndex);
+   }
+
+   const int32_t prevIndex = m_chunks[chunkIndex].prevPhysical;
+   if (prevIndex != -1 && m_chunks[prevIndex].isFree)
+   {
+      removeFreeChunk(prevIndex);
+      mergeWithNext(prevIndex);
+      chunkIndex = prevIndex;
+   }
+
+   insertFreeChunk(chunkIndex);
+}
+
+bool MemoryBlock::allocLinear(
+      const VkDeviceSize size,
+      const VkDeviceSize alignment,
+      VkDeviceSize& offset
+) {
+   const VkDeviceSize alignedOffset = alignUp(m_linearHead, alignment);
+
+   if (alignedOffset + size > m_size)
+      return false;
+
+   offset = alignedOffset;
+   m_linearHead = alignedOffset + size;
+   m_linearAllocations[offset] = size;
+   m_usedBytes += size;
+
+   return true;
+}
+
+bool MemoryBlock::allocTLSF(
+      const VkDeviceSize size,
+      const VkDeviceSize alignment,
+      VkDeviceSize& offset
+) {
+   const VkDeviceSize chunkSize = alignUp(
+         std::max(size, MIN_CHUNK_SIZE),
+         MIN_CHUNK_SIZE
+   );
+   // All the chunks are already aligned to MIN_CHUNK_SIZE, so bigger
+   // alignments need some extra space in the worst case.
+   const VkDeviceSize searchSize = (
+         chunkSize +
+         ((alignment > MIN_CHUNK_SIZE) ? alignment - MIN_CHUNK_SIZE : 0)
+   );
+
+   uint32_t fl, sl;
+   if (mappingSearch(searchSize, fl, sl) == false)
+      return false;
+
+   int32_t chunkIndex = findFreeChunk(fl, sl);
+   if (chunkIndex == -1)
+      return false;
+
+   removeFreeChunk(chunkIndex);
+
+   // The padding needed by the alignment goes back to the free lists.
+   const VkDeviceSize padding = (
+         alignUp(m_chunks[chunkIndex].offset, alignment) -
+         m_chunks[chunkIndex].offset
+   );
+   if (padding > 0)
+   {
+      const int32_t alignedIndex = splitChunk(chunkIndex, padding);
+
+      insertFreeChunk(chunkIndex);
+      chunkIndex = alignedIndex;
+   }
+
+   // The rest too.
+   if (m_chunks[chunkIndex].size - chunkSize >= MIN_CHUNK_SIZE)
+   {
+      const int32_t remainderIndex = splitChunk(chunkIndex, chunkSize);
+
+      insertFreeChunk(remainderIndex);
+   }
+
+   Chunk& chunk = m_chunks[chunkIndex];
+   chunk.isFree = false;
+
+   offset = chunk.offset;
+   m_usedChunks[offset] = chunkIndex;
+   m_usedBytes += chunk.size;
+
+   return true;
+}
+
+/*
+ * -First level: power of 2 range of the size.
+ * -Second level: linear subdivision of that range.
+ */
+void MemoryBlock::mapping(
+      const VkDeviceSize size,
+      uint32_t& fl,
+      uint32_t& sl
+) const {
+   if (size < SMALL_SIZE)
+   {
+      fl = 0;
+      sl = static_cast<uint32_t>(size / MIN_CHUNK_SIZE);
+
+      return;
+   }
+
+   const uint32_t log2 = floorLog2(size);
+
+   fl = log2 - SMALL_SIZE_LOG2 + 1;
+   sl = static_cast<uint32_t>(size >> (log2 - SL_LOG2)) ^ SL_COUNT;
+}
+
+/*
+ * -Same as mapping, but rounds up the size to the next list. This way any
+ * chunk of the list found is big enough(so we don't need to iterate it).
+ */
+bool MemoryBlock::mappingSearch(
+      const VkDeviceSize size,
+      uint32_t& fl,
+      uint32_t& sl
+) const {
+   VkDeviceSize roundedSize = size;
+
+   if (size >= SMALL_SIZE)
+      roundedSize += (VkDeviceSize(1) << (floorLog2(size) - SL_LOG2)) - 1;
+
+   mapping(roundedSize, fl, sl);
+
+   return (fl < FL_COUNT);
+}
+
+int32_t MemoryBlock::findFreeChunk(uint32_t fl, uint32_t sl) const
+{
+   // Lists of the same first level with a bigger(or equal) second level.
+   uint32_t slMap = m_slBitmaps[fl] & (~0u << sl);
+
+   if (slMap == 0)
+   {
+      // Then, lists of a bigger first level.
+      const uint64_t flMap = (
+            (fl + 1 < 64) ?
+               m_flBitmap & (~uint64_t(0) << (fl + 1)) :
+               0
+      );
+
+      if (flMap == 0)
+         return -1;
+
+      fl = __builtin_ctzll(flMap);
+      slMap = m_slBitmaps[fl];
+   }
+
+   sl = __builtin_ctz(slMap);
+
+   return m_freeHeads[fl][sl];
+}
+
+void MemoryBlock::insertFreeChunk(const int32_t chunkIndex)
+{
+   Chunk& chunk = m_chunks[chunkIndex];
+
+   uint32_t fl, sl;
+   mapping(chunk.size, fl, sl);
+
+   chunk.isFree = true;
+   chunk.prevFree = -1;
+   chunk.nextFree = m_freeHeads[fl][sl];
+
+   if (chunk.nextFree != -1)
+      m_chunks[chunk.nextFree].prevFree = chunkIndex;
+
+   m_freeHeads[fl][sl] = chunkIndex;
+   m_flBitmap |= (uint64_t(1) << fl);
+   m_slBitmaps[fl] |= (1u << sl);
+}
+
+void MemoryBlock::removeFreeChunk(const int32_t chunkIndex)
+{
+   Chunk& chunk = m_chunks[chunkIndex];
+
+   uint32_t fl, sl;
+   mapping(chunk.size, fl, sl);
+
+   if (chunk.prevFree != -1)
+      m_chunks[chunk.prevFree].nextFree = chunk.nextFree;
+   else
+      m_freeHeads[fl][sl] = chunk.nextFree;
+
+   if (chunk.nextFree != -1)
+      m_chunks[chunk.nextFree].prevFree = chunk.prevFree;
+
+   if (m_freeHeads[fl][sl] == -1)
+   {
+      m_slBitmaps[fl] &= ~(1u << sl);
+
+      if (m_slBitmaps[fl] == 0)
+         m_flBitmap &= ~(uint64_t(1) << fl);
+   }
+
+   chunk.isFree = false;
+}
+
+/*
+ * -Keeps the first 'size' bytes in the chunk and returns the index of the new
+ * chunk with the rest.
+ */
+int32_t MemoryBlock::splitChunk(const int32_t chunkIndex, const VkDeviceSize size)
+{
+   const int32_t restIndex = newChunk();
+
+   // (newChunk can reallocate the vector)
+   Chunk& chunk = m_chunks[chunkIndex];
+   Chunk& rest = m_chunks[restIndex];
+
+   rest.offset = chunk.offset + size;
+   rest.size = chunk.size - size;
+   rest.isFree = false;
+   rest.prevPhysical = chunkIndex;
+   rest.nextPhysical = chunk.nextPhysical;
+
+   if (chunk.nextPhysical != -1)
+      m_chunks[chunk.nextPhysical].prevPhysical = restIndex;
+
+   chunk.size = size;
+   chunk.nextPhysical = restIndex;
+
+   return restIndex;
+}
+
+/*
+ * -The chunk absorbs its next physical neighbour.
+ */
+void MemoryBlock::mergeWithNext(const int32_t chunkIndex)
+{
+   Chunk& chunk = m_chunks[chunkIndex];
+   const int32_t nextIndex = chunk.nextPhysical;
+   Chunk& next = m_chunks[nextIndex];
+
+   chunk.size += next.size;
+   chunk.nextPhysical = next.nextPhysical;
+
+   if (next.nextPhysical != -1)
+      m_chunks[next.nextPhysical].prevPhysical = chunkIndex;
+
+   m_unusedChunks.push_back(nextIndex);
+}
+
+int32_t MemoryBlock::newChunk()
+{
+   int32_t chunkIndex;
+
+   if (m_unusedChunks.size() > 0)
+   {
+      chunkIndex = m_unusedChunks.back();
+      m_unusedChunks.pop_back();
+   } else
+   {
+      chunkIndex = static_cast<int32_t>(m_chunks.size());
+      m_chunks.push_back({});
+   }
+
+   m_chunks[chunkIndex] = {0, 0, false, -1, -1, -1, -1};
+
+   return chunkIndex;
+}
+
+const bool MemoryBlock::isEmpty() const
+{
+   return (m_allocationsCount == 0);
+}
+
+const bool MemoryBlock::isDedicated() const
+{
+   return m_isDedicated;
+}
+
+const VkDeviceMemory& MemoryBlock::getMemory() const
+{
+   return m_memory;
+}
+
+void* MemoryBlock::getMappedData() const
+{
+   return m_mappedData;
+}
+
+const uint32_t MemoryBlock::getMemoryTypeIndex() const
+{
+   return m_memoryTypeIndex;
+}
+
+const VkDeviceSize MemoryBlock::getSize() const
+{
+   return m_size;
+}
+
+const VkDeviceSize MemoryBlock::getUsedBytes() const
+{
+   return m_usedBytes;
+}
+
+const uint32_t MemoryBlock::getAllocationsCount() const
+{
+   return m_allocationsCount;
+}
+
+void MemoryBlock::destroy()
+{
+   if (m_mappedData != nullptr)
+      vkUnmapMemory(m_logicalDevice, m_memory);
+
+   vkFreeMemory(m_logicalDevice, m_memory, nullptr);
+}
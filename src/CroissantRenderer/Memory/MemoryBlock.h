@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Memory/Allocation.h>
+
+/*
+ * One VkDeviceMemory that is sub-allocated with the TLSF or the LINEAR
+ * strategy.
+ */
+class MemoryBlock
+{
+
+public:
+
+   MemoryBlock(
+         const VkDevice& logicalDevice,
+         const uint32_t memoryTypeIndex,
+         const VkDeviceSize size,
+         const bool isHostVisible,
+         const AllocationStrategy strategy,
+         const bool isDedicated
+   );
+   ~MemoryBlock();
+   bool alloc(
+         const VkDeviceSize size,
+         const VkDeviceSize alignment,
+         VkDeviceSize& offset
+   );
+   void free(const VkDeviceSize offset);
+   const bool isEmpty() const;
+   const bool isDedicated() const;
+   const VkDeviceMemory& getMemory() const;
+   void* getMappedData() const;
+   const uint32_t getMemoryTypeIndex() const;
+   const VkDeviceSize getSize() const;
+   const VkDeviceSize getUsedBytes() const;
+   const uint32_t getAllocationsCount() const;
+   void destroy();
+
+private:
+
+   // TLSF
+   // Second level subdivisions per first level(power of 2) range.
+   static constexpr uint32_t     SL_LOG2 = 4;
+   static constexpr uint32_t     SL_COUNT = 1 << SL_LOG2;
+   // Sizes smaller than this are all in the first level 0(linear steps).
+   static constexpr uint32_t     SMALL_SIZE_LOG2 = 8;
+   static constexpr VkDeviceSize SMALL_SIZE = 1 << SMALL_SIZE_LOG2;
+   static constexpr uint32_t     FL_COUNT = 48;
+   // All the chunks start and end at a multiple of this.
+   static constexpr VkDeviceSize MIN_CHUNK_SIZE = SMALL_SIZE / SL_COUNT;
+
+   struct Chunk
+   {
+      VkDeviceSize offset;
+      VkDeviceSize size;
+      bool         isFree;
+      // Neighbours in memory.
+      int32_t      prevPhysical;
+      int32_t      nextPhysical;
+      // Neighbours in the free list.
+      int32_t      prevFree;
+      int32_t      nextFree;
+   };
+
+   void mapping(
+         const VkDeviceSize size,
+         uint32_t& fl,
+         uint32_t& sl
+   ) const;
+   bool mappingSearch(
+         const VkDeviceSize size,
+         uint32_t& fl,
+         uint32_t& sl
+   ) const;
+   int32_t findFreeChunk(uint32_t fl, uint32_t sl) const;
+   void insertFreeChunk(const int32_t chunkIndex);
+   void removeFreeChunk(const int32_t chunkIndex);
+   int32_t splitChunk(const int32_t chunkIndex, const VkDeviceSize size);
+   void mergeWithNext(const int32_t chunkIndex);
+   int32_t newChunk();
+   bool allocTLSF(
+         const VkDeviceSize size,
+         const VkDeviceSize alignment,
+         VkDeviceSize& offset
+   );
+   bool allocLinear(
+         const VkDeviceSize size,
+         const VkDeviceSize alignment,
+         VkDeviceSize& offset
+   );
+
+   VkDevice                                  m_logicalDevice;
+   VkDeviceMemory                            m_memory;
+   void*                                     m_mappedData;
+   uint32_t                                  m_memoryTypeIndex;
+   VkDeviceSize                              m_size;
+   AllocationStrategy                        m_strategy;
+   bool                                      m_isDedicated;
+
+   VkDeviceSize                              m_usedBytes;
+   uint32_t                                  m_allocationsCount;
+
+   // TLSF
+   std::vector<Chunk>                        m_chunks;
+   std::vector<int32_t>                      m_unusedChunks;
+   uint64_t                                  m_flBitmap;
+   uint32_t                                  m_slBitmaps[FL_COUNT];
+   int32_t                                   m_freeHeads[FL_COUNT][SL_COUNT];
+   // offset -> chunk
+   std::unordered_map<VkDeviceSize, int32_t> m_usedChunks;
+
+   // LINEAR
+   VkDeviceSize                              m_linearHead;
+   // offset -> size
+   std::unordered_map<
+      VkDeviceSize,
+      VkDeviceSize
+   > m_linearAllocations;
+};
@@ -0,0 +1,293 @@
+#include <CroissantRenderer/Memory/memoryAllocator.h>
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <stdexcept>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Settings/config.h>
+#include <CroissantRenderer/Memory/MemoryBlock.h>
+
+// Heaps smaller than this use smaller blocks(heapSize / 8).
+static const VkDeviceSize SMALL_HEAP_SIZE = 1024ull * 1024 * 1024;
+
+static std::mutex                          s_mutex;
+static VkDevice                            s_logicalDevice = VK_NULL_HANDLE;
+static VkPhysicalDeviceMemoryProperties    s_memProperties;
+static VkDeviceSize                        s_bufferImageGranularity;
+// key(memory type, resource kind and strategy) -> blocks
+static std::map<
+   uint32_t,
+   std::vector<std::unique_ptr<MemoryBlock>>
+> s_pools;
+
+static uint32_t findMemoryType(
+      const uint32_t typeFilter,
+      const VkMemoryPropertyFlags properties
+) {
+   for (uint32_t i = 0; i < s_memProperties.memoryTypeCount; i++)
+   {
+      bool isMemoryTypeSuitable = typeFilter & (1 << i);
+      bool hasMemoryDesiredProperties = (
+            s_memProperties.memoryTypes[i].propertyFlags & properties
+      ) == properties;
+
+      if (isMemoryTypeSuitable && hasMemoryDesiredProperties)
+         return i;
+   }
+
+   throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+static VkDeviceSize getBlockSize(const uint32_t memoryTypeIndex)
+{
+   const uint32_t heapIndex = (
+         s_memProperties.memoryTypes[memoryTypeIndex].heapIndex
+   );
+   const VkDeviceSize heapSize = s_memProperties.memoryHeaps[heapIndex].size;
+
+   if (heapSize <= SMALL_HEAP_SIZE)
+      return heapSize / 8;
+
+   return config::MEMORY_BLOCK_SIZE;
+}
+
+static uint32_t getPoolKey(
+      const uint32_t memoryTypeIndex,
+      memoryAllocator::ResourceKind kind,
+      const AllocationStrategy strategy
+) {
+   // If there isn't any granularity restriction, buffers and images can be
+   // mixed in the same blocks.
+   if (s_bufferImageGranularity <= 1)
+      kind = memoryAllocator::ResourceKind::LINEAR;
+
+   return (
+         (memoryTypeIndex << 2) |
+         (static_cast<uint32_t>(kind) << 1) |
+         static_cast<uint32_t>(strategy)
+   );
+}
+
+void memoryAllocator::init(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice
+) {
+   std::lock_guard<std::mutex> lock(s_mutex);
+
+   s_logicalDevice = logicalDevice;
+
+   vkGetPhysicalDeviceMemoryProperties(physicalDevice, &s_memProperties);
+
+   VkPhysicalDeviceProperties properties;
+   vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+   s_bufferImageGranularity = properties.limits.bufferImageGranularity;
+}
+
+/*
+ * -Looks for space in the blocks of the pool and creates a new block if there
+ * isn't any. Allocations bigger than half a block get their own block.
+ */
+void memoryAllocator::allocate(
+      const VkMemoryRequirements& memRequirements,
+      const VkMemoryPropertyFlags memoryProperties,
+      const ResourceKind kind,
+      const AllocationStrategy strategy,
+      Allocation& allocation
+) {
+   std::lock_guard<std::mutex> lock(s_mutex);
+
+   const uint32_t memoryTypeIndex = findMemoryType(
+         memRequirements.memoryTypeBits,
+         memoryProperties
+   );
+   const bool isHostVisible = (
+         s_memProperties.memoryTypes[memoryTypeIndex].propertyFlags &
+         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+   );
+   const VkDeviceSize blockSize = getBlockSize(memoryTypeIndex);
+
+   auto& pool = s_pools[getPoolKey(memoryTypeIndex, kind, strategy)];
+
+   MemoryBlock* opBlock = nullptr;
+   VkDeviceSize offset = 0;
+
+   if (memRequirements.size > blockSize / 2)
+   {
+      // (there is only one allocation at offset 0, so it's just bumped)
+      pool.push_back(
+            std::make_unique<MemoryBlock>(
+               s_logicalDevice,
+               memoryTypeIndex,
+               memRequirements.size,
+               isHostVisible,
+               AllocationStrategy::LINEAR,
+               true
+            )
+      );
+      opBlock = pool.back().get();
+      opBlock->alloc(memRequirements.size, 1, offset);
+
+   } else
+   {
+      for (auto& block : pool)
+      {
+         if (block->isDedicated())
+            continue;
+
+         if (block->alloc(
+                  memRequirements.size,
+                  memRequirements.alignment,
+                  offset
+            )
+         ) {
+            opBlock = block.get();
+            break;
+         }
+      }
+
+      if (opBlock == nullptr)
+      {
+         pool.push_back(
+               std::make_unique<MemoryBlock>(
+                  s_logicalDevice,
+                  memoryTypeIndex,
+                  blockSize,
+                  isHostVisible,
+                  strategy,
+                  false
+               )
+         );
+         opBlock = pool.back().get();
+
+         if (opBlock->alloc(
+                  memRequirements.size,
+                  memRequirements.alignment,
+                  offset
+            ) == false
+         ) {
+            throw std::runtime_error("Failed to sub-allocate memory!");
+         }
+      }
+   }
+
+   allocation.memory = opBlock->getMemory();
+   allocation.offset = offset;
+   allocation.size = memRequirements.size;
+   allocation.opBlock = opBlock;
+   allocation.mappedData = (
+         (isHostVisible) ?
+            static_cast<uint8_t*>(opBlock->getMappedData()) + offset :
+            nullptr
+   );
+}
+
+/*
+ * -Dedicated blocks are destroyed when they get empty. The normal ones are
+ * kept(one empty block per pool) to avoid creating them again and again.
+ */
+void memoryAllocator::free(Allocation& allocation)
+{
+   if (allocation.opBlock == nullptr)
+      return;
+
+   std::lock_guard<std::mutex> lock(s_mutex);
+
+   MemoryBlock* opBlock = allocation.opBlock;
+   opBlock->free(allocation.offset);
+
+   allocation = Allocation{};
+
+   if (opBlock->isEmpty() == false)
+      return;
+
+   for (auto& [key, pool] : s_pools)
+   {
+      auto blockIt = std::find_if(
+            pool.begin(),
+            pool.end(),
+            [&](const std::unique_ptr<MemoryBlock>& block)
+            {
+               return block.get() == opBlock;
+            }
+      );
+
+      if (blockIt == pool.end())
+         continue;
+
+      const size_t emptyBlocksCount = std::count_if(
+            pool.begin(),
+            pool.end(),
+            [](const std::unique_ptr<MemoryBlock>& block)
+            {
+               return block->isDedicated() == false && block->isEmpty();
+            }
+      );
+
+      if (opBlock->isDedicated() || emptyBlocksCount > 1)
+      {
+         opBlock->destroy();
+         pool.erase(blockIt);
+      }
+
+      return;
+   }
+}
+
+memoryAllocator::Stats memoryAllocator::getStats()
+{
+   std::lock_guard<std::mutex> lock(s_mutex);
+
+   Stats stats{};
+
+   for (auto& [key, pool] : s_pools)
+   {
+      for (auto& block : pool)
+      {
+         stats.blocksCount++;
+         stats.allocationsCount += block->getAllocationsCount();
+         stats.usedBytes += block->getUsedBytes();
+         stats.reservedBytes += block->getSize();
+
+         if (block->isDedicated())
+            stats.dedicatedBlocksCount++;
+      }
+   }
+
+   return stats;
+}
+
+void memoryAllocator::printStats()
+{
+   const Stats stats = getStats();
+   const double MiB = 1024.0 * 1024.0;
+
+   std::cout << "Device memory: "
+             << stats.allocationsCount << " allocations in "
+             << stats.blocksCount << " blocks("
+             << stats.dedicatedBlocksCount << " dedicated), "
+             << stats.usedBytes / MiB << " MiB used of "
+             << stats.reservedBytes / MiB << " MiB reserved.\n";
+}
+
+/*
+ * -All the resources have to be freed before this.
+ */
+void memoryAllocator::destroy()
+{
+   std::lock_guard<std::mutex> lock(s_mutex);
+
+   for (auto& [key, pool] : s_pools)
+   {
+      for (auto& block : pool)
+         block->destroy();
+   }
+
+   s_pools.clear();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Memory/Allocation.h>
+
+/*
+ * Sub-allocates the device memory of the buffers and images from big blocks
+ * (one pool of blocks per memory type), instead of calling vkAllocateMemory
+ * per resource.
+ */
+namespace memoryAllocator
+{
+   // Buffers and linear images can't share a page with optimal images
+   // (bufferImageGranularity), so they go to different blocks.
+   enum class ResourceKind
+   {
+      LINEAR  = 0,
+      OPTIMAL = 1
+   };
+
+   struct Stats
+   {
+      uint32_t     blocksCount;
+      uint32_t     dedicatedBlocksCount;
+      uint32_t     allocationsCount;
+      VkDeviceSize usedBytes;
+      VkDeviceSize reservedBytes;
+   };
+
+   void init(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice
+   );
+   void allocate(
+         const VkMemoryRequirements& memRequirements,
+         const VkMemoryPropertyFlags memoryProperties,
+         const ResourceKind kind,
+         const AllocationStrategy strategy,
+         Allocation& allocation
+   );
+   void free(Allocation& allocation);
+   Stats getStats();
+   void printStats();
+   void destroy();
+};
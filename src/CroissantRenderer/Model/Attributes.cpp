@@ -4,6 +4,8 @@
 
 #include <vector>
 
+#include <glm/gtc/packing.hpp>
+
 // TODO: Duplicated code!
 
 // Code from:
@@ -42,7 +44,7 @@ VkVertexInputBindingDescription Attributes::PBR::getBindingDescription()
 std::vector<VkVertexInputAttributeDescription> 
    Attributes::PBR::getAttributeDescriptions() 
 {
-   std::vector<VkVertexInputAttributeDescription> attributeDescriptions(6);
+   std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
 
    // -Vertex Attribute: Position
 
@@ -58,52 +60,65 @@ std::vector<VkVertexInputAttributeDescription>
 
    attributeDescriptions[1].binding = 0;
    attributeDescriptions[1].location = 1;
-   attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
    attributeDescriptions[1].offset = offsetof(PBR::Vertex, texCoord);
 
    // - Vertex Attribute: Normal
 
    attributeDescriptions[2].binding = 0;
    attributeDescriptions[2].location = 2;
-   attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
    attributeDescriptions[2].offset = offsetof(PBR::Vertex, normal);
    
-   // - Vertex Attribute: Tangent
+   // - Vertex Attribute: Tangent(w -> sign of the bitangent)
    
    attributeDescriptions[3].binding = 0;
    attributeDescriptions[3].location = 3;
-   attributeDescriptions[3].format = VK_FORMAT_R32G32B32_SFLOAT;
    attributeDescriptions[3].offset = offsetof(PBR::Vertex, tangent);
 
-
-   // - Vertex Attribute: Bitangent
-   
-   attributeDescriptions[4].binding = 0;
-   attributeDescriptions[4].location = 4;
-   attributeDescriptions[4].format = VK_FORMAT_R32G32B32_SFLOAT;
-   attributeDescriptions[4].offset = offsetof(PBR::Vertex, bitangent);
-   //// - Vertex Attribute: TBNtransposed
-
-   //for (int i = 0; i < 3; i++)
-   //{
-   //   attributeDescriptions[3 + i].binding = 0;
-   //   attributeDescriptions[3 + i].location = 3 + i;
-   //   attributeDescriptions[3 + i].format = VK_FORMAT_R32G32B32_SFLOAT;
-   //   attributeDescriptions[3 + i].offset = array_offsetof(
-   //         PBR::Vertex, TBNtransposed, i
-   //   );
-   //}
-
-   // - Vertex Attribute: posInLightSpace
-
-   attributeDescriptions[5].binding = 0;
-   attributeDescriptions[5].location = 5;
-   attributeDescriptions[5].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-   attributeDescriptions[5].offset = offsetof(PBR::Vertex, posInLightSpace);
+#ifdef COMPACT_VERTEX_LAYOUT_ON
+   // (the shader gets them as floats, the unorm ones in [0, 1])
+   attributeDescriptions[1].format = VK_FORMAT_R16G16_SFLOAT;
+   attributeDescriptions[2].format = VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+   attributeDescriptions[3].format = VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+#else
+   attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+   attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
+   attributeDescriptions[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+#endif
 
    return attributeDescriptions;
 }
 
+/*
+ * -Builds the vertex with the layout selected at compile time. The normal and
+ * the tangent have to be normalized and the w of the tangent has to be 1 or
+ * -1.
+ */
+Attributes::PBR::Vertex Attributes::PBR::createVertex(
+      const glm::vec3& pos,
+      const glm::vec2& texCoord,
+      const glm::vec3& normal,
+      const glm::vec4& tangent
+) {
+   Vertex vertex{};
+
+   vertex.pos = pos;
+
+#ifdef COMPACT_VERTEX_LAYOUT_ON
+   // [-1, 1] -> [0, 1]
+   vertex.normal = glm::packUnorm3x10_1x2(
+         glm::vec4(normal * 0.5f + 0.5f, 0.0f)
+   );
+   vertex.tangent = glm::packUnorm3x10_1x2(tangent * 0.5f + 0.5f);
+   vertex.texCoord = glm::packHalf2x16(texCoord);
+#else
+   vertex.texCoord = texCoord;
+   vertex.normal = normal;
+   vertex.tangent = tangent;
+#endif
+
+   return vertex;
+}
+
 ////////////////////////////////////SKYBOX/////////////////////////////////////
 
 VkVertexInputBindingDescription Attributes::SKYBOX::getBindingDescription()
@@ -219,3 +234,31 @@ std::vector<VkVertexInputAttributeDescription>
    
    return attributeDescriptions;
 }
+
+/////////////////////////////////Depth Pre-pass////////////////////////////////
+VkVertexInputBindingDescription
+   Attributes::DEPTH_PREPASS::getBindingDescription()
+{
+   VkVertexInputBindingDescription bindingDescription{};
+   bindingDescription.binding = 0;
+   // (only the positions, tightly packed)
+   bindingDescription.stride = sizeof(DEPTH_PREPASS::Vertex);
+   bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+   return bindingDescription;
+}
+
+std::vector<VkVertexInputAttributeDescription> 
+   Attributes::DEPTH_PREPASS::getAttributeDescriptions() 
+{
+   std::vector<VkVertexInputAttributeDescription> attributeDescriptions(1);
+
+   // -Vertex Attribute: Position
+   attributeDescriptions[0].binding = 0;
+   attributeDescriptions[0].location = 0;
+   // Format -> vec3
+   attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+   attributeDescriptions[0].offset = offsetof(DEPTH_PREPASS::Vertex, pos);
+
+   return attributeDescriptions;
+}
@@ -9,19 +9,40 @@ namespace Attributes
 {
    namespace PBR
    {
+#ifdef COMPACT_VERTEX_LAYOUT_ON
+      /*
+       * -24 bytes per vertex:
+       *    -normal: 10:10:10 unorm(xyz * 0.5 + 0.5).
+       *    -tangent: 10:10:10 unorm + 2 bits with the sign of the bitangent.
+       *    -texCoord: 2 half floats.
+       */
+      struct Vertex
+      {
+         glm::vec3 pos;
+         uint32_t  normal;
+         uint32_t  tangent;
+         uint32_t  texCoord;
+      };
+#else
       struct Vertex
       {
          glm::vec3 pos;
          glm::vec2 texCoord;
          glm::vec3 normal;
-         glm::vec3 tangent;
-         glm::vec3 bitangent;
-         glm::vec4 posInLightSpace;
+         // (w -> sign of the bitangent)
+         glm::vec4 tangent;
       };
+#endif
 
       VkVertexInputBindingDescription getBindingDescription();
       std::vector<VkVertexInputAttributeDescription> 
          getAttributeDescriptions();
+      Vertex createVertex(
+            const glm::vec3& pos,
+            const glm::vec2& texCoord,
+            const glm::vec3& normal,
+            const glm::vec4& tangent
+      );
    };
 
    namespace SKYBOX
@@ -49,6 +70,18 @@ namespace Attributes
             getAttributeDescriptions();
    };
 
+   // Position stream of the PBR meshes(see GeometryBuffer).
+   namespace DEPTH_PREPASS
+   {
+      struct Vertex
+      {
+         glm::vec3 pos;
+      };
+      VkVertexInputBindingDescription getBindingDescription();
+      std::vector<VkVertexInputAttributeDescription> 
+            getAttributeDescriptions();
+   };
+
    namespace SHADOWMAP
    {
       struct Vertex
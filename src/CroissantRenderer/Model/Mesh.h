@@ -9,23 +9,52 @@
 #include <CroissantRenderer/Descriptor/DescriptorSets.h>
 #include <CroissantRenderer/Model/Attributes.h>
 
+struct MeshLOD
+{
+   // (relative to the indices of the mesh)
+   uint32_t firstIndex;
+   uint32_t indicesCount;
+   // Max. distance(in model space) to the original mesh.
+   float    error;
+};
+
 template<typename T>
 struct Mesh
 {
    // Vertex
    std::vector<T>                         vertices;
+   // (the indices of all the LODs, one after the other)
    std::vector<uint32_t>                  indices;
+   // From the most detailed to the least detailed.
+   std::vector<MeshLOD>                   lods;
+   // Bounding volumes(in model space).
+   glm::vec3                              aabbMin;
+   glm::vec3                              aabbMax;
+   // xyz -> center, w -> radius
+   glm::vec4                              boundingSphere;
+
+   // Range of the mesh in the geometry buffer of its vertex layout.
+   // (firstIndex is relative to the indices of its index type)
+   uint32_t                               vertexOffset;
+   uint32_t                               firstIndex;
+   VkIndexType                            indexType;
 
-   VkBuffer                               vertexBuffer;
-   VkBuffer                               indexBuffer;
-   VkDeviceMemory                         vertexMemory;
-   VkDeviceMemory                         indexMemory;
+   // Transforms of the nodes of the model that reference the mesh.
+   std::vector<glm::mat4>                 nodeTransforms;
+   // Range of the instances of the mesh in the instances buffer of the scene
+   // and of their visible lists in the visible instances buffer(one list
+   // per cascade of the shadow map and then one per LOD, instancesCount
+   // each).
+   uint32_t                               firstInstance;
+   uint32_t                               instancesCount;
+   uint32_t                               firstVisibleInstance;
 
    std::vector<std::shared_ptr<Texture>>  textures;
    std::vector<TextureToLoadInfo>         texturesToLoadInfo;
 
    // (One descriptor set for all the ubo and samplers of a mesh)
    // (The same descriptor set for each frame in flight)
+   // (not used by the PBR meshes, they share the set of their model)
    DescriptorSets                         descriptorSets;
 };
 
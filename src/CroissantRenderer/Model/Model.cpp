@@ -5,13 +5,16 @@
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <utility>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
+#include <CroissantRenderer/Settings/config.h>
 #include <CroissantRenderer/Settings/graphicsPipelineConfig.h>
 #include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
 
@@ -25,10 +28,12 @@ Model::Model(
 ) : m_type(type),
     m_name(name),
     m_folderName(folderName),
+    m_uboOffsets(config::MAX_FRAMES_IN_FLIGHT, 0),
     m_pos(pos),
     m_rot(rot),
     m_size(size),
-    m_hideStatus(false)
+    m_hideStatus(false),
+    m_isDirty(true)
 {}
 
 Model::~Model() {}
@@ -48,31 +53,106 @@ const bool Model::isHidden() const
    return m_hideStatus;
 }
 
-void Model::processNode(aiNode* node, const aiScene* scene)
+const bool Model::isDirty() const
 {
+   return m_isDirty;
+}
+
+void Model::clearDirty()
+{
+   m_isDirty = false;
+}
+
+// (swaps the last 2 indices of each triangle)
+static void flipWinding(aiMesh* mesh)
+{
+   for (size_t i = 0; i < mesh->mNumFaces; i++)
+   {
+      aiFace& face = mesh->mFaces[i];
+
+      if (face.mNumIndices == 3)
+         std::swap(face.mIndices[1], face.mIndices[2]);
+   }
+}
+
+/*
+ * -Each mesh of the scene is processed only once, even if it's referenced by
+ * several nodes. The transform of every node that references it(relative to
+ * the root) is added as an instance of the mesh.
+ * -A mirrored transform(negative determinant) flips the winding of the
+ * triangles and the back-face culling would discard the front faces, so
+ * these nodes use a copy of the mesh with the winding flipped(only the PBR
+ * models use the transforms of the nodes).
+ */
+void Model::processNode(
+      aiNode* node,
+      const aiScene* scene,
+      const glm::mat4& parentTransform,
+      std::unordered_map<uint64_t, size_t>& meshesID
+) {
+   // (assimp's matrices are row-major)
+   const glm::mat4 transform = parentTransform * glm::transpose(
+         glm::make_mat4(&node->mTransformation.a1)
+   );
+   const bool isMirrored = (
+         m_type == ModelType::NORMAL_PBR &&
+         glm::determinant(glm::mat3(transform)) < 0.0f
+   );
+
    // Processes all the node's meshes(if any).
    for (size_t i = 0; i < node->mNumMeshes; i++)
    {
-      aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-      processMesh(mesh, scene);
+      const unsigned int meshID = node->mMeshes[i];
+      // (mesh + if it's the mirrored copy)
+      const uint64_t key = (uint64_t(meshID) << 1) | isMirrored;
+
+      auto it = meshesID.find(key);
+
+      if (it == meshesID.end())
+      {
+         const size_t meshIndex = meshesID.size();
+         aiMesh* mesh = scene->mMeshes[meshID];
+
+         if (isMirrored)
+         {
+            flipWinding(mesh);
+            processMesh(mesh, scene);
+            // (the mesh can also be used by other nodes)
+            flipWinding(mesh);
+         } else
+            processMesh(mesh, scene);
+
+         it = meshesID.emplace(key, meshIndex).first;
+      }
+
+      addMeshInstance(it->second, transform);
    }
 
    // Processes all the node's childrens(if any).
    for (size_t i = 0; i < node->mNumChildren; i++)
-      processNode(node->mChildren[i], scene);
+      processNode(node->mChildren[i], scene, transform, meshesID);
 }
 
+/*
+ * -By default the transforms of the nodes are ignored.
+ */
+void Model::addMeshInstance(
+      const size_t meshIndex,
+      const glm::mat4& nodeTransform
+) {}
+
 void Model::loadModel(const char* pathToModel)
 {
    unsigned int flags;
 
+   // The vertices of the PBR models aren't pretransformed, so the meshes
+   // referenced by several nodes are loaded once and drawn instanced.
    if (m_type == ModelType::NORMAL_PBR)
    {
       flags = (
             aiProcess_Triangulate |
             aiProcess_FlipUVs |
-            aiProcess_CalcTangentSpace |
-            aiProcess_PreTransformVertices
+            aiProcess_CalcTangentSpace
       );
    } else
    {
@@ -98,22 +178,20 @@ void Model::loadModel(const char* pathToModel)
       );
    }
 
-   processNode(scene->mRootNode, scene);
+   std::unordered_map<uint64_t, size_t> meshesID;
+
+   processNode(scene->mRootNode, scene, glm::mat4(1.0f), meshesID);
+
+   meshOptimizer::printReport(m_name, m_geometryReport);
 }
 
 void Model::upload(
       const VkPhysicalDevice& physicalDevice,
       const VkDevice& logicalDevice,
       const VkQueue& graphicsQueue,
-      const std::shared_ptr<CommandPool>& commandPool,
-      const uint32_t uboCount
+      const std::shared_ptr<CommandPool>& commandPool
 ) {
-   uploadVertexData(
-         physicalDevice,
-         logicalDevice,
-         graphicsQueue,
-         commandPool
-   );
+   // (the vertex data is uploaded by the scene to the geometry buffers)
    uploadTextures(
          physicalDevice,
          logicalDevice,
@@ -121,11 +199,6 @@ void Model::upload(
          commandPool,
          graphicsQueue
    );
-   createUniformBuffers(
-         physicalDevice,
-         logicalDevice,
-         uboCount
-   );
 
 }
 
@@ -144,18 +217,23 @@ const glm::fvec3& Model::getSize() const
    return m_size;
 }
 
+// (the GUI sets them every frame, so they are only marked as dirty if they
+// change)
 void Model::setPos(const glm::fvec4& newPos)
 {
+   m_isDirty = m_isDirty || newPos != m_pos;
    m_pos = newPos;
 }
 
 void Model::setRot(const glm::fvec3& newRot)
 {
+   m_isDirty = m_isDirty || newRot != m_rot;
    m_rot = newRot;
 }
 
 void Model::setSize(const glm::fvec3& newSize)
 {
+   m_isDirty = m_isDirty || newSize != m_size;
    m_size = newSize;
 }
 
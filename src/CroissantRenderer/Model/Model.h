@@ -11,10 +11,12 @@
 #include <assimp/postprocess.h>
 
 #include <CroissantRenderer/Model/Mesh.h>
+#include <CroissantRenderer/Model/meshOptimizer.h>
 #include <CroissantRenderer/Texture/Texture.h>
 #include <CroissantRenderer/Command/CommandPool.h>
 #include <CroissantRenderer/Descriptor/DescriptorInfo.h>
 #include <CroissantRenderer/Descriptor/Types/UBO/UBO.h>
+#include <CroissantRenderer/Descriptor/Types/UBO/UniformRing.h>
 #include <CroissantRenderer/Descriptor/Types/UBO/UBOinfo.h>
 #include <CroissantRenderer/Descriptor/DescriptorSets.h>
 #include <CroissantRenderer/Features/ShadowMap.h>
@@ -45,8 +47,7 @@ public:
          const VkPhysicalDevice& physicalDevice,
          const VkDevice& logicalDevice,
          const VkQueue& graphicsQueue,
-         const std::shared_ptr<CommandPool>& commandPool,
-         const uint32_t uboCount
+         const std::shared_ptr<CommandPool>& commandPool
    );
    virtual void bindData(
          const Graphics* graphicsPipeline,
@@ -60,7 +61,7 @@ public:
          DescriptorPool& descriptorPool
    ) = 0;
    virtual void updateUBO(
-      const VkDevice& logicalDevice,
+      UniformRing& uniformRing,
       const uint32_t& currentFrame,
       const UBOinfo& uboInfo
    ) = 0;
@@ -70,6 +71,8 @@ public:
    const glm::fvec3& getRot() const;
    const glm::fvec3& getSize() const;
    const bool isHidden() const;
+   const bool isDirty() const;
+   void clearDirty();
    void setPos(const glm::fvec4& newPos);
    void setRot(const glm::fvec3& newRot);
    void setSize(const glm::fvec3& newSize);
@@ -78,13 +81,11 @@ public:
 protected:
 
    virtual void processMesh(aiMesh* mesh, const aiScene* scene) = 0;
+   virtual void addMeshInstance(
+         const size_t meshIndex,
+         const glm::mat4& nodeTransform
+   );
    void loadModel(const char* pathToModel);
-   virtual void uploadVertexData(
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         const VkQueue& graphicsQueue,
-         const std::shared_ptr<CommandPool>& commandPool
-   ) = 0;
    virtual void uploadTextures(
          const VkPhysicalDevice& physicalDevice,
          const VkDevice& logicalDevice,
@@ -92,32 +93,40 @@ protected:
          const std::shared_ptr<CommandPool>& commandPool,
          const VkQueue& graphicsQueue
    ) = 0;
-   virtual void createUniformBuffers(
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         const uint32_t& uboCount
-   ) = 0;
 
 
    ModelType            m_type;
    std::string          m_name;
    std::string          m_folderName;
-   std::shared_ptr<UBO> m_ubo;
+   // Offset of the UBO of each frame in flight in the uniform ring(written by
+   // updateUBO()).
+   std::vector<uint32_t> m_uboOffsets;
 
    glm::fvec4           m_pos;
    glm::fvec3           m_rot;
    glm::fvec3           m_size;
 
    bool                 m_hideStatus;
+   // Set when a property of the model changes, until it's cleared by the one
+   // who uploads it(e.g. the lights buffer of the scene).
+   bool                 m_isDirty;
 
    // We need these to not reload the textures again if they are used multiple
    // times in different(or in the same) meshes.
    std::vector<std::shared_ptr<Texture>>   m_texturesLoaded;
    std::unordered_map<std::string, size_t> m_texturesID;
 
+   // Stats of the optimization of the meshes(filled by processMesh()).
+   meshOptimizer::Report                   m_geometryReport;
+
 
 private:
 
-   void processNode(aiNode* node, const aiScene* scene);
+   void processNode(
+         aiNode* node,
+         const aiScene* scene,
+         const glm::mat4& parentTransform,
+         std::unordered_map<uint64_t, size_t>& meshesID
+   );
 
 };
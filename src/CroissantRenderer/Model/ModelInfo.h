@@ -24,4 +24,15 @@ struct ModelInfo
    // For light models.
    LightType   lType;
    glm::fvec3  endPos;
+
+   // For PBR models.
+   // Transforms of the copies of the model(relative to pos, rot and size).
+   // If it's empty, there is only one copy.
+   std::vector<glm::mat4> instances;
+   // Its least detailed LOD hides the rest of the meshes in the software
+   // occlusion culling.
+   bool isOccluder = false;
+   // Features of the lighting of its materials(see materialFeatures).
+   bool receivesShadows = true;
+   bool usesIBL = true;
 };
@@ -2,8 +2,6 @@
 
 #include <CroissantRenderer/Settings/graphicsPipelineConfig.h>
 #include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
-#include <CroissantRenderer/Descriptor/Types/UBO/UBOutils.h>
-#include <CroissantRenderer/Buffer/bufferManager.h>
 #include <CroissantRenderer/Math/mathUtils.h>
 #include <CroissantRenderer/Texture/Type/NormalTexture.h>
 #include <CroissantRenderer/Command/commandManager.h>
@@ -19,7 +17,8 @@ Light::Light(const ModelInfo& modelInfo)
     ),
     m_targetPos(glm::fvec4(modelInfo.endPos, 1.0f)),
     m_color(glm::fvec4(modelInfo.color, 1.0f)),
-    m_lightType(modelInfo.lType)
+    m_lightType(modelInfo.lType),
+    m_opGeometryBuffer(nullptr)
 {
    if (modelInfo.lType == LightType::DIRECTIONAL_LIGHT)
       m_intensity = 3.0f;
@@ -41,31 +40,8 @@ Light::~Light() {}
 
 void Light::destroy(const VkDevice& logicalDevice)
 {
-   m_ubo->destroy();
-
    for (auto& texture : m_texturesLoaded)
       texture->destroy();
-
-   for (auto& mesh : m_meshes)
-   {
-      bufferManager::destroyBuffer(
-            logicalDevice,
-            mesh.vertexBuffer
-      );
-      bufferManager::destroyBuffer(
-            logicalDevice,
-            mesh.indexBuffer
-      );
-      
-      bufferManager::freeMemory(
-            logicalDevice,
-            mesh.vertexMemory
-      );
-      bufferManager::freeMemory(
-            logicalDevice,
-            mesh.indexMemory
-      );
-   }
 }
 
 void Light::processMesh(aiMesh* mesh, const aiScene* scene)
@@ -98,28 +74,18 @@ void Light::processMesh(aiMesh* mesh, const aiScene* scene)
          newMesh.indices.emplace_back(face.mIndices[j]);
    }
 
+   meshOptimizer::optimize(newMesh, m_geometryReport);
+
    m_meshes.emplace_back(newMesh);
 }
 
-void Light::createUniformBuffers(
-      const VkPhysicalDevice& physicalDevice,
-      const VkDevice& logicalDevice,
-      const uint32_t& uboCount
-) {
-   m_ubo = std::make_shared<UBO>(
-         physicalDevice,
-         logicalDevice,
-         uboCount,
-         sizeof(DescriptorTypes::UniformBufferObject::Light)
-   );
-}
 void Light::createDescriptorSets(
       const VkDevice& logicalDevice,
       const VkDescriptorSetLayout& descriptorSetLayout,
       DescriptorSetInfo* info,
       DescriptorPool& descriptorPool
 ) {
-   std::vector<UBO*> opUBOs = {m_ubo.get()};
+   std::vector<UBO*> opUBOs = {info->uniformRing};
 
    for (auto& mesh : m_meshes)
    {
@@ -141,26 +107,10 @@ void Light::bindData(
       const VkCommandBuffer& commandBuffer,
       const uint32_t currentFrame
 ) {
+   VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+
    for (auto& mesh : m_meshes)
    {
-      commandManager::state::bindVertexBuffers(
-            {mesh.vertexBuffer},
-            // Offsets.
-            {0},
-            // Index of first binding.
-            0,
-            // Bindings count.
-            1,
-            commandBuffer
-      );
-      commandManager::state::bindIndexBuffer(
-            mesh.indexBuffer,
-            // Offset.
-            0,
-            VK_INDEX_TYPE_UINT32,
-            commandBuffer
-      );
-
       commandManager::state::bindDescriptorSets(
             graphicsPipeline->getPipelineLayout(),
             PipelineType::GRAPHICS,
@@ -168,61 +118,35 @@ void Light::bindData(
             0,
             {mesh.descriptorSets.get(currentFrame)},
             // Dynamic offsets.
-            {},
+            {m_uboOffsets[currentFrame]},
             commandBuffer
       );
 
-      commandManager::action::drawIndexed(
-            // Index Count
-            mesh.indices.size(),
+      m_opGeometryBuffer->drawIndexed(
+            mesh,
+            // LOD
+            0,
             // Instance Count
             1,
-            // First index.
-            0,
-            // Vertex Offset.
-            0,
-            // First Intance.
+            // First Instance
             0,
+            boundIndexType,
             commandBuffer
       );
    }
 }
 
+/*
+ * -Reserves the range of each mesh in the geometry buffer and records the
+ * copy of its data(the batch is submitted by the caller).
+ */
 void Light::uploadVertexData(
-      const VkPhysicalDevice& physicalDevice,
-      const VkDevice& logicalDevice,
-      const VkQueue& graphicsQueue,
-      const std::shared_ptr<CommandPool>& commandPool
+      GeometryBuffer<Attributes::LIGHT::Vertex>& geometryBuffer,
+      UploadBatch& uploadBatch
 ) {
+   geometryBuffer.add(m_meshes, uploadBatch);
 
-   for (auto& mesh : m_meshes)
-   {
-      // Vertex Buffer(with staging buffer)
-      bufferManager::createBufferAndTransferToDevice(
-            commandPool,
-            physicalDevice,
-            logicalDevice,
-            mesh.vertices.data(),
-            sizeof(mesh.vertices[0]) * mesh.vertices.size(),
-            graphicsQueue,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            mesh.vertexMemory,
-            mesh.vertexBuffer
-         );
-
-      // Index Buffer(with staging buffer)
-      bufferManager::createBufferAndTransferToDevice(
-            commandPool,
-            physicalDevice,
-            logicalDevice,
-            mesh.indices.data(),
-            sizeof(mesh.indices[0]) * mesh.indices.size(),
-            graphicsQueue,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            mesh.indexMemory,
-            mesh.indexBuffer
-      );
-   }
+   m_opGeometryBuffer = &geometryBuffer;
 }
 
 void Light::uploadTextures(
@@ -270,7 +194,7 @@ void Light::uploadTextures(
 }
 
 void Light::updateUBO(
-      const VkDevice& logicalDevice,
+      UniformRing& uniformRing,
       const uint32_t& currentFrame,
       const UBOinfo& uboInfo
 ) {
@@ -285,12 +209,9 @@ void Light::updateUBO(
 
    m_dataInShader.lightColor = m_color;
 
-   size_t size = sizeof(m_dataInShader);
-   UBOutils::updateUBO(
-         logicalDevice,
-         m_ubo,
-         size,
+   m_uboOffsets[currentFrame] = uniformRing.push(
          &m_dataInShader,
+         sizeof(m_dataInShader),
          currentFrame
    );
 }
@@ -315,18 +236,26 @@ const LightType& Light::getLightType() const
    return m_lightType;
 }
 
+const std::vector<Mesh<Attributes::LIGHT::Vertex>>& Light::getMeshes() const
+{
+   return m_meshes;
+}
+
 void Light::setColor(const glm::fvec4& newColor)
 {
+   m_isDirty = m_isDirty || newColor != m_color;
    m_color = newColor;
 }
 
 void Light::setTargetPos(const glm::fvec4& pos)
 {
+   m_isDirty = m_isDirty || pos != m_targetPos;
    m_targetPos = pos;
 }
 
 void Light::setIntensity(const float& intensity)
 {
+   m_isDirty = m_isDirty || intensity != m_intensity;
    m_intensity = intensity;
 }
 
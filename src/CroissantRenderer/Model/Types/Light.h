@@ -3,6 +3,8 @@
 #include <CroissantRenderer/Model/Model.h>
 #include <CroissantRenderer/Model/ModelInfo.h>
 #include <CroissantRenderer/Features/ShadowMap.h>
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
+#include <CroissantRenderer/Buffer/UploadBatch.h>
 
 #include <GLFW/glfw3.h>
 
@@ -26,15 +28,20 @@ public:
          const uint32_t currentFrame
    ) override;
    void updateUBO(
-         const VkDevice& logicalDevice,
+         UniformRing& uniformRing,
          const uint32_t& currentFrame,
          const UBOinfo& uboInfo
    ) override;
+   void uploadVertexData(
+         GeometryBuffer<Attributes::LIGHT::Vertex>& geometryBuffer,
+         UploadBatch& uploadBatch
+   );
 
    const glm::fvec4& getColor() const;
    const glm::fvec4& getTargetPos() const;
    const float& getIntensity() const;
    const LightType& getLightType() const;
+   const std::vector<Mesh<Attributes::LIGHT::Vertex>>& getMeshes() const;
    void setColor(const glm::fvec4& newColor);
    void setIntensity(const float& intensity);
    void setTargetPos(const glm::fvec4& pos);
@@ -42,17 +49,6 @@ public:
 
 private:
 
-   void createUniformBuffers(
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         const uint32_t& uboCount
-   ) override;
-   void uploadVertexData(
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         const VkQueue& graphicsQueue,
-         const std::shared_ptr<CommandPool>& commandPool
-   ) override;
    void uploadTextures(
          const VkPhysicalDevice& physicalDevice,
          const VkDevice& logicalDevice,
@@ -69,5 +65,7 @@ private:
    LightType  m_lightType;
 
    std::vector<Mesh<Attributes::LIGHT::Vertex>> m_meshes;
+   // (set by uploadVertexData())
+   const GeometryBuffer<Attributes::LIGHT::Vertex>* m_opGeometryBuffer;
    DescriptorTypes::UniformBufferObject::Light m_dataInShader;
 };
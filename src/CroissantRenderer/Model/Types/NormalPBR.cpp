@@ -1,11 +1,19 @@
 #include <CroissantRenderer/Model/Types/NormalPBR.h>
 
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <set>
+
 #include <CroissantRenderer/Settings/graphicsPipelineConfig.h>
 #include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
-#include <CroissantRenderer/Descriptor/Types/UBO/UBOutils.h>
-#include <CroissantRenderer/Buffer/bufferManager.h>
-#include <CroissantRenderer/Model/Types/Light.h>
 #include <CroissantRenderer/Math/mathUtils.h>
+#include <CroissantRenderer/Model/meshSimplifier.h>
+#include <CroissantRenderer/Model/materialFeatures.h>
+#include <CroissantRenderer/Culling/frustumCulling.h>
+#include <CroissantRenderer/Culling/MaskedOcclusion.h>
+#include <CroissantRenderer/Culling/GPUculling.h>
 #include <CroissantRenderer/Texture/Type/NormalTexture.h>
 #include <CroissantRenderer/Command/commandManager.h>
 
@@ -17,8 +25,26 @@ NormalPBR::NormalPBR(const ModelInfo& modelInfo)
       glm::fvec4(modelInfo.pos, 1.0f),
       modelInfo.rot,
       modelInfo.size
+   ),
+   m_opGeometryBuffer(nullptr),
+   m_opTextures(nullptr),
+   m_firstMaterial(0),
+   m_instances(modelInfo.instances),
+   m_firstInstance(0),
+   m_opVisibleInstances(nullptr),
+   m_pixelsPerUnit(0.0f),
+   m_opGPUculling(nullptr),
+   m_firstDrawIndex(0),
+   m_draws16Count(0),
+   m_isOccluder(modelInfo.isOccluder),
+   m_lightingFeatures(
+      ((modelInfo.receivesShadows) ? materialFeatures::RECEIVES_SHADOWS : 0) |
+      ((modelInfo.usesIBL) ? materialFeatures::IBL : 0)
    )
 {
+   if (m_instances.size() == 0)
+      m_instances.push_back(glm::mat4(1.0f));
+
    loadModel(
          (
             std::string(MODEL_DIR) +
@@ -32,33 +58,8 @@ NormalPBR::~NormalPBR() {}
 
 void NormalPBR::destroy(const VkDevice& logicalDevice)
 {
-   m_ubo->destroy();
-   m_uboLights->destroy();
-
    for (auto& texture : m_texturesLoaded) 
       texture->destroy();
-
-   for (auto& mesh : m_meshes)
-   {
-
-      bufferManager::destroyBuffer(
-            logicalDevice,
-            mesh.vertexBuffer
-      );
-      bufferManager::destroyBuffer(
-            logicalDevice,
-            mesh.indexBuffer
-      );
-      
-      bufferManager::freeMemory(
-            logicalDevice,
-            mesh.vertexMemory
-      );
-      bufferManager::freeMemory(
-            logicalDevice,
-            mesh.indexMemory
-      );
-   }
 }
 
 void NormalPBR::getMaterialTextureInfo(
@@ -66,6 +67,8 @@ void NormalPBR::getMaterialTextureInfo(
       const aiTextureType& type,
       const std::string& typeName,
       const std::string& defaultTextureFile,
+      const uint32_t feature,
+      uint32_t& materialKey,
       TextureToLoadInfo& info
 ) {
    if (material->GetTextureCount(type) > 0)
@@ -73,11 +76,7 @@ void NormalPBR::getMaterialTextureInfo(
       aiString str;
       material->GetTexture(type, 0, &str);
 
-      if (typeName == "NORMALS")
-         m_dataInShader.hasNormalMap = 1;
-
-      if (typeName == "METALIC_ROUGHNESS")
-         m_dataInShader.hasMetallicRoughnessMap = 1;
+      materialKey |= feature;
 
       info.folderName = m_folderName;
 
@@ -85,12 +84,8 @@ void NormalPBR::getMaterialTextureInfo(
 
    } else
    {
-      if (typeName == "NORMALS")
-         m_dataInShader.hasNormalMap = 0;
-
-      if (typeName == "METALIC_ROUGHNESS")
-         m_dataInShader.hasMetallicRoughnessMap = 0;
-
+      // (still loaded, but only the base color is read without its
+      // feature)
       info.folderName = "/defaultTextures";
 
       info.name = defaultTextureFile;
@@ -103,17 +98,18 @@ void NormalPBR::processMesh(aiMesh* mesh, const aiScene* scene)
 
    for (size_t i = 0; i < mesh->mNumVertices; i++)
    {
-      Attributes::PBR::Vertex vertex{};
-
-      vertex.pos = {
+      const glm::vec3 pos = {
          mesh->mVertices[i].x,
          mesh->mVertices[i].y,
          mesh->mVertices[i].z
       };
+      glm::vec3 normal;
+      glm::vec2 texCoord;
+      glm::vec4 tangent;
 
       if (mesh->mNormals != NULL)
       {
-         vertex.normal = glm::normalize(
+         normal = glm::normalize(
                glm::fvec3(
                   mesh->mNormals[i].x,
                   mesh->mNormals[i].y,
@@ -126,30 +122,50 @@ void NormalPBR::processMesh(aiMesh* mesh, const aiScene* scene)
       if (mesh->mTextureCoords[0] != NULL)
       {
 
-         vertex.texCoord = {
+         texCoord = {
             mesh->mTextureCoords[0][i].x,
             mesh->mTextureCoords[0][i].y,
          };
 
       } else
-         vertex.texCoord = glm::fvec3(1.0f);
+         texCoord = glm::fvec2(1.0f);
 
       if (mesh->mTangents != NULL)
       {
-         vertex.tangent = glm::normalize(
+         const glm::vec3 t = glm::normalize(
                glm::fvec3(
                   mesh->mTangents[i].x,
                   mesh->mTangents[i].y,
                   mesh->mTangents[i].z
                )
          );
+         // The shader recomputes the bitangent as cross(N, T), so only its
+         // sign is kept(mirrored uvs).
+         float bitangentSign = 1.0f;
+
+         if (mesh->mBitangents != NULL)
+         {
+            const glm::vec3 bitangent(
+                  mesh->mBitangents[i].x,
+                  mesh->mBitangents[i].y,
+                  mesh->mBitangents[i].z
+            );
+
+            if (glm::dot(glm::cross(normal, t), bitangent) < 0.0f)
+               bitangentSign = -1.0f;
+         }
+
+         tangent = glm::fvec4(t, bitangentSign);
       } else
-         vertex.tangent = glm::fvec3(1.0f);
+         tangent = glm::fvec4(glm::normalize(glm::fvec3(1.0f)), 1.0f);
 
-      //glm::vec3 bitangent = glm::cross(vertex.normal, tangent);
+      const Attributes::PBR::Vertex vertex = Attributes::PBR::createVertex(
+            pos,
+            texCoord,
+            normal,
+            tangent
+      );
 
-      vertex.posInLightSpace = glm::fvec4(1.0f);
-      
       newMesh.vertices.emplace_back(vertex);
 
    }
@@ -162,6 +178,14 @@ void NormalPBR::processMesh(aiMesh* mesh, const aiScene* scene)
    }
 
 
+   // (the indices of the textures are set by reserveMaterials())
+   DescriptorTypes::StorageBufferObject::Material materialData{};
+   materialData.metallicFactor = 1.0f;
+   materialData.roughnessFactor = 1.0f;
+   materialData.lightingFeatures = m_lightingFeatures;
+   // (see materialFeatures)
+   uint32_t materialKey = m_lightingFeatures;
+
    if (mesh->mMaterialIndex >= 0)
    {
 
@@ -171,12 +195,12 @@ void NormalPBR::processMesh(aiMesh* mesh, const aiScene* scene)
       aiGetMaterialFloat(
             material,
             AI_MATKEY_METALLIC_FACTOR,
-            &m_dataInShader.metallicFactor
+            &materialData.metallicFactor
       );
       aiGetMaterialFloat(
             material,
             AI_MATKEY_ROUGHNESS_FACTOR,
-            &m_dataInShader.roughnessFactor
+            &materialData.roughnessFactor
       );
 
       // Material Textures
@@ -187,6 +211,8 @@ void NormalPBR::processMesh(aiMesh* mesh, const aiScene* scene)
          std::string   defaultTextureFile;
          VkFormat      format;
          int           desiredChannels;
+         // (bit of the key if the mesh has the texture)
+         uint32_t      feature;
       };
 
       std::vector<materialInfo> materials =
@@ -196,35 +222,40 @@ void NormalPBR::processMesh(aiMesh* mesh, const aiScene* scene)
             "DIFFUSE",
             "baseColor.png",
             VK_FORMAT_R8G8B8A8_SRGB,
-            4
+            4,
+            0
          },
          {
             aiTextureType_UNKNOWN,
             "METALIC_ROUGHNESS",
             "metallicRoughness.png",
             VK_FORMAT_R8G8B8A8_SRGB,
-            4
+            4,
+            materialFeatures::METALLIC_ROUGHNESS_MAP
          },
          {
             aiTextureType_EMISSIVE,
             "EMISSIVE",
             "emissiveColor.png",
             VK_FORMAT_R8G8B8A8_SRGB,
-            4
+            4,
+            materialFeatures::EMISSIVE_MAP
          },
          {
             aiTextureType_LIGHTMAP,
             "AO",
             "ambientOcclusion.png",
             VK_FORMAT_R8G8B8A8_SRGB,
-            4
+            4,
+            materialFeatures::AO_MAP
          },
          {
             aiTextureType_NORMALS,
             "NORMALS",
             "baseColor.png",
             VK_FORMAT_R8G8B8A8_UNORM,
-            4
+            4,
+            materialFeatures::NORMAL_MAP
          }
       };
 
@@ -237,6 +268,8 @@ void NormalPBR::processMesh(aiMesh* mesh, const aiScene* scene)
                m.type,
                m.typeName,
                m.defaultTextureFile,
+               m.feature,
+               materialKey,
                info
          );
 
@@ -248,78 +281,205 @@ void NormalPBR::processMesh(aiMesh* mesh, const aiScene* scene)
 
    }
 
+   meshOptimizer::optimize(newMesh, m_geometryReport);
+   frustumCulling::computeBounds(newMesh);
+   meshSimplifier::generateLODs(newMesh);
+
+   if (m_isOccluder)
+      addOccluderMesh(newMesh);
+
    m_meshes.emplace_back(newMesh);
+   m_materials.push_back(materialData);
+   m_materialKeys.push_back(materialKey);
 }
 
-void NormalPBR::createUniformBuffers(
-      const VkPhysicalDevice& physicalDevice,
-      const VkDevice& logicalDevice,
-      const uint32_t& uboCount
+/*
+ * -Copies the least detailed LOD of the mesh as an occluder(only the
+ * positions of the vertices that it uses).
+ */
+void NormalPBR::addOccluderMesh(const Mesh<Attributes::PBR::Vertex>& mesh)
+{
+   OccluderMesh occluderMesh;
+
+   if (mesh.lods.size() == 0)
+   {
+      m_occluderMeshes.push_back(occluderMesh);
+      return;
+   }
+
+   const MeshLOD& lod = mesh.lods.back();
+   // (new index of each vertex of the mesh)
+   std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+
+   occluderMesh.indices.reserve(lod.indicesCount);
+
+   for (uint32_t i = lod.firstIndex; i < lod.firstIndex + lod.indicesCount; i++)
+   {
+      const uint32_t index = mesh.indices[i];
+
+      if (remap[index] == UINT32_MAX)
+      {
+         remap[index] = occluderMesh.vertices.size();
+         occluderMesh.vertices.push_back(mesh.vertices[index].pos);
+      }
+
+      occluderMesh.indices.push_back(remap[index]);
+   }
+
+   m_occluderMeshes.push_back(occluderMesh);
+}
+
+void NormalPBR::addMeshInstance(
+      const size_t meshIndex,
+      const glm::mat4& nodeTransform
 ) {
-   m_ubo = std::make_shared<UBO>(
-         physicalDevice,
-         logicalDevice,
-         uboCount,
-         sizeof(DescriptorTypes::UniformBufferObject::NormalPBR)
-   );
-   m_uboLights = std::make_shared<UBO>(
-         physicalDevice,
-         logicalDevice,
-         uboCount,
-         sizeof(DescriptorTypes::UniformBufferObject::LightInfo) * 10
-   );
+   m_meshes[meshIndex].nodeTransforms.push_back(nodeTransform);
 }
 
+/*
+ * -All the meshes share the same descriptor sets(the materials are indexed
+ * by instance), so they are bound once per model:
+ *    - With the GPU culling, the commands of all the meshes(and LODs) with
+ *      the same index type are drawn with one multi-draw.
+ *    - Otherwise each mesh is drawn once per LOD, with all its visible
+ *      instances of that LOD.
+ */
 void NormalPBR::bindData(
       const Graphics* graphicsPipeline,
       const VkCommandBuffer& commandBuffer,
       const uint32_t currentFrame
 ) {
+   bindMeshes(graphicsPipeline, std::nullopt, commandBuffer, currentFrame);
+}
 
-   for (auto& mesh : m_meshes)
+/*
+ * -Only draws the meshes whose material has the key of the variant of the
+ * pipeline bound(see materialFeatures).
+ */
+void NormalPBR::bindData(
+      const Graphics* graphicsPipeline,
+      const uint32_t materialKey,
+      const VkCommandBuffer& commandBuffer,
+      const uint32_t currentFrame
+) {
+   // (none of its meshes use the variant)
+   if (std::find(
+            m_materialKeys.begin(),
+            m_materialKeys.end(),
+            materialKey
+      ) == m_materialKeys.end()
+   ) {
+      return;
+   }
+
+   bindMeshes(graphicsPipeline, materialKey, commandBuffer, currentFrame);
+}
+
+void NormalPBR::bindMeshes(
+      const Graphics* graphicsPipeline,
+      const std::optional<uint32_t>& materialKey,
+      const VkCommandBuffer& commandBuffer,
+      const uint32_t currentFrame
+) {
+
+   commandManager::state::bindDescriptorSets(
+         graphicsPipeline->getPipelineLayout(),
+         PipelineType::GRAPHICS,
+         // Index of first descriptor set.
+         0,
+         {
+            m_descriptorSets.get(currentFrame),
+            // (GRAPHICS_PIPELINE::PBR::TEXTURES_SET)
+            m_opTextures->getDescriptorSet()
+         },
+         // Dynamic offsets.
+         {m_uboOffsets[currentFrame]},
+         commandBuffer
+   );
+
+   VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+
+   // (culled and LOD selected by the GPU, one command per LOD of each mesh
+   // and the unused ones are left empty)
+   if (m_opGPUculling != nullptr)
    {
-      commandManager::state::bindVertexBuffers(
-            {mesh.vertexBuffer},
-            // Offsets.
-            {0},
-            // Index of first binding.
-            0,
-            // Bindings count.
-            1,
+      const uint32_t maxLODs = (
+            DescriptorTypes::StorageBufferObject::CULLING_MAX_LODS
+      );
+
+      // (one multi-draw per range of commands with the key)
+      if (materialKey.has_value())
+      {
+         for (const auto& range : m_indirectRanges)
+         {
+            if (range.materialKey != materialKey.value())
+               continue;
+
+            m_opGeometryBuffer->drawIndexedIndirect(
+                  range.indexType,
+                  m_opGPUculling->getIndirectBuffer(currentFrame),
+                  m_opGPUculling->getCommandOffset(range.firstDrawIndex),
+                  // Draw count
+                  range.drawsCount * maxLODs,
+                  boundIndexType,
+                  commandBuffer
+            );
+         }
+
+         return;
+      }
+
+      m_opGeometryBuffer->drawIndexedIndirect(
+            VK_INDEX_TYPE_UINT16,
+            m_opGPUculling->getIndirectBuffer(currentFrame),
+            m_opGPUculling->getCommandOffset(m_firstDrawIndex),
+            // Draw count
+            m_draws16Count * maxLODs,
+            boundIndexType,
             commandBuffer
       );
-      commandManager::state::bindIndexBuffer(
-            mesh.indexBuffer,
-            // Offset.
-            0,
+      m_opGeometryBuffer->drawIndexedIndirect(
             VK_INDEX_TYPE_UINT32,
+            m_opGPUculling->getIndirectBuffer(currentFrame),
+            m_opGPUculling->getCommandOffset(
+               m_firstDrawIndex + m_draws16Count
+            ),
+            // Draw count
+            (m_meshes.size() - m_draws16Count) * maxLODs,
+            boundIndexType,
             commandBuffer
       );
 
-      commandManager::state::bindDescriptorSets(
-            graphicsPipeline->getPipelineLayout(),
-            PipelineType::GRAPHICS,
-            // Index of first descriptor set.
-            0,
-            {mesh.descriptorSets.get(currentFrame)},
-            // Dynamic offsets.
-            {},
-            commandBuffer
-      );
+      return;
+   }
 
-      commandManager::action::drawIndexed(
-            // Index Count
-            mesh.indices.size(),
-            // Instance Count
-            1,
-            // First index.
-            0,
-            // Vertex Offset.
-            0,
-            // First Intance.
-            0,
-            commandBuffer
-      );
+   for (size_t i = 0; i < m_meshes.size(); i++)
+   {
+      if (materialKey.has_value() && m_materialKeys[i] != materialKey.value())
+         continue;
+
+      auto& mesh = m_meshes[i];
+      const auto& visibleInstancesCounts = m_visibleInstancesCounts[i];
+
+      for (uint32_t lod = 0; lod < mesh.lods.size(); lod++)
+      {
+         // (all the instances of the LOD are outside of the frustum of the
+         // camera)
+         if (visibleInstancesCounts[lod] == 0)
+            continue;
+
+         m_opGeometryBuffer->drawIndexed(
+               mesh,
+               lod,
+               // Instance Count
+               visibleInstancesCounts[lod],
+               // First Instance(the visible list of the LOD)
+               mesh.firstVisibleInstance +
+               (config::SHADOW_CASCADES_COUNT + lod) * mesh.instancesCount,
+               boundIndexType,
+               commandBuffer
+         );
+      }
    }
 }
 
@@ -331,60 +491,334 @@ void NormalPBR::createDescriptorSets(
       DescriptorPool& descriptorPool
 ) {
    std::vector<UBO*> opUBOs = {
-      (m_ubo.get()),
-      (m_uboLights.get())
+      info->uniformRing,
+      info->lights,
+      info->instances,
+      info->visibleInstances,
+      info->instanceMaterials,
+      info->materials,
+      info->clustersFrame,
+      info->lightGrid,
+      info->lightIndices,
+      info->shadowAtlasTiles
    };
 
-   for (auto& mesh : m_meshes)
+   m_opVisibleInstances = info->visibleInstances;
+   m_opTextures = info->textures;
+
+   m_descriptorSets = DescriptorSets(
+         logicalDevice,
+         GRAPHICS_PIPELINE::PBR::UBOS_INFO,
+         GRAPHICS_PIPELINE::PBR::SAMPLERS_INFO,
+         // (the textures of the meshes are in the texture table)
+         {},
+         descriptorSetLayout,
+         descriptorPool,
+         info,
+         opUBOs
+   );
+}
+
+/*
+ * -Reserves the range of each mesh in the geometry buffer and records the
+ * copy of its data(the batch is submitted by the caller).
+ */
+void NormalPBR::uploadVertexData(
+      GeometryBuffer<Attributes::PBR::Vertex>& geometryBuffer,
+      UploadBatch& uploadBatch
+) {
+   geometryBuffer.add(m_meshes, uploadBatch);
+
+   m_opGeometryBuffer = &geometryBuffer;
+}
+
+/*
+ * -Reserves the instances of the meshes from firstInstance(in the instances
+ * buffer) and their visible lists from firstVisibleInstance(in the visible
+ * instances buffer). Both are advanced to the next free ones.
+ * -Each copy of the model has an instance of every node of each mesh.
+ */
+void NormalPBR::reserveInstances(
+      uint32_t& firstInstance,
+      uint32_t& firstVisibleInstance
+) {
+   m_firstInstance = firstInstance;
+   m_instanceTransforms.clear();
+   m_visibleInstancesCounts.resize(m_meshes.size());
+   m_shadowVisibleInstancesCounts.assign(
+         config::SHADOW_CASCADES_COUNT,
+         std::vector<uint32_t>(m_meshes.size(), 0)
+   );
+
+   for (size_t i = 0; i < m_meshes.size(); i++)
    {
-      mesh.descriptorSets = DescriptorSets(
-            logicalDevice,
-            GRAPHICS_PIPELINE::PBR::UBOS_INFO,
-            GRAPHICS_PIPELINE::PBR::SAMPLERS_INFO,
-            mesh.textures,
-            descriptorSetLayout,
-            descriptorPool,
-            info,
-            opUBOs
+      auto& mesh = m_meshes[i];
+
+      mesh.firstInstance = firstInstance;
+      mesh.instancesCount = m_instances.size() * mesh.nodeTransforms.size();
+      mesh.firstVisibleInstance = firstVisibleInstance;
+
+      for (auto& instance : m_instances)
+      {
+         for (auto& nodeTransform : mesh.nodeTransforms)
+            m_instanceTransforms.push_back(instance * nodeTransform);
+      }
+
+      m_visibleInstancesCounts[i].assign(mesh.lods.size(), 0);
+
+      firstInstance += mesh.instancesCount;
+      // (one per cascade of the shadow map + one per LOD)
+      firstVisibleInstance += (
+            mesh.instancesCount *
+            (config::SHADOW_CASCADES_COUNT + mesh.lods.size())
       );
    }
+}
 
+/*
+ * -Copies the transforms of the instances of the model to the mapped
+ * instances buffer of the scene.
+ */
+void NormalPBR::writeInstances(void* instancesData) const
+{
+   std::memcpy(
+         static_cast<glm::mat4*>(instancesData) + m_firstInstance,
+         m_instanceTransforms.data(),
+         sizeof(glm::mat4) * m_instanceTransforms.size()
+   );
 }
 
-void NormalPBR::uploadVertexData(
-      const VkPhysicalDevice& physicalDevice,
-      const VkDevice& logicalDevice,
-      const VkQueue& graphicsQueue,
-      const std::shared_ptr<CommandPool>& commandPool
+/*
+ * -Adds the textures of the meshes to the texture table and reserves their
+ * materials from firstMaterial(in the materials buffer), which is advanced
+ * to the next free one.
+ * -It has to be called after the upload of the textures.
+ */
+void NormalPBR::reserveMaterials(
+      BindlessTextures& textures,
+      uint32_t& firstMaterial
 ) {
+   m_firstMaterial = firstMaterial;
+
+   for (size_t i = 0; i < m_meshes.size(); i++)
+   {
+      const auto& meshTextures = m_meshes[i].textures;
+      auto& materialData = m_materials[i];
+
+      // (same order as the textures loaded by processMesh())
+      materialData.baseColor = textures.add(meshTextures[0].get());
+      materialData.metallicRoughness = textures.add(meshTextures[1].get());
+      materialData.emissive = textures.add(meshTextures[2].get());
+      materialData.AO = textures.add(meshTextures[3].get());
+      materialData.normal = textures.add(meshTextures[4].get());
+   }
+
+   firstMaterial += m_materials.size();
+}
+
+/*
+ * -Copies the materials of the meshes to the mapped materials buffer of the
+ * scene and the index of the material of each instance to the mapped
+ * instance materials buffer.
+ */
+void NormalPBR::writeMaterials(
+      void* materialsData,
+      void* instanceMaterialsData
+) const {
+   std::memcpy(
+         static_cast<DescriptorTypes::StorageBufferObject::Material*>(
+            materialsData
+         ) + m_firstMaterial,
+         m_materials.data(),
+         sizeof(m_materials[0]) * m_materials.size()
+   );
+
+   uint32_t* instanceMaterials = static_cast<uint32_t*>(
+         instanceMaterialsData
+   );
+
+   for (size_t i = 0; i < m_meshes.size(); i++)
+   {
+      const auto& mesh = m_meshes[i];
 
+      std::fill(
+            instanceMaterials + mesh.firstInstance,
+            instanceMaterials + mesh.firstInstance + mesh.instancesCount,
+            static_cast<uint32_t>(m_firstMaterial + i)
+      );
+   }
+}
+
+/*
+ * -Adds the bounds(in world space) of each instance of each mesh.
+ */
+void NormalPBR::addCullingBounds(frustumCulling::Bounds& bounds) const
+{
    for (auto& mesh : m_meshes)
    {
-      // Vertex Buffer(with staging buffer)
-      bufferManager::createBufferAndTransferToDevice(
-            commandPool,
-            physicalDevice,
-            logicalDevice,
-            mesh.vertices.data(),
-            sizeof(mesh.vertices[0]) * mesh.vertices.size(),
-            graphicsQueue,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            mesh.vertexMemory,
-            mesh.vertexBuffer
+      const size_t first = mesh.firstInstance - m_firstInstance;
+
+      for (size_t i = first; i < first + mesh.instancesCount; i++)
+      {
+         frustumCulling::addBounds(
+               m_dataInShader.model * m_instanceTransforms[i],
+               mesh.aabbMin,
+               mesh.aabbMax,
+               bounds
          );
+      }
+   }
+}
 
-      // Index Buffer(with staging buffer)
-      bufferManager::createBufferAndTransferToDevice(
-            commandPool,
-            physicalDevice,
-            logicalDevice,
-            mesh.indices.data(),
-            sizeof(mesh.indices[0]) * mesh.indices.size(),
-            graphicsQueue,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            mesh.indexMemory,
-            mesh.indexBuffer
-      );
+/*
+ * -Adds each instance of the meshes as an occluder(the meshes have to be
+ * kept until the occluders are rendered).
+ */
+void NormalPBR::addOccluders(MaskedOcclusion& maskedOcclusion) const
+{
+   for (size_t i = 0; i < m_occluderMeshes.size(); i++)
+   {
+      const auto& mesh = m_meshes[i];
+      const size_t first = mesh.firstInstance - m_firstInstance;
+
+      for (size_t j = first; j < first + mesh.instancesCount; j++)
+      {
+         maskedOcclusion.addOccluder(
+               m_dataInShader.model * m_instanceTransforms[j],
+               m_occluderMeshes[i]
+         );
+      }
+   }
+}
+
+/*
+ * -Only keeps the features of the mask in the keys of the materials, for the
+ * ones that don't change the variant of the pipeline(the meshes with the
+ * same masked key are drawn together).
+ * (before setIndirectDraws() and the creation of the pipelines)
+ */
+void NormalPBR::maskMaterialKeys(const uint32_t mask)
+{
+   for (auto& materialKey : m_materialKeys)
+      materialKey &= mask;
+}
+
+/*
+ * -Reserves the indirect commands of the meshes from firstDrawIndex. The
+ * meshes with 16-bit indices go first, so each index type is a consecutive
+ * range of commands, and inside of each index type they are sorted by the
+ * key of their material, so each variant of the PBR pipeline draws a
+ * consecutive range too.
+ */
+void NormalPBR::setIndirectDraws(
+      const GPUculling* opGPUculling,
+      const uint32_t firstDrawIndex
+) {
+   m_opGPUculling = opGPUculling;
+   m_firstDrawIndex = firstDrawIndex;
+   m_draws16Count = 0;
+   m_drawIndices.resize(m_meshes.size());
+   m_indirectRanges.clear();
+
+   const std::set<uint32_t> materialKeys(
+         m_materialKeys.begin(),
+         m_materialKeys.end()
+   );
+
+   uint32_t drawIndex = firstDrawIndex;
+
+   for (auto indexType : {VK_INDEX_TYPE_UINT16, VK_INDEX_TYPE_UINT32})
+   {
+      for (const uint32_t materialKey : materialKeys)
+      {
+         IndirectRange range{materialKey, indexType, drawIndex, 0};
+
+         for (size_t i = 0; i < m_meshes.size(); i++)
+         {
+            if (
+                  m_meshes[i].indexType != indexType ||
+                  m_materialKeys[i] != materialKey
+            ) {
+               continue;
+            }
+
+            m_drawIndices[i] = drawIndex;
+            drawIndex++;
+            range.drawsCount++;
+
+            if (indexType == VK_INDEX_TYPE_UINT16)
+               m_draws16Count++;
+         }
+
+         if (range.drawsCount > 0)
+            m_indirectRanges.push_back(range);
+      }
+   }
+}
+
+/*
+ * -Builds the lists of the visible instances of this frame from the results
+ * of the culling of all the scene, where the bounds of this model start at
+ * firstBoundsIndex(see addCullingBounds()). Each instance visible from the
+ * camera goes to the list of its LOD and to the list of each cascade that
+ * it's inside of.
+ */
+void NormalPBR::setVisibleInstances(
+      const std::vector<uint8_t>& isVisible,
+      const std::vector<std::vector<uint8_t>>& isShadowVisible,
+      const size_t firstBoundsIndex,
+      const uint32_t currentFrame
+) {
+   uint32_t* visibleInstances = static_cast<uint32_t*>(
+         m_opVisibleInstances->getAllocation(currentFrame).mappedData
+   );
+   size_t boundsIndex = firstBoundsIndex;
+
+   for (size_t i = 0; i < m_meshes.size(); i++)
+   {
+      const auto& mesh = m_meshes[i];
+      auto& visibleCounts = m_visibleInstancesCounts[i];
+
+      std::fill(visibleCounts.begin(), visibleCounts.end(), 0);
+
+      for (auto& shadowVisibleCounts : m_shadowVisibleInstancesCounts)
+         shadowVisibleCounts[i] = 0;
+
+      for (uint32_t j = 0; j < mesh.instancesCount; j++, boundsIndex++)
+      {
+         const uint32_t instance = mesh.firstInstance + j;
+
+         for (uint32_t c = 0; c < isShadowVisible.size(); c++)
+         {
+            if (!isShadowVisible[c][boundsIndex])
+               continue;
+
+            auto& shadowVisibleCount = m_shadowVisibleInstancesCounts[c][i];
+
+            visibleInstances[
+               mesh.firstVisibleInstance +
+               c * mesh.instancesCount +
+               shadowVisibleCount
+            ] = instance;
+            shadowVisibleCount++;
+         }
+
+         if (!isVisible[boundsIndex])
+            continue;
+
+         const uint32_t lod = selectLOD(
+               mesh,
+               m_dataInShader.model *
+               m_instanceTransforms[instance - m_firstInstance]
+         );
+
+         visibleInstances[
+            mesh.firstVisibleInstance +
+            (config::SHADOW_CASCADES_COUNT + lod) * mesh.instancesCount +
+            visibleCounts[lod]
+         ] = instance;
+         visibleCounts[lod]++;
+      }
    }
 }
 
@@ -441,7 +875,7 @@ const glm::mat4& NormalPBR::getModelM() const
 
 
 void NormalPBR::updateUBO(
-      const VkDevice& logicalDevice,
+      UniformRing& uniformRing,
       const uint32_t& currentFrame,
       const UBOinfo& uboInfo
 ) {
@@ -453,53 +887,108 @@ void NormalPBR::updateUBO(
    );
    m_dataInShader.view = uboInfo.view;
    m_dataInShader.proj = uboInfo.proj;
-   m_dataInShader.lightSpace = uboInfo.lightSpace;
+
+   const ShadowCascades& shadowCascades = uboInfo.shadowCascades;
+
+   for (uint32_t c = 0; c < shadowCascades.count; c++)
+      m_dataInShader.lightSpaces[c] = shadowCascades.lightSpaces[c];
+
+   m_dataInShader.cascadeSplits = shadowCascades.splits;
+   m_dataInShader.cascadesCount = static_cast<int>(shadowCascades.count);
 
    m_dataInShader.cameraPos = uboInfo.cameraPos;
    m_dataInShader.lightsCount = uboInfo.lightsCount;
 
-   size_t size = sizeof(m_dataInShader);
-   UBOutils::updateUBO(
-         logicalDevice,
-         m_ubo,
-         size,
+   // (the sign of proj[1][1] is flipped for Vulkan)
+   m_pixelsPerUnit = (
+         std::abs(uboInfo.proj[1][1]) * 0.5f * uboInfo.extent.height
+   );
+
+   m_uboOffsets[currentFrame] = uniformRing.push(
          &m_dataInShader,
+         sizeof(m_dataInShader),
          currentFrame
    );
 }
 
-void NormalPBR::updateUBOlights(
-      const VkDevice& logicalDevice,
-      const std::vector<size_t> lightModelIndices,
-      const std::vector<std::shared_ptr<Model>>& models,
-      const uint32_t& currentFrame
-) {
-   for (size_t i = 0; i < lightModelIndices.size(); i++)
+/*
+ * -Selects the least detailed LOD of an instance of the mesh whose error,
+ * projected at the closest point of its bounding sphere, is smaller than
+ * config::LOD_PIXEL_ERROR pixels.
+ */
+const uint32_t NormalPBR::selectLOD(
+      const Mesh<Attributes::PBR::Vertex>& mesh,
+      const glm::mat4& model
+) const {
+   const float scale = std::max(
+         glm::length(glm::vec3(model[0])),
+         std::max(
+            glm::length(glm::vec3(model[1])),
+            glm::length(glm::vec3(model[2]))
+         )
+   );
+   const glm::vec3 center = glm::vec3(
+         model * glm::vec4(glm::vec3(mesh.boundingSphere), 1.0f)
+   );
+   const float distance = (
+         glm::length(center - glm::vec3(m_dataInShader.cameraPos)) -
+         mesh.boundingSphere.w * scale
+   );
+
+   // (the camera is inside the sphere)
+   if (distance <= 0.0f)
+      return 0;
+
+   for (uint32_t lod = mesh.lods.size() - 1; lod > 0; lod--)
    {
-      size_t j = lightModelIndices[i];
+      const float pixelsError = (
+            mesh.lods[lod].error * scale / distance * m_pixelsPerUnit
+      );
 
-      if (auto pModel = std::dynamic_pointer_cast<Light>(models[j]))
-      {
-         m_lightsInfo[i].pos = pModel->getPos();
-         m_lightsInfo[i].dir = pModel->getTargetPos() - pModel->getPos();
-         m_lightsInfo[i].color = pModel->getColor();
-         m_lightsInfo[i].intensity = pModel->getIntensity();
-         m_lightsInfo[i].type = (int)pModel->getLightType();
-      }
+      if (pixelsError <= config::LOD_PIXEL_ERROR)
+         return lod;
    }
 
-   size_t size = sizeof(m_lightsInfo[0]) * 10;
-
-   UBOutils::updateUBO(
-         logicalDevice,
-         m_uboLights,
-         size,
-         &m_lightsInfo,
-         currentFrame
-   );
+   return 0;
 }
 
 const std::vector<Mesh<Attributes::PBR::Vertex>>& NormalPBR::getMeshes() const
 {
    return m_meshes;
 }
+
+const uint32_t NormalPBR::getInstancesCount() const
+{
+   return m_instanceTransforms.size();
+}
+
+const std::vector<uint32_t>& NormalPBR::getShadowVisibleInstancesCounts(
+      const uint32_t cascade
+) const {
+   return m_shadowVisibleInstancesCounts[cascade];
+}
+
+const std::vector<uint32_t>& NormalPBR::getDrawIndices() const
+{
+   return m_drawIndices;
+}
+
+const uint32_t NormalPBR::getFirstDrawIndex() const
+{
+   return m_firstDrawIndex;
+}
+
+const uint32_t NormalPBR::getDraws16Count() const
+{
+   return m_draws16Count;
+}
+
+const std::vector<uint32_t>& NormalPBR::getMaterialKeys() const
+{
+   return m_materialKeys;
+}
+
+const bool NormalPBR::isOccluder() const
+{
+   return m_isOccluder;
+}
@@ -1,10 +1,20 @@
 #pragma once
 
+#include <vector>
+#include <optional>
+
 #include <CroissantRenderer/Settings/config.h>
 #include <CroissantRenderer/Model/Model.h>
 #include <CroissantRenderer/Model/ModelInfo.h>
 #include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
 #include <CroissantRenderer/Features/ShadowMap.h>
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
+#include <CroissantRenderer/Buffer/UploadBatch.h>
+#include <CroissantRenderer/Culling/frustumCulling.h>
+#include <CroissantRenderer/Culling/MaskedOcclusion.h>
+#include <CroissantRenderer/Descriptor/BindlessTextures.h>
+
+class GPUculling;
 
 class NormalPBR : public Model
 {
@@ -28,37 +38,96 @@ public:
          const VkCommandBuffer& commandBuffer,
          const uint32_t currentFrame
    ) override;
+   void bindData(
+         const Graphics* graphicsPipeline,
+         const uint32_t materialKey,
+         const VkCommandBuffer& commandBuffer,
+         const uint32_t currentFrame
+   );
    void updateUBO(
-         const VkDevice& logicalDevice,
+         UniformRing& uniformRing,
          const uint32_t& currentFrame,
          const UBOinfo& uboInfo
    ) override;
-   void updateUBOlights(
-         const VkDevice& logicalDevice,
-         const std::vector<size_t> lightModelIndices,
-         const std::vector<std::shared_ptr<Model>>& models,
-         const uint32_t& currentFrame
+   void uploadVertexData(
+         GeometryBuffer<Attributes::PBR::Vertex>& geometryBuffer,
+         UploadBatch& uploadBatch
+   );
+
+   void reserveInstances(
+         uint32_t& firstInstance,
+         uint32_t& firstVisibleInstance
+   );
+   void writeInstances(void* instancesData) const;
+   void reserveMaterials(BindlessTextures& textures, uint32_t& firstMaterial);
+   void writeMaterials(
+         void* materialsData,
+         void* instanceMaterialsData
+   ) const;
+   void addCullingBounds(frustumCulling::Bounds& bounds) const;
+   void addOccluders(MaskedOcclusion& maskedOcclusion) const;
+   void setVisibleInstances(
+         const std::vector<uint8_t>& isVisible,
+         // (one per cascade of the shadow map)
+         const std::vector<std::vector<uint8_t>>& isShadowVisible,
+         const size_t firstBoundsIndex,
+         const uint32_t currentFrame
+   );
+   void maskMaterialKeys(const uint32_t mask);
+   void setIndirectDraws(
+         const GPUculling* opGPUculling,
+         const uint32_t firstDrawIndex
    );
 
    const glm::mat4& getModelM() const;
    const std::vector<Mesh<Attributes::PBR::Vertex>>& getMeshes() const;
+   const uint32_t getInstancesCount() const;
+   const std::vector<uint32_t>& getShadowVisibleInstancesCounts(
+         const uint32_t cascade
+   ) const;
+   const std::vector<uint32_t>& getDrawIndices() const;
+   const uint32_t getFirstDrawIndex() const;
+   const uint32_t getDraws16Count() const;
+   const std::vector<uint32_t>& getMaterialKeys() const;
+   const bool isOccluder() const;
 
 private:
 
+   // Consecutive indirect commands of the meshes with the same material key
+   // and index type.
+   struct IndirectRange
+   {
+      uint32_t    materialKey;
+      VkIndexType indexType;
+      uint32_t    firstDrawIndex;
+      uint32_t    drawsCount;
+   };
+
    void processMesh(aiMesh* mesh, const aiScene* scene) override;
+   void addMeshInstance(
+         const size_t meshIndex,
+         const glm::mat4& nodeTransform
+   ) override;
+   void bindMeshes(
+         const Graphics* graphicsPipeline,
+         const std::optional<uint32_t>& materialKey,
+         const VkCommandBuffer& commandBuffer,
+         const uint32_t currentFrame
+   );
+   void addOccluderMesh(const Mesh<Attributes::PBR::Vertex>& mesh);
+   const uint32_t selectLOD(
+         const Mesh<Attributes::PBR::Vertex>& mesh,
+         const glm::mat4& model
+   ) const;
    void getMaterialTextureInfo(
       aiMaterial* material,
       const aiTextureType& type,
       const std::string& typeName,
       const std::string& defaultTextureFile,
+      const uint32_t feature,
+      uint32_t& materialKey,
       TextureToLoadInfo& info
    );
-   void uploadVertexData(
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         const VkQueue& graphicsQueue,
-         const std::shared_ptr<CommandPool>& commandPool
-   ) override;
    void uploadTextures(
          const VkPhysicalDevice& physicalDevice,
          const VkDevice& logicalDevice,
@@ -66,15 +135,47 @@ private:
          const std::shared_ptr<CommandPool>& commandPool,
          const VkQueue& graphicsQueue
    ) override;
-   void createUniformBuffers(
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         const uint32_t& uboCount
-   ) override;
-
-   std::shared_ptr<UBO> m_uboLights;
 
    DescriptorTypes::UniformBufferObject::NormalPBR m_dataInShader;
-   DescriptorTypes::UniformBufferObject::LightInfo m_lightsInfo[config::LIGHTS_COUNT];
    std::vector<Mesh<Attributes::PBR::Vertex>> m_meshes;
+   // (one per frame in flight, shared by all the meshes)
+   DescriptorSets m_descriptorSets;
+   // (set by createDescriptorSets())
+   const BindlessTextures* m_opTextures;
+   // Material of each mesh, from the first material of the model in the
+   // materials buffer of the scene.
+   std::vector<DescriptorTypes::StorageBufferObject::Material> m_materials;
+   // Key of the material of each mesh(textures that it has and lighting
+   // features of the model, see materialFeatures).
+   std::vector<uint32_t> m_materialKeys;
+   uint32_t m_firstMaterial;
+   // (set by uploadVertexData())
+   const GeometryBuffer<Attributes::PBR::Vertex>* m_opGeometryBuffer;
+   // Transforms of the copies of the model(from ModelInfo::instances).
+   std::vector<glm::mat4> m_instances;
+   // Transform of each instance of the meshes(copy * node), from the first
+   // instance of the model in the instances buffer of the scene.
+   std::vector<glm::mat4> m_instanceTransforms;
+   uint32_t m_firstInstance;
+   // (set by createDescriptorSets())
+   UBO* m_opVisibleInstances;
+   // Pixels covered by 1 unit at distance 1(set by updateUBO()).
+   float m_pixelsPerUnit;
+   // Count of the visible instances of each mesh per LOD and of each
+   // cascade of the shadow map per mesh(set by Scene::cullMeshes()).
+   std::vector<std::vector<uint32_t>> m_visibleInstancesCounts;
+   std::vector<std::vector<uint32_t>> m_shadowVisibleInstancesCounts;
+   // GPU culling(set by setIndirectDraws(), otherwise nullptr)
+   const GPUculling* m_opGPUculling;
+   // Indirect command of each mesh. The meshes with 16-bit indices go first.
+   std::vector<uint32_t> m_drawIndices;
+   uint32_t m_firstDrawIndex;
+   uint32_t m_draws16Count;
+   std::vector<IndirectRange> m_indirectRanges;
+   // Software occlusion culling(the least detailed LOD of each mesh, only
+   // if the model is an occluder)
+   bool m_isOccluder;
+   std::vector<OccluderMesh> m_occluderMeshes;
+   // (RECEIVES_SHADOWS and IBL bits of the keys of all its materials)
+   uint32_t m_lightingFeatures;
 };
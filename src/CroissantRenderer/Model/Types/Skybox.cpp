@@ -14,51 +14,27 @@
 #include <CroissantRenderer/Descriptor/descriptorSetLayoutManager.h>
 #include <CroissantRenderer/Pipeline/Graphics.h>
 #include <CroissantRenderer/Model/Attributes.h>
-#include <CroissantRenderer/Descriptor/Types/UBO/UBOutils.h>
 #include <CroissantRenderer/Descriptor/Types/DescriptorTypes.h>
 #include <CroissantRenderer/Descriptor/Types/UBO/UBO.h>
 #include <CroissantRenderer/Descriptor/DescriptorSets.h>
 #include <CroissantRenderer/Descriptor/DescriptorPool.h>
 #include <CroissantRenderer/Model/Attributes.h>
-#include <CroissantRenderer/Buffer/bufferManager.h>
 #include <CroissantRenderer/Math/mathUtils.h>
 #include <CroissantRenderer/Texture/Type/Cubemap.h>
 #include <CroissantRenderer/Command/commandManager.h>
 
 Skybox::Skybox(const ModelInfo& modelInfo)
-   : Model(modelInfo.name, modelInfo.folderName, ModelType::SKYBOX)
+   : Model(modelInfo.name, modelInfo.folderName, ModelType::SKYBOX),
+     m_opGeometryBuffer(nullptr)
 {
    loadModel((std::string(MODEL_DIR) + "cubeDefault/Cube.gltf").c_str());
 }
 
 void Skybox::destroy(const VkDevice& logicalDevice)
 {
-   m_ubo->destroy();
-
    for (auto& texture : m_texturesLoaded)
       texture->destroy();
    m_irradianceMap->destroy();
-
-   for (auto& mesh : m_meshes)
-   {
-      bufferManager::destroyBuffer(
-            logicalDevice,
-            mesh.vertexBuffer
-      );
-      bufferManager::destroyBuffer(
-            logicalDevice,
-            mesh.indexBuffer
-      );
-      
-      bufferManager::freeMemory(
-            logicalDevice,
-            mesh.vertexMemory
-      );
-      bufferManager::freeMemory(
-            logicalDevice,
-            mesh.indexMemory
-      );
-   }
 }
 
 void Skybox::processMesh(aiMesh* mesh, const aiScene* scene)
@@ -86,6 +62,8 @@ void Skybox::processMesh(aiMesh* mesh, const aiScene* scene)
          newMesh.indices.emplace_back(face.mIndices[j]);
    }
 
+   meshOptimizer::optimize(newMesh, m_geometryReport);
+
    m_meshes.emplace_back(newMesh);
 }
 
@@ -99,7 +77,7 @@ void Skybox::createDescriptorSets(
       DescriptorPool& descriptorPool
 ) {
 
-   std::vector<UBO*> opUBOs = {m_ubo.get()};
+   std::vector<UBO*> opUBOs = {info->uniformRing};
 
    for (auto& mesh : m_meshes)
    {
@@ -116,54 +94,17 @@ void Skybox::createDescriptorSets(
    }
 }
 
-void Skybox::createUniformBuffers(
-      const VkPhysicalDevice& physicalDevice,
-      const VkDevice& logicalDevice,
-      const uint32_t& uboCount
-) {
-   m_ubo = std::make_shared<UBO>(
-         physicalDevice,
-         logicalDevice,
-         uboCount,
-         sizeof(DescriptorTypes::UniformBufferObject::Skybox)
-   );
-}
-
+/*
+ * -Reserves the range of each mesh in the geometry buffer and records the
+ * copy of its data(the batch is submitted by the caller).
+ */
 void Skybox::uploadVertexData(
-      const VkPhysicalDevice& physicalDevice,
-      const VkDevice& logicalDevice,
-      const VkQueue& graphicsQueue,
-      const std::shared_ptr<CommandPool>& commandPool
+      GeometryBuffer<Attributes::SKYBOX::Vertex>& geometryBuffer,
+      UploadBatch& uploadBatch
 ) {
+   geometryBuffer.add(m_meshes, uploadBatch);
 
-   for (auto& mesh : m_meshes)
-   {
-      // Vertex Buffer(with staging buffer)
-      bufferManager::createBufferAndTransferToDevice(
-            commandPool,
-            physicalDevice,
-            logicalDevice,
-            mesh.vertices.data(),
-            sizeof(mesh.vertices[0]) * mesh.vertices.size(),
-            graphicsQueue,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            mesh.vertexMemory,
-            mesh.vertexBuffer
-         );
-
-      // Index Buffer(with staging buffer)
-      bufferManager::createBufferAndTransferToDevice(
-            commandPool,
-            physicalDevice,
-            logicalDevice,
-            mesh.indices.data(),
-            sizeof(mesh.indices[0]) * mesh.indices.size(),
-            graphicsQueue,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            mesh.indexMemory,
-            mesh.indexBuffer
-      );
-   }
+   m_opGeometryBuffer = &geometryBuffer;
 }
 
 void Skybox::uploadTextures(
@@ -235,7 +176,7 @@ void Skybox::uploadTextures(
 }
 
 void Skybox::updateUBO(
-      const VkDevice& logicalDevice,
+      UniformRing& uniformRing,
       const uint32_t& currentFrame,
       const UBOinfo& uboInfo
 ) {
@@ -257,8 +198,11 @@ void Skybox::updateUBO(
       40.0f
    );
    
-   const size_t size = sizeof(newUBO);
-   UBOutils::updateUBO(logicalDevice, m_ubo, size, &newUBO, currentFrame);
+   m_uboOffsets[currentFrame] = uniformRing.push(
+         &newUBO,
+         sizeof(newUBO),
+         currentFrame
+   );
 }
 
 void Skybox::bindData(
@@ -266,26 +210,10 @@ void Skybox::bindData(
       const VkCommandBuffer& commandBuffer,
       const uint32_t currentFrame
 ) {
+   VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+
    for (auto& mesh : m_meshes)
    {
-      commandManager::state::bindVertexBuffers(
-            {mesh.vertexBuffer},
-            // Offsets.
-            {0},
-            // Index of first binding.
-            0,
-            // Bindings count.
-            1,
-            commandBuffer
-      );
-      commandManager::state::bindIndexBuffer(
-            mesh.indexBuffer,
-            // Offset.
-            0,
-            VK_INDEX_TYPE_UINT32,
-            commandBuffer
-      );
-
       commandManager::state::bindDescriptorSets(
             graphicsPipeline->getPipelineLayout(),
             PipelineType::GRAPHICS,
@@ -293,21 +221,19 @@ void Skybox::bindData(
             0,
             {mesh.descriptorSets.get(currentFrame)},
             // Dynamic offsets.
-            {},
+            {m_uboOffsets[currentFrame]},
             commandBuffer
       );
 
-      commandManager::action::drawIndexed(
-            // Index Count
-            mesh.indices.size(),
+      m_opGeometryBuffer->drawIndexed(
+            mesh,
+            // LOD
+            0,
             // Instance Count
             1,
-            // First index.
-            0,
-            // Vertex Offset.
-            0,
-            // First Intance.
+            // First Instance
             0,
+            boundIndexType,
             commandBuffer
       );
    }
@@ -16,6 +16,8 @@
 #include <CroissantRenderer/Descriptor/DescriptorSets.h>
 #include <CroissantRenderer/Descriptor/Types/UBO/UBO.h>
 #include <CroissantRenderer/Features/ShadowMap.h>
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
+#include <CroissantRenderer/Buffer/UploadBatch.h>
 
 class Skybox : public Model
 {
@@ -37,10 +39,14 @@ public:
          const uint32_t currentFrame
    ) override;
    void updateUBO(
-         const VkDevice& logicalDevice,
+         UniformRing& uniformRing,
          const uint32_t& currentFrame,
          const UBOinfo& uboInfo
    ) override;
+   void uploadVertexData(
+         GeometryBuffer<Attributes::SKYBOX::Vertex>& geometryBuffer,
+         UploadBatch& uploadBatch
+   );
 
    const std::string& getTextureFolderName() const;
    const std::shared_ptr<Texture>& getEnvMap() const;
@@ -50,12 +56,6 @@ public:
 private:
 
    void processMesh(aiMesh* mesh, const aiScene* scene) override;
-   void uploadVertexData(
-      const VkPhysicalDevice& physicalDevice,
-      const VkDevice& logicalDevice,
-      const VkQueue& graphicsQueue,
-      const std::shared_ptr<CommandPool>& commandPool
-   );
    void uploadTextures(
          const VkPhysicalDevice& physicalDevice,
          const VkDevice& logicalDevice,
@@ -63,15 +63,12 @@ private:
          const std::shared_ptr<CommandPool>& commandPool,
          const VkQueue& graphicsQueue
    ) override;
-   void createUniformBuffers(
-         const VkPhysicalDevice& physicalDevice,
-         const VkDevice& logicalDevice,
-         const uint32_t& uboCount
-   ) override;
 
    std::string                m_textureFolderName;
    std::shared_ptr<Texture>   m_envMap;
    std::shared_ptr<Texture>   m_irradianceMap;
 
    std::vector<Mesh<Attributes::SKYBOX::Vertex>> m_meshes;
+   // (set by uploadVertexData())
+   const GeometryBuffer<Attributes::SKYBOX::Vertex>* m_opGeometryBuffer;
 };
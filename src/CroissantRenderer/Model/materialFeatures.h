@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Features of the material of a mesh. The bits of the features that it uses
+ * are its key, and the PBR models are drawn with one pipeline variant per
+ * key(see Scene::createPipelines()), where each feature is a specialization
+ * constant of the fragment shaders. So a pixel only pays for the textures
+ * and the lighting of its material.
+ * (the constant_id of each feature is its bit + 1, the 0 is SHADOW_FILTER)
+ */
+namespace materialFeatures
+{
+   inline const uint32_t NORMAL_MAP             = 1 << 0;
+   inline const uint32_t METALLIC_ROUGHNESS_MAP = 1 << 1;
+   inline const uint32_t EMISSIVE_MAP           = 1 << 2;
+   inline const uint32_t AO_MAP                 = 1 << 3;
+   inline const uint32_t RECEIVES_SHADOWS       = 1 << 4;
+   inline const uint32_t IBL                    = 1 << 5;
+
+   // (they don't change the G-buffer, so the deferred path drops them from
+   // the keys, see NormalPBR::maskMaterialKeys())
+   inline const uint32_t LIGHTING               = RECEIVES_SHADOWS | IBL;
+
+   inline const uint32_t COUNT = 6;
+};
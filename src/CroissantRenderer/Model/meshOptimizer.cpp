@@ -0,0 +1,515 @@
+#include <CroissantRenderer/Model/meshOptimizer.h>
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Settings/config.h>
+#include <CroissantRenderer/Model/Attributes.h>
+
+// A cluster is split while its ACMR is under the ACMR of the whole cluster
+// multiplied by this(more clusters -> better sorting but more cache misses).
+static const float OVERDRAW_THRESHOLD = 1.05f;
+
+/*
+ * -FIFO cache simulation. A vertex is in the cache if it was added in the last
+ * VERTEX_CACHE_SIZE misses(timestamp - cacheTime <= VERTEX_CACHE_SIZE).
+ * Returns 1 if the vertex wasn't in the cache.
+ */
+static uint32_t updateCache(
+      const uint32_t vertex,
+      std::vector<uint32_t>& cacheTime,
+      uint32_t& timestamp
+) {
+   if (timestamp - cacheTime[vertex] > config::VERTEX_CACHE_SIZE)
+   {
+      cacheTime[vertex] = timestamp++;
+
+      return 1;
+   }
+
+   return 0;
+}
+
+static void resetCache(uint32_t& timestamp)
+{
+   timestamp += config::VERTEX_CACHE_SIZE + 1;
+}
+
+template<typename T>
+void meshOptimizer::optimize(Mesh<T>& mesh, Report& report)
+{
+   // (only triangle lists)
+   if (mesh.indices.empty() || mesh.indices.size() % 3 != 0)
+      return;
+
+   report.meshesCount++;
+   report.trianglesCount += mesh.indices.size() / 3;
+   report.verticesBefore += mesh.vertices.size();
+   report.cacheMissesBefore += getCacheMissesCount(
+         mesh.indices,
+         mesh.vertices.size()
+   );
+
+   weldVertices(mesh);
+   optimizeVertexCache(mesh.indices, mesh.vertices.size());
+   optimizeOverdraw(mesh);
+   optimizeVertexFetch(mesh);
+
+   report.verticesAfter += mesh.vertices.size();
+   report.cacheMissesAfter += getCacheMissesCount(
+         mesh.indices,
+         mesh.vertices.size()
+   );
+}
+
+/*
+ * -Two vertices are the same if all their bytes are equal(the vertices are
+ * value-initialized, so there isn't garbage in the padding).
+ */
+template<typename T>
+void meshOptimizer::weldVertices(Mesh<T>& mesh)
+{
+   const std::vector<T>& vertices = mesh.vertices;
+
+   // FNV-1a
+   auto hasher = [&vertices](const uint32_t index)
+   {
+      const auto* bytes = reinterpret_cast<const uint8_t*>(&vertices[index]);
+      size_t hash = 14695981039346656037ull;
+
+      for (size_t i = 0; i < sizeof(T); i++)
+      {
+         hash ^= bytes[i];
+         hash *= 1099511628211ull;
+      }
+
+      return hash;
+   };
+   auto isEqual = [&vertices](const uint32_t a, const uint32_t b)
+   {
+      return std::memcmp(&vertices[a], &vertices[b], sizeof(T)) == 0;
+   };
+
+   // index of the vertex -> index of the first vertex equal to it
+   std::unordered_map<uint32_t, uint32_t, decltype(hasher), decltype(isEqual)>
+      uniqueVertices(vertices.size(), hasher, isEqual);
+
+   std::vector<T> newVertices;
+   std::vector<uint32_t> remap(vertices.size());
+
+   newVertices.reserve(vertices.size());
+
+   for (uint32_t i = 0; i < vertices.size(); i++)
+   {
+      auto [it, isNew] = uniqueVertices.try_emplace(i, newVertices.size());
+
+      if (isNew)
+         newVertices.push_back(vertices[i]);
+
+      remap[i] = it->second;
+   }
+
+   for (auto& index : mesh.indices)
+      index = remap[index];
+
+   mesh.vertices = std::move(newVertices);
+}
+
+/*
+ * -Tipsify(Sander et al. 2007, "Fast Triangle Reordering for Vertex Locality
+ * and Reduced Overdraw"). It emits all the triangles around a vertex(fan)
+ * and chooses as next fanning vertex one of the last vertices emitted that
+ * will still be in the cache after emitting its triangles. If there isn't
+ * any, it goes back to the vertices emitted(dead-end stack) or to the next
+ * vertex in the input order.
+ */
+void meshOptimizer::optimizeVertexCache(
+      std::vector<uint32_t>& indices,
+      const size_t verticesCount
+) {
+   const size_t trianglesCount = indices.size() / 3;
+
+   if (trianglesCount == 0)
+      return;
+
+   // Triangles of each vertex.
+   std::vector<uint32_t> liveTriangles(verticesCount, 0);
+
+   for (auto index : indices)
+      liveTriangles[index]++;
+
+   std::vector<uint32_t> adjacencyOffsets(verticesCount + 1, 0);
+
+   for (size_t i = 0; i < verticesCount; i++)
+      adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i];
+
+   std::vector<uint32_t> adjacency(indices.size());
+   std::vector<uint32_t> adjacencyEnds(
+         adjacencyOffsets.begin(),
+         adjacencyOffsets.end() - 1
+   );
+
+   for (uint32_t i = 0; i < trianglesCount; i++)
+   {
+      for (size_t j = 0; j < 3; j++)
+         adjacency[adjacencyEnds[indices[i * 3 + j]]++] = i;
+   }
+
+   std::vector<uint32_t> cacheTime(verticesCount, 0);
+   std::vector<bool>     isEmitted(trianglesCount, false);
+   std::vector<uint32_t> deadEnd;
+   std::vector<uint32_t> candidates;
+   std::vector<uint32_t> newIndices;
+
+   deadEnd.reserve(indices.size());
+   newIndices.reserve(indices.size());
+
+   uint32_t timestamp = config::VERTEX_CACHE_SIZE + 1;
+   // Next vertex to check(in the input order) when there is a dead-end.
+   size_t cursor = 0;
+   int64_t fanningVertex = indices[0];
+
+   while (fanningVertex >= 0)
+   {
+      candidates.clear();
+
+      for (uint32_t i = adjacencyOffsets[fanningVertex];
+           i < adjacencyOffsets[fanningVertex + 1];
+           i++
+      ) {
+         const uint32_t triangle = adjacency[i];
+
+         if (isEmitted[triangle])
+            continue;
+
+         for (size_t j = 0; j < 3; j++)
+         {
+            const uint32_t vertex = indices[triangle * 3 + j];
+
+            newIndices.push_back(vertex);
+            deadEnd.push_back(vertex);
+            candidates.push_back(vertex);
+
+            liveTriangles[vertex]--;
+
+            updateCache(vertex, cacheTime, timestamp);
+         }
+
+         isEmitted[triangle] = true;
+      }
+
+      // Next fanning vertex.
+      fanningVertex = -1;
+      int64_t bestPriority = -1;
+
+      for (auto vertex : candidates)
+      {
+         if (liveTriangles[vertex] == 0)
+            continue;
+
+         // Each triangle adds at most 2 vertices to the cache, so it's
+         // still there if this doesn't exceed the cache size.
+         int64_t priority = 0;
+         const uint32_t age = timestamp - cacheTime[vertex];
+
+         if (age + 2 * liveTriangles[vertex] <= config::VERTEX_CACHE_SIZE)
+            priority = age;
+
+         if (priority > bestPriority)
+         {
+            bestPriority = priority;
+            fanningVertex = vertex;
+         }
+      }
+
+      if (fanningVertex >= 0)
+         continue;
+
+      while (deadEnd.empty() == false && fanningVertex < 0)
+      {
+         const uint32_t vertex = deadEnd.back();
+         deadEnd.pop_back();
+
+         if (liveTriangles[vertex] > 0)
+            fanningVertex = vertex;
+      }
+
+      while (cursor < verticesCount && fanningVertex < 0)
+      {
+         if (liveTriangles[cursor] > 0)
+            fanningVertex = cursor;
+         else
+            cursor++;
+      }
+   }
+
+   indices = std::move(newIndices);
+}
+
+/*
+ * -The triangles(already ordered for the vertex cache) are grouped in
+ * clusters that start where the cache is flushed(hard boundaries) and these
+ * are split while the cache efficiency doesn't drop too much(soft
+ * boundaries). Then the clusters are sorted so the ones that face outwards
+ * (and are more likely to occlude the others) are drawn first.
+ */
+template<typename T>
+void meshOptimizer::optimizeOverdraw(Mesh<T>& mesh)
+{
+   const std::vector<uint32_t>& indices = mesh.indices;
+   const size_t trianglesCount = indices.size() / 3;
+
+   if (trianglesCount == 0)
+      return;
+
+   std::vector<uint32_t> cacheTime(mesh.vertices.size(), 0);
+   uint32_t timestamp = config::VERTEX_CACHE_SIZE + 1;
+
+   // - Hard boundaries(triangles with all the vertices out of the cache).
+   std::vector<size_t> hardBoundaries;
+
+   for (size_t i = 0; i < trianglesCount; i++)
+   {
+      uint32_t misses = 0;
+
+      for (size_t j = 0; j < 3; j++)
+         misses += updateCache(indices[i * 3 + j], cacheTime, timestamp);
+
+      if (i == 0 || misses == 3)
+         hardBoundaries.push_back(i);
+   }
+
+   hardBoundaries.push_back(trianglesCount);
+
+   // - Soft boundaries
+   std::vector<size_t> boundaries;
+
+   for (size_t i = 0; i + 1 < hardBoundaries.size(); i++)
+   {
+      const size_t start = hardBoundaries[i];
+      const size_t end = hardBoundaries[i + 1];
+
+      resetCache(timestamp);
+
+      uint32_t clusterMisses = 0;
+
+      for (size_t t = start; t < end; t++)
+      {
+         for (size_t j = 0; j < 3; j++)
+         {
+            clusterMisses += updateCache(
+                  indices[t * 3 + j],
+                  cacheTime,
+                  timestamp
+            );
+         }
+      }
+
+      const float threshold = (
+            OVERDRAW_THRESHOLD * clusterMisses / float(end - start)
+      );
+
+      boundaries.push_back(start);
+      resetCache(timestamp);
+
+      uint32_t misses = 0;
+      size_t trianglesInCluster = 0;
+
+      for (size_t t = start; t < end; t++)
+      {
+         for (size_t j = 0; j < 3; j++)
+            misses += updateCache(indices[t * 3 + j], cacheTime, timestamp);
+
+         trianglesInCluster++;
+
+         if (t + 1 < end && misses / float(trianglesInCluster) <= threshold)
+         {
+            boundaries.push_back(t + 1);
+            resetCache(timestamp);
+
+            misses = 0;
+            trianglesInCluster = 0;
+         }
+      }
+   }
+
+   boundaries.push_back(trianglesCount);
+
+   // - Sort key of each cluster: how much it faces outwards from the center
+   // of the mesh.
+   const size_t clustersCount = boundaries.size() - 1;
+   std::vector<glm::vec3> clusterCentroids(clustersCount, glm::vec3(0.0f));
+   std::vector<glm::vec3> clusterNormals(clustersCount, glm::vec3(0.0f));
+   glm::vec3 meshCentroid(0.0f);
+   float meshArea = 0.0f;
+
+   for (size_t c = 0; c < clustersCount; c++)
+   {
+      float clusterArea = 0.0f;
+
+      for (size_t t = boundaries[c]; t < boundaries[c + 1]; t++)
+      {
+         const glm::vec3& p0 = mesh.vertices[indices[t * 3 + 0]].pos;
+         const glm::vec3& p1 = mesh.vertices[indices[t * 3 + 1]].pos;
+         const glm::vec3& p2 = mesh.vertices[indices[t * 3 + 2]].pos;
+
+         // (its length is twice the area of the triangle)
+         const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+         const float area = glm::length(normal);
+
+         clusterCentroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+         clusterNormals[c] += normal;
+         clusterArea += area;
+      }
+
+      meshCentroid += clusterCentroids[c];
+      meshArea += clusterArea;
+
+      if (clusterArea > 0.0f)
+         clusterCentroids[c] /= clusterArea;
+   }
+
+   if (meshArea > 0.0f)
+      meshCentroid /= meshArea;
+
+   std::vector<float> sortKeys(clustersCount, 0.0f);
+
+   for (size_t c = 0; c < clustersCount; c++)
+   {
+      const float normalLength = glm::length(clusterNormals[c]);
+
+      if (normalLength > 0.0f)
+      {
+         sortKeys[c] = glm::dot(
+               clusterCentroids[c] - meshCentroid,
+               clusterNormals[c] / normalLength
+         );
+      }
+   }
+
+   std::vector<size_t> clusterOrder(clustersCount);
+
+   for (size_t c = 0; c < clustersCount; c++)
+      clusterOrder[c] = c;
+
+   std::stable_sort(
+         clusterOrder.begin(),
+         clusterOrder.end(),
+         [&sortKeys](const size_t a, const size_t b)
+         {
+            return sortKeys[a] > sortKeys[b];
+         }
+   );
+
+   std::vector<uint32_t> newIndices;
+   newIndices.reserve(indices.size());
+
+   for (auto c : clusterOrder)
+   {
+      newIndices.insert(
+            newIndices.end(),
+            indices.begin() + boundaries[c] * 3,
+            indices.begin() + boundaries[c + 1] * 3
+      );
+   }
+
+   mesh.indices = std::move(newIndices);
+}
+
+/*
+ * -The vertices are sorted in the order they are first used by the indices
+ * (the unused ones are removed).
+ */
+template<typename T>
+void meshOptimizer::optimizeVertexFetch(Mesh<T>& mesh)
+{
+   const uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+
+   std::vector<uint32_t> remap(mesh.vertices.size(), UNUSED);
+   std::vector<T> newVertices;
+
+   newVertices.reserve(mesh.vertices.size());
+
+   for (auto& index : mesh.indices)
+   {
+      if (remap[index] == UNUSED)
+      {
+         remap[index] = newVertices.size();
+         newVertices.push_back(mesh.vertices[index]);
+      }
+
+      index = remap[index];
+   }
+
+   mesh.vertices = std::move(newVertices);
+}
+
+size_t meshOptimizer::getCacheMissesCount(
+      const std::vector<uint32_t>& indices,
+      const size_t verticesCount
+) {
+   std::vector<uint32_t> cacheTime(verticesCount, 0);
+   uint32_t timestamp = config::VERTEX_CACHE_SIZE + 1;
+   size_t misses = 0;
+
+   for (auto index : indices)
+      misses += updateCache(index, cacheTime, timestamp);
+
+   return misses;
+}
+
+/*
+ * -ACMR: average cache miss ratio(misses per triangle, 0.5 is the best case
+ *  in a regular grid).
+ * -ATVR: average transformed vertex ratio(misses per vertex, 1.0 is the best
+ *  case).
+ */
+void meshOptimizer::printReport(
+      const std::string& modelName,
+      const Report& report
+) {
+   if (report.meshesCount == 0)
+      return;
+
+   const float trianglesCount = report.trianglesCount;
+
+   // (written at once, the models are loaded in parallel)
+   std::ostringstream message;
+   message << std::fixed << std::setprecision(2)
+           << "Geometry of " << modelName << ": "
+           << report.meshesCount << " meshes, "
+           << report.trianglesCount << " triangles, vertices "
+           << report.verticesBefore << " -> " << report.verticesAfter
+           << ", ACMR "
+           << report.cacheMissesBefore / trianglesCount << " -> "
+           << report.cacheMissesAfter / trianglesCount
+           << ", ATVR "
+           << report.cacheMissesBefore / float(report.verticesBefore) << " -> "
+           << report.cacheMissesAfter / float(report.verticesAfter)
+           << "\n";
+
+   std::cout << message.str();
+}
+
+////////////////////////////////////INSTANCES//////////////////////////////////
+template void meshOptimizer::optimize<Attributes::PBR::Vertex>(
+      Mesh<Attributes::PBR::Vertex>& mesh,
+      Report& report
+);
+template void meshOptimizer::optimize<Attributes::SKYBOX::Vertex>(
+      Mesh<Attributes::SKYBOX::Vertex>& mesh,
+      Report& report
+);
+template void meshOptimizer::optimize<Attributes::LIGHT::Vertex>(
+      Mesh<Attributes::LIGHT::Vertex>& mesh,
+      Report& report
+);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include <CroissantRenderer/Model/Mesh.h>
+
+/*
+ * Import time optimization of the meshes(triangle lists), in this order:
+ *    1. Vertex welding(removes the duplicated vertices).
+ *    2. Triangle reordering for the post-transform vertex cache(Tipsify).
+ *    3. Reordering of the clusters of triangles to reduce the overdraw(the
+ *       ones facing outwards first).
+ *    4. Vertex reordering in the order they are fetched by the indices.
+ */
+namespace meshOptimizer
+{
+   // Accumulated stats of the optimized meshes(of a model).
+   struct Report
+   {
+      size_t meshesCount       = 0;
+      size_t trianglesCount    = 0;
+      size_t verticesBefore    = 0;
+      size_t verticesAfter     = 0;
+      size_t cacheMissesBefore = 0;
+      size_t cacheMissesAfter  = 0;
+   };
+
+   template<typename T>
+   void optimize(Mesh<T>& mesh, Report& report);
+   template<typename T>
+   void weldVertices(Mesh<T>& mesh);
+   void optimizeVertexCache(
+         std::vector<uint32_t>& indices,
+         const size_t verticesCount
+   );
+   template<typename T>
+   void optimizeOverdraw(Mesh<T>& mesh);
+   template<typename T>
+   void optimizeVertexFetch(Mesh<T>& mesh);
+   size_t getCacheMissesCount(
+         const std::vector<uint32_t>& indices,
+         const size_t verticesCount
+   );
+   void printReport(const std::string& modelName, const Report& report);
+};
@@ -0,0 +1,484 @@
+#include <CroissantRenderer/Model/meshSimplifier.h>
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Settings/config.h>
+#include <CroissantRenderer/Model/Attributes.h>
+#include <CroissantRenderer/Model/meshOptimizer.h>
+
+// A collapse is rejected if it rotates a triangle more than this(cosine).
+static const float MIN_NORMAL_COS = 0.25f;
+// A LOD is discarded if it doesn't remove at least this fraction of the
+// triangles of the previous one.
+static const float MIN_LOD_REDUCTION = 0.2f;
+
+/*
+ * -Sum of the squared distances to the planes(weighted by the area of their
+ * triangles): p^T * A * p + 2 * b^T * p + c
+ * -The error is divided by the sum of the weights, so it's the mean squared
+ * distance to the planes and its square root is a distance.
+ */
+struct Quadric
+{
+   double a00 = 0.0, a11 = 0.0, a22 = 0.0;
+   double a01 = 0.0, a02 = 0.0, a12 = 0.0;
+   double b0  = 0.0, b1  = 0.0, b2  = 0.0;
+   double c   = 0.0;
+   double w   = 0.0;
+
+   void addPlane(const glm::dvec3& n, const double d, const double weight)
+   {
+      a00 += weight * n.x * n.x;
+      a11 += weight * n.y * n.y;
+      a22 += weight * n.z * n.z;
+      a01 += weight * n.x * n.y;
+      a02 += weight * n.x * n.z;
+      a12 += weight * n.y * n.z;
+      b0  += weight * n.x * d;
+      b1  += weight * n.y * d;
+      b2  += weight * n.z * d;
+      c   += weight * d * d;
+      w   += weight;
+   }
+
+   void add(const Quadric& q)
+   {
+      a00 += q.a00; a11 += q.a11; a22 += q.a22;
+      a01 += q.a01; a02 += q.a02; a12 += q.a12;
+      b0  += q.b0;  b1  += q.b1;  b2  += q.b2;
+      c   += q.c;
+      w   += q.w;
+   }
+
+   double getError(const glm::dvec3& p) const
+   {
+      const double error = (
+            a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z +
+            2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+            2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) +
+            c
+      );
+
+      if (w == 0.0)
+         return 0.0;
+
+      // (precision)
+      return std::max(error / w, 0.0);
+   }
+};
+
+struct Collapse
+{
+   uint32_t from;
+   uint32_t to;
+   double   error;
+};
+
+/*
+ * -Vertices that can't be moved: the ones that share the position with
+ * other vertices(uv seams and hard normals) and the ones on a border(edges
+ * with only one triangle).
+ */
+static std::vector<bool> getLockedVertices(
+      const std::vector<uint32_t>& indices,
+      const std::vector<glm::vec3>& positions
+) {
+   const size_t verticesCount = positions.size();
+
+   // Vertex -> first vertex with its position.
+   auto hasher = [&positions](const uint32_t index)
+   {
+      // (-0.0 + 0.0 = 0.0, so both zeros have the same hash)
+      const glm::vec3 p = positions[index] + glm::vec3(0.0f);
+      uint32_t bits[3];
+      std::memcpy(bits, &p, sizeof(bits));
+
+      return size_t(
+            (bits[0] * 73856093u) ^
+            (bits[1] * 19349663u) ^
+            (bits[2] * 83492791u)
+      );
+   };
+   auto isEqual = [&positions](const uint32_t a, const uint32_t b)
+   {
+      return positions[a] == positions[b];
+   };
+
+   std::unordered_map<uint32_t, uint32_t, decltype(hasher), decltype(isEqual)>
+      uniquePositions(verticesCount, hasher, isEqual);
+
+   std::vector<uint32_t> positionRemap(verticesCount);
+   std::vector<uint32_t> positionUses(verticesCount, 0);
+
+   for (uint32_t i = 0; i < verticesCount; i++)
+   {
+      positionRemap[i] = uniquePositions.try_emplace(i, i).first->second;
+      positionUses[positionRemap[i]]++;
+   }
+
+   std::vector<bool> isPositionLocked(verticesCount, false);
+
+   for (uint32_t i = 0; i < verticesCount; i++)
+   {
+      if (positionUses[positionRemap[i]] > 1)
+         isPositionLocked[positionRemap[i]] = true;
+   }
+
+   // - Borders(undirected edges, by position, used by only one triangle).
+   std::unordered_map<uint64_t, uint32_t> edgeUses;
+
+   for (size_t i = 0; i < indices.size(); i += 3)
+   {
+      for (size_t j = 0; j < 3; j++)
+      {
+         uint32_t a = positionRemap[indices[i + j]];
+         uint32_t b = positionRemap[indices[i + (j + 1) % 3]];
+
+         if (a > b)
+            std::swap(a, b);
+
+         edgeUses[(uint64_t(a) << 32) | b]++;
+      }
+   }
+
+   for (auto& [edge, uses] : edgeUses)
+   {
+      if (uses == 1)
+      {
+         isPositionLocked[edge >> 32] = true;
+         isPositionLocked[edge & 0xFFFFFFFF] = true;
+      }
+   }
+
+   std::vector<bool> isLocked(verticesCount);
+
+   for (uint32_t i = 0; i < verticesCount; i++)
+      isLocked[i] = isPositionLocked[positionRemap[i]];
+
+   return isLocked;
+}
+
+/*
+ * -Checks if moving a vertex flips(or rotates too much) any of the triangles
+ * around it.
+ */
+static bool isCollapseFlipping(
+      const Collapse& collapse,
+      const std::vector<uint32_t>& indices,
+      const std::vector<glm::vec3>& positions,
+      const std::vector<uint32_t>& adjacencyOffsets,
+      const std::vector<uint32_t>& adjacency
+) {
+   for (uint32_t i = adjacencyOffsets[collapse.from];
+        i < adjacencyOffsets[collapse.from + 1];
+        i++
+   ) {
+      const uint32_t* triangle = &indices[adjacency[i] * 3];
+
+      // (these ones are removed)
+      if (triangle[0] == collapse.to ||
+          triangle[1] == collapse.to ||
+          triangle[2] == collapse.to
+      ) {
+         continue;
+      }
+
+      glm::vec3 p[3];
+      glm::vec3 newP[3];
+
+      for (size_t j = 0; j < 3; j++)
+      {
+         p[j] = positions[triangle[j]];
+         newP[j] = (
+               (triangle[j] == collapse.from) ?
+                  positions[collapse.to] :
+                  p[j]
+         );
+      }
+
+      const glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+      const glm::vec3 newNormal = glm::cross(
+            newP[1] - newP[0],
+            newP[2] - newP[0]
+      );
+
+      const float lengths = glm::length(normal) * glm::length(newNormal);
+
+      if (glm::dot(normal, newNormal) <= MIN_NORMAL_COS * lengths)
+         return true;
+   }
+
+   return false;
+}
+
+/*
+ * -The positions have to be normalized(the error is a distance relative to
+ * them). In each pass the collapses are sorted by their error and applied
+ * if they don't touch the neighborhood of another collapse of the pass.
+ */
+std::vector<uint32_t> meshSimplifier::simplify(
+      const std::vector<uint32_t>& indices,
+      const std::vector<glm::vec3>& positions,
+      const size_t targetIndicesCount,
+      const float targetError,
+      float& resultError
+) {
+   const size_t verticesCount = positions.size();
+   const double maxError = double(targetError) * targetError;
+   double error = 0.0;
+
+   const std::vector<bool> isLocked = getLockedVertices(indices, positions);
+
+   // - Quadrics
+   std::vector<Quadric> quadrics(verticesCount);
+
+   for (size_t i = 0; i < indices.size(); i += 3)
+   {
+      const glm::dvec3 p0 = positions[indices[i + 0]];
+      const glm::dvec3 p1 = positions[indices[i + 1]];
+      const glm::dvec3 p2 = positions[indices[i + 2]];
+
+      glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+      const double area = glm::length(normal);
+
+      if (area == 0.0)
+         continue;
+
+      normal /= area;
+
+      for (size_t j = 0; j < 3; j++)
+         quadrics[indices[i + j]].addPlane(normal, -glm::dot(normal, p0), area);
+   }
+
+   std::vector<uint32_t> result = indices;
+   std::vector<uint32_t> collapseRemap(verticesCount);
+   std::vector<bool>     isTouched(verticesCount);
+   std::vector<Collapse> collapses;
+
+   while (result.size() > targetIndicesCount)
+   {
+      // - Triangles of each vertex.
+      std::vector<uint32_t> adjacencyOffsets(verticesCount + 1, 0);
+
+      for (auto index : result)
+         adjacencyOffsets[index + 1]++;
+
+      for (size_t i = 0; i < verticesCount; i++)
+         adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+
+      std::vector<uint32_t> adjacency(result.size());
+      std::vector<uint32_t> adjacencyEnds(
+            adjacencyOffsets.begin(),
+            adjacencyOffsets.end() - 1
+      );
+
+      for (uint32_t i = 0; i < result.size(); i++)
+         adjacency[adjacencyEnds[result[i]]++] = i / 3;
+
+      // - Candidates(both directions of each edge).
+      collapses.clear();
+
+      for (size_t i = 0; i < result.size(); i += 3)
+      {
+         for (size_t j = 0; j < 3; j++)
+         {
+            const uint32_t a = result[i + j];
+            const uint32_t b = result[i + (j + 1) % 3];
+
+            if (isLocked[a] == false)
+            {
+               collapses.push_back(
+                     {a, b, quadrics[a].getError(positions[b])}
+               );
+            }
+            if (isLocked[b] == false)
+            {
+               collapses.push_back(
+                     {b, a, quadrics[b].getError(positions[a])}
+               );
+            }
+         }
+      }
+
+      std::sort(
+            collapses.begin(),
+            collapses.end(),
+            [](const Collapse& a, const Collapse& b)
+            {
+               return a.error < b.error;
+            }
+      );
+
+      // - Collapses of the pass
+      for (uint32_t i = 0; i < verticesCount; i++)
+         collapseRemap[i] = i;
+
+      std::fill(isTouched.begin(), isTouched.end(), false);
+
+      const size_t trianglesToRemove = (
+            (result.size() - targetIndicesCount) / 3
+      );
+      size_t trianglesRemoved = 0;
+      size_t collapsesCount = 0;
+
+      for (auto& collapse : collapses)
+      {
+         if (collapse.error > maxError ||
+             trianglesRemoved >= trianglesToRemove
+         ) {
+            break;
+         }
+
+         if (isTouched[collapse.from] || isTouched[collapse.to])
+            continue;
+
+         if (isCollapseFlipping(
+                  collapse,
+                  result,
+                  positions,
+                  adjacencyOffsets,
+                  adjacency
+            )
+         ) {
+            continue;
+         }
+
+         collapseRemap[collapse.from] = collapse.to;
+         quadrics[collapse.to].add(quadrics[collapse.from]);
+
+         // The triangles around the vertex can't be changed by other
+         // collapses of this pass.
+         for (uint32_t j = adjacencyOffsets[collapse.from];
+              j < adjacencyOffsets[collapse.from + 1];
+              j++
+         ) {
+            const uint32_t* triangle = &result[adjacency[j] * 3];
+
+            if (triangle[0] == collapse.to ||
+                triangle[1] == collapse.to ||
+                triangle[2] == collapse.to
+            ) {
+               trianglesRemoved++;
+            }
+
+            for (size_t k = 0; k < 3; k++)
+               isTouched[triangle[k]] = true;
+         }
+
+         error = std::max(error, collapse.error);
+         collapsesCount++;
+      }
+
+      if (collapsesCount == 0)
+         break;
+
+      // - Removes the degenerated triangles.
+      size_t newIndicesCount = 0;
+
+      for (size_t i = 0; i < result.size(); i += 3)
+      {
+         const uint32_t a = collapseRemap[result[i + 0]];
+         const uint32_t b = collapseRemap[result[i + 1]];
+         const uint32_t c = collapseRemap[result[i + 2]];
+
+         if (a == b || b == c || a == c)
+            continue;
+
+         result[newIndicesCount++] = a;
+         result[newIndicesCount++] = b;
+         result[newIndicesCount++] = c;
+      }
+
+      result.resize(newIndicesCount);
+   }
+
+   resultError = std::sqrt(error);
+
+   return result;
+}
+
+/*
+ * -Each LOD tries to halve the triangles of the previous one(without going
+ * over config::LOD_MAX_ERROR). The indices of the LODs are appended to the
+ * ones of the mesh.
+ * -The bounds of the mesh have to be computed before(frustumCulling).
+ */
+template<typename T>
+void meshSimplifier::generateLODs(Mesh<T>& mesh)
+{
+   const uint32_t indicesCount = mesh.indices.size();
+
+   mesh.lods = {{0, indicesCount, 0.0f}};
+
+   if (indicesCount == 0 || indicesCount % 3 != 0)
+      return;
+
+   // - Normalized positions(the AABB of the mesh is computed before).
+   const glm::vec3 minPos = mesh.aabbMin;
+   const glm::vec3 extents = mesh.aabbMax - mesh.aabbMin;
+   const float scale = std::max(extents.x, std::max(extents.y, extents.z));
+
+   if (scale == 0.0f)
+      return;
+
+   std::vector<glm::vec3> positions(mesh.vertices.size());
+
+   for (size_t i = 0; i < positions.size(); i++)
+      positions[i] = (mesh.vertices[i].pos - minPos) / scale;
+
+   // - LODs
+   std::vector<uint32_t> previousIndices(
+         mesh.indices.begin(),
+         mesh.indices.end()
+   );
+
+   for (uint32_t i = 1; i < config::LOD_COUNT; i++)
+   {
+      const size_t targetIndicesCount = (previousIndices.size() / 6) * 3;
+      float error;
+
+      std::vector<uint32_t> lodIndices = simplify(
+            previousIndices,
+            positions,
+            targetIndicesCount,
+            config::LOD_MAX_ERROR,
+            error
+      );
+
+      const size_t maxIndicesCount = (
+            previousIndices.size() * (1.0f - MIN_LOD_REDUCTION)
+      );
+
+      if (lodIndices.empty() || lodIndices.size() > maxIndicesCount)
+         break;
+
+      meshOptimizer::optimizeVertexCache(lodIndices, mesh.vertices.size());
+
+      // (it's simplified from the previous LOD, so their errors are added)
+      mesh.lods.push_back(
+            {
+               static_cast<uint32_t>(mesh.indices.size()),
+               static_cast<uint32_t>(lodIndices.size()),
+               mesh.lods.back().error + error * scale
+            }
+      );
+      mesh.indices.insert(
+            mesh.indices.end(),
+            lodIndices.begin(),
+            lodIndices.end()
+      );
+
+      previousIndices = std::move(lodIndices);
+   }
+}
+
+////////////////////////////////////INSTANCES//////////////////////////////////
+template void meshSimplifier::generateLODs<Attributes::PBR::Vertex>(
+      Mesh<Attributes::PBR::Vertex>& mesh
+);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Model/Mesh.h>
+
+/*
+ * Import time generation of LODs by edge collapses(quadric error metrics).
+ * The vertices aren't modified(each collapse moves a vertex to one of its
+ * neighbors), so all the LODs are only index lists of the same vertices.
+ * The vertices on uv seams, hard normals(vertices split with the same
+ * position) and borders are never moved.
+ */
+namespace meshSimplifier
+{
+   std::vector<uint32_t> simplify(
+         const std::vector<uint32_t>& indices,
+         const std::vector<glm::vec3>& positions,
+         const size_t targetIndicesCount,
+         const float targetError,
+         float& resultError
+   );
+   template<typename T>
+   void generateLODs(Mesh<T>& mesh);
+};
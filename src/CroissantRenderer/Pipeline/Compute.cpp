@@ -8,6 +8,7 @@
 #include <GLFW/glfw3.h>
 
 #include <CroissantRenderer/Shader/shaderManager.h>
+#include <CroissantRenderer/Pipeline/pipelineCache.h>
 #include <CroissantRenderer/Descriptor/descriptorSetLayoutManager.h>
 
 Compute::Compute() {}
@@ -42,6 +43,15 @@ Compute::Compute(
          shaderStageInfo
    );
 
+   std::vector<VkSpecializationMapEntry> mapEntries;
+   VkSpecializationInfo specializationInfo{};
+
+   if (shaderInfo.specializationConstants.empty() == false)
+   {
+      createSpecializationInfo(shaderInfo, mapEntries, specializationInfo);
+      shaderStageInfo.pSpecializationInfo = &specializationInfo;
+   }
+
    // -------------------Fixed Functions------------------
 
    // Pipeline layout
@@ -57,7 +67,8 @@ Compute::Compute(
    
    auto status = vkCreateComputePipelines(
          logicalDevice,
-         VK_NULL_HANDLE,
+         // (see pipelineCache)
+         pipelineCache::get(),
          1,
          &pipelineInfo, nullptr,
          &m_pipeline
@@ -66,12 +77,8 @@ Compute::Compute(
    if (status != VK_SUCCESS)
       throw std::runtime_error("Failed to create compute pipeline!");
 
-   // Since after the creation of the Compute Pipeline the shaders are
-   // already linked, we won't need the shader modules anymore.
-   shaderManager::destroyShaderModule(
-         shaderModule,
-         logicalDevice
-   );
+   // (the shader module is kept by the shaderManager for the next pipelines
+   // that use it)
 }
 
 /*
@@ -8,6 +8,7 @@
 #include <GLFW/glfw3.h>
 
 #include <CroissantRenderer/Shader/shaderManager.h>
+#include <CroissantRenderer/Pipeline/pipelineCache.h>
 #include <CroissantRenderer/Features/featuresUtils.h>
 #include <CroissantRenderer/Descriptor/descriptorSetLayoutManager.h>
 
@@ -27,9 +28,13 @@ Graphics::Graphics(
       const std::vector<size_t>& modelIndices,
       const std::vector<DescriptorInfo>& uboInfo,
       const std::vector<DescriptorInfo>& samplersInfo,
-      const std::vector<VkPushConstantRange>& pushConstantRanges
+      const std::vector<VkPushConstantRange>& pushConstantRanges,
+      const std::vector<VkDescriptorSetLayout>& additionalSetLayouts,
+      const uint32_t subpass,
+      const uint32_t colorAttachmentsCount
 ) : Pipeline(logicalDevice, PipelineType::GRAPHICS),
     m_gType(type),
+    m_subpass(subpass),
     m_modelIndices(modelIndices)
 {
 
@@ -39,6 +44,10 @@ Graphics::Graphics(
    std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(
          shaderInfos.size()
    );
+   std::vector<std::vector<VkSpecializationMapEntry>> mapEntries(
+         shaderInfos.size()
+   );
+   std::vector<VkSpecializationInfo> specializationInfos(shaderInfos.size());
 
    for (size_t i = 0; i < shaderInfos.size(); i++)
    {
@@ -51,6 +60,16 @@ Graphics::Graphics(
             shaderInfos[i].type,
             shaderStagesInfos[i]
       );
+
+      if (shaderInfos[i].specializationConstants.empty() == false)
+      {
+         createSpecializationInfo(
+               shaderInfos[i],
+               mapEntries[i],
+               specializationInfos[i]
+         );
+         shaderStagesInfos[i].pSpecializationInfo = &specializationInfos[i];
+      }
    }
 
    // -------------------Fixed Functions------------------
@@ -119,11 +138,20 @@ Graphics::Graphics(
    createColorBlendingAttachment(colorBlendAttachment);
 
    // Color blending(global)
+   // (the same for all the color attachments of the subpass)
+   std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments(
+         colorAttachmentsCount,
+         colorBlendAttachment
+   );
    VkPipelineColorBlendStateCreateInfo colorBlendingInfo{};
-   createColorBlendingGlobalInfo(colorBlendAttachment, colorBlendingInfo);
+   createColorBlendingGlobalInfo(colorBlendAttachments, colorBlendingInfo);
    
    // Pipeline layout
-   createPipelineLayout(m_descriptorSetLayout, pushConstantRanges);
+   createPipelineLayout(
+         m_descriptorSetLayout,
+         pushConstantRanges,
+         additionalSetLayouts
+   );
 
    // Depth and stencil
    VkPipelineDepthStencilStateCreateInfo depthStencil{};
@@ -131,6 +159,10 @@ Graphics::Graphics(
          m_gType,
          depthStencil
    );
+   // (the depth is read-only after the first subpass, it's read as input
+   // attachment)
+   if (m_subpass > 0)
+      depthStencil.depthWriteEnable = VK_FALSE;
    
    // --------------Graphics pipeline creation------------
 
@@ -152,7 +184,7 @@ Graphics::Graphics(
    // Render pass and the index of the sub pass where this graphics
    // pipeline will be used.
    pipelineInfo.renderPass = renderPass.get();
-   pipelineInfo.subpass = 0;
+   pipelineInfo.subpass = m_subpass;
    // Pipelines derivatives(less expensive to set up pipelines when they
    // have much functionality in common whith an existing pupeline and
    // switching between pipelines from the same parent can also be done
@@ -164,7 +196,8 @@ Graphics::Graphics(
    
    auto status = vkCreateGraphicsPipelines(
          logicalDevice,
-         VK_NULL_HANDLE,
+         // (see pipelineCache)
+         pipelineCache::get(),
          1,
          &pipelineInfo, nullptr,
          &m_pipeline
@@ -173,15 +206,8 @@ Graphics::Graphics(
    if (status != VK_SUCCESS)
       throw std::runtime_error("Failed to create graphics pipeline!");
 
-   // Since after the creation of the Graphics Pipeline the shaders are
-   // already linked, we won't need the shader modules anymore.
-   for (auto& shaderModule : shaderModules)
-   {
-      shaderManager::destroyShaderModule(
-            shaderModule,
-            logicalDevice
-      );
-   }
+   // (the shader modules are kept by the shaderManager for the next
+   // pipelines that use them)
 }
 
 /*
@@ -208,7 +234,7 @@ void Graphics::createShaderStageInfo(
    shaderStageInfo.pName = "main";
    // pSpecializationInfo -> Specifies values for shader constants. This
    // optimizes the shaders avoiding the use of if-statements.
-   // ..
+   // (set by the constructor, see Pipeline::createSpecializationInfo())
 }
 
 void Graphics::createDynamicStatesInfo(
@@ -239,7 +265,10 @@ void Graphics::createVertexShaderInputInfo(
    );
    // Bindings: Number of vertex bindings descriptions provided in
    //           pVertexBindingDescriptions.
-   vertexInputInfo.vertexBindingDescriptionCount = 1;
+   //           (none if the vertices are generated by the vertex shader)
+   vertexInputInfo.vertexBindingDescriptionCount = (
+         attribDescriptions.empty() ? 0 : 1
+   );
    // Attribute descriptions: Type of the attributes passsed to the vertex
    //                         shader, which binding to load them from and at
    //                         which OFFSET.
@@ -328,8 +357,9 @@ void Graphics::createRasterizerInfo(
    {
       rasterizerInfo.cullMode = VK_CULL_MODE_FRONT_BIT;
 
-   } else if (m_gType == GraphicsPipelineType::PREFILTER_ENV_MAP)
-   {
+   } else if (m_gType == GraphicsPipelineType::PREFILTER_ENV_MAP ||
+              m_gType == GraphicsPipelineType::DEFERRED_LIGHTING
+   ) {
       rasterizerInfo.cullMode = VK_CULL_MODE_NONE;
 
    } else
@@ -375,18 +405,26 @@ void Graphics::createMultisamplingInfo(
 void Graphics::createColorBlendingAttachment(
       VkPipelineColorBlendAttachmentState& colorBlendAttachment
 ) {
-   colorBlendAttachment.colorWriteMask = (
-         VK_COLOR_COMPONENT_R_BIT |
-         VK_COLOR_COMPONENT_G_BIT |
-         VK_COLOR_COMPONENT_B_BIT |
-         VK_COLOR_COMPONENT_A_BIT
-   );
+   // (the depth pre-pass doesn't have fragment shader, it only writes the
+   // depth)
+   if (m_gType == GraphicsPipelineType::DEPTH_PREPASS)
+      colorBlendAttachment.colorWriteMask = 0;
+   else
+   {
+      colorBlendAttachment.colorWriteMask = (
+            VK_COLOR_COMPONENT_R_BIT |
+            VK_COLOR_COMPONENT_G_BIT |
+            VK_COLOR_COMPONENT_B_BIT |
+            VK_COLOR_COMPONENT_A_BIT
+      );
+   }
    colorBlendAttachment.blendEnable = VK_FALSE;
 }
 
 
 void Graphics::createColorBlendingGlobalInfo(
-      const VkPipelineColorBlendAttachmentState& colorBlendAttachment,
+      const std::vector<VkPipelineColorBlendAttachmentState>&
+         colorBlendAttachments,
       VkPipelineColorBlendStateCreateInfo& colorBlendingInfo
 ) {
    colorBlendingInfo.sType = (
@@ -394,8 +432,10 @@ void Graphics::createColorBlendingGlobalInfo(
    );
    colorBlendingInfo.logicOpEnable = VK_FALSE;
    colorBlendingInfo.logicOp = VK_LOGIC_OP_COPY; // Optional
-   colorBlendingInfo.attachmentCount = 1;
-   colorBlendingInfo.pAttachments = &colorBlendAttachment;
+   colorBlendingInfo.attachmentCount = static_cast<uint32_t>(
+         colorBlendAttachments.size()
+   );
+   colorBlendingInfo.pAttachments = colorBlendAttachments.data();
    colorBlendingInfo.blendConstants[0] = 0.0f; // Optional
    colorBlendingInfo.blendConstants[1] = 0.0f; // Optional
    colorBlendingInfo.blendConstants[2] = 0.0f; // Optional
@@ -414,6 +454,11 @@ const GraphicsPipelineType Graphics::getGraphicsPipelineType() const
    return m_gType;
 }
 
+const uint32_t Graphics::getSubpass() const
+{
+   return m_subpass;
+}
+
 void Graphics::createDescriptorSetLayout(
       const std::vector<DescriptorInfo>& uboInfo,
       const std::vector<DescriptorInfo>& samplersInfo
@@ -16,7 +16,11 @@ enum class GraphicsPipelineType
    LIGHT = 1,
    SKYBOX = 2,
    SHADOWMAP = 3,
-   PREFILTER_ENV_MAP = 4
+   PREFILTER_ENV_MAP = 4,
+   DEFERRED_LIGHTING = 5,
+   DEPTH_PREPASS = 6,
+   // (PBR that only shades the samples written by the depth pre-pass)
+   PBR_AFTER_DEPTH_PREPASS = 7
 };
 
 class Graphics : public Pipeline
@@ -38,11 +42,17 @@ public:
          const std::vector<size_t>& modelIndices,
          const std::vector<DescriptorInfo>& uboInfo,
          const std::vector<DescriptorInfo>& samplersInfo,
-         const std::vector<VkPushConstantRange>& pushConstantRanges
+         const std::vector<VkPushConstantRange>& pushConstantRanges,
+         // (shared sets, after the one of the pipeline)
+         const std::vector<VkDescriptorSetLayout>& additionalSetLayouts = {},
+         // (index of the subpass of the render pass where it's used)
+         const uint32_t subpass = 0,
+         const uint32_t colorAttachmentsCount = 1
    );
    ~Graphics();
    const GraphicsPipelineType getGraphicsPipelineType() const;
    const std::vector<size_t>& getModelIndices() const;
+   const uint32_t getSubpass() const;
 
 private:
 
@@ -84,11 +94,13 @@ private:
       VkPipelineColorBlendAttachmentState& colorBlendAttachment
    );
    void createColorBlendingGlobalInfo(
-      const VkPipelineColorBlendAttachmentState& colorBlendAttachment,
+      const std::vector<VkPipelineColorBlendAttachmentState>&
+         colorBlendAttachments,
       VkPipelineColorBlendStateCreateInfo& colorBlendingInfo
    );
 
    GraphicsPipelineType m_gType;
+   uint32_t             m_subpass;
 
    std::vector<size_t> m_modelIndices;
 };
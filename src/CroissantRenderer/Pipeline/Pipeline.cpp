@@ -22,47 +22,78 @@ void Pipeline::createShaderModule(
       const ShaderInfo& shaderInfo,
       VkShaderModule& shaderModule
 ) {
-   std::vector<char> shaderCode;
+   std::string binaryName;
 
    if (shaderInfo.type == shaderType::VERTEX)
-   {
-      shaderCode = (
-            shaderManager::getBinaryDataFromFile("vert-" + shaderInfo.fileName)
-      );
-   } else if (shaderInfo.type == shaderType::FRAGMENT)
-   {
-      shaderCode = (
-            shaderManager::getBinaryDataFromFile("frag-" + shaderInfo.fileName)
-      );
-   } else if (shaderInfo.type == shaderType::COMPUTE)
-   {
-      shaderCode = (
-            shaderManager::getBinaryDataFromFile("comp-" + shaderInfo.fileName)
-      );
-   } else
-   {
+      binaryName = "vert-" + shaderInfo.fileName;
+   else if (shaderInfo.type == shaderType::FRAGMENT)
+      binaryName = "frag-" + shaderInfo.fileName;
+   else if (shaderInfo.type == shaderType::COMPUTE)
+      binaryName = "comp-" + shaderInfo.fileName;
+   else
       throw std::runtime_error("Shader type doesn't exist.");
-   }
 
-   shaderModule = shaderManager::createShaderModule(
-         shaderCode,
+   // (shared by all the pipelines, see shaderManager::getShaderModule())
+   shaderModule = shaderManager::getShaderModule(
+         binaryName,
          m_logicalDevice
    );
 }
 
+/*
+ * Values of the specialization constants of the shader. They are set when
+ * the pipeline is created, so the compiler removes the branches that depend
+ * on them(e.g. the shadow filter, see pbrLighting.glsl).
+ * (the info points to the values of the shader info and to the entries, so
+ * both have to live until the pipeline is created)
+ */
+void Pipeline::createSpecializationInfo(
+      const ShaderInfo& shaderInfo,
+      std::vector<VkSpecializationMapEntry>& mapEntries,
+      VkSpecializationInfo& specializationInfo
+) {
+   const auto& constants = shaderInfo.specializationConstants;
+
+   mapEntries.resize(constants.size());
+
+   for (size_t i = 0; i < constants.size(); i++)
+   {
+      mapEntries[i].constantID = static_cast<uint32_t>(i);
+      mapEntries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+      mapEntries[i].size = sizeof(uint32_t);
+   }
+
+   specializationInfo.mapEntryCount = static_cast<uint32_t>(
+         mapEntries.size()
+   );
+   specializationInfo.pMapEntries = mapEntries.data();
+   specializationInfo.dataSize = constants.size() * sizeof(uint32_t);
+   specializationInfo.pData = constants.data();
+}
+
 /*
  * Interface that creates and allows us to communicate with the uniform
  * values and push constants in the shaders.
+ * The descriptor set of the pipeline is the set 0 and the additional ones
+ * follow it(set 1, 2...).
 */
 void Pipeline::createPipelineLayout(
       const VkDescriptorSetLayout& descriptorSetLayout,
-      const std::vector<VkPushConstantRange>& pushConstantRanges
+      const std::vector<VkPushConstantRange>& pushConstantRanges,
+      const std::vector<VkDescriptorSetLayout>& additionalSetLayouts
 ) {
+   std::vector<VkDescriptorSetLayout> setLayouts = {descriptorSetLayout};
+   setLayouts.insert(
+         setLayouts.end(),
+         additionalSetLayouts.begin(),
+         additionalSetLayouts.end()
+   );
+
    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-   // In this case we gonna bind the descriptor layout.
-   pipelineLayoutInfo.setLayoutCount= 1;
-   pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+   // In this case we gonna bind the descriptor layouts.
+   pipelineLayoutInfo.setLayoutCount = setLayouts.size();
+   pipelineLayoutInfo.pSetLayouts = setLayouts.data();
    pipelineLayoutInfo.pushConstantRangeCount = pushConstantRanges.size();
    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
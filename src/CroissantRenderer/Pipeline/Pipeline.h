@@ -17,9 +17,15 @@ struct ShaderInfo
 {
    shaderType type;
    std::string fileName;
-
-   ShaderInfo(const shaderType& sType, const std::string& fName) 
-   :  type(sType), fileName(fName) {}
+   // Values of the specialization constants of the shader(the constant_id of
+   // each one is its index).
+   std::vector<uint32_t> specializationConstants;
+
+   ShaderInfo(
+         const shaderType& sType,
+         const std::string& fName,
+         const std::vector<uint32_t>& constants = {}
+   ) :  type(sType), fileName(fName), specializationConstants(constants) {}
 };
 
 enum class PipelineType
@@ -57,9 +63,15 @@ protected:
       const ShaderInfo& shaderInfos,
       VkShaderModule& shaderModule
    );
+   void createSpecializationInfo(
+      const ShaderInfo& shaderInfo,
+      std::vector<VkSpecializationMapEntry>& mapEntries,
+      VkSpecializationInfo& specializationInfo
+   );
    void createPipelineLayout(
          const VkDescriptorSetLayout& descriptorSetLayout,
-         const std::vector<VkPushConstantRange>& pushConstantRanges
+         const std::vector<VkPushConstantRange>& pushConstantRanges,
+         const std::vector<VkDescriptorSetLayout>& additionalSetLayouts = {}
    );
 
    VkDevice                m_logicalDevice;
@@ -0,0 +1,191 @@
+#include <CroissantRenderer/Pipeline/pipelineCache.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <vulkan/vulkan.h>
+
+#include <CroissantRenderer/Settings/config.h>
+
+static VkDevice                     s_logicalDevice = VK_NULL_HANDLE;
+static VkPipelineCache              s_pipelineCache = VK_NULL_HANDLE;
+static VkPhysicalDeviceProperties   s_deviceProperties;
+
+static std::string getFilePath()
+{
+   return (
+         std::string(SHADERS_BINARY_DIR) + "/" + config::PIPELINE_CACHE_FILE
+   );
+}
+
+/*
+ * -Reads the data of the cache file. It's discarded if the header(see
+ * VkPipelineCacheHeaderVersionOne) was written by another device or driver.
+ */
+static std::vector<char> loadCacheData()
+{
+   std::ifstream file(getFilePath(), std::ios::ate | std::ios::binary);
+
+   if (!file.is_open())
+      return {};
+
+   size_t fileSize = (size_t)file.tellg();
+   std::vector<char> data(fileSize);
+
+   file.seekg(0);
+   file.read(data.data(), fileSize);
+   file.close();
+
+   VkPipelineCacheHeaderVersionOne header{};
+
+   if (data.size() < sizeof(header))
+      return {};
+
+   std::memcpy(&header, data.data(), sizeof(header));
+
+   const bool isValid = (
+         header.headerSize >= sizeof(header) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == s_deviceProperties.vendorID &&
+         header.deviceID == s_deviceProperties.deviceID &&
+         std::memcmp(
+            header.pipelineCacheUUID,
+            s_deviceProperties.pipelineCacheUUID,
+            VK_UUID_SIZE
+         ) == 0
+   );
+
+   if (isValid == false)
+   {
+      std::cout << "Pipeline cache: the file was written by another device"
+                << " or driver, it will be rebuilt.\n";
+
+      return {};
+   }
+
+   return data;
+}
+
+void pipelineCache::init(
+      const VkPhysicalDevice& physicalDevice,
+      const VkDevice& logicalDevice
+) {
+   s_logicalDevice = logicalDevice;
+
+   if (config::PIPELINE_CACHE == false)
+      return;
+
+   vkGetPhysicalDeviceProperties(physicalDevice, &s_deviceProperties);
+
+   std::vector<char> data = loadCacheData();
+
+   VkPipelineCacheCreateInfo createInfo{};
+   createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+   createInfo.initialDataSize = data.size();
+   createInfo.pInitialData = (data.empty()) ? nullptr : data.data();
+
+   auto status = vkCreatePipelineCache(
+         s_logicalDevice,
+         &createInfo,
+         nullptr,
+         &s_pipelineCache
+   );
+
+   // (the driver can still reject the data)
+   if (status != VK_SUCCESS && data.empty() == false)
+   {
+      createInfo.initialDataSize = 0;
+      createInfo.pInitialData = nullptr;
+
+      status = vkCreatePipelineCache(
+            s_logicalDevice,
+            &createInfo,
+            nullptr,
+            &s_pipelineCache
+      );
+   }
+
+   if (status != VK_SUCCESS)
+      throw std::runtime_error("Failed to create pipeline cache!");
+}
+
+const VkPipelineCache& pipelineCache::get()
+{
+   return s_pipelineCache;
+}
+
+/*
+ * -Writes the cache to a temporary file and then replaces the old one, so an
+ * interrupted save doesn't leave a broken cache.
+ */
+void pipelineCache::save()
+{
+   if (s_pipelineCache == VK_NULL_HANDLE)
+      return;
+
+   size_t dataSize = 0;
+   vkGetPipelineCacheData(
+         s_logicalDevice,
+         s_pipelineCache,
+         &dataSize,
+         nullptr
+   );
+
+   std::vector<char> data(dataSize);
+   auto status = vkGetPipelineCacheData(
+         s_logicalDevice,
+         s_pipelineCache,
+         &dataSize,
+         data.data()
+   );
+
+   if (status != VK_SUCCESS || dataSize == 0)
+      return;
+
+   const std::string filePath = getFilePath();
+   const std::string tmpFilePath = filePath + ".tmp";
+
+   std::ofstream file(tmpFilePath, std::ios::binary | std::ios::trunc);
+
+   if (!file.is_open())
+   {
+      std::cout << "Pipeline cache: failed to write " << tmpFilePath << "\n";
+      return;
+   }
+
+   file.write(data.data(), dataSize);
+   file.close();
+
+   // (a partial file never replaces the last good one)
+   if (file.fail())
+   {
+      std::cout << "Pipeline cache: failed to write " << tmpFilePath << "\n";
+      std::remove(tmpFilePath.c_str());
+      return;
+   }
+
+   // The rename replaces the old file atomically on POSIX, so a crash keeps
+   // either the old or the new cache. Windows can't rename over an existing
+   // file, so there it's removed first.
+#ifdef _WIN32
+   std::remove(filePath.c_str());
+#endif
+   if (std::rename(tmpFilePath.c_str(), filePath.c_str()) != 0)
+      std::cout << "Pipeline cache: failed to replace " << filePath << "\n";
+}
+
+void pipelineCache::destroy()
+{
+   if (s_pipelineCache == VK_NULL_HANDLE)
+      return;
+
+   save();
+
+   vkDestroyPipelineCache(s_logicalDevice, s_pipelineCache, nullptr);
+   s_pipelineCache = VK_NULL_HANDLE;
+}
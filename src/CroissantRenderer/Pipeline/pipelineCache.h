@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+/*
+ * Pipeline cache of the device, shared by all the pipelines(Graphics,
+ * Compute and the GUI). It's loaded from PIPELINE_CACHE_FILE when the
+ * renderer starts and saved when it's destroyed, so a warm start skips most
+ * of the compilation of the driver.
+ * The data of the file is only used if its header matches the device
+ * (vendor, device and pipeline cache UUID of the driver), otherwise the cache
+ * starts empty and the file is replaced.
+ */
+namespace pipelineCache
+{
+   void init(
+         const VkPhysicalDevice& physicalDevice,
+         const VkDevice& logicalDevice
+   );
+   // (VK_NULL_HANDLE if config::PIPELINE_CACHE is disabled)
+   const VkPipelineCache& get();
+   void save();
+   // (saves the cache before destroying it)
+   void destroy();
+};
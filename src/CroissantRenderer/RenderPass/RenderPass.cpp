@@ -74,6 +74,13 @@ void RenderPass::begin(
    );
 }
          
+void RenderPass::nextSubpass(
+      const VkCommandBuffer& commandBuffer,
+      const VkSubpassContents& subPassContents
+) const {
+   vkCmdNextSubpass(commandBuffer, subPassContents);
+}
+
 void RenderPass::end(const VkCommandBuffer& commandBuffer) const
 {
    vkCmdEndRenderPass(commandBuffer);
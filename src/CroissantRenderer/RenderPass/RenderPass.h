@@ -24,6 +24,10 @@ public:
       const VkCommandBuffer& commandBuffer,
       const VkSubpassContents& subPassContents
    ) const;
+   void nextSubpass(
+      const VkCommandBuffer& commandBuffer,
+      const VkSubpassContents& subPassContents
+   ) const;
    void end(const VkCommandBuffer& commandBuffer) const;
    void createSubPass(
          const VkAttachmentReference& colorAttachmentRef,
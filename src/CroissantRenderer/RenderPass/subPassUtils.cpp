@@ -12,13 +12,20 @@ void subPassUtils::createSubPassDescription(
       const VkAttachmentReference* colorAttachRef,
       const VkAttachmentReference* depthStencilAttachRef,
       const VkAttachmentReference* colorResolveAttachmentRef,
-      VkSubpassDescription& subPassDescription
+      VkSubpassDescription& subPassDescription,
+      const uint32_t colorAttachmentsCount,
+      const VkAttachmentReference* inputAttachRefs,
+      const uint32_t inputAttachmentsCount
 ) {
    subPassDescription.pipelineBindPoint = pipelineBindPoint;
-   subPassDescription.colorAttachmentCount = 1;
+   subPassDescription.colorAttachmentCount = colorAttachmentsCount;
    subPassDescription.pColorAttachments = colorAttachRef;
    subPassDescription.pDepthStencilAttachment = depthStencilAttachRef;
    subPassDescription.pResolveAttachments = colorResolveAttachmentRef;
+   // Attachments written by a previous subpass and read by this one(only
+   // the sample of the fragment).
+   subPassDescription.inputAttachmentCount = inputAttachmentsCount;
+   subPassDescription.pInputAttachments = inputAttachRefs;
 }
 
 /*
@@ -11,7 +11,11 @@ namespace subPassUtils
          const VkAttachmentReference* colorAttachRef,
          const VkAttachmentReference* depthStencilAttachRef,
          const VkAttachmentReference* colorResolveAttachmentRef,
-         VkSubpassDescription& subPassDescription
+         VkSubpassDescription& subPassDescription,
+         // (colorAttachRef is an array of colorAttachmentsCount)
+         const uint32_t colorAttachmentsCount = 1,
+         const VkAttachmentReference* inputAttachRefs = nullptr,
+         const uint32_t inputAttachmentsCount = 0
    );
 
    void createSubPassDependency(
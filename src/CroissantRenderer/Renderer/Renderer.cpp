@@ -28,6 +28,8 @@
 #include <CroissantRenderer/Queue/QueueFamilyHandles.h>
 #include <CroissantRenderer/Swapchain/Swapchain.h>
 #include <CroissantRenderer/Pipeline/Graphics.h>
+#include <CroissantRenderer/Pipeline/pipelineCache.h>
+#include <CroissantRenderer/Shader/shaderManager.h>
 #include <CroissantRenderer/Command/CommandPool.h>
 #include <CroissantRenderer/Command/commandManager.h>
 #include <CroissantRenderer/Model/Model.h>
@@ -52,8 +54,19 @@
 #include <CroissantRenderer/Camera/Types/Arcball.h>
 #include <CroissantRenderer/Features/ShadowMap.h>
 #include <CroissantRenderer/Image/imageManager.h>
+#include <CroissantRenderer/Job/JobSystem.h>
+#include <CroissantRenderer/Memory/memoryAllocator.h>
 
 
+/*
+ * -Selects how the PBR models are lit(forward by default). It can't be
+ * changed once the renderer is running.
+ */
+void Renderer::setRenderPath(const RenderPath renderPath)
+{
+   m_renderPath = renderPath;
+}
+
 void Renderer::run()
 {
 
@@ -75,10 +88,37 @@ void Renderer::run()
          m_device->getPhysicalDevice(),
          m_qfHandles.graphicsQueue,
          m_commandPoolForGraphics,
+         m_qfIndices.graphicsFamily.value(),
          m_descriptorPoolForGraphics,
-         m_shadowMap
+         m_shadowMap,
+         m_shadowAtlas,
+         m_gBuffer,
+         m_depthBuffer
    );
 
+   // (it needs the meshes already in the geometry buffers)
+   if (config::GPU_CULLING &&
+       m_device->isMultiDrawIndirectSupported() &&
+       m_device->isDrawIndirectFirstInstanceSupported()
+   ) {
+      m_GPUculling = std::make_shared<GPUculling>(
+            m_device->getPhysicalDevice(),
+            m_device->getLogicalDevice(),
+            m_qfHandles.graphicsQueue,
+            m_commandPoolForGraphics,
+            m_qfIndices.graphicsFamily.value(),
+            m_scene.getModels(),
+            m_scene.getObjectModelIndices(),
+            m_scene.getInstances(),
+            m_scene.getVisibleInstances(),
+            m_scene.getTextures().getDescriptorSetLayout(),
+            m_swapchain->getExtent(),
+            m_depthBuffer.getFormat()
+      );
+   }
+
+   memoryAllocator::printStats();
+
    m_camera = std::make_shared<Arcball>(
          m_window->get(),
          glm::fvec4(0.0f, 0.0f, 5.0f, 1.0f),
@@ -105,6 +145,10 @@ void Renderer::run()
          m_window
    );
 
+   // (the startup pipelines are already compiled, so a crash doesn't lose
+   // them)
+   pipelineCache::save();
+
    mainLoop();
 
    cleanup();
@@ -140,13 +184,23 @@ void Renderer::addSkybox(
 
 }
 
+/*
+ * -The occluders hide the rest of the meshes in the software occlusion
+ * culling(e.g. the walls of a building).
+ * -Without shadows or IBL, its meshes are drawn with the variants of the PBR
+ * pipeline that skip them(in the deferred path, the G-buffer keeps them for
+ * the lighting pass).
+ */
 void Renderer::addObjectPBR(
       const std::string& name,
       const std::string& folderName,
       const std::string& fileName,
       const glm::fvec3& pos,
       const glm::fvec3& rot,
-      const glm::fvec3& size
+      const glm::fvec3& size,
+      const bool isOccluder,
+      const bool receivesShadows,
+      const bool usesIBL
 ) {
 
    m_modelsToLoadInfo.push_back({
@@ -159,7 +213,51 @@ void Renderer::addObjectPBR(
          rot,
          size,
          LightType::NONE,
-         glm::fvec3(0.0f)
+         glm::fvec3(0.0f),
+         {},
+         isOccluder,
+         receivesShadows,
+         usesIBL
+   });
+
+}
+
+/*
+ * -Adds copies of the same asset(loaded only once). Each transform places
+ * one copy relative to pos, rot and size, and all the copies of a mesh are
+ * drawn with instancing.
+ */
+void Renderer::addObjectPBRInstances(
+      const std::string& name,
+      const std::string& folderName,
+      const std::string& fileName,
+      const std::vector<glm::mat4>& instances,
+      const glm::fvec3& pos,
+      const glm::fvec3& rot,
+      const glm::fvec3& size,
+      const bool isOccluder,
+      const bool receivesShadows,
+      const bool usesIBL
+) {
+
+   if (instances.size() == 0)
+      throw std::runtime_error("Add at least 1 instance of " + name + ".");
+
+   m_modelsToLoadInfo.push_back({
+         ModelType::NORMAL_PBR,
+         name,
+         folderName,
+         fileName,
+         glm::fvec3(0.0f),
+         pos,
+         rot,
+         size,
+         LightType::NONE,
+         glm::fvec3(0.0f),
+         instances,
+         isOccluder,
+         receivesShadows,
+         usesIBL
    });
 
 }
@@ -355,6 +453,16 @@ void Renderer::initVK()
    
    m_qfHandles.setQueueHandles(m_device->getLogicalDevice(), m_qfIndices);
 
+   memoryAllocator::init(
+         m_device->getPhysicalDevice(),
+         m_device->getLogicalDevice()
+   );
+
+   pipelineCache::init(
+         m_device->getPhysicalDevice(),
+         m_device->getLogicalDevice()
+   );
+
    m_swapchain = std::make_shared<Swapchain>(
          m_device->getPhysicalDevice(),
          m_device->getLogicalDevice(),
@@ -364,28 +472,7 @@ void Renderer::initVK()
 
    //------------------------------Descriptor Pools----------------------------
 
-   m_descriptorPoolForGraphics = DescriptorPool(
-         m_device->getLogicalDevice(),
-         // Type of descriptors / Count of each type of descriptor in the pool.
-         {
-            {
-               VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-               // framesInFlight * #allmeshes
-               static_cast<uint32_t>(m_modelsToLoadInfo.size()) *
-               config::MAX_FRAMES_IN_FLIGHT *
-               100
-            },
-            { 
-               VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-               // framesInFlight * #allTextures
-               config::MAX_FRAMES_IN_FLIGHT * 100
-            }
-         },
-         // Descriptor SETS count.
-         // framesInFlight * #allMeshes
-         m_modelsToLoadInfo.size() * config::MAX_FRAMES_IN_FLIGHT * 100
-   );
-
+   // (the one for the graphics is created once the scene is loaded)
    m_descriptorPoolForComputations = DescriptorPool(
          m_device->getLogicalDevice(),
          {
@@ -407,13 +494,29 @@ void Renderer::initVK()
          m_swapchain->getImageFormat()
    );
 
+   // (the deferred lighting reads the depth to get the position)
    m_depthBuffer = DepthBuffer(
          m_device->getPhysicalDevice(),
          m_device->getLogicalDevice(),
          m_swapchain->getExtent(),
-         m_msaa.getSamplesCount()
+         m_msaa.getSamplesCount(),
+         (m_renderPath == RenderPath::DEFERRED) ? (
+            VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT
+         ) : 0
    );
 
+   if (m_renderPath == RenderPath::DEFERRED)
+   {
+      m_gBuffer = GBuffer(
+            m_device->getPhysicalDevice(),
+            m_device->getLogicalDevice(),
+            m_swapchain->getExtent(),
+            m_msaa.getSamplesCount()
+      );
+   }
+
+
+   m_jobSystem = std::make_shared<JobSystem>();
 
    m_scene = Scene(
          m_device->getLogicalDevice(),
@@ -421,28 +524,48 @@ void Renderer::initVK()
          m_swapchain->getExtent(),
          m_msaa.getSamplesCount(),
          m_depthBuffer.getFormat(),
+         m_renderPath,
          m_modelsToLoadInfo,
          // Parameters needed by the computations.
          m_device->getPhysicalDevice(),
          m_qfIndices,
-         m_descriptorPoolForComputations
+         m_descriptorPoolForComputations,
+         m_jobSystem
    );
 
+   // Sized for the models of the scene.
+   {
+      // Type of descriptors / Count of each type of descriptor in the pool.
+      std::vector<VkDescriptorPoolSize> poolSizes;
+      uint32_t descriptorSetsCount;
+
+      m_scene.getDescriptorsCount(poolSizes, descriptorSetsCount);
+
+      m_descriptorPoolForGraphics = DescriptorPool(
+            m_device->getLogicalDevice(),
+            poolSizes,
+            descriptorSetsCount
+      );
+   }
+
    //-----------------------------Secondary Features---------------------------
    //(these features are not used by all the pipelines and need dependencies)
 
+   // (all the PBR models cast shadows)
+   // (their pipelines are compiled here while the workers are still
+   // compiling the ones of the scene, see Scene::createPipelines())
    m_shadowMap = std::make_shared<ShadowMap<Attributes::PBR::Vertex>>(
          m_device->getPhysicalDevice(),
          m_device->getLogicalDevice(),
-         m_swapchain->getExtent(),
-         m_swapchain->getImageCount(),
          m_depthBuffer.getFormat(),
          config::MAX_FRAMES_IN_FLIGHT,
-         &(
-            std::dynamic_pointer_cast<NormalPBR>(
-               m_scene.getMainModel()
-            )->getMeshes()
-         ),
+         m_scene.getObjectModelIndices()
+   );
+   m_shadowAtlas = std::make_shared<ShadowAtlas>(
+         m_device->getPhysicalDevice(),
+         m_device->getLogicalDevice(),
+         m_qfIndices.graphicsFamily.value(),
+         m_depthBuffer.getFormat(),
          m_scene.getObjectModelIndices()
    );
 
@@ -451,7 +574,9 @@ void Renderer::initVK()
    m_swapchain->createFramebuffers(
          m_scene.getRenderPass(),
          m_depthBuffer,
-         m_msaa
+         m_msaa,
+         // (empty in the forward path)
+         m_gBuffer.getImageViews()
    );
 
    //--------------------------------------------------------------------------
@@ -507,8 +632,20 @@ void Renderer::recordCommandBuffer(
 
          //---------------------------------CMDs-------------------------------
 
+         // (the pipelines are sorted by subpass)
+         uint32_t subpass = 0;
+
          for (auto graphicsPipeline : graphicsPipelines)
          {
+            while (subpass < graphicsPipeline->getSubpass())
+            {
+               renderPass.nextSubpass(
+                     commandBuffer,
+                     VK_SUBPASS_CONTENTS_INLINE
+               );
+               subpass++;
+            }
+
             commandManager::state::bindPipeline(
                   graphicsPipeline->get(),
                   PipelineType::GRAPHICS,
@@ -533,11 +670,61 @@ void Renderer::recordCommandBuffer(
                   commandBuffer
             );
 
+            // All the models of the pipeline share the same vertex/index
+            // buffers.
+            m_scene.bindGeometry(
+                  graphicsPipeline->getGraphicsPipelineType(),
+                  commandBuffer
+            );
+
+            if (graphicsPipeline->getGraphicsPipelineType() ==
+                GraphicsPipelineType::DEFERRED_LIGHTING
+            ) {
+               m_scene.drawDeferredLighting(commandBuffer, currentFrame);
+
+               continue;
+            }
+
+            // Each variant of the PBR pipeline only draws the meshes with
+            // its material key.
             if (graphicsPipeline->getGraphicsPipelineType() ==
-                GraphicsPipelineType::SHADOWMAP
+                  GraphicsPipelineType::PBR ||
+                graphicsPipeline->getGraphicsPipelineType() ==
+                  GraphicsPipelineType::PBR_AFTER_DEPTH_PREPASS
             ) {
+               const auto& variants = m_scene.getPBRvariants(
+                     graphicsPipeline->getGraphicsPipelineType()
+               );
 
-               m_shadowMap->bindData(commandBuffer, currentFrame);
+               for (const auto& [materialKey, variant] : variants)
+               {
+                  // (the first one is already bound)
+                  if (&variant != graphicsPipeline)
+                  {
+                     commandManager::state::bindPipeline(
+                           variant.get(),
+                           PipelineType::GRAPHICS,
+                           commandBuffer
+                     );
+                  }
+
+                  for (auto i : variant.getModelIndices())
+                  {
+                     auto pModel = std::dynamic_pointer_cast<NormalPBR>(
+                           m_scene.getModel(i)
+                     );
+
+                     if (pModel && pModel->isHidden() == false)
+                     {
+                        pModel->bindData(
+                              &variant,
+                              materialKey,
+                              commandBuffer,
+                              currentFrame
+                        );
+                     }
+                  }
+               }
 
                continue;
             }
@@ -564,6 +751,165 @@ void Renderer::recordCommandBuffer(
    commandPool->endCommandBuffer(commandBuffer);
 }
 
+/*
+ * -Draws all the PBR models to each dirty cascade of the shadow map, with one
+ * render pass per cascade(each one only has the layer of its cascade). The
+ * layers of the other cascades are kept from the last time they were drawn.
+ */
+void Renderer::recordShadowMapCommandBuffer(const uint32_t currentFrame)
+{
+   const auto& commandPool = m_shadowMap->getCommandPool();
+   const VkCommandBuffer& commandBuffer = (
+         m_shadowMap->getCommandBuffer(currentFrame)
+   );
+   const RenderPass& renderPass = m_shadowMap->getRenderPass();
+   const Graphics& graphicsPipeline = m_shadowMap->getGraphicsPipeline();
+   const VkExtent2D& extent = m_shadowMap->getExtent();
+   const uint32_t cascadesCount = m_shadowMap->getCascades().count;
+
+   commandPool->resetCommandBuffer(currentFrame);
+   commandPool->beginCommandBuffer(0, commandBuffer);
+
+   for (uint32_t cascade = 0; cascade < cascadesCount; cascade++)
+   {
+      if (m_shadowMap->isCascadeDirty(cascade) == false)
+         continue;
+
+      renderPass.begin(
+            m_shadowMap->getFramebuffer(cascade),
+            extent,
+            m_clearValuesShadowMap,
+            commandBuffer,
+            VK_SUBPASS_CONTENTS_INLINE
+      );
+
+         commandManager::state::bindPipeline(
+               graphicsPipeline.get(),
+               PipelineType::GRAPHICS,
+               commandBuffer
+         );
+         // Set Dynamic States
+         commandManager::state::setViewport(
+               0.0f,
+               0.0f,
+               extent,
+               0.0f,
+               1.0f,
+               0,
+               1,
+               commandBuffer
+         );
+         commandManager::state::setScissor(
+               {0, 0},
+               extent,
+               0,
+               1,
+               commandBuffer
+         );
+
+         m_scene.bindGeometry(
+               GraphicsPipelineType::SHADOWMAP,
+               commandBuffer
+         );
+
+         for (auto i : m_scene.getObjectModelIndices())
+         {
+            auto pModel = std::dynamic_pointer_cast<NormalPBR>(
+                  m_scene.getModel(i)
+            );
+
+            if (pModel == nullptr || pModel->isHidden())
+               continue;
+
+            if (m_GPUculling)
+            {
+               m_shadowMap->bindDataIndirect(
+                     m_scene.getGeometryPBR(),
+                     pModel->getModelM(),
+                     cascade,
+                     m_GPUculling->getIndirectBuffer(currentFrame),
+                     m_GPUculling->getShadowCommandOffset(
+                        pModel->getFirstDrawIndex(),
+                        cascade
+                     ),
+                     pModel->getDraws16Count(),
+                     pModel->getMeshes().size(),
+                     commandBuffer,
+                     currentFrame
+               );
+
+            } else
+            {
+               m_shadowMap->bindData(
+                     m_scene.getGeometryPBR(),
+                     pModel->getMeshes(),
+                     pModel->getModelM(),
+                     cascade,
+                     pModel->getShadowVisibleInstancesCounts(cascade),
+                     commandBuffer,
+                     currentFrame
+               );
+            }
+         }
+
+      renderPass.end(commandBuffer);
+   }
+
+   commandPool->endCommandBuffer(commandBuffer);
+
+   m_shadowMap->clearDirty();
+}
+
+/*
+ * -Draws all the PBR models to the tiles of the shadow atlas picked this
+ * frame(see ShadowAtlas::update()), in the same render pass.
+ */
+void Renderer::recordShadowAtlasCommandBuffer(const uint32_t currentFrame)
+{
+   const auto& commandPool = m_shadowAtlas->getCommandPool();
+   const VkCommandBuffer& commandBuffer = (
+         m_shadowAtlas->getCommandBuffer(currentFrame)
+   );
+
+   commandPool->resetCommandBuffer(currentFrame);
+   commandPool->beginCommandBuffer(0, commandBuffer);
+
+   m_shadowAtlas->beginRenderPass(commandBuffer);
+
+      m_scene.bindGeometry(
+            GraphicsPipelineType::SHADOWMAP,
+            commandBuffer
+      );
+
+      for (auto tile : m_shadowAtlas->getTilesToDraw())
+      {
+         m_shadowAtlas->beginTile(tile, commandBuffer);
+
+         for (auto i : m_scene.getObjectModelIndices())
+         {
+            auto pModel = std::dynamic_pointer_cast<NormalPBR>(
+                  m_scene.getModel(i)
+            );
+
+            if (pModel == nullptr || pModel->isHidden())
+               continue;
+
+            m_shadowAtlas->bindData(
+                  m_scene.getGeometryPBR(),
+                  pModel->getMeshes(),
+                  pModel->getModelM(),
+                  tile,
+                  commandBuffer,
+                  currentFrame
+            );
+         }
+      }
+
+   m_shadowAtlas->endRenderPass(commandBuffer);
+
+   commandPool->endCommandBuffer(commandBuffer);
+}
+
 void Renderer::drawFrame(uint8_t& currentFrame)
 {
 
@@ -601,28 +947,77 @@ void Renderer::drawFrame(uint8_t& currentFrame)
             m_scene.getDirectionalLight()
       );
 
-      auto pMainModel = std::dynamic_pointer_cast<NormalPBR>(
-            m_scene.getMainModel()
-      );
-      m_shadowMap->updateUBO(
-            // TODO: make it for more than 1 model
-            pMainModel->getModelM(),
+      m_shadowMap->updateCascades(
+            m_camera,
             pLight->getPos(),
             pLight->getTargetPos(),
-            m_camera->getAspect(),
-            config::Z_NEAR,
-            config::Z_FAR,
             currentFrame
       );
    }
 
    m_scene.updateUBO(
          m_camera,
-         m_shadowMap->getLightSpace(),
+         m_shadowMap->getCascades(),
          m_swapchain->getExtent(),
          currentFrame
    );
 
+   // Casters of the shadow map and of the shadow atlas(all the PBR models),
+   // once their model matrices are updated.
+   std::vector<glm::mat4> castersModelMs;
+   uint64_t castersTrianglesCount = 0;
+
+   for (auto i : m_scene.getObjectModelIndices())
+   {
+      auto pModel = std::dynamic_pointer_cast<NormalPBR>(
+            m_scene.getModel(i)
+      );
+
+      if (pModel == nullptr)
+         continue;
+
+      castersModelMs.push_back(
+            (pModel->isHidden()) ? glm::mat4(0.0f) : pModel->getModelM()
+      );
+
+      if (pModel->isHidden())
+         continue;
+
+      for (const auto& mesh : pModel->getMeshes())
+      {
+         castersTrianglesCount += (
+               (uint64_t)mesh.lods[0].indicesCount / 3 * mesh.instancesCount
+         );
+      }
+   }
+   m_shadowMap->updateCasters(castersModelMs);
+   // (after the update of the lights buffer)
+   m_shadowAtlas->update(
+         m_scene.getLightsInfo(),
+         glm::vec3(m_camera->getPos()),
+         castersModelMs,
+         castersTrianglesCount,
+         currentFrame
+   );
+
+   if (m_GPUculling)
+   {
+      m_GPUculling->update(
+            m_camera,
+            m_shadowMap->getCascades(),
+            m_swapchain->getExtent(),
+            currentFrame
+      );
+
+   } else
+   {
+      m_scene.cullMeshes(
+            m_camera,
+            m_shadowMap->getCascades(),
+            currentFrame
+      );
+   }
+
 
    //--------------------Acquires an image from the swapchain------------------
    
@@ -632,30 +1027,46 @@ void Renderer::drawFrame(uint8_t& currentFrame)
 
    //---------------------Records all the command buffer-----------------------
 
+   // GPU culling
+   if (m_GPUculling)
+      m_GPUculling->recordCommandBuffer(currentFrame);
+
+   // Occluders of the Hi-Z
+   const HiZ* hiZ = (m_GPUculling) ? m_GPUculling->getHiZ() : nullptr;
+   if (hiZ)
+   {
+      recordCommandBuffer(
+            hiZ->getFramebuffer(),
+            hiZ->getRenderPass(),
+            m_swapchain->getExtent(),
+            {
+               &hiZ->getOccludersPipeline()
+            },
+            currentFrame,
+            hiZ->getCommandBuffer(currentFrame),
+            m_clearValuesShadowMap,
+            hiZ->getCommandPool()
+      );
+   }
+
    // Shadow Map
-   recordCommandBuffer(
-         m_shadowMap->getFramebuffer(imageIndex),
-         m_shadowMap->getRenderPass(),
-         m_swapchain->getExtent(),
-         {
-            &m_shadowMap->getGraphicsPipeline()
-         },
-         currentFrame,
-         m_shadowMap->getCommandBuffer(currentFrame),
-         m_clearValuesShadowMap,
-         m_shadowMap->getCommandPool()
+   // (nothing is submitted if all the cascades are cached)
+   const bool isShadowMapDirty = m_shadowMap->isDirty();
+   if (isShadowMapDirty)
+      recordShadowMapCommandBuffer(currentFrame);
+   // Shadow Atlas
+   // (only the tiles picked by the budget of this frame)
+   const bool isShadowAtlasDrawn = (
+         m_shadowAtlas->getTilesToDraw().empty() == false
    );
+   if (isShadowAtlasDrawn)
+      recordShadowAtlasCommandBuffer(currentFrame);
    // Scene
    recordCommandBuffer(
          m_swapchain->getFramebuffer(imageIndex),
          m_scene.getRenderPass(),
          m_swapchain->getExtent(),
-         {
-            &m_scene.getLightPipeline(),
-            &m_scene.getPBRpipeline(),
-            // The skybox has to be always the last one.
-            &m_scene.getSkyboxPipeline()
-         },
+         m_scene.getPipelines(),
          currentFrame,
          m_commandPoolForGraphics->getCommandBuffer(currentFrame),
          m_clearValues,
@@ -667,10 +1078,49 @@ void Renderer::drawFrame(uint8_t& currentFrame)
    //----------------------Submits the command buffer--------------------------
 
    std::vector<VkCommandBuffer> commandBuffersToSubmit = {
-      m_shadowMap->getCommandBuffer(currentFrame),
       m_commandPoolForGraphics->getCommandBuffer(currentFrame),
       m_GUI->getCommandBuffer(currentFrame)
    };
+
+   if (isShadowAtlasDrawn)
+   {
+      commandBuffersToSubmit.insert(
+            commandBuffersToSubmit.begin(),
+            m_shadowAtlas->getCommandBuffer(currentFrame)
+      );
+   }
+   if (isShadowMapDirty)
+   {
+      commandBuffersToSubmit.insert(
+            commandBuffersToSubmit.begin(),
+            m_shadowMap->getCommandBuffer(currentFrame)
+      );
+   }
+
+   // (the culling has to be executed before the draws)
+   if (m_GPUculling)
+   {
+      // (early culling -> occluders -> late culling)
+      if (hiZ)
+      {
+         commandBuffersToSubmit.insert(
+               commandBuffersToSubmit.begin(),
+               {
+                  hiZ->getCommandBuffer(currentFrame),
+                  m_GPUculling->getLateCommandBuffer(currentFrame)
+               }
+         );
+      }
+      commandBuffersToSubmit.insert(
+            commandBuffersToSubmit.begin(),
+            m_GPUculling->getCommandBuffer(currentFrame)
+      );
+   }
+   // (the PBR models read the lights of each cluster)
+   commandBuffersToSubmit.insert(
+         commandBuffersToSubmit.begin(),
+         m_scene.getLightClusters()->getCommandBuffer(currentFrame)
+   );
    std::vector<VkSemaphore> waitSemaphores = {
       m_imageAvailableSemaphores[currentFrame]
    };
@@ -796,6 +1246,9 @@ void Renderer::mainLoop()
       calculateFrames(lastTime, framesCounter);
 
       handleInput();
+
+      bool isDepthPrepassEnabled = m_scene.isDepthPrepassEnabled();
+
       // Draws Imgui
       m_GUI->draw(
             m_scene.getModels(),
@@ -805,8 +1258,16 @@ void Renderer::mainLoop()
             m_device->getDeviceName(),
             m_mpf,
             m_msaa.getSamplesCount(),
-            m_device->getApiVersion()
+            m_device->getApiVersion(),
+            (
+               (m_GPUculling) ?
+                  m_GPUculling->getStats() :
+                  m_scene.getCullingStats()
+            ),
+            isDepthPrepassEnabled
       );
+      m_scene.setDepthPrepass(isDepthPrepassEnabled);
+
       drawFrame(currentFrame);
    }
    vkDeviceWaitIdle(m_device->getLogicalDevice());
@@ -911,6 +1372,10 @@ void Renderer::cleanup()
    // DepthBuffer
    m_depthBuffer.destroy();
 
+   // G-buffer
+   if (m_renderPath == RenderPath::DEFERRED)
+      m_gBuffer.destroy();
+
    // ImGui
    m_GUI->destroy();
 
@@ -922,6 +1387,10 @@ void Renderer::cleanup()
 
    // Models -> Buffers, Memories and Textures.
    m_shadowMap->destroy();
+   m_shadowAtlas->destroy();
+
+   if (m_GPUculling)
+      m_GPUculling->destroy();
 
    // Descriptor Pool
    m_descriptorPoolForGraphics.destroy();
@@ -934,6 +1403,13 @@ void Renderer::cleanup()
    if (m_commandPoolForGraphics) m_commandPoolForGraphics->destroy();
    if (m_commandPoolForCompute)  m_commandPoolForCompute->destroy();
    
+   // Pipeline cache(saved to disk) and shader modules
+   pipelineCache::destroy();
+   shaderManager::destroyShaderModules(m_device->getLogicalDevice());
+
+   // Memory blocks
+   memoryAllocator::destroy();
+
    // Logical Device
    vkDestroyDevice(m_device->getLogicalDevice(), nullptr);
    
@@ -945,6 +1421,9 @@ void Renderer::cleanup()
 
    // GLFW
    m_window->destroy();
+
+   // Workers
+   m_jobSystem->destroy();
 }
 
 void Renderer::demo1()
@@ -1022,7 +1501,8 @@ void Renderer::demo4()
          "Sponza.gltf",
          glm::fvec3(0.0f),
          glm::fvec3(1.0f, -1.555, 1.0f),
-         glm::fvec3(1.0f)
+         glm::fvec3(1.0f),
+         true
    );
    addDirectionalLight(
          "Sun",
@@ -1044,7 +1524,8 @@ void Renderer::demo5()
          "Sponza.gltf",
          glm::fvec3(0.0f),
          glm::fvec3(1.0f, -1.555, 1.0f),
-         glm::fvec3(1.0f)
+         glm::fvec3(1.0f),
+         true
    );
    addDirectionalLight(
          "Sun",
@@ -0,0 +1,14 @@
+#pragma once
+
+/*
+ * How the PBR models are lit:
+ *    -FORWARD: each fragment of the models is lit while it's drawn.
+ *    -DEFERRED: the models write their material to a G-buffer and then the
+ *    lighting is done once per sample of the screen(the overdraw of the
+ *    models doesn't pay for the lighting). It needs MSAA.
+ */
+enum class RenderPath
+{
+   FORWARD  = 0,
+   DEFERRED = 1
+};
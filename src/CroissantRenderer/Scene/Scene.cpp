@@ -1,9 +1,41 @@
 #include <CroissantRenderer/Scene/Scene.h>
 
-#include <thread>
 #include <iostream>
+#include <exception>
+#include <map>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <set>
+#include <functional>
+#include <utility>
 
 #include <CroissantRenderer/Texture/Type/NormalTexture.h>
+#include <CroissantRenderer/Buffer/UploadBatch.h>
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
+#include <CroissantRenderer/Command/commandManager.h>
+#include <CroissantRenderer/Model/materialFeatures.h>
+
+// Attenuation of the point and spot lights(the same as in scene.frag).
+static const float LIGHT_LINEAR = 0.09f;
+static const float LIGHT_QUADRATIC = 0.032f;
+
+/*
+ * -Specialization constants of the fragment shader of a variant of the PBR
+ * pipeline: SHADOW_FILTER and then one bool per bit of the material key.
+ */
+static std::vector<uint32_t> getPBRspecializationConstants(
+      const uint32_t materialKey
+) {
+   std::vector<uint32_t> constants = {
+      static_cast<uint32_t>(config::SHADOW_FILTER)
+   };
+
+   for (uint32_t bit = 0; bit < materialFeatures::COUNT; bit++)
+      constants.push_back((materialKey >> bit) & 1);
+
+   return constants;
+}
 
 Scene::Scene() {}
 
@@ -13,18 +45,50 @@ Scene::Scene(
       const VkExtent2D& extent,
       const VkSampleCountFlagBits& msaaSamplesCount,
       const VkFormat& depthBufferFormat,
+      const RenderPath renderPath,
       const std::vector<ModelInfo>& modelsToLoadInfo,
       // Parameters needed for the computations.
       const VkPhysicalDevice& physicalDevice,
       const QueueFamilyIndices& queueFamilyIndices,
-      DescriptorPool& descriptorPoolForComputations
+      DescriptorPool& descriptorPoolForComputations,
+      const std::shared_ptr<JobSystem>& jobSystem
 ) : m_logicalDevice(logicalDevice),
+    m_jobSystem(jobSystem),
+    m_renderPath(renderPath),
+    m_isDepthPrepassEnabled(config::DEPTH_PREPASS),
     m_mainModelIndex(-1),
     m_directionalLightIndex(-1)
 {
+   // (the lighting subpass reads the samples of the G-buffer)
+   if (m_renderPath == RenderPath::DEFERRED &&
+       msaaSamplesCount == VK_SAMPLE_COUNT_1_BIT
+   ) {
+      throw std::runtime_error(
+            "The deferred render path needs MSAA."
+      );
+   }
+
    loadModels(modelsToLoadInfo);
 
-   createRenderPass(format, msaaSamplesCount, depthBufferFormat);
+   if (config::SOFTWARE_OCCLUSION_CULLING)
+   {
+      m_maskedOcclusion = MaskedOcclusion(
+            config::SOFTWARE_OCCLUSION_W,
+            config::SOFTWARE_OCCLUSION_H
+      );
+   }
+
+   // (the PBR pipeline needs its layout)
+   m_textures = BindlessTextures(
+         physicalDevice,
+         m_logicalDevice,
+         GRAPHICS_PIPELINE::PBR::TEXTURES_INFO
+   );
+
+   if (m_renderPath == RenderPath::DEFERRED)
+      createDeferredRenderPass(format, msaaSamplesCount, depthBufferFormat);
+   else
+      createRenderPass(format, msaaSamplesCount, depthBufferFormat);
 
    createPipelines(format, extent, msaaSamplesCount);
 
@@ -179,164 +243,581 @@ void Scene::createRenderPass(
    );
 }
 
-void Scene::createPipelines(
+/*
+ * -Render pass of the deferred path, with 2 subpasses:
+ *    0 -> the PBR models write their material to the G-buffer and the depth.
+ *    1 -> the lighting reads them as input attachments and writes the color,
+ *    and then the skybox and the lights are drawn(with the depth
+ *    read-only).
+ * -The G-buffer is never stored, it only lives inside the render pass(so the
+ * tile-based GPUs can keep it on-chip).
+ * -Attachments: 0 color, 1 depth, 2 color resolve and 3.. G-buffer(the same
+ * order as the framebuffers).
+ */
+void Scene::createDeferredRenderPass(
       const VkFormat& format,
-      const VkExtent2D& extent,
-      const VkSampleCountFlagBits& msaaSamplesCount
+      const VkSampleCountFlagBits& msaaSamplesCount,
+      const VkFormat& depthBufferFormat
 ) {
+   // -Attachments
 
-   m_graphicsPipelineSkybox = Graphics(
-         m_logicalDevice,
-         GraphicsPipelineType::SKYBOX,
-         extent,
-         m_renderPass,
-         {
-            {
-               shaderType::VERTEX,
-               "skybox"
-            },
-            {
-               shaderType::FRAGMENT,
-               "skybox"
-            }
-         },
+   // Color Attachment
+   VkAttachmentDescription colorAttachment{};
+   attachmentUtils::createAttachmentDescription(
+         format,
          msaaSamplesCount,
-         Attributes::SKYBOX::getBindingDescription(),
-         Attributes::SKYBOX::getAttributeDescriptions(),
-         m_skyboxModelIndex,
-         GRAPHICS_PIPELINE::SKYBOX::UBOS_INFO,
-         GRAPHICS_PIPELINE::SKYBOX::SAMPLERS_INFO,
-         {}
+         VK_ATTACHMENT_LOAD_OP_CLEAR,
+         VK_ATTACHMENT_STORE_OP_STORE,
+         VK_IMAGE_LAYOUT_UNDEFINED,
+         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+         colorAttachment
    );
-   
-   m_graphicsPipelinePBR = Graphics(
-         m_logicalDevice,
-         GraphicsPipelineType::PBR,
-         extent,
-         m_renderPass,
-         {
-            {
-               shaderType::VERTEX,
-               // Filename of the vertex shader.
-               "scene"
-            },
-            {
-               shaderType::FRAGMENT,
-               // Filename of the fragment shader.
-               "scene"
-            }
-         },
+
+   // Depth Attachment
+   VkAttachmentDescription depthAttachment{};
+   attachmentUtils::createAttachmentDescriptionWithStencil(
+         depthBufferFormat,
          msaaSamplesCount,
-         Attributes::PBR::getBindingDescription(),
-         Attributes::PBR::getAttributeDescriptions(),
-         // Models assocciated with this graphics pipeline.
-         m_objectModelIndices,
-         GRAPHICS_PIPELINE::PBR::UBOS_INFO,
-         GRAPHICS_PIPELINE::PBR::SAMPLERS_INFO,
-         {}
+         VK_ATTACHMENT_LOAD_OP_CLEAR,
+         VK_ATTACHMENT_STORE_OP_DONT_CARE,
+         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+         VK_ATTACHMENT_STORE_OP_DONT_CARE,
+         VK_IMAGE_LAYOUT_UNDEFINED,
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+         depthAttachment
    );
 
-   m_graphicsPipelineLight = Graphics(
-         m_logicalDevice,
-         GraphicsPipelineType::LIGHT,
-         extent,
-         m_renderPass,
-         {
-            {
-               shaderType::VERTEX,
-               "light"
-            },
-            {
-               shaderType::FRAGMENT,
-               "light"
-            }
-         },
-         msaaSamplesCount,
-         Attributes::LIGHT::getBindingDescription(),
-         Attributes::LIGHT::getAttributeDescriptions(),
-         // Models assocciated with this graphics pipeline.
-         m_lightModelIndices,
-         GRAPHICS_PIPELINE::LIGHT::UBOS_INFO,
-         GRAPHICS_PIPELINE::LIGHT::SAMPLERS_INFO,
-         {}
+   // Color Resolve Attachment(needed by MSAA)
+   VkAttachmentDescription colorResolveAttachment{};
+   attachmentUtils::createAttachmentDescriptionWithStencil(
+         format,
+         VK_SAMPLE_COUNT_1_BIT,
+         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+         VK_ATTACHMENT_STORE_OP_STORE,
+         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+         VK_ATTACHMENT_STORE_OP_DONT_CARE,
+         VK_IMAGE_LAYOUT_UNDEFINED,
+         // (the GUI presents it)
+         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+         colorResolveAttachment
    );
-}
 
-void Scene::loadModels(const std::vector<ModelInfo>& modelsToLoadInfo)
-{
-   std::vector<std::thread> threads;
+   std::vector<VkAttachmentDescription> attachments = {
+      colorAttachment,
+      depthAttachment,
+      colorResolveAttachment
+   };
+
+   // G-buffer Attachments
+   // (fully written by the first subpass and discarded at the end)
+   for (auto& gBufferFormat : GBuffer::getFormats())
+   {
+      VkAttachmentDescription gBufferAttachment{};
+      attachmentUtils::createAttachmentDescription(
+            gBufferFormat,
+            msaaSamplesCount,
+            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            gBufferAttachment
+      );
+
+      attachments.push_back(gBufferAttachment);
+   }
+
+   // Attachment references
+
+   VkAttachmentReference colorAttachmentRef{};
+   attachmentUtils::createAttachmentReference(
+         0,
+         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+         colorAttachmentRef
+   );
+
+   VkAttachmentReference depthAttachmentRef{};
+   attachmentUtils::createAttachmentReference(
+         1,
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+         depthAttachmentRef
+   );
+
+   VkAttachmentReference depthReadOnlyAttachmentRef{};
+   attachmentUtils::createAttachmentReference(
+         1,
+         VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+         depthReadOnlyAttachmentRef
+   );
+
+   VkAttachmentReference colorResolveAttachmentRef{};
+   attachmentUtils::createAttachmentReference(
+         2,
+         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+         colorResolveAttachmentRef
+   );
+
+   std::vector<VkAttachmentReference> gBufferAttachmentRefs(
+         GBuffer::getFormats().size()
+   );
+   // (the G-buffer + the depth, in the order of the input attachments of
+   // deferredLighting.frag)
+   std::vector<VkAttachmentReference> inputAttachmentRefs(
+         GBuffer::getFormats().size()
+   );
+
+   for (uint32_t i = 0; i < gBufferAttachmentRefs.size(); i++)
+   {
+      attachmentUtils::createAttachmentReference(
+            3 + i,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            gBufferAttachmentRefs[i]
+      );
+      attachmentUtils::createAttachmentReference(
+            3 + i,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            inputAttachmentRefs[i]
+      );
+   }
+   inputAttachmentRefs.push_back(depthReadOnlyAttachmentRef);
+
+   // Subpasses
+
+   // G-buffer
+   VkSubpassDescription gBufferSubPassDescript{};
+   subPassUtils::createSubPassDescription(
+         VK_PIPELINE_BIND_POINT_GRAPHICS,
+         gBufferAttachmentRefs.data(),
+         &depthAttachmentRef,
+         nullptr,
+         gBufferSubPassDescript,
+         static_cast<uint32_t>(gBufferAttachmentRefs.size())
+   );
+
+   // Lighting
+   VkSubpassDescription lightingSubPassDescript{};
+   subPassUtils::createSubPassDescription(
+         VK_PIPELINE_BIND_POINT_GRAPHICS,
+         &colorAttachmentRef,
+         &depthReadOnlyAttachmentRef,
+         &colorResolveAttachmentRef,
+         lightingSubPassDescript,
+         1,
+         inputAttachmentRefs.data(),
+         static_cast<uint32_t>(inputAttachmentRefs.size())
+   );
+
+   // Subpass dependencies
+
+   // (the same as the forward path, for each subpass)
+   std::vector<VkSubpassDependency> dependencies(3);
+   for (uint32_t i = 0; i < 2; i++)
+   {
+      subPassUtils::createSubPassDependency(
+            VK_SUBPASS_EXTERNAL,
+            (
+             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+            ),
+            0,
+            i,
+            (
+             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+            ),
+            (
+             VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+            ),
+            (VkDependencyFlagBits)0,
+            dependencies[i]
+      );
+   }
+
+   // The lighting reads the G-buffer and the depth written by the first
+   // subpass(only the same sample, so it can be done by region).
+   subPassUtils::createSubPassDependency(
+         0,
+         (
+          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+          VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+         ),
+         (
+          VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+         ),
+         1,
+         (
+          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+          VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+         ),
+         (
+          VK_ACCESS_INPUT_ATTACHMENT_READ_BIT |
+          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+         ),
+         VK_DEPENDENCY_BY_REGION_BIT,
+         dependencies[2]
+   );
 
-   const size_t maxThreadsCount = std::thread::hardware_concurrency() - 1;
-   size_t chunckSize = (
-         (modelsToLoadInfo.size() < maxThreadsCount) ?
-            1 :
-            modelsToLoadInfo.size() / maxThreadsCount
+   m_renderPass = RenderPass(
+         m_logicalDevice,
+         attachments,
+         {gBufferSubPassDescript, lightingSubPassDescript},
+         dependencies
    );
-   const size_t threadsCount = (
-         (modelsToLoadInfo.size() < maxThreadsCount) ?
-            modelsToLoadInfo.size() :
-            maxThreadsCount
+}
+
+/*
+ * -Compiles the pipelines of the scene as independent jobs. The render pass
+ * and the descriptor set layouts that they need are created before, so the
+ * jobs only read their handles. waitPipelines() moves them to their targets
+ * once they are needed.
+ * -The jobs only capture copies(the scene is moved after its construction,
+ * while they are still running).
+ * -The PBR pipelines are compiled once per material key used by the models,
+ * so the permutations that no material needs aren't compiled.
+ */
+void Scene::createPipelines(
+      const VkFormat& format,
+      const VkExtent2D& extent,
+      const VkSampleCountFlagBits& msaaSamplesCount
+) {
+   const bool isDeferred = (m_renderPath == RenderPath::DEFERRED);
+   // (in the deferred path, everything but the PBR models is drawn after the
+   // lighting)
+   const uint32_t lightingSubpass = (isDeferred) ? 1 : 0;
+   const uint32_t pbrColorAttachmentsCount = (isDeferred) ? (
+         static_cast<uint32_t>(GBuffer::getFormats().size())
+   ) : 1;
+
+   const VkDevice logicalDevice = m_logicalDevice;
+   const RenderPass renderPass = m_renderPass;
+   const VkDescriptorSetLayout texturesSetLayout = (
+         m_textures.getDescriptorSetLayout()
    );
+   const std::vector<size_t> skyboxModelIndex = m_skyboxModelIndex;
+   const std::vector<size_t> objectModelIndices = m_objectModelIndices;
+   const std::vector<size_t> lightModelIndices = m_lightModelIndices;
+
+   // (where each pipeline goes / its creation)
+   std::vector<std::pair<
+      std::function<Graphics&(Scene&)>,
+      std::function<Graphics()>
+   >> pipelines;
+
+   // (for the pipelines that go to a member)
+   auto member = [](Graphics Scene::* pipeline) {
+      return [pipeline](Scene& scene) -> Graphics& {
+         return scene.*pipeline;
+      };
+   };
+
+   pipelines.push_back({member(&Scene::m_graphicsPipelineSkybox), [=]() {
+      return Graphics(
+            logicalDevice,
+            GraphicsPipelineType::SKYBOX,
+            extent,
+            renderPass,
+            {
+               {
+                  shaderType::VERTEX,
+                  "skybox"
+               },
+               {
+                  shaderType::FRAGMENT,
+                  "skybox"
+               }
+            },
+            msaaSamplesCount,
+            Attributes::SKYBOX::getBindingDescription(),
+            Attributes::SKYBOX::getAttributeDescriptions(),
+            skyboxModelIndex,
+            GRAPHICS_PIPELINE::SKYBOX::UBOS_INFO,
+            GRAPHICS_PIPELINE::SKYBOX::SAMPLERS_INFO,
+            {},
+            {},
+            lightingSubpass
+      );
+   }});
+
+   std::set<uint32_t> materialKeys;
 
-   for (size_t i = 0; i < threadsCount; i++)
+   for (auto i : m_objectModelIndices)
    {
-      if (i == threadsCount - 1 && maxThreadsCount < modelsToLoadInfo.size())
+      if (auto pModel = std::dynamic_pointer_cast<NormalPBR>(m_models[i]))
       {
-         chunckSize += (
-               modelsToLoadInfo.size() - (threadsCount * chunckSize)
-         );
+         // (the G-buffer doesn't depend on the lighting, so those keys
+         // would compile the same variant)
+         if (isDeferred)
+            pModel->maskMaterialKeys(~materialFeatures::LIGHTING);
+
+         const auto& keys = pModel->getMaterialKeys();
+         materialKeys.insert(keys.begin(), keys.end());
       }
+   }
 
-      threads.push_back(
-            std::thread(
-               &Scene::loadModel,
-               this,
-               i,
-               chunckSize,
-               modelsToLoadInfo
-            )
+   // (without PBR models, the variant with all the features still gives the
+   // layout of the PBR pipeline)
+   if (materialKeys.empty())
+   {
+      materialKeys.insert(
+            ((1u << materialFeatures::COUNT) - 1) &
+            ((isDeferred) ? ~materialFeatures::LIGHTING : ~0u)
       );
    }
 
-   for (auto& thread : threads)
-      thread.join();
+   // (PBR_AFTER_DEPTH_PREPASS only changes the depth state)
+   for (auto type : {
+         GraphicsPipelineType::PBR,
+         GraphicsPipelineType::PBR_AFTER_DEPTH_PREPASS
+   }) {
+      for (const uint32_t materialKey : materialKeys)
+      {
+         // (the lighting features that aren't in the key stay on, so the
+         // G-buffer takes them from the material)
+         const uint32_t specializedKey = (isDeferred) ? (
+               materialKey | materialFeatures::LIGHTING
+         ) : materialKey;
+         std::map<uint32_t, Graphics> Scene::* variants = (
+               (type == GraphicsPipelineType::PBR) ? (
+                  &Scene::m_graphicsPipelinesPBR
+               ) : &Scene::m_graphicsPipelinesPBRafterDepthPrepass
+         );
+         auto target = [variants, materialKey](Scene& scene) -> Graphics& {
+            return (scene.*variants)[materialKey];
+         };
+
+         pipelines.push_back({target, [=]() {
+            return Graphics(
+                  logicalDevice,
+                  type,
+                  extent,
+                  renderPass,
+                  {
+                     {
+                        shaderType::VERTEX,
+                        // Filename of the vertex shader.
+                        "scene"
+                     },
+                     {
+                        shaderType::FRAGMENT,
+                        // Filename of the fragment shader.
+                        // (the deferred path only writes the material)
+                        (isDeferred) ? "gBuffer" : "scene",
+                        getPBRspecializationConstants(specializedKey)
+                     }
+                  },
+                  msaaSamplesCount,
+                  Attributes::PBR::getBindingDescription(),
+                  Attributes::PBR::getAttributeDescriptions(),
+                  // Models assocciated with this graphics pipeline.
+                  objectModelIndices,
+                  GRAPHICS_PIPELINE::PBR::UBOS_INFO,
+                  GRAPHICS_PIPELINE::PBR::SAMPLERS_INFO,
+                  {},
+                  // (GRAPHICS_PIPELINE::PBR::TEXTURES_SET)
+                  {texturesSetLayout},
+                  0,
+                  pbrColorAttachmentsCount
+            );
+         }});
+      }
+   }
 
-   if (m_objectModelIndices.size() == 0)
-      throw std::runtime_error(
-            "Add at least 1 model."
-      );
-   if (m_directionalLightIndex == -1)
-      throw std::runtime_error(
-            "Add at least 1 directional light."
+   // Only the positions and the depth. It has the same layout as the PBR
+   // pipeline, so the models bind their descriptor sets as in the PBR pass.
+   pipelines.push_back({member(&Scene::m_graphicsPipelineDepthPrepass), [=]() {
+      return Graphics(
+            logicalDevice,
+            GraphicsPipelineType::DEPTH_PREPASS,
+            extent,
+            renderPass,
+            {
+               {
+                  shaderType::VERTEX,
+                  "depthPrepass"
+               }
+            },
+            msaaSamplesCount,
+            Attributes::DEPTH_PREPASS::getBindingDescription(),
+            Attributes::DEPTH_PREPASS::getAttributeDescriptions(),
+            objectModelIndices,
+            GRAPHICS_PIPELINE::PBR::UBOS_INFO,
+            GRAPHICS_PIPELINE::PBR::SAMPLERS_INFO,
+            {},
+            {texturesSetLayout},
+            0,
+            pbrColorAttachmentsCount
       );
-   if (m_skyboxModelIndex.size() == 0)
-      throw std::runtime_error(
-            "Add at least 1 skybox."
+   }});
+
+   pipelines.push_back({member(&Scene::m_graphicsPipelineLight), [=]() {
+      return Graphics(
+            logicalDevice,
+            GraphicsPipelineType::LIGHT,
+            extent,
+            renderPass,
+            {
+               {
+                  shaderType::VERTEX,
+                  "light"
+               },
+               {
+                  shaderType::FRAGMENT,
+                  "light"
+               }
+            },
+            msaaSamplesCount,
+            Attributes::LIGHT::getBindingDescription(),
+            Attributes::LIGHT::getAttributeDescriptions(),
+            // Models assocciated with this graphics pipeline.
+            lightModelIndices,
+            GRAPHICS_PIPELINE::LIGHT::UBOS_INFO,
+            GRAPHICS_PIPELINE::LIGHT::SAMPLERS_INFO,
+            {},
+            {},
+            lightingSubpass
       );
-   if (m_skyboxModelIndex.size() > 1)
-      throw std::runtime_error(
-            "You can't add more than 1 skybox per scene."
+   }});
+
+   // (a full-screen triangle, without vertex buffer)
+   if (isDeferred)
+   {
+      auto lighting = member(&Scene::m_graphicsPipelineDeferredLighting);
+
+      pipelines.push_back({lighting, [=]() {
+         return Graphics(
+               logicalDevice,
+               GraphicsPipelineType::DEFERRED_LIGHTING,
+               extent,
+               renderPass,
+               {
+                  {
+                     shaderType::VERTEX,
+                     "deferredLighting"
+                  },
+                  {
+                     shaderType::FRAGMENT,
+                     "deferredLighting",
+                     // (SHADOW_FILTER)
+                     {static_cast<uint32_t>(config::SHADOW_FILTER)}
+                  }
+               },
+               msaaSamplesCount,
+               {},
+               {},
+               {},
+               GRAPHICS_PIPELINE::DEFERRED_LIGHTING::UBOS_INFO,
+               GRAPHICS_PIPELINE::DEFERRED_LIGHTING::SAMPLERS_INFO,
+               {},
+               {},
+               lightingSubpass
+         );
+      }});
+   }
+
+   auto build = std::make_shared<PipelinesBuild>();
+   build->job = m_jobSystem->createJob([](){});
+   build->pipelines.resize(pipelines.size());
+   build->errors.resize(pipelines.size());
+
+   for (size_t i = 0; i < pipelines.size(); i++)
+   {
+      build->targets.push_back(pipelines[i].first);
+
+      auto create = pipelines[i].second;
+
+      m_jobSystem->run(
+            m_jobSystem->createJob(
+               [build, create, i]() {
+                  // The exceptions can't cross threads, so we save them and
+                  // waitPipelines() rethrows them.
+                  try
+                  {
+                     build->pipelines[i] = create();
+
+                  } catch (...)
+                  {
+                     build->errors[i] = std::current_exception();
+                  }
+               },
+               build->job
+            )
       );
+   }
+
+   m_jobSystem->run(build->job);
+
+   m_pipelinesBuild = build;
 }
 
-void Scene::loadModel(
-      const size_t startI,
-      const size_t chunckSize,
-      const std::vector<ModelInfo>& modelsToLoadInfo
-) {
-   const size_t endI = startI + chunckSize;
+/*
+ * -Waits for the pipelines of createPipelines()(the calling thread helps with
+ * the pending jobs meanwhile) and moves them to their targets.
+ */
+void Scene::waitPipelines()
+{
+   if (m_pipelinesBuild == nullptr)
+      return;
+
+   auto build = m_pipelinesBuild;
+   m_pipelinesBuild = nullptr;
+
+   m_jobSystem->wait(build->job);
+
+   for (size_t i = 0; i < build->targets.size(); i++)
+      build->targets[i](*this) = build->pipelines[i];
+
+   for (auto& error : build->errors)
+   {
+      if (error)
+         std::rethrow_exception(error);
+   }
+}
+
+/*
+ * -Loads every model as a job(so the import takes as long as the slowest
+ * model) and then registers them following the order of the input.
+ */
+void Scene::loadModels(const std::vector<ModelInfo>& modelsToLoadInfo)
+{
+   // Each job only writes in its own slot, so we don't need locks and the
+   // indices of the models are always the same.
+   std::vector<std::shared_ptr<Model>> loadedModels(modelsToLoadInfo.size());
+   // The exceptions can't cross threads, so we save them and rethrow them
+   // here.
+   std::vector<std::exception_ptr> errors(modelsToLoadInfo.size());
+
+   m_jobSystem->parallelFor(
+         modelsToLoadInfo.size(),
+         [&](const size_t i) {
+            try
+            {
+               loadedModels[i] = loadModel(modelsToLoadInfo[i]);
+
+            } catch (...)
+            {
+               errors[i] = std::current_exception();
+            }
+         }
+   );
+
+   for (auto& error : errors)
+   {
+      if (error)
+         std::rethrow_exception(error);
+   }
 
-   for (size_t i = startI; i < endI; i++)
+   for (size_t i = 0; i < loadedModels.size(); i++)
    {
       const ModelInfo& modelInfo = modelsToLoadInfo[i];
 
+      m_models.push_back(loadedModels[i]);
+
       switch (modelInfo.type)
       {
          case ModelType::SKYBOX:
          {
-            m_models.push_back(std::make_shared<Skybox>(modelInfo));
-      
-            m_skyboxModelIndex.push_back(m_models.size() - 1);
+            m_skyboxModelIndex.push_back(i);
             m_skybox = std::dynamic_pointer_cast<Skybox>(
                   m_models[m_skyboxModelIndex[0]]
             );
@@ -345,19 +826,17 @@ void Scene::loadModel(
       
          } case ModelType::NORMAL_PBR:
          {
-            m_models.push_back(std::make_shared<NormalPBR>(modelInfo));
-            m_objectModelIndices.push_back(m_models.size() - 1);
+            m_objectModelIndices.push_back(i);
       
-            // Just the first model added will be shadowable.
+            // (the first model added)
             if (m_mainModelIndex == -1)
-               m_mainModelIndex = m_models.size() - 1;
+               m_mainModelIndex = i;
       
             break;
       
          } case ModelType::LIGHT:
          {
-            m_models.push_back(std::make_shared<Light>(modelInfo));
-            m_lightModelIndices.push_back(m_models.size() - 1);
+            m_lightModelIndices.push_back(i);
 
             if (modelInfo.lType == LightType::DIRECTIONAL_LIGHT)
             {
@@ -366,18 +845,50 @@ void Scene::loadModel(
                         "You can't add more than 1 directional light per scene!"
                   );
                
-               m_directionalLightIndex = m_models.size() - 1;
+               m_directionalLightIndex = i;
             }
 
             break;
          }
       }
    }
-}
 
-const std::shared_ptr<Model>& Scene::getDirectionalLight() const
-{
-   return m_models[m_directionalLightIndex];
+   if (m_objectModelIndices.size() == 0)
+      throw std::runtime_error(
+            "Add at least 1 model."
+      );
+   if (m_directionalLightIndex == -1)
+      throw std::runtime_error(
+            "Add at least 1 directional light."
+      );
+   if (m_skyboxModelIndex.size() == 0)
+      throw std::runtime_error(
+            "Add at least 1 skybox."
+      );
+   if (m_skyboxModelIndex.size() > 1)
+      throw std::runtime_error(
+            "You can't add more than 1 skybox per scene."
+      );
+}
+
+std::shared_ptr<Model> Scene::loadModel(const ModelInfo& modelInfo)
+{
+   switch (modelInfo.type)
+   {
+      case ModelType::SKYBOX:
+         return std::make_shared<Skybox>(modelInfo);
+      case ModelType::NORMAL_PBR:
+         return std::make_shared<NormalPBR>(modelInfo);
+      case ModelType::LIGHT:
+         return std::make_shared<Light>(modelInfo);
+   }
+
+   throw std::runtime_error("Unknown model type!");
+}
+
+const std::shared_ptr<Model>& Scene::getDirectionalLight() const
+{
+   return m_models[m_directionalLightIndex];
 }
 
 const std::shared_ptr<Model>& Scene::getMainModel() const
@@ -385,9 +896,20 @@ const std::shared_ptr<Model>& Scene::getMainModel() const
    return m_models[m_mainModelIndex];
 }
 
+/*
+ * -Any variant of the PBR pipeline(all of them have the same layout).
+ */
 const Graphics& Scene::getPBRpipeline() const
 {
-   return m_graphicsPipelinePBR;
+   return m_graphicsPipelinesPBR.begin()->second;
+}
+
+const std::map<uint32_t, Graphics>& Scene::getPBRvariants(
+      const GraphicsPipelineType type
+) const {
+   return (type == GraphicsPipelineType::PBR_AFTER_DEPTH_PREPASS) ? (
+         m_graphicsPipelinesPBRafterDepthPrepass
+   ) : m_graphicsPipelinesPBR;
 }
 
 const Graphics& Scene::getSkyboxPipeline() const
@@ -400,19 +922,104 @@ const Graphics& Scene::getLightPipeline() const
    return m_graphicsPipelineLight;
 }
 
+const Graphics& Scene::getDeferredLightingPipeline() const
+{
+   return m_graphicsPipelineDeferredLighting;
+}
+
+/*
+ * -Pipelines of the scene in the order they are drawn(sorted by subpass).
+ * -The skybox is drawn after the models, where the depth is still the clear
+ * value. In the deferred path, the lights are drawn after the lighting(the
+ * depth of the models is already there, but it's read-only).
+ * -With the depth pre-pass, the PBR models are drawn twice: first only their
+ * depth and then their shading with the depth compare EQUAL, so each sample
+ * is shaded once.
+ * -The PBR models are drawn with each variant of the PBR pipeline(see
+ * getPBRvariants()), here it's only the first one.
+ */
+std::vector<const Graphics*> Scene::getPipelines() const
+{
+   const Graphics* pbr = &m_graphicsPipelinesPBR.begin()->second;
+   const Graphics* pbrAfterDepthPrepass = (
+         &m_graphicsPipelinesPBRafterDepthPrepass.begin()->second
+   );
+
+   if (m_renderPath == RenderPath::DEFERRED)
+   {
+      if (m_isDepthPrepassEnabled)
+      {
+         return {
+            &m_graphicsPipelineDepthPrepass,
+            pbrAfterDepthPrepass,
+            &m_graphicsPipelineDeferredLighting,
+            &m_graphicsPipelineSkybox,
+            &m_graphicsPipelineLight
+         };
+      }
+
+      return {
+         pbr,
+         &m_graphicsPipelineDeferredLighting,
+         &m_graphicsPipelineSkybox,
+         &m_graphicsPipelineLight
+      };
+   }
+
+   if (m_isDepthPrepassEnabled)
+   {
+      return {
+         &m_graphicsPipelineDepthPrepass,
+         &m_graphicsPipelineLight,
+         pbrAfterDepthPrepass,
+         // The skybox has to be always the last one.
+         &m_graphicsPipelineSkybox
+      };
+   }
+
+   return {
+      &m_graphicsPipelineLight,
+      pbr,
+      // The skybox has to be always the last one.
+      &m_graphicsPipelineSkybox
+   };
+}
+
+/*
+ * -The pipelines are recorded each frame, so the change is applied on the
+ * next recording.
+ */
+void Scene::setDepthPrepass(const bool isEnabled)
+{
+   m_isDepthPrepassEnabled = isEnabled;
+}
+
+const bool Scene::isDepthPrepassEnabled() const
+{
+   return m_isDepthPrepassEnabled;
+}
+
+const RenderPath Scene::getRenderPath() const
+{
+   return m_renderPath;
+}
+
 void Scene::updateUBO(
       const std::shared_ptr<Camera>& camera,
       // From the shadow map
-      const glm::mat4& lightSpace,
+      const ShadowCascades& shadowCascades,
       const VkExtent2D& extent,
       const uint32_t& currentFrame
 ) {
 
+   // (the GPU has finished with the last UBOs of the frame)
+   m_uniformRing.reset(currentFrame);
+
    UBOinfo uboInfo = {
       camera->getPos(),
       camera->getViewM(),
       camera->getProjectionM(),
-      lightSpace,
+      shadowCascades,
       static_cast<uint32_t>(m_lightModelIndices.size()),
       extent
    };
@@ -421,22 +1028,251 @@ void Scene::updateUBO(
    for (auto& model : m_models)
    {
       model->updateUBO(
-            m_logicalDevice,
+            m_uniformRing,
             currentFrame,
             uboInfo
       );
+   }
+
+   updateLights(currentFrame);
+
+   m_lightClusters->update(camera, extent, currentFrame);
+
+   if (m_renderPath == RenderPath::DEFERRED)
+      updateDeferredLightingUBO(camera, shadowCascades, currentFrame);
+}
+
+void Scene::updateDeferredLightingUBO(
+      const std::shared_ptr<Camera>& camera,
+      const ShadowCascades& shadowCascades,
+      const uint32_t currentFrame
+) {
+   DescriptorTypes::UniformBufferObject::DeferredLighting ubo{};
+
+   ubo.view = camera->getViewM();
+   ubo.invViewProj = glm::inverse(camera->getProjectionM() * ubo.view);
+
+   for (uint32_t c = 0; c < shadowCascades.count; c++)
+      ubo.lightSpaces[c] = shadowCascades.lightSpaces[c];
+
+   ubo.cascadeSplits = shadowCascades.splits;
+   ubo.cascadesCount = static_cast<int>(shadowCascades.count);
+   ubo.cameraPos = camera->getPos();
+   ubo.lightsCount = static_cast<int>(m_lightModelIndices.size());
+
+   m_deferredLightingOffsets[currentFrame] = m_uniformRing.push(
+         &ubo,
+         sizeof(ubo),
+         currentFrame
+   );
+}
+
+/*
+ * -Distance where the radiance of the light falls to LIGHT_MIN_RADIANCE:
+ *    intensity * color / (1 + linear * d + quadratic * d^2) = min. radiance
+ */
+static float getLightRadius(const float intensity, const glm::vec4& color)
+{
+   const float maxRadiance = (
+         intensity * std::max(color.r, std::max(color.g, color.b))
+   );
+   const float c = 1.0f - maxRadiance / config::LIGHT_MIN_RADIANCE;
+
+   if (c >= 0.0f)
+      return 0.0f;
+
+   return (
+         (
+            -LIGHT_LINEAR +
+            std::sqrt(LIGHT_LINEAR * LIGHT_LINEAR - 4.0f * LIGHT_QUADRATIC * c)
+         ) / (2.0f * LIGHT_QUADRATIC)
+   );
+}
+
+/*
+ * -Creates the lights buffer of the scene(one per frame in flight), with
+ * room for all the lights of the scene. It's shared by all the PBR models.
+ * -The point and spot lights reserve their tiles in the shadow atlas(the
+ * directional light uses the shadow map).
+ */
+void Scene::createLightsBuffer(
+      const VkPhysicalDevice& physicalDevice,
+      ShadowAtlas& shadowAtlas
+) {
+   m_lightsInfo.resize(m_lightModelIndices.size());
+
+   for (size_t i = 0; i < m_lightModelIndices.size(); i++)
+   {
+      auto pLight = std::dynamic_pointer_cast<Light>(
+            m_models[m_lightModelIndices[i]]
+      );
+      const LightType type = pLight->getLightType();
+
+      m_lightsInfo[i].shadowTile = (
+            (type == LightType::DIRECTIONAL_LIGHT) ?
+               -1 :
+               shadowAtlas.addLight(i, type == LightType::POINT_LIGHT)
+      );
+   }
+   // (the first update writes all of them)
+   m_isLightsBufferOutdated.assign(config::MAX_FRAMES_IN_FLIGHT, true);
+
+   m_lights = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(m_lightsInfo[0]) * m_lightsInfo.size(),
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+   );
+}
+
+/*
+ * -Gathers the info of the lights that changed since the last update and
+ * copies all of them to the lights buffer of currentFrame, only if it's
+ * outdated(each frame in flight has its own buffer, so a change has to be
+ * copied once to each of them).
+ */
+void Scene::updateLights(const uint32_t currentFrame)
+{
+   bool hasChanged = false;
+
+   for (size_t i = 0; i < m_lightModelIndices.size(); i++)
+   {
+      auto& model = m_models[m_lightModelIndices[i]];
+
+      if (model->isDirty() == false)
+         continue;
+
+      auto pLight = std::dynamic_pointer_cast<Light>(model);
+      auto& lightInfo = m_lightsInfo[i];
+
+      lightInfo.pos = pLight->getPos();
+      lightInfo.dir = pLight->getTargetPos() - pLight->getPos();
+      lightInfo.color = pLight->getColor();
+      lightInfo.intensity = pLight->getIntensity();
+      lightInfo.radius = getLightRadius(lightInfo.intensity, lightInfo.color);
+      lightInfo.type = (int)pLight->getLightType();
+
+      pLight->clearDirty();
+      hasChanged = true;
+   }
+
+   if (hasChanged)
+   {
+      std::fill(
+            m_isLightsBufferOutdated.begin(),
+            m_isLightsBufferOutdated.end(),
+            true
+      );
+   }
+
+   if (m_isLightsBufferOutdated[currentFrame] == false)
+      return;
+
+   std::memcpy(
+         m_lights->getAllocation(currentFrame).mappedData,
+         m_lightsInfo.data(),
+         sizeof(m_lightsInfo[0]) * m_lightsInfo.size()
+   );
+
+   m_isLightsBufferOutdated[currentFrame] = false;
+}
+
+/*
+ * -Culls the instances of the meshes of the PBR models against the frustum
+ * of the camera and the one of each cascade of the shadow map. Each model
+ * builds the lists of its visible instances of currentFrame, so the culled
+ * ones aren't drawn.
+ * -With the software occlusion culling, the instances visible from the
+ * camera are also tested against the depth of the occluders.
+ * -It has to be called after updateUBO()(it uses the updated model matrices).
+ */
+void Scene::cullMeshes(
+      const std::shared_ptr<Camera>& camera,
+      // From the shadow map
+      const ShadowCascades& shadowCascades,
+      const uint32_t currentFrame
+) {
+   frustumCulling::clearBounds(m_cullingBounds);
 
-      if (auto pModel = std::dynamic_pointer_cast<NormalPBR>(model))
+   for (auto i : m_objectModelIndices)
+   {
+      if (auto pModel = std::dynamic_pointer_cast<NormalPBR>(m_models[i]))
+         pModel->addCullingBounds(m_cullingBounds);
+   }
+
+   const uint32_t boundsCount = m_cullingBounds.centerX.size();
+   const glm::mat4 viewProj = camera->getProjectionM() * camera->getViewM();
+
+   m_cullingStats.visibleCount = frustumCulling::cull(
+         frustumCulling::getPlanes(viewProj),
+         m_cullingBounds,
+         *m_jobSystem,
+         m_instancesVisibility
+   );
+
+   // (only the ones that passed the frustum culling are tested)
+   m_cullingStats.occludedCount = 0;
+
+   if (config::SOFTWARE_OCCLUSION_CULLING)
+   {
+      m_maskedOcclusion.clearOccluders();
+
+      for (auto i : m_objectModelIndices)
       {
-         pModel->updateUBOlights(
-               m_logicalDevice,
-               m_lightModelIndices,
-               m_models,
+         auto pModel = std::dynamic_pointer_cast<NormalPBR>(m_models[i]);
+
+         if (pModel && pModel->isOccluder())
+            pModel->addOccluders(m_maskedOcclusion);
+      }
+
+      m_maskedOcclusion.render(viewProj, *m_jobSystem);
+
+      m_cullingStats.occludedCount = m_maskedOcclusion.cull(
+            viewProj,
+            m_cullingBounds,
+            *m_jobSystem,
+            m_instancesVisibility
+      );
+      m_cullingStats.visibleCount -= m_cullingStats.occludedCount;
+   }
+
+   m_cullingStats.culledCount = boundsCount - m_cullingStats.visibleCount;
+
+   // (counted once per cascade)
+   m_instancesShadowVisibility.resize(shadowCascades.count);
+   m_cullingStats.shadowVisibleCount = 0;
+
+   for (uint32_t c = 0; c < shadowCascades.count; c++)
+   {
+      m_cullingStats.shadowVisibleCount += frustumCulling::cull(
+            frustumCulling::getPlanes(shadowCascades.lightSpaces[c]),
+            m_cullingBounds,
+            *m_jobSystem,
+            m_instancesShadowVisibility[c]
+      );
+   }
+   m_cullingStats.shadowCulledCount = (
+         boundsCount * shadowCascades.count -
+         m_cullingStats.shadowVisibleCount
+   );
+
+   size_t firstBoundsIndex = 0;
+
+   for (auto i : m_objectModelIndices)
+   {
+      if (auto pModel = std::dynamic_pointer_cast<NormalPBR>(m_models[i]))
+      {
+         pModel->setVisibleInstances(
+               m_instancesVisibility,
+               m_instancesShadowVisibility,
+               firstBoundsIndex,
                currentFrame
          );
+
+         firstBoundsIndex += pModel->getInstancesCount();
       }
    }
-
 }
 
 const std::vector<std::shared_ptr<Model>>& Scene::getModels() const
@@ -458,26 +1294,52 @@ void Scene::upload(
       const VkPhysicalDevice& physicalDevice,
       const VkQueue& graphicsQueue,
       const std::shared_ptr<CommandPool>& commandPool,
+      const uint32_t& graphicsFamilyIndex,
       DescriptorPool& descriptorPool,
       // Features
-      const std::shared_ptr<ShadowMap<Attributes::PBR::Vertex>> shadowMap
+      const std::shared_ptr<ShadowMap<Attributes::PBR::Vertex>> shadowMap,
+      const std::shared_ptr<ShadowAtlas> shadowAtlas,
+      const GBuffer& gBuffer,
+      const DepthBuffer& depthBuffer
 ) {
-   // First we upload the skybox because we need some dependencies from it for
-   // the descriptor sets of the other models.
-   m_skybox->upload(
+   // All the vertex/index buffers are recorded in the same batch and
+   // submitted together.
+   UploadBatch uploadBatch(
          physicalDevice,
          m_logicalDevice,
-         graphicsQueue,
          commandPool,
-         config::MAX_FRAMES_IN_FLIGHT
+         graphicsQueue,
+         config::STAGING_BUFFER_SIZE
+   );
+
+   createGeometryBuffers(physicalDevice);
+
+   // (the UBOs of all the models)
+   m_uniformRing = UniformRing(
+         physicalDevice,
+         m_logicalDevice,
+         config::UNIFORM_RING_SIZE
+   );
+   createLightsBuffer(physicalDevice, *shadowAtlas);
+   m_lightClusters = std::make_shared<LightClusters>(
+         physicalDevice,
+         m_logicalDevice,
+         graphicsFamilyIndex,
+         m_lights,
+         static_cast<uint32_t>(m_lightModelIndices.size())
    );
 
-   m_skybox->createDescriptorSets(
+   // First we upload the skybox because we need some dependencies from it for
+   // the descriptor sets of the other models.
+   m_skybox->uploadVertexData(m_geometrySkybox, uploadBatch);
+   m_skybox->upload(
+         physicalDevice,
          m_logicalDevice,
-         m_graphicsPipelineSkybox.getDescriptorSetLayout(),
-         nullptr,
-         descriptorPool
+         graphicsQueue,
+         commandPool
    );
+   // The prefiltered env. map draws the skybox's meshes right away.
+   uploadBatch.submit();
 
    // IBL
    {
@@ -493,10 +1355,38 @@ void Scene::upload(
             commandPool,
             config::PREF_ENV_MAP_DIM,
             m_skybox->getMeshes(),
+            m_geometrySkybox,
             m_skybox->getEnvMap()
       );
    }
 
+   uploadVertexData(uploadBatch);
+
+   for (auto& model : m_models)
+   {
+      if (model->getType() == ModelType::SKYBOX)
+         continue;
+
+      model->upload(
+            physicalDevice,
+            m_logicalDevice,
+            graphicsQueue,
+            commandPool
+      );
+   }
+
+   createInstanceBuffers(physicalDevice);
+   // (it needs the textures already uploaded)
+   createMaterialBuffers(physicalDevice);
+
+   // (the shadow map draws the instances of all the PBR models)
+   shadowMap->createDescriptorSets(m_instances.get(), m_visibleInstances.get());
+   shadowAtlas->createDescriptorSets(m_instances.get());
+
+   // (the descriptor sets need the layouts of the pipelines, until here
+   // they were compiled by the workers)
+   waitPipelines();
+
    // TODO: Improve this.
    VkDescriptorSetLayout descriptorSetLayout;
    DescriptorSetInfo descriptorSetInfo = {
@@ -504,38 +1394,44 @@ void Scene::upload(
       &(*m_BRDFlut),
       &(shadowMap->getShadowMapView()),
       &(shadowMap->getSampler()),
-      &(m_prefilteredEnvMap->get())
+      &(shadowAtlas->getImageView()),
+      &(shadowAtlas->getSampler()),
+      shadowAtlas->getTiles(),
+      &(m_prefilteredEnvMap->get()),
+      m_lights.get(),
+      m_instances.get(),
+      m_visibleInstances.get(),
+      m_instanceMaterials.get(),
+      m_materials.get(),
+      &m_textures,
+      m_uniformRing.get(),
+      m_lightClusters->getFrames(),
+      m_lightClusters->getLightGrid(),
+      m_lightClusters->getLightIndices(),
+      // (only for the deferred lighting)
+      nullptr
    };
 
    for (auto& model : m_models)
    {
       auto type = model->getType();
 
-      if (type == ModelType::SKYBOX)
-         continue;
-
-      model->upload(
-            physicalDevice,
-            m_logicalDevice,
-            graphicsQueue,
-            commandPool,
-            // UBO count
-            config::MAX_FRAMES_IN_FLIGHT
-      );
-
       // Descriptor Sets
       if (type == ModelType::NORMAL_PBR)
+      {
+         descriptorSetLayout = getPBRpipeline().getDescriptorSetLayout();
+  
+      } else if (type == ModelType::LIGHT)
       {
          descriptorSetLayout = (
-               m_graphicsPipelinePBR.getDescriptorSetLayout()
+               m_graphicsPipelineLight.getDescriptorSetLayout()
          );
-  
+
       } else
       {
-         if (type == ModelType::LIGHT)
-            descriptorSetLayout = (
-                  m_graphicsPipelineLight.getDescriptorSetLayout()
-            );
+         descriptorSetLayout = (
+               m_graphicsPipelineSkybox.getDescriptorSetLayout()
+         );
       }
 
       model->createDescriptorSets(
@@ -545,16 +1441,418 @@ void Scene::upload(
          descriptorPool
       );
    }
+
+   if (m_renderPath == RenderPath::DEFERRED)
+   {
+      createDeferredLightingDescriptorSets(
+            descriptorSetInfo,
+            gBuffer,
+            depthBuffer,
+            descriptorPool
+      );
+   }
+
+   // Waits only for the batches(and not for the whole queue).
+   uploadBatch.destroy();
+}
+
+/*
+ * -The lighting subpass reads the same lights and IBL as the PBR models,
+ * plus the G-buffer and the depth as input attachments.
+ */
+void Scene::createDeferredLightingDescriptorSets(
+      DescriptorSetInfo descriptorSetInfo,
+      const GBuffer& gBuffer,
+      const DepthBuffer& depthBuffer,
+      DescriptorPool& descriptorPool
+) {
+   std::vector<VkDescriptorImageInfo> inputAttachments;
+
+   for (auto& imageView : gBuffer.getImageViews())
+   {
+      inputAttachments.push_back(
+            {
+               VK_NULL_HANDLE,
+               imageView,
+               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            }
+      );
+   }
+   inputAttachments.push_back(
+         {
+            VK_NULL_HANDLE,
+            depthBuffer.getImageView(),
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+         }
+   );
+
+   descriptorSetInfo.inputAttachments = &inputAttachments;
+
+   m_deferredLightingOffsets.resize(config::MAX_FRAMES_IN_FLIGHT, 0);
+
+   m_deferredLightingDescriptorSets = DescriptorSets(
+         m_logicalDevice,
+         GRAPHICS_PIPELINE::DEFERRED_LIGHTING::UBOS_INFO,
+         GRAPHICS_PIPELINE::DEFERRED_LIGHTING::SAMPLERS_INFO,
+         {},
+         m_graphicsPipelineDeferredLighting.getDescriptorSetLayout(),
+         descriptorPool,
+         &descriptorSetInfo,
+         {
+            m_uniformRing.get(),
+            m_lights.get(),
+            m_lightClusters->getFrames(),
+            m_lightClusters->getLightGrid(),
+            m_lightClusters->getLightIndices(),
+            descriptorSetInfo.shadowAtlasTiles
+         }
+   );
+}
+
+/*
+ * -Creates the geometry buffers with enough space for all the meshes of the
+ * scene.
+ */
+void Scene::createGeometryBuffers(const VkPhysicalDevice& physicalDevice)
+{
+   std::vector<const std::vector<Mesh<Attributes::PBR::Vertex>>*> meshesPBR;
+   std::vector<const std::vector<Mesh<Attributes::LIGHT::Vertex>>*> meshesLight;
+
+   for (auto i : m_objectModelIndices)
+   {
+      meshesPBR.push_back(
+            &(std::dynamic_pointer_cast<NormalPBR>(m_models[i])->getMeshes())
+      );
+   }
+
+   for (auto i : m_lightModelIndices)
+   {
+      meshesLight.push_back(
+            &(std::dynamic_pointer_cast<Light>(m_models[i])->getMeshes())
+      );
+   }
+
+   m_geometryPBR = GeometryBuffer<Attributes::PBR::Vertex>(
+         physicalDevice,
+         m_logicalDevice,
+         meshesPBR,
+         // (for the depth pre-pass)
+         true
+   );
+   m_geometrySkybox = GeometryBuffer<Attributes::SKYBOX::Vertex>(
+         physicalDevice,
+         m_logicalDevice,
+         {&(m_skybox->getMeshes())}
+   );
+   m_geometryLight = GeometryBuffer<Attributes::LIGHT::Vertex>(
+         physicalDevice,
+         m_logicalDevice,
+         meshesLight
+   );
+}
+
+/*
+ * -Records the upload of the meshes of all the models(except the skybox,
+ * which is uploaded first) to their geometry buffer.
+ */
+void Scene::uploadVertexData(UploadBatch& uploadBatch)
+{
+   for (auto i : m_objectModelIndices)
+   {
+      std::dynamic_pointer_cast<NormalPBR>(m_models[i])->uploadVertexData(
+            m_geometryPBR,
+            uploadBatch
+      );
+   }
+
+   for (auto i : m_lightModelIndices)
+   {
+      std::dynamic_pointer_cast<Light>(m_models[i])->uploadVertexData(
+            m_geometryLight,
+            uploadBatch
+      );
+   }
+}
+
+/*
+ * -Reserves the instances of all the PBR models and creates the buffers
+ * shared by all of them:
+ *    - Instances -> the transforms, written here(they don't change).
+ *    - Visible instances -> the lists of the instances drawn by each draw,
+ *      written each frame by the culling(CPU or GPU).
+ */
+void Scene::createInstanceBuffers(const VkPhysicalDevice& physicalDevice)
+{
+   uint32_t instancesCount = 0;
+   uint32_t visibleInstancesCount = 0;
+
+   for (auto i : m_objectModelIndices)
+   {
+      std::dynamic_pointer_cast<NormalPBR>(m_models[i])->reserveInstances(
+            instancesCount,
+            visibleInstancesCount
+      );
+   }
+
+   m_instances = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(glm::mat4) * instancesCount,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+   );
+   m_visibleInstances = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(uint32_t) * visibleInstancesCount,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+   );
+
+   for (auto& allocation : m_instances->getAllocations())
+   {
+      for (auto i : m_objectModelIndices)
+      {
+         std::dynamic_pointer_cast<NormalPBR>(m_models[i])->writeInstances(
+               allocation.mappedData
+         );
+      }
+   }
+}
+
+/*
+ * -Adds the textures of the materials of all the PBR models to the texture
+ * table and creates the buffers with the materials and with the material of
+ * each instance(written here, they don't change).
+ */
+void Scene::createMaterialBuffers(const VkPhysicalDevice& physicalDevice)
+{
+   uint32_t materialsCount = 0;
+   uint32_t instancesCount = 0;
+
+   for (auto i : m_objectModelIndices)
+   {
+      auto pModel = std::dynamic_pointer_cast<NormalPBR>(m_models[i]);
+
+      pModel->reserveMaterials(m_textures, materialsCount);
+
+      instancesCount += pModel->getInstancesCount();
+   }
+
+   m_materials = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(DescriptorTypes::StorageBufferObject::Material) *
+         materialsCount,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+   );
+   m_instanceMaterials = std::make_shared<UBO>(
+         physicalDevice,
+         m_logicalDevice,
+         config::MAX_FRAMES_IN_FLIGHT,
+         sizeof(uint32_t) * instancesCount,
+         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+   );
+
+   for (int frame = 0; frame < config::MAX_FRAMES_IN_FLIGHT; frame++)
+   {
+      for (auto i : m_objectModelIndices)
+      {
+         std::dynamic_pointer_cast<NormalPBR>(m_models[i])->writeMaterials(
+               m_materials->getAllocation(frame).mappedData,
+               m_instanceMaterials->getAllocation(frame).mappedData
+         );
+      }
+   }
+}
+
+/*
+ * -Counts the descriptors(by type) and the descriptor sets needed by the
+ * models of the scene: one set per frame in flight for each PBR model(its
+ * meshes share it) and for each mesh of the rest of the models.
+ * -The textures of the PBR materials aren't counted, they are in the texture
+ * table.
+ */
+void Scene::getDescriptorsCount(
+      std::vector<VkDescriptorPoolSize>& poolSizes,
+      uint32_t& descriptorSetsCount
+) const {
+   std::map<VkDescriptorType, uint32_t> descriptorsCount;
+   descriptorSetsCount = 0;
+
+   auto addSets = [&](
+         const std::vector<DescriptorInfo>& ubosInfo,
+         const std::vector<DescriptorInfo>& samplersInfo,
+         const uint32_t setsCount
+   ) {
+      for (auto& info : ubosInfo)
+         descriptorsCount[info.descriptorType] += setsCount;
+
+      for (auto& info : samplersInfo)
+         descriptorsCount[info.descriptorType] += setsCount;
+
+      descriptorSetsCount += setsCount;
+   };
+
+   for (auto& model : m_models)
+   {
+      switch (model->getType())
+      {
+         case ModelType::NORMAL_PBR:
+         {
+            addSets(
+                  GRAPHICS_PIPELINE::PBR::UBOS_INFO,
+                  GRAPHICS_PIPELINE::PBR::SAMPLERS_INFO,
+                  config::MAX_FRAMES_IN_FLIGHT
+            );
+
+            break;
+
+         } case ModelType::LIGHT:
+         {
+            const uint32_t meshesCount = (
+                  std::dynamic_pointer_cast<Light>(model)->getMeshes().size()
+            );
+
+            addSets(
+                  GRAPHICS_PIPELINE::LIGHT::UBOS_INFO,
+                  GRAPHICS_PIPELINE::LIGHT::SAMPLERS_INFO,
+                  meshesCount * config::MAX_FRAMES_IN_FLIGHT
+            );
+
+            break;
+
+         } case ModelType::SKYBOX:
+         {
+            const uint32_t meshesCount = (
+                  std::dynamic_pointer_cast<Skybox>(model)->getMeshes().size()
+            );
+
+            addSets(
+                  GRAPHICS_PIPELINE::SKYBOX::UBOS_INFO,
+                  GRAPHICS_PIPELINE::SKYBOX::SAMPLERS_INFO,
+                  meshesCount * config::MAX_FRAMES_IN_FLIGHT
+            );
+
+            break;
+         }
+      }
+   }
+
+   if (m_renderPath == RenderPath::DEFERRED)
+   {
+      addSets(
+            GRAPHICS_PIPELINE::DEFERRED_LIGHTING::UBOS_INFO,
+            GRAPHICS_PIPELINE::DEFERRED_LIGHTING::SAMPLERS_INFO,
+            config::MAX_FRAMES_IN_FLIGHT
+      );
+   }
+
+   poolSizes.clear();
+
+   for (auto& [type, count] : descriptorsCount)
+      poolSizes.push_back({type, count});
+}
+
+/*
+ * -Binds the geometry buffer used by the pipeline(only once, all the draws
+ * of the pipeline use the same buffers). The index buffer is bound by the
+ * draws, with the index type of each mesh.
+ */
+void Scene::bindGeometry(
+      const GraphicsPipelineType& pipelineType,
+      const VkCommandBuffer& commandBuffer
+) const {
+   switch (pipelineType)
+   {
+      case GraphicsPipelineType::PBR:
+      case GraphicsPipelineType::PBR_AFTER_DEPTH_PREPASS:
+      case GraphicsPipelineType::SHADOWMAP:
+      {
+         m_geometryPBR.bind(commandBuffer);
+
+         break;
+
+      } case GraphicsPipelineType::DEPTH_PREPASS:
+      {
+         m_geometryPBR.bindPositions(commandBuffer);
+
+         break;
+
+      } case GraphicsPipelineType::LIGHT:
+      {
+         m_geometryLight.bind(commandBuffer);
+
+         break;
+
+      } case GraphicsPipelineType::SKYBOX:
+      case GraphicsPipelineType::PREFILTER_ENV_MAP:
+      {
+         m_geometrySkybox.bind(commandBuffer);
+
+         break;
+
+      } case GraphicsPipelineType::DEFERRED_LIGHTING:
+      {
+         // (the full-screen triangle is generated by the vertex shader)
+         break;
+      }
+   }
+}
+
+/*
+ * -Lights all the samples of the G-buffer with one full-screen triangle.
+ */
+void Scene::drawDeferredLighting(
+      const VkCommandBuffer& commandBuffer,
+      const uint32_t currentFrame
+) const {
+   commandManager::state::bindDescriptorSets(
+         m_graphicsPipelineDeferredLighting.getPipelineLayout(),
+         PipelineType::GRAPHICS,
+         // Index of first descriptor set.
+         0,
+         {m_deferredLightingDescriptorSets.get(currentFrame)},
+         // Dynamic offsets.
+         {m_deferredLightingOffsets[currentFrame]},
+         commandBuffer
+   );
+
+   commandManager::action::draw(3, 1, 0, 0, commandBuffer);
 }
 
 void Scene::destroy()
 {
+   // (in case the scene is destroyed before its upload)
+   waitPipelines();
+
    for (auto& model : m_models)
       model->destroy(m_logicalDevice);
 
-   m_graphicsPipelinePBR.destroy();
+   m_geometryPBR.destroy();
+   m_geometrySkybox.destroy();
+   m_geometryLight.destroy();
+
+   m_uniformRing.destroy();
+   m_lights->destroy();
+   m_lightClusters->destroy();
+
+   m_instances->destroy();
+   m_visibleInstances->destroy();
+   m_instanceMaterials->destroy();
+   m_materials->destroy();
+   m_textures.destroy();
+
+   for (auto& variant : m_graphicsPipelinesPBR)
+      variant.second.destroy();
+   for (auto& variant : m_graphicsPipelinesPBRafterDepthPrepass)
+      variant.second.destroy();
+   m_graphicsPipelineDepthPrepass.destroy();
    m_graphicsPipelineSkybox.destroy();
    m_graphicsPipelineLight.destroy();
+   if (m_renderPath == RenderPath::DEFERRED)
+      m_graphicsPipelineDeferredLighting.destroy();
 
    m_renderPass.destroy();
 
@@ -633,6 +1931,21 @@ const Computation& Scene::getComputation() const
    return m_BRDFcomp;
 }
 
+const GeometryBuffer<Attributes::PBR::Vertex>& Scene::getGeometryPBR() const
+{
+   return m_geometryPBR;
+}
+
+const std::shared_ptr<UBO>& Scene::getInstances() const
+{
+   return m_instances;
+}
+
+const std::shared_ptr<UBO>& Scene::getVisibleInstances() const
+{
+   return m_visibleInstances;
+}
+
 const std::vector<size_t>& Scene::getObjectModelIndices() const
 {
    return m_objectModelIndices;
@@ -642,3 +1955,25 @@ const std::vector<size_t>& Scene::getLightModelIndices() const
 {
    return m_lightModelIndices;
 }
+
+const frustumCulling::Stats& Scene::getCullingStats() const
+{
+   return m_cullingStats;
+}
+
+const std::shared_ptr<LightClusters>& Scene::getLightClusters() const
+{
+   return m_lightClusters;
+}
+
+const std::vector<
+   DescriptorTypes::StorageBufferObject::LightInfo
+>& Scene::getLightsInfo() const
+{
+   return m_lightsInfo;
+}
+
+const BindlessTextures& Scene::getTextures() const
+{
+   return m_textures;
+}
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <vector>
+#include <map>
+#include <memory>
+#include <exception>
+#include <functional>
+
 #include <vulkan/vulkan.h>
 
 #include <CroissantRenderer/Model/Model.h>
@@ -15,6 +21,19 @@
 #include <CroissantRenderer/Settings/computePipelineConfig.h>
 #include <CroissantRenderer/Computation/Computation.h>
 #include <CroissantRenderer/Features/PrefilteredEnvMap.h>
+#include <CroissantRenderer/Job/JobSystem.h>
+#include <CroissantRenderer/Buffer/GeometryBuffer.h>
+#include <CroissantRenderer/Buffer/UploadBatch.h>
+#include <CroissantRenderer/Culling/frustumCulling.h>
+#include <CroissantRenderer/Culling/MaskedOcclusion.h>
+#include <CroissantRenderer/Culling/LightClusters.h>
+#include <CroissantRenderer/Descriptor/BindlessTextures.h>
+#include <CroissantRenderer/Descriptor/Types/UBO/UniformRing.h>
+#include <CroissantRenderer/Features/GBuffer.h>
+#include <CroissantRenderer/Features/DepthBuffer.h>
+#include <CroissantRenderer/Features/ShadowCascades.h>
+#include <CroissantRenderer/Features/ShadowAtlas.h>
+#include <CroissantRenderer/Scene/RenderPath.h>
 
 class Scene
 {
@@ -27,49 +46,87 @@ public:
          const VkExtent2D& extent,
          const VkSampleCountFlagBits& msaaSamplesCount,
          const VkFormat& depthBufferFormat,
+         const RenderPath renderPath,
          const std::vector<ModelInfo>& modelsToLoadInfo,
          // Parameters needed by the computations.
          const VkPhysicalDevice& physicalDevice,
          const QueueFamilyIndices& queueFamilyIndices,
-         DescriptorPool& descriptorPoolForComputations
+         DescriptorPool& descriptorPoolForComputations,
+         const std::shared_ptr<JobSystem>& jobSystem
    );
    ~Scene();
    void upload(
          const VkPhysicalDevice& physicalDevice,
          const VkQueue& graphicsQueue,
          const std::shared_ptr<CommandPool>& commandPool,
+         const uint32_t& graphicsFamilyIndex,
          DescriptorPool& descriptorPool,
          // Features
-         const std::shared_ptr<ShadowMap<Attributes::PBR::Vertex>> shadowMap
+         const std::shared_ptr<ShadowMap<Attributes::PBR::Vertex>> shadowMap,
+         const std::shared_ptr<ShadowAtlas> shadowAtlas,
+         // (only read by the deferred path)
+         const GBuffer& gBuffer,
+         const DepthBuffer& depthBuffer
    );
    void updateUBO(
          const std::shared_ptr<Camera>& camera,
          // From the shadow map
-         const glm::mat4& lightSpace,
+         const ShadowCascades& shadowCascades,
          const VkExtent2D& extent,
          const uint32_t& currentFrame
    );
+   void cullMeshes(
+         const std::shared_ptr<Camera>& camera,
+         // From the shadow map
+         const ShadowCascades& shadowCascades,
+         const uint32_t currentFrame
+   );
    const RenderPass& getRenderPass() const;
    const std::shared_ptr<Model>& getDirectionalLight() const;
    const std::shared_ptr<Model>& getMainModel() const;
    const Graphics& getPBRpipeline() const;
+   const std::map<uint32_t, Graphics>& getPBRvariants(
+         const GraphicsPipelineType type
+   ) const;
    const Graphics& getSkyboxPipeline() const;
    const Graphics& getLightPipeline() const;
+   const Graphics& getDeferredLightingPipeline() const;
+   std::vector<const Graphics*> getPipelines() const;
+   const RenderPath getRenderPath() const;
+   void setDepthPrepass(const bool isEnabled);
+   const bool isDepthPrepassEnabled() const;
    const std::vector<std::shared_ptr<Model>>& getModels() const;
    const std::shared_ptr<Model>& getModel(uint32_t i) const;
    const std::vector<size_t>& getObjectModelIndices() const;
    const std::vector<size_t>& getLightModelIndices() const;
    const Computation& getComputation() const;
+   const GeometryBuffer<Attributes::PBR::Vertex>& getGeometryPBR() const;
+   const std::shared_ptr<UBO>& getInstances() const;
+   const std::shared_ptr<UBO>& getVisibleInstances() const;
+   const frustumCulling::Stats& getCullingStats() const;
+   const std::shared_ptr<LightClusters>& getLightClusters() const;
+   const std::vector<
+      DescriptorTypes::StorageBufferObject::LightInfo
+   >& getLightsInfo() const;
+   const BindlessTextures& getTextures() const;
+   void getDescriptorsCount(
+         std::vector<VkDescriptorPoolSize>& poolSizes,
+         uint32_t& descriptorSetsCount
+   ) const;
+   void bindGeometry(
+         const GraphicsPipelineType& pipelineType,
+         const VkCommandBuffer& commandBuffer
+   ) const;
+   void drawDeferredLighting(
+         const VkCommandBuffer& commandBuffer,
+         const uint32_t currentFrame
+   ) const;
    void destroy();
 
 private:
 
    void loadModels(const std::vector<ModelInfo>& modelsToLoadInfo);
-   void loadModel(
-         const size_t startI,
-         const size_t chunckSize,
-         const std::vector<ModelInfo>& modelsToLoadInfo
-   );
+   std::shared_ptr<Model> loadModel(const ModelInfo& modelInfo);
    void initComputations(
          const VkPhysicalDevice& physicalDevice,
          const QueueFamilyIndices& queueFamilyIndices,
@@ -85,29 +142,123 @@ private:
          const VkExtent2D& extent,
          const VkSampleCountFlagBits& msaaSamplesCount
    );
+   void waitPipelines();
    void createRenderPass(
          const VkFormat& format,
          const VkSampleCountFlagBits& msaaSamplesCount,
          const VkFormat& depthBufferFormat
    );
+   void createDeferredRenderPass(
+         const VkFormat& format,
+         const VkSampleCountFlagBits& msaaSamplesCount,
+         const VkFormat& depthBufferFormat
+   );
+   void createDeferredLightingDescriptorSets(
+         DescriptorSetInfo descriptorSetInfo,
+         const GBuffer& gBuffer,
+         const DepthBuffer& depthBuffer,
+         DescriptorPool& descriptorPool
+   );
+   void createGeometryBuffers(const VkPhysicalDevice& physicalDevice);
+   void uploadVertexData(UploadBatch& uploadBatch);
+   void createInstanceBuffers(const VkPhysicalDevice& physicalDevice);
+   void createMaterialBuffers(const VkPhysicalDevice& physicalDevice);
+   void createLightsBuffer(
+         const VkPhysicalDevice& physicalDevice,
+         ShadowAtlas& shadowAtlas
+   );
+   void updateLights(const uint32_t currentFrame);
+   void updateDeferredLightingUBO(
+         const std::shared_ptr<Camera>& camera,
+         const ShadowCascades& shadowCascades,
+         const uint32_t currentFrame
+   );
+
+   // Pipelines compiled by the job system(see createPipelines()).
+   struct PipelinesBuild
+   {
+      // (parent of the job of each pipeline)
+      std::shared_ptr<Job>             job;
+      // (where each pipeline goes)
+      std::vector<std::function<Graphics&(Scene&)>> targets;
+      std::vector<Graphics>            pipelines;
+      std::vector<std::exception_ptr>  errors;
+   };
 
    VkDevice                            m_logicalDevice;
+   std::shared_ptr<JobSystem>          m_jobSystem;
+   // (null once the pipelines are in their targets)
+   std::shared_ptr<PipelinesBuild>     m_pipelinesBuild;
+   RenderPath                          m_renderPath;
    RenderPass                          m_renderPass;
-   Graphics                            m_graphicsPipelinePBR;
+   // Variants of the PBR pipeline by material key(see materialFeatures),
+   // only the ones used by the models.
+   std::map<uint32_t, Graphics>        m_graphicsPipelinesPBR;
    Graphics                            m_graphicsPipelineSkybox;
    Graphics                            m_graphicsPipelineLight;
 
+   // Depth pre-pass(optional, it can be toggled each frame)
+   bool                                m_isDepthPrepassEnabled;
+   Graphics                            m_graphicsPipelineDepthPrepass;
+   std::map<uint32_t, Graphics>        m_graphicsPipelinesPBRafterDepthPrepass;
+
+   // Deferred path(lighting subpass, reads the G-buffer)
+   Graphics                            m_graphicsPipelineDeferredLighting;
+   DescriptorSets                      m_deferredLightingDescriptorSets;
+   // (slice of the uniform ring of each frame)
+   std::vector<uint32_t>               m_deferredLightingOffsets;
+
    std::vector<std::shared_ptr<Model>> m_models;
 
+   // UBOs of all the models(one slice per model each frame).
+   UniformRing                         m_uniformRing;
+
+   // Lights of the scene(one buffer per frame in flight), only copied when
+   // a light changes.
+   std::shared_ptr<UBO>                m_lights;
+   std::vector<
+      DescriptorTypes::StorageBufferObject::LightInfo
+   > m_lightsInfo;
+   std::vector<bool>                   m_isLightsBufferOutdated;
+   // Lights of each cluster of the view frustum(computed each frame).
+   std::shared_ptr<LightClusters>      m_lightClusters;
+
+   // One per vertex layout(shared by all the meshes of the scene).
+   GeometryBuffer<Attributes::PBR::Vertex>      m_geometryPBR;
+   GeometryBuffer<Attributes::SKYBOX::Vertex>   m_geometrySkybox;
+   GeometryBuffer<Attributes::LIGHT::Vertex>    m_geometryLight;
+
    std::shared_ptr<Skybox>             m_skybox;
    std::vector<size_t>                 m_objectModelIndices;
    std::vector<size_t>                 m_lightModelIndices;
    std::vector<size_t>                 m_skyboxModelIndex;
 
-   // For now, this will be the only shadowable model of the scene.
+   // (the first PBR model added)
    int                                 m_mainModelIndex;
    int                                 m_directionalLightIndex;
 
+   // Instances of the meshes of the PBR models(one per frame in flight).
+   // -Transforms of all the instances.
+   std::shared_ptr<UBO>                m_instances;
+   // -Indices of the instances drawn by each draw(written by the culling).
+   std::shared_ptr<UBO>                m_visibleInstances;
+   // -Index of the material of each instance.
+   std::shared_ptr<UBO>                m_instanceMaterials;
+
+   // Materials of the meshes of all the PBR models and the table with their
+   // textures.
+   std::shared_ptr<UBO>                m_materials;
+   BindlessTextures                    m_textures;
+
+   // Culling(the bounds of the instances of all the PBR models, one after
+   // the other)
+   frustumCulling::Bounds              m_cullingBounds;
+   std::vector<uint8_t>                m_instancesVisibility;
+   // (one per cascade of the shadow map)
+   std::vector<std::vector<uint8_t>>   m_instancesShadowVisibility;
+   frustumCulling::Stats               m_cullingStats;
+   // (only with SOFTWARE_OCCLUSION_CULLING)
+   MaskedOcclusion                     m_maskedOcclusion;
 
    // IBL
    Computation                         m_BRDFcomp;
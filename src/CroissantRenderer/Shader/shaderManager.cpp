@@ -4,9 +4,15 @@
 #include <vector>
 #include <fstream>
 #include <iostream>
+#include <unordered_map>
+#include <mutex>
 
 #include <vulkan/vulkan.h>
 
+static std::mutex                                       s_mutex;
+// binary name -> module
+static std::unordered_map<std::string, VkShaderModule>  s_shaderModules;
+
 std::vector<char> shaderManager::getBinaryDataFromFile(
       const std::string& filename
 ) {
@@ -63,3 +69,33 @@ void shaderManager::destroyShaderModule(
 ) {
    vkDestroyShaderModule(logicalDevice, shaderModule, nullptr);
 }
+
+VkShaderModule shaderManager::getShaderModule(
+      const std::string& binaryName,
+      const VkDevice& logicalDevice
+) {
+   std::lock_guard<std::mutex> lock(s_mutex);
+
+   auto it = s_shaderModules.find(binaryName);
+
+   if (it != s_shaderModules.end())
+      return it->second;
+
+   VkShaderModule shaderModule = createShaderModule(
+         getBinaryDataFromFile(binaryName),
+         logicalDevice
+   );
+   s_shaderModules[binaryName] = shaderModule;
+
+   return shaderModule;
+}
+
+void shaderManager::destroyShaderModules(const VkDevice& logicalDevice)
+{
+   std::lock_guard<std::mutex> lock(s_mutex);
+
+   for (auto& [binaryName, shaderModule] : s_shaderModules)
+      destroyShaderModule(shaderModule, logicalDevice);
+
+   s_shaderModules.clear();
+}
@@ -16,4 +16,12 @@ namespace shaderManager
          VkShaderModule& shaderModule,
          const VkDevice& logicalDevice
    );
+   // Module of the binary(e.g. "vert-scene"). It's read and created the
+   // first time that it's asked and kept until destroyShaderModules(), so the
+   // pipelines that share a shader don't read it again.
+   VkShaderModule getShaderModule(
+         const std::string& binaryName,
+         const VkDevice& logicalDevice
+   );
+   void destroyShaderModules(const VkDevice& logicalDevice);
 };
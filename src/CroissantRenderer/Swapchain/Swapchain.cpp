@@ -198,7 +198,8 @@ void Swapchain::createAllImageViews()
 void Swapchain::createFramebuffers(
       const RenderPass& renderPass,
       const DepthBuffer& depthBuffer,
-      const MSAA& msaa
+      const MSAA& msaa,
+      const std::vector<VkImageView>& additionalAttachments
 ) {
    m_framebuffers.resize(m_imageViews.size());
 
@@ -211,6 +212,11 @@ void Swapchain::createFramebuffers(
          depthBuffer.getImageView(),
          m_imageViews[i]
       };
+      attachments.insert(
+            attachments.end(),
+            additionalAttachments.begin(),
+            additionalAttachments.end()
+      );
 
       framebufferManager::createFramebuffer(
             m_logicalDevice,
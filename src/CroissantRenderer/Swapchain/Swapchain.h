@@ -42,7 +42,9 @@ public:
    void createFramebuffers(
          const RenderPass& renderPass,
          const DepthBuffer& depthBuffer,
-         const MSAA& msaa
+         const MSAA& msaa,
+         // (after the swapchain image, e.g. the G-buffer)
+         const std::vector<VkImageView>& additionalAttachments = {}
    );
    void presentImage(
          const uint32_t imageIndex,
@@ -134,6 +134,7 @@ void mipmapUtils::generateMipmaps(
          {commandBuffer},
          true
    );
+   commandPool->recycleCommandBuffer(commandBuffer);
 }
 
 
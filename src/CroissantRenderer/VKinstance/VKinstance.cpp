@@ -31,7 +31,8 @@ VKinstance::VKinstance(const std::string& appName)
    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
    appInfo.pEngineName = "No Engine";
    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-   appInfo.apiVersion = VK_API_VERSION_1_0;
+   // (1.1 -> vkGetPhysicalDeviceFeatures2/Properties2)
+   appInfo.apiVersion = VK_API_VERSION_1_1;
 
    // This data is not optional and tells the Vulkan driver which global
    // extensions and validation layers we want to use.
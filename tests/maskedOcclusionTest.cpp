@@ -0,0 +1,264 @@
+/*
+ * Headless test of the software occlusion culling(see MaskedOcclusion), it
+ * doesn't need a GPU. A quad at depth 0.5 that covers the center of the
+ * screen is the only occluder and the view-projection is the identity, so the
+ * expected result of each AABB is known:
+ *    - Behind the quad and inside of it -> occluded.
+ *    - In front of the quad or partly outside of it -> visible.
+ * An occluder in front of the near plane can't hide anything(it isn't
+ * clipped, so its triangles are discarded).
+ * The same boxes are culled with 1 and N workers and the results have to be
+ * the same. If a file is passed, the results are written to it, so the SSE and
+ * the AVX2 builds of this test can be compared(see tests/CMakeLists.txt).
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include <CroissantRenderer/Culling/MaskedOcclusion.h>
+#include <CroissantRenderer/Culling/Bounds.h>
+#include <CroissantRenderer/Job/JobSystem.h>
+
+static const uint32_t WIDTH = 320;
+static const uint32_t HEIGHT = 180;
+// (in NDC)
+static const float QUAD_HALF_SIZE = 0.5f;
+static const float QUAD_DEPTH = 0.5f;
+// Distance to the border of the quad where a box inside of it can still be
+// visible(the tiles of the border aren't fully covered).
+static const float BORDER_MARGIN = 0.1f;
+
+static uint32_t s_failsCount = 0;
+
+static void check(const bool condition, const std::string& what)
+{
+   if (condition)
+      return;
+
+   std::cerr << "FAILED: " << what << "\n";
+   s_failsCount++;
+}
+
+static const OccluderMesh& getQuad()
+{
+   static const OccluderMesh quad = {
+      {
+         {-QUAD_HALF_SIZE, -QUAD_HALF_SIZE, QUAD_DEPTH},
+         { QUAD_HALF_SIZE, -QUAD_HALF_SIZE, QUAD_DEPTH},
+         { QUAD_HALF_SIZE,  QUAD_HALF_SIZE, QUAD_DEPTH},
+         {-QUAD_HALF_SIZE,  QUAD_HALF_SIZE, QUAD_DEPTH}
+      },
+      {0, 1, 2, 0, 2, 3}
+   };
+
+   return quad;
+}
+
+/*
+ * -Grid of small boxes over all the screen, in front of and behind the quad
+ * (more than one job of the culling).
+ */
+static frustumCulling::Bounds createProbes()
+{
+   frustumCulling::Bounds bounds;
+
+   for (const float z : {0.3f, 0.8f})
+   {
+      for (int y = 0; y < 40; y++)
+      {
+         for (int x = 0; x < 40; x++)
+         {
+            bounds.centerX.push_back(-0.975f + x * 0.05f);
+            bounds.centerY.push_back(-0.975f + y * 0.05f);
+            bounds.centerZ.push_back(z);
+            bounds.extentX.push_back(0.02f);
+            bounds.extentY.push_back(0.02f);
+            bounds.extentZ.push_back(0.05f);
+         }
+      }
+   }
+
+   return bounds;
+}
+
+static std::vector<uint8_t> cullProbes(
+      const uint32_t workersCount,
+      const frustumCulling::Bounds& probes
+) {
+   JobSystem jobSystem(workersCount);
+   MaskedOcclusion maskedOcclusion(WIDTH, HEIGHT);
+   const glm::mat4 viewProj = glm::mat4(1.0f);
+
+   maskedOcclusion.addOccluder(glm::mat4(1.0f), getQuad());
+   maskedOcclusion.render(viewProj, jobSystem);
+
+   std::vector<uint8_t> isVisible(probes.centerX.size(), 1);
+   maskedOcclusion.cull(viewProj, probes, jobSystem, isVisible);
+
+   jobSystem.destroy();
+
+   return isVisible;
+}
+
+static void testKnownBoxes()
+{
+   JobSystem jobSystem(2);
+   MaskedOcclusion maskedOcclusion(WIDTH, HEIGHT);
+   const glm::mat4 viewProj = glm::mat4(1.0f);
+
+   maskedOcclusion.addOccluder(glm::mat4(1.0f), getQuad());
+   maskedOcclusion.render(viewProj, jobSystem);
+
+   check(
+         maskedOcclusion.isOccluded(
+            viewProj,
+            glm::vec3(0.0f, 0.0f, 0.8f),
+            glm::vec3(0.2f, 0.2f, 0.05f)
+         ),
+         "a box fully behind the quad is occluded"
+   );
+   check(
+         !maskedOcclusion.isOccluded(
+            viewProj,
+            glm::vec3(0.0f, 0.0f, 0.3f),
+            glm::vec3(0.2f, 0.2f, 0.05f)
+         ),
+         "a box in front of the quad is visible"
+   );
+   check(
+         !maskedOcclusion.isOccluded(
+            viewProj,
+            glm::vec3(0.0f, 0.0f, 0.8f),
+            glm::vec3(0.7f, 0.2f, 0.05f)
+         ),
+         "a box behind the quad but wider than it is visible"
+   );
+   check(
+         !maskedOcclusion.isOccluded(
+            viewProj,
+            glm::vec3(0.8f, 0.0f, 0.8f),
+            glm::vec3(0.1f, 0.1f, 0.05f)
+         ),
+         "a box beside the quad is visible"
+   );
+
+   jobSystem.destroy();
+}
+
+static void testNearPlane()
+{
+   // (same quad, but its bottom edge is in front of the near plane)
+   static const OccluderMesh nearQuad = {
+      {
+         {-QUAD_HALF_SIZE, -QUAD_HALF_SIZE, -0.1f},
+         { QUAD_HALF_SIZE, -QUAD_HALF_SIZE, -0.1f},
+         { QUAD_HALF_SIZE,  QUAD_HALF_SIZE, 0.2f},
+         {-QUAD_HALF_SIZE,  QUAD_HALF_SIZE, 0.2f}
+      },
+      {0, 1, 2, 0, 2, 3}
+   };
+
+   JobSystem jobSystem(2);
+   MaskedOcclusion maskedOcclusion(WIDTH, HEIGHT);
+   const glm::mat4 viewProj = glm::mat4(1.0f);
+
+   maskedOcclusion.addOccluder(glm::mat4(1.0f), nearQuad);
+   maskedOcclusion.render(viewProj, jobSystem);
+
+   check(
+         !maskedOcclusion.isOccluded(
+            viewProj,
+            glm::vec3(0.0f, 0.0f, 0.8f),
+            glm::vec3(0.2f, 0.2f, 0.05f)
+         ),
+         "an occluder that crosses the near plane doesn't hide anything"
+   );
+
+   jobSystem.destroy();
+}
+
+static void testProbes(
+      const std::vector<uint8_t>& isVisible,
+      const frustumCulling::Bounds& probes
+) {
+   uint32_t occludedCount = 0;
+
+   for (size_t i = 0; i < isVisible.size(); i++)
+   {
+      const float minX = probes.centerX[i] - probes.extentX[i];
+      const float maxX = probes.centerX[i] + probes.extentX[i];
+      const float minY = probes.centerY[i] - probes.extentY[i];
+      const float maxY = probes.centerY[i] + probes.extentY[i];
+      const float minZ = probes.centerZ[i] - probes.extentZ[i];
+
+      const bool isPartlyOutside = (
+            minX < -QUAD_HALF_SIZE || maxX > QUAD_HALF_SIZE ||
+            minY < -QUAD_HALF_SIZE || maxY > QUAD_HALF_SIZE
+      );
+      const bool isWellInside = (
+            minX > -QUAD_HALF_SIZE + BORDER_MARGIN &&
+            maxX < QUAD_HALF_SIZE - BORDER_MARGIN &&
+            minY > -QUAD_HALF_SIZE + BORDER_MARGIN &&
+            maxY < QUAD_HALF_SIZE - BORDER_MARGIN
+      );
+      const std::string name = "probe " + std::to_string(i);
+
+      if (minZ < QUAD_DEPTH || isPartlyOutside)
+         check(isVisible[i] == 1, name + " is visible");
+      else if (isWellInside)
+         check(isVisible[i] == 0, name + " is occluded");
+
+      occludedCount += (isVisible[i] == 0);
+   }
+
+   check(occludedCount > 0, "some probes are occluded");
+}
+
+int main(int argc, char** argv)
+{
+#if defined(__AVX2__)
+   std::cout << "MaskedOcclusion(AVX2)\n";
+#else
+   std::cout << "MaskedOcclusion(SSE)\n";
+#endif
+
+   testKnownBoxes();
+   testNearPlane();
+
+   const frustumCulling::Bounds probes = createProbes();
+   const uint32_t workersCount = std::max(
+         std::thread::hardware_concurrency(),
+         4u
+   );
+
+   const std::vector<uint8_t> isVisible1 = cullProbes(1, probes);
+   const std::vector<uint8_t> isVisibleN = cullProbes(workersCount, probes);
+
+   testProbes(isVisible1, probes);
+   check(isVisible1 == isVisibleN, "1 and N workers give the same result");
+
+   if (argc > 1)
+   {
+      std::ofstream results(argv[1]);
+
+      for (auto isVisible : isVisible1)
+         results << (isVisible ? '1' : '0');
+
+      results << "\n";
+   }
+
+   if (s_failsCount > 0)
+   {
+      std::cerr << s_failsCount << " checks failed.\n";
+      return 1;
+   }
+
+   std::cout << "All the checks passed.\n";
+
+   return 0;
+}